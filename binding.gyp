@@ -1,4 +1,11 @@
 {
+    "variables": {
+        # Nivel minimo de spdlog que se compila en los drivers: SPDLOG_LEVEL_INFO (default, prebuilds de produccion)
+        # quita por completo las llamadas trace/debug. Para un build de depuracion usar OINK_LOG_LEVEL=SPDLOG_LEVEL_TRACE
+        "spdlog_active_level%": "<!(node -p \"process.env.OINK_LOG_LEVEL || 'SPDLOG_LEVEL_INFO'\")",
+        # Con OINK_BENCH=1 tambien se compila el ejecutable de microbenchmarks (test/bench-drivers.cpp)
+        "oink_bench%": "<!(node -p \"process.env.OINK_BENCH || '0'\")"
+    },
     "targets": [{
         "target_name": "oink-addons",
         'cflags!': [
@@ -7,19 +14,35 @@
         'cflags_cc!': [
             '-fno-exceptions'
         ],
+        # Las tablas de codigos de los drivers usan std::string_view (C++17): se fija el estandar en vez de depender
+        # del default de node-gyp, que en versiones viejas de Node es gnu++14
+        'cflags_cc': [
+            '-std=c++17'
+        ],
         'xcode_settings': {
-            'GCC_ENABLE_CPP_EXCEPTIONS': 'YES'
+            'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',
+            'CLANG_CXX_LANGUAGE_STANDARD': 'c++17'
         },
         'msvs_settings': {
             'VCCLCompilerTool': {
-                'ExceptionHandling': 1
+                'ExceptionHandling': 1,
+                'AdditionalOptions': ['/std:c++17']
             }
         },
         "sources": [
             "src/main.cpp",
+            "src/common/ResultCache.cpp",
+            "src/common/CommandScheduler.cpp",
+            "src/common/Logging.cpp",
+            "src/common/FlightRecorder.cpp",
+            "src/common/SerialCapture.cpp",
+            "src/common/EventJournal.cpp",
+            "src/common/StateFile.cpp",
+            "src/common/PollScheduler.cpp",
             "src/pelicano/PelicanoControl.cpp",
             "src/pelicano/StateMachine.cpp",
             "src/pelicano/ValidatorPelicano.cpp",
+            "src/pelicano/SpeedControl.cpp",
             "src/pelicano/Pelicano.cpp",
             "src/azkoyen/AzkoyenControl.cpp",
             "src/azkoyen/StateMachine.cpp",
@@ -29,6 +52,7 @@
             "src/dispenser/DispenserControl.cpp",
             "src/dispenser/DispenserWrapper.cpp",
             "src/dispenser/StateMachine.cpp",
+            "src/nv10/EscrowPolicy.cpp",
             "src/nv10/NV10Control.cpp",
             "src/nv10/NV10Wrapper.cpp",
             "src/nv10/StateMachine.cpp",
@@ -39,7 +63,7 @@
             "src/spdlog/include"
         ],
         'libraries': [],
-        'defines': ['NAPI_CPP_EXCEPTIONS'],
+        'defines': ['NAPI_CPP_EXCEPTIONS', 'SPDLOG_ACTIVE_LEVEL=<(spdlog_active_level)'],
         'conditions': [
             ['OS=="mac"', {
             'xcode_settings': {
@@ -58,5 +82,42 @@
             }
           }],
         ]
-    }]
+    }],
+    "conditions": [
+        ['oink_bench==1', {
+            "targets": [{
+                "target_name": "oink-bench",
+                "type": "executable",
+                'cflags!': [
+                    '-fno-exceptions'
+                ],
+                'cflags_cc!': [
+                    '-fno-exceptions'
+                ],
+                'cflags_cc': [
+                    '-std=c++17'
+                ],
+                'xcode_settings': {
+                    'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',
+                    'CLANG_CXX_LANGUAGE_STANDARD': 'c++17'
+                },
+                "sources": [
+                    "test/bench-drivers.cpp",
+                    "src/common/Logging.cpp",
+                    "src/common/FlightRecorder.cpp",
+                    "src/common/SerialCapture.cpp",
+                    "src/pelicano/ValidatorPelicano.cpp",
+                    "src/azkoyen/ValidatorAzkoyen.cpp",
+                    "src/dispenser/Dispenser.cpp",
+                    "src/nv10/ValidatorNV10.cpp",
+                ],
+                'include_dirs': [
+                    "src",
+                    "src/spdlog/include"
+                ],
+                'libraries': ['-lpthread'],
+                'defines': ['SPDLOG_ACTIVE_LEVEL=<(spdlog_active_level)'],
+            }]
+        }],
+    ]
 }
\ No newline at end of file
@@ -1,12 +1,40 @@
 #include "Azkoyen.hpp"
 
 
-std::thread nativeThreadAzkoyen;
-Napi::ThreadSafeFunction tsfnAzkoyen;
-static bool isRunningAzkoyen = true;
-static bool threadEndedAzkoyen = true;
+// Mensajes de getCoin/onCoin para el modo compacto. Los codigos 401/402/403 llevan contadores en el mensaje
+// completo, por eso aqui solo se deja su descripcion general
+static const StatusMessage_t CoinMessages[] = {
+  { 202, "Moneda detectada" },
+  { 302, "Moneda rechazada" },
+  { 303, "No hay nueva informacion" },
+  { 401, "Error reportado por el validador" },
+  { 402, "Error reportado por el validador. Contador de errores criticos lleno" },
+  { 403, "Error reportado por el validador. Contador de alertas lleno" },
+  { 404, "DeafaultError" },
+  { 503, "Fallo con el validador. No responde" },
+  { 507, "No se ha iniciado el lector (StartReader)" },
+};
 
-Napi::FunctionReference Azkoyen::constructor;
+static Napi::Object CoinResult(Napi::Env env, const CoinError_t &coin, bool compact) {
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  if (compact) {
+    Field_t fields[] = {
+      { KEY_STATUS_CODE,  cache->Number(env, coin.StatusCode) },
+      { KEY_EVENT,        cache->Number(env, coin.Event) },
+      { KEY_COIN,         cache->Number(env, coin.Coin) },
+      { KEY_REMAINING,    cache->Number(env, coin.Remaining) },
+    };
+    return cache->Build(env, fields);
+  }
+  Field_t fields[] = {
+    { KEY_STATUS_CODE,  cache->Number(env, coin.StatusCode) },
+    { KEY_EVENT,        cache->Number(env, coin.Event) },
+    { KEY_COIN,         cache->Number(env, coin.Coin) },
+    { KEY_MESSAGE,      cache->Message(env, coin.StatusCode, coin.Message) },
+    { KEY_REMAINING,    cache->Number(env, coin.Remaining) },
+  };
+  return cache->Build(env, fields);
+}
 
 Napi::Object Azkoyen::Init(Napi::Env env, Napi::Object exports) {
   Napi::HandleScope scope(env);
@@ -22,9 +50,13 @@ Napi::Object Azkoyen::Init(Napi::Env env, Napi::Object exports) {
     InstanceMethod("testStatus", &Azkoyen::TestStatus),
     InstanceMethod("cleanDevice", &Azkoyen::CleanDevice),
     InstanceMethod("onCoin", &Azkoyen::OnCoin),
+    InstanceMethod("getQueueStats", &Azkoyen::GetQueueStats),
+    InstanceMethod("dumpFlightRecorder", &Azkoyen::DumpFlightRecorder),
+    InstanceMethod("getEvents", &Azkoyen::GetEvents),
+    InstanceMethod("getPollStats", &Azkoyen::GetPollStats),
+    StaticValue("messages", ResultCacheClass::Get(env)->MessageTable(env, CoinMessages, sizeof(CoinMessages)/sizeof(CoinMessages[0]))),
   });
-  constructor = Napi::Persistent(func);
-  constructor.SuppressDestruct();
+  env.GetInstanceData<AddonData::AddonDataClass>()->AzkoyenConstructor = Napi::Persistent(func);
   exports.Set("Azkoyen", func);
   return exports;
 }
@@ -61,64 +93,74 @@ Azkoyen::Azkoyen(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Azkoyen>(inf
   this->azkoyenControl_->MaximumPorts = MaximumPorts.Int32Value();
   this->azkoyenControl_->LogLvl = LogLvl.Uint32Value();
   this->azkoyenControl_->Path = LogFilePath.Utf8Value();
+  if (params.Has("capturePath")) {
+    this->azkoyenControl_->CapturePath = params.Get("capturePath").ToString().Utf8Value();
+  }
+  if (params.Has("journalPath")) {
+    this->azkoyenControl_->JournalPath = params.Get("journalPath").ToString().Utf8Value();
+  }
+  PollScheduler::Config_t config = this->azkoyenControl_->PollRate.GetConfig();
+  if (PollScheduler::ParseConfig(params, config)) {
+    this->azkoyenControl_->PollRate.Configure(config);
+  }
+  this->compact_ = params.Has("compact") && params.Get("compact").ToBoolean().Value();
+
+  this->isRunning_ = true;
+  this->threadEnded_ = true;
 
   this->azkoyenControl_->InitLog();
 }
 
+// Igual que Pelicano: los hilos ya terminaron (Ref/Unref) y al borrar el control se libera el puerto
+Azkoyen::~Azkoyen() {
+  this->isRunning_ = false;
+  if (this->nativeThread_.joinable()) {
+    this->nativeThread_.join();
+  }
+  delete this->azkoyenControl_;
+}
+
 Napi::Value Azkoyen::Connect(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->azkoyenControl_->Connect();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value Azkoyen::CheckDevice(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->azkoyenControl_->CheckDevice();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value Azkoyen::StartReader(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->azkoyenControl_->StartReader();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value Azkoyen::GetCoin(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   CoinError_t response = this->azkoyenControl_->GetCoin();
-  Napi::Object object = Napi::Object::New(env);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  object["event"] = Napi::Number::New(env, response.Event);
-  object["coin"] = Napi::Number::New(env, response.Coin);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["remaining"] = Napi::Number::New(env, response.Remaining);
-  return object;
+  return CoinResult(env, response, this->compact_);
 }
 
 Napi::Value Azkoyen::GetLostCoins(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   CoinLost_t response = this->azkoyenControl_->GetLostCoins();
-  Napi::Object object = Napi::Object::New(env);
-  object["50"] = Napi::Number::New(env, response.CoinCinc);
-  object["100"] = Napi::Number::New(env, response.CoinCien);
-  object["200"] = Napi::Number::New(env, response.CoinDosc);
-  object["500"] = Napi::Number::New(env, response.CoinQuin);
-  object["1000"] = Napi::Number::New(env, response.CoinMil);
-  return object;
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  Field_t fields[] = {
+    { KEY_COIN_50,    cache->Number(env, response.CoinCinc) },
+    { KEY_COIN_100,   cache->Number(env, response.CoinCien) },
+    { KEY_COIN_200,   cache->Number(env, response.CoinDosc) },
+    { KEY_COIN_500,   cache->Number(env, response.CoinQuin) },
+    { KEY_COIN_1000,  cache->Number(env, response.CoinMil) },
+  };
+  return cache->Build(env, fields);
 }
 
 Napi::Value Azkoyen::ModifyChannels(const Napi::CallbackInfo& info) {
@@ -132,46 +174,39 @@ Napi::Value Azkoyen::ModifyChannels(const Napi::CallbackInfo& info) {
   Napi::Number InhibitMask2 = info[1].As<Napi::Number>();
 
   Response_t response = this->azkoyenControl_->ModifyChannels(InhibitMask1.Int32Value(), InhibitMask2.Int32Value());
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value Azkoyen::StopReader(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
-  isRunningAzkoyen = false;
+  this->isRunning_ = false;
   Response_t response = this->azkoyenControl_->StopReader();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value Azkoyen::ResetDevice(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->azkoyenControl_->ResetDevice();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value Azkoyen::TestStatus(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   TestStatus_t response = this->azkoyenControl_->TestStatus();
-  Napi::Object object = Napi::Object::New(env);
-  object["version"] = Napi::String::New(env, response.Version);
-  object["device"] = Napi::Number::New(env, response.Device);
-  object["errorType"] = Napi::Number::New(env, response.ErrorType);
-  object["errorCode"] = Napi::Number::New(env, response.ErrorCode);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["aditionalInfo"] = Napi::String::New(env, response.AditionalInfo);
-  object["priority"] = Napi::Number::New(env, response.Priority);
-  return object;
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  Field_t fields[] = {
+    { KEY_VERSION,        cache->String(env, response.Version) },
+    { KEY_DEVICE,         cache->Number(env, response.Device) },
+    { KEY_ERROR_TYPE,     cache->Number(env, response.ErrorType) },
+    { KEY_ERROR_CODE,     cache->Number(env, response.ErrorCode) },
+    { KEY_MESSAGE,        cache->Text(env, response.Message) },
+    { KEY_ADITIONAL_INFO, cache->Text(env, response.AditionalInfo) },
+    { KEY_PRIORITY,       cache->Number(env, response.Priority) },
+  };
+  return cache->Build(env, fields);
 }
 
 Napi::Value Azkoyen::CleanDevice(const Napi::CallbackInfo &info) {
@@ -190,47 +225,74 @@ Napi::Value Azkoyen::OnCoin(const Napi::CallbackInfo &info)
   }
   
   Napi::Function napiFunction = info[0].As<Napi::Function>();
-  tsfnAzkoyen = Napi::ThreadSafeFunction::New(
+  // El hilo usa this: el objeto no se libera hasta el finalizador del tsfn (Unref)
+  this->Ref();
+  this->tsfn_ = Napi::ThreadSafeFunction::New(
     env, 
     napiFunction, 
     "Callback", 
     0, 
     1,
-    []( Napi::Env ) {
-      nativeThreadAzkoyen.join();
+    [this]( Napi::Env ) {
+      this->nativeThread_.join();
+      this->Unref();
     });
 
-  nativeThreadAzkoyen = std::thread ( [this] {
-    auto callback = [](Napi::Env env, Napi::Function jsCallback, CoinError_t* coin) {
-      Napi::Object object = Napi::Object::New(env);
-      object["statusCode"] = Napi::Number::New(env, coin->StatusCode);
-      object["event"] = Napi::Number::New(env, coin->Event);
-      object["coin"] = Napi::Number::New(env, coin->Coin);
-      object["message"] = Napi::String::New(env, coin->Message);
-      object["remaining"] = Napi::Number::New(env, coin->Remaining);
-      jsCallback.Call({object});
+  this->nativeThread_ = std::thread ( [this] {
+    bool compact = this->compact_;
+    auto callback = [compact](Napi::Env env, Napi::Function jsCallback, CoinError_t* coin) {
+      jsCallback.Call({CoinResult(env, *coin, compact)});
       delete coin;
     };
-    isRunningAzkoyen = true;
-    threadEndedAzkoyen = false;
-    while (isRunningAzkoyen) {
-      std::this_thread::sleep_for( std::chrono::milliseconds(10));
+    this->isRunning_ = true;
+    this->threadEnded_ = false;
+    while (this->isRunning_) {
+      // La espera larga (sin actividad) va en pasos de 10 ms para responder rapido a finish
+      PollScheduler::WaitNextPoll([this] { return this->azkoyenControl_->PollDelayMs(); }, this->isRunning_);
       CoinError_t response = this->azkoyenControl_->GetCoin();
       if (response.StatusCode == 303) continue;
       CoinError_t *value = new CoinError_t(response);
-      napi_status status = tsfnAzkoyen.BlockingCall(value, callback);
+      napi_status status = this->tsfn_.BlockingCall(value, callback);
       if ( status != napi_ok ) break;
     }
-    threadEndedAzkoyen = true;
-    tsfnAzkoyen.Release();
+    this->threadEnded_ = true;
+    this->tsfn_.Release();
   });
 
-  auto finishFn = [] (const Napi::CallbackInfo& info) {
-    isRunningAzkoyen = false;
-    while (!threadEndedAzkoyen);
+  auto finishFn = [this] (const Napi::CallbackInfo& info) {
+    this->isRunning_ = false;
+    while (!this->threadEnded_);
     std::this_thread::sleep_for( std::chrono::milliseconds(50));
     return;
   };
 
   return Napi::Function::New(env, finishFn);
+}
+
+Napi::Value Azkoyen::GetQueueStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  return ResultCacheClass::Get(env)->QueueStats(env, this->azkoyenControl_->Scheduler);
+}
+
+Napi::Value Azkoyen::DumpFlightRecorder(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  long count = this->azkoyenControl_->DumpFlightRecorder();
+  return ResultCacheClass::Get(env)->RecorderDump(env, count, this->azkoyenControl_->Globals.AzkoyenObject.Recorder.Path);
+}
+
+Napi::Value Azkoyen::GetEvents(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  uint64_t since = (info.Length() > 0 && info[0].IsNumber()) ? static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value()) : 0;
+  std::vector<EventJournal::Event_t> events;
+  this->azkoyenControl_->GetEvents(since, events);
+  return ResultCacheClass::Get(env)->JournalEvents(env, events);
+}
+
+Napi::Value Azkoyen::GetPollStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  return ResultCacheClass::Get(env)->PollStats(env, this->azkoyenControl_->GetPollStats());
 }
\ No newline at end of file
@@ -1,16 +1,20 @@
 #include <napi.h>
 #include <thread>
 #include <chrono>
+#include <atomic>
 #include "AzkoyenControl.hpp"
+#include "../common/AddonData.hpp"
+#include "../common/PollOptions.hpp"
 
 using namespace AzkoyenControl;
+using namespace ResultCache;
 
 class Azkoyen : public Napi::ObjectWrap<Azkoyen> {
   public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     Azkoyen(const Napi::CallbackInfo& info);
+    ~Azkoyen();
   private:
-    static Napi::FunctionReference constructor;
     Napi::Value Connect(const Napi::CallbackInfo& info);
     Napi::Value CheckDevice(const Napi::CallbackInfo& info);
     Napi::Value StartReader(const Napi::CallbackInfo& info);
@@ -22,5 +26,14 @@ class Azkoyen : public Napi::ObjectWrap<Azkoyen> {
     Napi::Value TestStatus(const Napi::CallbackInfo& info);
     Napi::Value CleanDevice(const Napi::CallbackInfo& info);
     Napi::Value OnCoin(const Napi::CallbackInfo& info);
+    Napi::Value GetQueueStats(const Napi::CallbackInfo& info);
+    Napi::Value DumpFlightRecorder(const Napi::CallbackInfo& info);
+    Napi::Value GetEvents(const Napi::CallbackInfo& info);
+    Napi::Value GetPollStats(const Napi::CallbackInfo& info);
     AzkoyenControlClass *azkoyenControl_;
+    std::thread nativeThread_;
+    Napi::ThreadSafeFunction tsfn_;
+    std::atomic<bool> isRunning_;
+    std::atomic<bool> threadEnded_;
+    bool compact_;
 };
\ No newline at end of file
@@ -16,33 +16,12 @@ namespace AzkoyenControl {
     using namespace AzkoyenStateMachine;
     using namespace ValidatorAzkoyen;
 
-    // --------------- EXTERNAL VARIABLES --------------------//
-
-    // READ ONLY
-    int PortO;   
-
-    // WRITE ONLY
-    int WarnToCritical;
-    int MaxCritical;
-    std::string Path;
-    int LogLvl;
-    int MaximumPorts;
-    
     // --------------- INTERNAL VARIABLES --------------------//
     
-    std::string VERSION = "1.1";
-    std::string DEFAULTERROR = "DeafaultError";
-    int Remaining;
-    bool FlagCritical;
-    bool FlagCritical2;
-    int DeckCounter;
-    int WarnCounter;
-    int CriticalCounter;
-    int CoinEventPrev;
-
-    Response_t Response;
+    const std::string VERSION = "1.1";
+    const std::string DEFAULTERROR = "DeafaultError";
     
-    AzkoyenControlClass::AzkoyenControlClass(){
+    AzkoyenControlClass::AzkoyenControlClass() : PollRate(PollScheduler::CCTALKMINMS, PollScheduler::CCTALKMAXMS) {
         PortO = 0;
         CoinEventPrev = 0;
         DeckCounter = 0;
@@ -66,9 +45,21 @@ namespace AzkoyenControl {
         Globals.AzkoyenObject.LoggerLevel = LogLvl;
         Globals.AzkoyenObject.InitLogger(Path);
         Globals.AzkoyenObject.MaxPorts = MaximumPorts;
+        if (!CapturePath.empty()){
+            Globals.AzkoyenObject.StartCapture(CapturePath);
+        }
+        if (!JournalPath.empty()){
+            if (Journal.Open(JournalPath) == 0){
+                Globals.AzkoyenObject.logger->info("[InitLog] Event journal {0} opened, last sequence {1}",JournalPath,Journal.LastSequence());
+            }
+            else {
+                Globals.AzkoyenObject.logger->error("[InitLog] Could not open event journal {0}",JournalPath);
+            }
+        }
     }
 
     Response_t AzkoyenControlClass::Connect() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
         
         int Connection = -1;
         int Check = -1;
@@ -103,6 +94,7 @@ namespace AzkoyenControl {
     }
 
     Response_t AzkoyenControlClass::CheckDevice() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         int Check = -1;
 
@@ -116,6 +108,7 @@ namespace AzkoyenControl {
     }
 
     Response_t AzkoyenControlClass::StartReader() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
         
         int Enable = -1;
         int Poll = -1;
@@ -137,10 +130,10 @@ namespace AzkoyenControl {
 
         //Deberia entrar aca desde el estado ST_CHECK
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
-        if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_CHECK") == 0){
+        if (Globals.SMObject.SM.CurrState == AzkoyenSMClass::ST_CHECK){
             FlagInit = true;
         }
-        else if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_POLLING") == 0){
+        else if (Globals.SMObject.SM.CurrState == AzkoyenSMClass::ST_POLLING){
             //Se revisa que el evento este reiniciado para poder comenzar a hacer polling correctamente
             if (Globals.AzkoyenObject.CoinEvent <= 1){
                 Response.StatusCode = 300;
@@ -188,6 +181,7 @@ namespace AzkoyenControl {
                     if (((Poll == 0) | (Poll == -2)) & (Globals.AzkoyenObject.CoinEvent <= 1)){
                         Response.StatusCode = 201;
                         Response.Message = "Validador OK. Listo para iniciar a leer monedas";
+                        PollRate.Start(std::chrono::steady_clock::now());
                     }
                     else if (Globals.AzkoyenObject.CoinEvent > 1){
                         Response.StatusCode = 506;
@@ -211,6 +205,7 @@ namespace AzkoyenControl {
     }
 
     CoinError_t AzkoyenControlClass::GetCoin() {
+        CommandTicket Ticket(Scheduler, PRIORITY_POLL);
         
         CoinError_t ResponseCE;
 
@@ -225,7 +220,7 @@ namespace AzkoyenControl {
         //Deberia entrar aca desde el estado ST_POLLING
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
 
-        if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_POLLING") == 0){
+        if (Globals.SMObject.SM.CurrState == AzkoyenSMClass::ST_POLLING){
             
             Poll = Globals.SMObject.StateMachineRun(AzkoyenSMClass::EV_POLL);
             
@@ -312,7 +307,18 @@ namespace AzkoyenControl {
                     ResponseCE.Remaining = Remaining;                            
                 }
 
+                // El diario guarda solo las monedas aceptadas y rechazadas, los errores quedan en el log. Va un registro
+                // por moneda del polling, tambien cuando el mismo polling trae un error, para que cuadre con InsertedCoins
+                for (const CoinPolling_t &Coin : Globals.AzkoyenObject.PollCoins){
+                    Journal.Append(SerialCapture::DEVICE_AZKOYEN, EventJournal::EVENT_COIN_ACCEPTED, Coin.Coin, Coin.Channel, ResponseCE.StatusCode);
+                }
+                Globals.AzkoyenObject.PollCoins.clear();
+                if (ResponseCE.StatusCode == 302){
+                    Journal.Append(SerialCapture::DEVICE_AZKOYEN, EventJournal::EVENT_COIN_REJECTED, 0, 0, ResponseCE.StatusCode);
+                }
+
                 CoinEventPrev = (Globals.AzkoyenObject.CoinEvent == 255) ? 0 : Globals.AzkoyenObject.CoinEvent;
+                PollRate.Activity(std::chrono::steady_clock::now());
                 
             }
             else{
@@ -321,6 +327,7 @@ namespace AzkoyenControl {
                 ResponseCE.Coin = 0;
                 ResponseCE.Message = "No hay nueva informacion";
             }
+            PollRate.Next(std::chrono::steady_clock::now());
         }
         else{
             ResponseCE.StatusCode = 507;
@@ -330,6 +337,7 @@ namespace AzkoyenControl {
     }
 
     CoinLost_t AzkoyenControlClass::GetLostCoins() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         CoinLost_t ResponseLC;
 
@@ -339,7 +347,7 @@ namespace AzkoyenControl {
         ResponseLC.CoinQuin = 0;
         ResponseLC.CoinMil = 0;
 
-        if(strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_POLLING") == 0){
+        if(Globals.SMObject.SM.CurrState == AzkoyenSMClass::ST_POLLING){
             ResponseLC.CoinCinc = Globals.AzkoyenObject.CoinCinc;
             ResponseLC.CoinCien = Globals.AzkoyenObject.CoinCien;
             ResponseLC.CoinDosc = Globals.AzkoyenObject.CoinDosc;
@@ -351,6 +359,7 @@ namespace AzkoyenControl {
     }
     
     Response_t AzkoyenControlClass::ModifyChannels(int InhibitMask1,int InhibitMask2) {
+        CommandTicket Ticket(Scheduler, PRIORITY_URGENT);
 
         int Inhibit = Globals.AzkoyenObject.ChangeInhibitChannels(InhibitMask1,InhibitMask2);
 
@@ -367,12 +376,13 @@ namespace AzkoyenControl {
     }
 
     Response_t AzkoyenControlClass::StopReader() {
+        CommandTicket Ticket(Scheduler, PRIORITY_URGENT);
               
         //Deberia entrar aca desde el estado ST_POLLING
 
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
 
-        if(strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_POLLING") == 0){
+        if(Globals.SMObject.SM.CurrState == AzkoyenSMClass::ST_POLLING){
             if ((FlagCritical) | (FlagCritical2)) {
                 //Cambio de estado: ST_POLLING ---> ST_ERROR
                 Globals.SMObject.StateMachineRun(AzkoyenSMClass::EV_ERROR);
@@ -408,6 +418,7 @@ namespace AzkoyenControl {
     }
 
     Response_t AzkoyenControlClass::ResetDevice() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         int Reset = -1;
 
@@ -428,6 +439,7 @@ namespace AzkoyenControl {
     }
 
     TestStatus_t AzkoyenControlClass::TestStatus() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         TestStatus_t Status;
         
@@ -489,5 +501,23 @@ namespace AzkoyenControl {
         }
         return Response;
     }
-}
 
+    long AzkoyenControlClass::DumpFlightRecorder() {
+        // Sin turno del planificador: el flight recorder se lee sin locks y no usa el puerto serial
+        return Globals.AzkoyenObject.DumpRecorder("N-API");
+    }
+
+    size_t AzkoyenControlClass::GetEvents(uint64_t Since, std::vector<EventJournal::Event_t> &Events) {
+        // Sin turno del planificador: el diario tiene su propio mutex y no usa el puerto serial
+        return Journal.ReadSince(Since, Events, EventJournal::READLIMIT);
+    }
+
+    PollScheduler::Stats_t AzkoyenControlClass::GetPollStats() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
+        return PollRate.Stats(std::chrono::steady_clock::now());
+    }
+
+    int AzkoyenControlClass::PollDelayMs() {
+        return PollRate.Interval();
+    }
+}
@@ -16,11 +16,15 @@
 #include <string>
 #include <iostream>
 #include "StateMachine.hpp"
+#include "../common/CommandScheduler.hpp"
+#include "../common/EventJournal.hpp"
+#include "../common/PollScheduler.hpp"
 #include "ValidatorAzkoyen.hpp"
 
 namespace AzkoyenControl{
 
     using namespace AzkoyenStateMachine;
+    using namespace CommandScheduler;
     using namespace ValidatorAzkoyen;
 
     struct Response_t{
@@ -72,10 +76,25 @@ namespace AzkoyenControl{
             int WarnToCritical;
             int MaxCritical;
             std::string Path;
+            std::string CapturePath;    // Vacio: sin captura binaria del trafico serial
+            std::string JournalPath;    // Vacio: sin diario de eventos
             int LogLvl;
             int MaximumPorts;
 
+            //INTERNAL
+            int Remaining;
+            bool FlagCritical;
+            bool FlagCritical2;
+            int DeckCounter;
+            int WarnCounter;
+            int CriticalCounter;
+            int CoinEventPrev;
+            Response_t Response;
+
             GlobalVariables Globals;
+            CommandSchedulerClass Scheduler;
+            EventJournal::EventJournalClass Journal;
+            PollScheduler::PollSchedulerClass PollRate; // Espera entre polls de onCoin
 
             AzkoyenControlClass();
             ~AzkoyenControlClass();
@@ -89,6 +108,10 @@ namespace AzkoyenControl{
             Response_t StopReader();
             Response_t ResetDevice();
             TestStatus_t TestStatus();
+            long DumpFlightRecorder();
+            size_t GetEvents(uint64_t Since, std::vector<EventJournal::Event_t> &Events);
+            PollScheduler::Stats_t GetPollStats();
+            int PollDelayMs();
             Response_t CheckCodes(int Check);
     };
 }
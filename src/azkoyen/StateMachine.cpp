@@ -15,19 +15,9 @@ namespace AzkoyenStateMachine {
 
     using namespace ValidatorAzkoyen;
 
-    AzkoyenClass *AzkoyenObject;
+    typedef StateMachineBase::StateMachine<AzkoyenClass, AzkoyenSMTypes::State_t, AzkoyenSMTypes::Event_t> Base_t;
 
-    AzkoyenSMClass::AzkoyenSMClass(ValidatorAzkoyen::AzkoyenClass *_AzkoyenClass_p){
-        AzkoyenObject = _AzkoyenClass_p;
-        SM.CurrState = AzkoyenSMClass::ST_IDLE;
-    };
-
-    struct StateFunctionRow_t{
-        const char * name;
-        int (AzkoyenClass::*func)(void);
-    };
-
-    static StateFunctionRow_t StateFunctionValidatorAzkoyen[] = {
+    static const Base_t::StateRow_t StateFunctionValidatorAzkoyen[] = {
             // NAME         // FUNC
         { "ST_IDLE",       &AzkoyenClass::StIdle },      
         { "ST_CONNECT",    &AzkoyenClass::StConnect }, 
@@ -37,14 +27,11 @@ namespace AzkoyenStateMachine {
         { "ST_RESET",      &AzkoyenClass::StReset },
         { "ST_ERROR",      &AzkoyenClass::StError }, 
     };
+    static_assert(sizeof(StateFunctionValidatorAzkoyen)/sizeof(StateFunctionValidatorAzkoyen[0]) == AzkoyenSMClass::ST_COUNT, "Falta la funcion de algun estado");
+
+    typedef StateTable::TransitionRow_t<AzkoyenSMClass::State_t, AzkoyenSMClass::Event_t> StateTransitionRow_t;
 
-    struct StateTransitionRow_t{
-        AzkoyenSMClass::State_t CurrState;
-        AzkoyenSMClass::Event_t Event;
-        AzkoyenSMClass::State_t NextState;
-    } ;
-    
-    static StateTransitionRow_t StateTransition[] = {
+    static constexpr StateTransitionRow_t StateTransition[] = {
         // CURR STATE       // EVENT            // NEXT STATE
         { AzkoyenSMClass::ST_IDLE,          AzkoyenSMClass::EV_ANY,             AzkoyenSMClass::ST_CONNECT},
 
@@ -69,46 +56,23 @@ namespace AzkoyenStateMachine {
         { AzkoyenSMClass::ST_ERROR,         AzkoyenSMClass::EV_ANY,             AzkoyenSMClass::ST_IDLE},
 
     };
+    static_assert(StateTable::IsValid<AzkoyenSMClass::ST_COUNT, AzkoyenSMClass::EV_COUNT>(StateTransition), "Transicion fuera de rango o repetida");
 
-    void AzkoyenSMClass::InitStateMachine() {
-        SM.CurrState = AzkoyenSMClass::ST_IDLE; 
-        (AzkoyenObject[0].*(StateFunctionValidatorAzkoyen[SM.CurrState].func))();
+    // Tabla densa [estado][evento] construida en compilacion a partir de StateTransition
+    static constexpr Base_t::Table_t Transitions = StateTable::BuildTable<AzkoyenSMClass::ST_COUNT, AzkoyenSMClass::EV_COUNT>(StateTransition);
+
+    AzkoyenSMClass::AzkoyenSMClass(ValidatorAzkoyen::AzkoyenClass *_AzkoyenClass_p)
+        : Base_t(_AzkoyenClass_p, StateFunctionValidatorAzkoyen, &Transitions, 0) {
+        SetRecorder(&_AzkoyenClass_p->Recorder);
+        SetEntryHook(ST_ERROR, &AzkoyenClass::DumpRecorderOnError);
     }
 
     int AzkoyenSMClass::RunCheck() {
-        int Response = -1;
-        LS.CurrState = SM.CurrState; 
-        SM.CurrState = AzkoyenSMClass::ST_CHECK; 
-        Response = (AzkoyenObject[0].*(StateFunctionValidatorAzkoyen[SM.CurrState].func))();
-        SM.CurrState = LS.CurrState;
-        return Response;
+        return RunState(AzkoyenSMClass::ST_CHECK);
     }
 
     int AzkoyenSMClass::RunReset() {
-        int Response = -1;
-        LS.CurrState = SM.CurrState; 
-        SM.CurrState = AzkoyenSMClass::ST_RESET; 
-        Response = (AzkoyenObject[0].*(StateFunctionValidatorAzkoyen[SM.CurrState].func))();
-        SM.CurrState = LS.CurrState;
-        return Response;
-    }
-    
-    int AzkoyenSMClass::StateMachineRun(Event_t Event) {
-        int Response = -1;
-        for(long unsigned int i = 0; i < sizeof(StateTransition)/sizeof(StateTransition[0]); i++) {
-            if(StateTransition[i].CurrState == SM.CurrState) {
-                if(StateTransition[i].Event == Event) {
-                    SM.CurrState =  StateTransition[i].NextState;
-                    Response = (AzkoyenObject[0].*(StateFunctionValidatorAzkoyen[SM.CurrState].func))();
-                    return Response;
-                    break;
-                }
-            }
-        }
-        return 0;
-    }
-    
-    const char * AzkoyenSMClass::StateMachineGetStateName(State_t State) {
-        return StateFunctionValidatorAzkoyen[State].name;
+        return RunState(AzkoyenSMClass::ST_RESET);
     }
+
 };
\ No newline at end of file
@@ -10,54 +10,12 @@
  */
 
 #include "ValidatorAzkoyen.hpp"
+#include "../common/CodeTable.hpp"
 
 namespace ValidatorAzkoyen{
 
-    // --------------- EXTERNAL VARIABLES --------------------//
-
-    //READ ONLY
-    
-    int SerialPort;
-    bool SuccessConnect;
-    int PortO;
-    
-    int CoinEvent;
-    int CoinEventPrev;
-
-    int CoinCinc;
-    int CoinCien;
-    int CoinDosc;
-    int CoinQuin;
-    int CoinMil;
-
-    bool ErrorHappened;
-    bool CriticalError;
-
-    int ErrorOCode;
-    std::string ErrorOMsg;
-    int ErrorOStatic;
-    int ErrorOCritical;
-
-    int FaultOCode;
-    std::string FaultOMsg;
-
-    bool NoUsedBit;
-    bool MeasurePhotoBlocked;
-    bool OutPhotoBlocked;
-    bool COSAlert;
-
-    int ActOCoin;
-    int ActOChannel;
-
-    //WRITE ONLY
-    
-    int LoggerLevel;
-    std::string LogFilePath;
-    int MaxPorts;
-
     // --------------- INTERNAL VARIABLES --------------------//
 
-    bool Scanning;
 
     std::vector<unsigned char> CMDSIMPLEPOLL    = {0x02, 0x00, 0x01, 0xFE, 0xFF};
     std::vector<unsigned char> CMDSTARTPOLL     = {0x02, 0x00, 0x01, 0xE5, 0x18};
@@ -68,18 +26,13 @@ namespace ValidatorAzkoyen{
     std::vector<unsigned char> CMDENABLE        = {0x02, 0x02, 0x01, 0xE7, 0xFF, 0xFF, 0x16};
     std::vector<unsigned char> CMDINHIBIT50     = {0x02, 0x02, 0x01, 0xE7, 0xF7, 0xFD, 0x20};
 
-    std::string DEFAULTERROR = "Error por defecto";
+    const std::string DEFAULTERROR = "Error por defecto";
     
-    ErrorCodePolling_t ErrP;
-    ErrorCodePolling_t ErrPPrev;
 
-    FaultCode_t FaultC;
 
-    CoinPolling_t ActCoin;
 
-    std::shared_ptr<spdlog::logger> logger;
     
-    static CoinPolling_t CoinPolling[] = {
+    static constexpr CoinPolling_t CoinPolling[] = {
         //Agregar los demás canales de moneda.
         {1,0},
         {2,0},
@@ -99,7 +52,7 @@ namespace ValidatorAzkoyen{
         {16,1000},
     };
 
-    static ErrorCodePolling_t ErrorCodePolling[] = {
+    static constexpr ErrorCodePolling_t ErrorCodePolling[] = {
         {0,"Null event",0,0},
         {1,"Reject coin",1,3},
         {2,"Inhibited coin",1,0},
@@ -178,7 +131,7 @@ namespace ValidatorAzkoyen{
         {255,"Unspecified alarm code",0,2},
     };
 
-    static SpdlogLevels_t SpdlogLvl[] = {
+    static constexpr SpdlogLevels_t SpdlogLvl[] = {
         {0,"trace"},
         {1,"debug"},
         {2,"info"},
@@ -188,7 +141,7 @@ namespace ValidatorAzkoyen{
         {6,"off"},
     };
 
-    static ErrorCodeExComm_t ErrorCodesExComm[] = {
+    static constexpr ErrorCodeExComm_t ErrorCodesExComm[] = {
         {-6,"[] Function EC/HR/HRP/HRI was not executed"},
         {-5,"[EC] Writting error"},
         {-4,"[EC] Writing successful but cannot read"},
@@ -204,7 +157,7 @@ namespace ValidatorAzkoyen{
         { 6,"[EC] Command not recognized or adress is wrong"},
     };
 
-    static FaultCode_t FaultCodeM[] = {
+    static constexpr FaultCode_t FaultCodeM[] = {
         {  0,"OK"},
         {  1,"Firmware checksum corrupted"},
         {  2,"Fault on electromagnetic sensors"},
@@ -222,9 +175,31 @@ namespace ValidatorAzkoyen{
         {255,"No valid hardware test: Measuring a coin inside"},
     };
 
+    // Tablas de acceso directo por codigo, construidas en compilacion a partir de las tablas anteriores
+    static constexpr SpdlogLevels_t SpdlogTableDefault = {0,"SpdlogLvl not found!!!"};
+    static_assert(CodeTable::IsValid<SpdlogLevels_t, &SpdlogLevels_t::Code>(SpdlogLvl), "Codigo fuera de la tabla SpdlogLvl");
+    static constexpr CodeTable::DenseTable_t<SpdlogLevels_t> SpdlogTable = CodeTable::BuildTable<SpdlogLevels_t, &SpdlogLevels_t::Code>(SpdlogLvl, SpdlogTableDefault);
+
+    static constexpr ErrorCodeExComm_t ExCommTableDefault = {0,"ErrorCode not found!!!"};
+    static_assert(CodeTable::IsValid<ErrorCodeExComm_t, &ErrorCodeExComm_t::Code>(ErrorCodesExComm, -128), "Codigo fuera de la tabla ErrorCodesExComm");
+    static constexpr CodeTable::DenseTable_t<ErrorCodeExComm_t> ExCommTable = CodeTable::BuildTable<ErrorCodeExComm_t, &ErrorCodeExComm_t::Code>(ErrorCodesExComm, ExCommTableDefault, -128);
+
+    static constexpr CoinPolling_t CoinTableDefault = {0,0};
+    static_assert(CodeTable::IsValid<CoinPolling_t, &CoinPolling_t::Channel>(CoinPolling), "Codigo fuera de la tabla CoinPolling");
+    static constexpr CodeTable::DenseTable_t<CoinPolling_t> CoinTable = CodeTable::BuildTable<CoinPolling_t, &CoinPolling_t::Channel>(CoinPolling, CoinTableDefault);
+
+    static constexpr ErrorCodePolling_t ErrorPollingTableDefault = {0,"ErrorCode not found!!!",3,0};
+    static_assert(CodeTable::IsValid<ErrorCodePolling_t, &ErrorCodePolling_t::Code>(ErrorCodePolling), "Codigo fuera de la tabla ErrorCodePolling");
+    static constexpr CodeTable::DenseTable_t<ErrorCodePolling_t> ErrorPollingTable = CodeTable::BuildTable<ErrorCodePolling_t, &ErrorCodePolling_t::Code>(ErrorCodePolling, ErrorPollingTableDefault);
+
+    static constexpr FaultCode_t FaultTableDefault = {0,"FaultCode not found!!!"};
+    static_assert(CodeTable::IsValid<FaultCode_t, &FaultCode_t::Code>(FaultCodeM), "Codigo fuera de la tabla FaultCodeM");
+    static constexpr CodeTable::DenseTable_t<FaultCode_t> FaultTable = CodeTable::BuildTable<FaultCode_t, &FaultCode_t::Code>(FaultCodeM, FaultTableDefault);
+
     // --------------- CONSTRUCTOR FUNCTIONS --------------------//
 
     AzkoyenClass::AzkoyenClass(){
+        Scanning = false;
         
         SerialPort = 0;
         SuccessConnect = false;
@@ -259,106 +234,41 @@ namespace ValidatorAzkoyen{
         COSAlert = false;
     }
 
-    AzkoyenClass::~AzkoyenClass(){}
+    AzkoyenClass::~AzkoyenClass(){
+        // Cerrar el puerto libera el flock, otra instancia puede tomarlo
+        if (SerialPort > 0){
+            close(SerialPort);
+            SerialPort = -1;
+        }
+        Logging::DropLogger(logger);
+    }
 
     // --------------- LOGGER FUNCTIONS --------------------//
 
-    SpdlogLevels_t AzkoyenClass::SearchSpdlogLevel(int Code){
-        SpdlogLevels_t SPLvl;
-        SPLvl.Message = "SpdlogLvl not found!!!"; 
-
-        for(long unsigned int i = 0; i < sizeof(SpdlogLvl)/sizeof(SpdlogLvl[0]); i++) {
-            if(SpdlogLvl[i].Code == Code) {
-                SPLvl.Message = SpdlogLvl[i].Message;
-                break;
-            }
-        }
-        
-        SPLvl.Code = Code;
-        return SPLvl;
+    SpdlogLevels_t AzkoyenClass::SearchSpdlogLevel (int Code){
+        return CodeTable::Lookup<SpdlogLevels_t, &SpdlogLevels_t::Code>(SpdlogTable, Code, SpdlogTableDefault);
     }
 
     void AzkoyenClass::SetSpdlogLevel(){
-        //spdlog::set_level(static_cast<spdlog::level::level_enum>(LoggerLevel)); // Set global log level
-        logger->set_level(spdlog::level::debug);
+        logger->set_level(static_cast<spdlog::level::level_enum>(LoggerLevel)); // Set instance log level
     }
 
     // --------------- SEARCH FUNCTIONS --------------------//
 
     ErrorCodeExComm_t AzkoyenClass::SearchErrorCodeExComm (int Code){
-        
-        ErrorCodeExComm_t Code_msg;
-        
-        Code_msg.Message = "ErrorCode not found!!!";
-        
-        for(long unsigned int i = 0; i < sizeof(ErrorCodesExComm)/sizeof(ErrorCodesExComm[0]); i++) {
-            if(ErrorCodesExComm[i].Code == Code) {
-                Code_msg.Message = ErrorCodesExComm[i].Message;
-                break;
-            }
-        }
-        
-        Code_msg.Code = Code;
-
-        return Code_msg;
+        return CodeTable::Lookup<ErrorCodeExComm_t, &ErrorCodeExComm_t::Code>(ExCommTable, Code, ExCommTableDefault);
     }
 
     CoinPolling_t AzkoyenClass::SearchCoin (int Channel){
-        
-        CoinPolling_t ChannelCoin;
-        
-        ChannelCoin.Coin = 0;
-        
-        for(long unsigned int i = 0; i < sizeof(CoinPolling)/sizeof(CoinPolling[0]); i++) {
-            if(CoinPolling[i].Channel == Channel) {
-                ChannelCoin.Coin = CoinPolling[i].Coin;
-                break;
-            }
-        }
-        
-        ChannelCoin.Channel = Channel;
-
-        return ChannelCoin;
+        return CodeTable::Lookup<CoinPolling_t, &CoinPolling_t::Channel>(CoinTable, Channel, CoinTableDefault);
     }
 
     ErrorCodePolling_t AzkoyenClass::SearchErrorCodePolling (int Code){
-        
-        ErrorCodePolling_t CodeMsgRej;
-        
-        CodeMsgRej.Message = "ErrorCode not found!!!";
-        CodeMsgRej.Static = 3;
-        CodeMsgRej.Critical = 0;
-        
-        for(long unsigned int i = 0; i < sizeof(ErrorCodePolling)/sizeof(ErrorCodePolling[0]); i++) {
-            if(ErrorCodePolling[i].Code == Code) {
-                CodeMsgRej.Message = ErrorCodePolling[i].Message;
-                CodeMsgRej.Static = ErrorCodePolling[i].Static;
-                CodeMsgRej.Critical = ErrorCodePolling[i].Critical;
-                break;
-            }
-        }
-        
-        CodeMsgRej.Code = Code;
-
-        return CodeMsgRej;
+        return CodeTable::Lookup<ErrorCodePolling_t, &ErrorCodePolling_t::Code>(ErrorPollingTable, Code, ErrorPollingTableDefault);
     }
 
     FaultCode_t AzkoyenClass::SearchFaultCode (int Code){
-        
-        FaultCode_t FaultCodeMsg;
-        
-        FaultCodeMsg.Message = "FaultCode not found!!!";
-
-        for(long unsigned int i = 0; i < sizeof(FaultCodeM)/sizeof(FaultCodeM[0]); i++) {
-            if(FaultCodeM[i].Code == Code) {
-                FaultCodeMsg.Message = FaultCodeM[i].Message;
-                break;
-            }
-        }
-        
-        FaultCodeMsg.Code = Code;
-
-        return FaultCodeMsg;
+        return CodeTable::Lookup<FaultCode_t, &FaultCode_t::Code>(FaultTable, Code, FaultTableDefault);
     }
 
     // --------------- STATES OF MACHINE STATE (FUNCTIONS) --------------------//
@@ -371,8 +281,8 @@ namespace ValidatorAzkoyen{
 
         logger->critical("[E0:STIDLE] Setting spdlog level in {}",SpdlogLvl.Message);
 
-        logger->trace("   [E0:STIDLE] --------------------------------------------------------------------------");
-        logger->debug("   [E0:STIDLE] --------------------------------------------------------------------------");
+        SPDLOG_LOGGER_TRACE(logger,"   [E0:STIDLE] --------------------------------------------------------------------------");
+        SPDLOG_LOGGER_DEBUG(logger,"   [E0:STIDLE] --------------------------------------------------------------------------");
         logger->info("    [E0:STIDLE] --------------------------------------------------------------------------");
         logger->warn(" [E0:STIDLE] --------------------------------------------------------------------------");
         logger->error("   [E0:STIDLE] --------------------------------------------------------------------------");
@@ -432,7 +342,7 @@ namespace ValidatorAzkoyen{
             }
         }
 
-        logger->debug("[E2:STCHECK] Fault code is: OK");
+        SPDLOG_LOGGER_DEBUG(logger,"[E2:STCHECK] Fault code is: OK");
 
         logger->info("[E2:STCHECK] Checking opto states");
 
@@ -466,7 +376,7 @@ namespace ValidatorAzkoyen{
             }
         }
 
-        logger->debug("[E2:STCHECK] 4 Optostates are OK");
+        SPDLOG_LOGGER_DEBUG(logger,"[E2:STCHECK] 4 Optostates are OK");
         return 0;
     }
 
@@ -563,8 +473,35 @@ namespace ValidatorAzkoyen{
 
     // Función para inicializar el logger
     void AzkoyenClass::InitLogger(const std::string& Path) {
-        // Crear el daily_logger y asignarlo a la variable logger
-        logger = spdlog::daily_logger_mt("ValidatorAzkoyen", Path, 23, 59);
+        // Crear el logger asincrono (archivo diario) de esta instancia y asignarlo a la variable logger
+        // Si ya existia (InitLog despues de reconectar) se da de baja primero para no dejarlo registrado
+        Logging::DropLogger(logger);
+        logger = Logging::CreateLogger("ValidatorAzkoyen", Path);
+        Recorder.Path = Path + ".flight";
+    }
+
+    long AzkoyenClass::DumpRecorder(const char *Reason){
+        long Entries = Recorder.Dump(Reason);
+        if (Entries >= 0){
+            logger->warn("[DumpRecorder] {0}: {1} entries written to {2}",Reason,Entries,Recorder.Path);
+        }
+        else {
+            logger->error("[DumpRecorder] {0}: could not write {1}",Reason,Recorder.Path);
+        }
+        return Entries;
+    }
+
+    void AzkoyenClass::DumpRecorderOnError(){
+        DumpRecorder("ST_ERROR");
+    }
+
+    int AzkoyenClass::StartCapture(const std::string& Path){
+        if (Capture.Open(Path, SerialCapture::DEVICE_AZKOYEN) != 0){
+            logger->error("[StartCapture] Could not open capture file {0}",Path);
+            return 1;
+        }
+        logger->info("[StartCapture] Capturing serial traffic to {0} (instance {1})",Path,Capture.Instance);
+        return 0;
     }
 
     //Connects to port /dev/ttyUSB% where % is the port number (Port)
@@ -575,11 +512,19 @@ namespace ValidatorAzkoyen{
             return 1;
         }
         else {
-            logger->debug("[ConnectSerial] Connecting to /dev/ttyUSB{0:d} port",Port);
+            SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] Connecting to /dev/ttyUSB{0:d} port",Port);
             char DeviceName [50];
             sprintf (DeviceName,"/dev/ttyUSB%d",Port);
             SerialPort = open(DeviceName, O_RDWR | O_NOCTTY );
 
+            // Bloqueo exclusivo del puerto para que otra instancia (o proceso) no lo tome mientras se usa
+            if ((SerialPort > 0) && (flock(SerialPort, LOCK_EX | LOCK_NB) != 0)){
+                SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] /dev/ttyUSB{0:d} is already in use",Port);
+                close(SerialPort);
+                SerialPort = -1;
+                return 5;
+            }
+
             if (SerialPort > 0){
 
                 struct termios Tty;
@@ -589,6 +534,8 @@ namespace ValidatorAzkoyen{
                 if(tcgetattr(SerialPort, &Tty) != 0) {
                     logger->error("[ConnectSerial] Error reading actual settings in this port. Error: {0:d}, from tcgetattr: {1}",errno,strerror(errno));
                     SuccessConnect = false;
+                    close(SerialPort);
+                    SerialPort = -1;
                     return 2;
                 }
 
@@ -621,15 +568,17 @@ namespace ValidatorAzkoyen{
                 if (tcsetattr(SerialPort, TCSANOW, &Tty) != 0) {
                     logger->error("[ConnectSerial] Error writing new settings in this port. Error: {0:d}, from tcgetattr: {1}",errno,strerror(errno));
                     SuccessConnect = false;
+                    close(SerialPort);
+                    SerialPort = -1;
                     return 3;
                 }
 
-                logger->debug("[ConnectSerial] Successfully connected to /dev/ttyUSB{0:d}",Port);
+                SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] Successfully connected to /dev/ttyUSB{0:d}",Port);
                 SuccessConnect = true;
                 return 0;
             }
             else{
-                logger->debug("[ConnectSerial] Could no connect to /dev/ttyUSB{0:d}",Port);
+                SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] Could no connect to /dev/ttyUSB{0:d}",Port);
                 return 4;
             }
         }
@@ -640,23 +589,29 @@ namespace ValidatorAzkoyen{
         int Port = -1;
         int Response = -1;
 
+        // Al reconectar se cierra el puerto que ya se tenia, tambien libera el flock y el puerto se puede volver a tomar
+        if (SerialPort > 0){
+            close(SerialPort);
+            SerialPort = -1;
+        }
+
         for (int i=1;i<MaxPorts;i++)
         {   
-            logger->debug("[ScanPorts] Trying connection to /dev/ttyUSB{0:d}",i-1);
+            SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Trying connection to /dev/ttyUSB{0:d}",i-1);
             Response = ConnectSerial(i-1);
 
             if (Response==0)
             {   
-                logger->debug("[ScanPorts] Connection successfull");
+                SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Connection successfull");
                 Response = -1;
                 Scanning = true;
-                logger->debug("[ScanPorts] Sending simple poll Command (Checking connection)");
+                SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Sending simple poll Command (Checking connection)");
 
                 Response = SendingCommand(CMDSIMPLEPOLL);
 
                 if (Response == 0){
                     Port = i-1;
-                    logger->debug("[ScanPorts] Validator Azkoyen found in port /dev/ttyUSB{0:d}",Port);
+                    SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Validator Azkoyen found in port /dev/ttyUSB{0:d}",Port);
                     i=MaxPorts;
                     Scanning = false;
                     return Port;
@@ -665,8 +620,9 @@ namespace ValidatorAzkoyen{
                     logger->warn("[ScanPorts] Error in writing/reading or Validator Azkoyen is NOT connected to /dev/ttyUSB{0:d} port",i-1);
                 }
 
-                logger->debug("[ScanPorts] Clossing connection in /dev/ttyUSB{0:d}",i-1);
-                close(SerialPort);            
+                SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Clossing connection in /dev/ttyUSB{0:d}",i-1);
+                close(SerialPort);
+                SerialPort = -1;
             }
         }
         Scanning = false;
@@ -683,23 +639,24 @@ namespace ValidatorAzkoyen{
 
         ErrorCodeExComm_t Err;
         Err = SearchErrorCodeExComm(Response);
+        Recorder.RecordResult(Err.Code, Err.Message.data());
 
-        logger->debug("[SendingCommand] Execute command returns: {0:d} with message: {1}",Err.Code,Err.Message);
+        SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Execute command returns: {0:d} with message: {1}",Err.Code,Err.Message);
 
         if(Response == 0){
-            //logger->trace("[SendingCommand] Everything is OK");
+            //SPDLOG_LOGGER_TRACE(logger,"[SendingCommand] Everything is OK");
             Res = 0;
         }
         else if((Response == -5)|(Response == -4)|(Response == 1)){
-            logger->debug("[SendingCommand] Fatal error with comand");
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Fatal error with comand");
             Res = -1;
         }
         else if(Response == 4){
-            logger->debug("[SendingCommand] Polling error");
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Polling error");
             Res = -2;
         }
         else{
-            logger->debug("[SendingCommand] Repeat command");
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Repeat command");
             Res = 1;
         }
         return Res;
@@ -713,7 +670,9 @@ namespace ValidatorAzkoyen{
         
         int Xlen = Comm.size();
 
-        //logger->trace("[ExecuteCommand] Writting command");
+        SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Writting command: {0:n}",Logging::Hex(Comm,Xlen));
+        Recorder.RecordFrame(FlightRecorder::ENTRY_TX, &Comm[0], Xlen);
+        Capture.Record(SerialCapture::DIRECTION_TX, &Comm[0], Xlen);
         Wrlen = write(SerialPort, &Comm[0], Xlen);
 
         if(Wrlen!=Xlen){
@@ -721,21 +680,24 @@ namespace ValidatorAzkoyen{
             Res = -5;
         }
         else{
-            //logger->trace("[ExecuteCommand] Length expected is the same: {0:d}",Wrlen);
+            //SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Length expected is the same: {0:d}",Wrlen);
             
             std::vector<unsigned char> Buffer(100);
             
             usleep(200000);
 
-            //logger->trace("[ExecuteCommand] Reading response");
+            //SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Reading response");
             Rdlen = read(SerialPort,&Buffer[0],Buffer.size());
+            Recorder.RecordFrame(FlightRecorder::ENTRY_RX, &Buffer[0], Rdlen);
+            Capture.Record(SerialCapture::DIRECTION_RX, &Buffer[0], Rdlen);
 
             if(Rdlen > 0){
 
-                logger->debug("[ExecuteCommand] Reading length: {0:d}",Rdlen);
+                SPDLOG_LOGGER_DEBUG(logger,"[ExecuteCommand] Reading length: {0:d}",Rdlen);
+                SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Data read: {0:n}",Logging::Hex(Buffer,Rdlen));
 
                 if (Rdlen >= Xlen){
-                    //logger->trace("[ExecuteCommand] Reading length greater or equal than {0}, handling response... ",Xlen);
+                    //SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Reading length greater or equal than {0}, handling response... ",Xlen);
                     Res = HandleResponse(Buffer,Rdlen,Xlen);
                 }
                 else if(Rdlen == Xlen-1){
@@ -770,12 +732,12 @@ namespace ValidatorAzkoyen{
         int Header = 0;
 
         if (Rdlen >= (Xlen+4)){
-            //logger->trace("[HandleResponse] Message seems to be complete");
+            //SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] Message seems to be complete");
             if (Response[Xlen + 3] == 0){
-                //logger->trace("[HandleResponse] ACK Received!");
+                //SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] ACK Received!");
                 Header = Response[3];
                 if ((Rdlen >= Xlen+15)&((Header == 229))){
-                    //logger->trace("[HandleResponse] Polling detected, searching response error");
+                    //SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] Polling detected, searching response error");
                     Res = HandleResponsePolling(Response,Rdlen);
                 }
                 else if ((Rdlen < Xlen+15)&((Header == 229))){
@@ -783,11 +745,11 @@ namespace ValidatorAzkoyen{
                     Res = 2;
                 }
                 else if((Header == 236)|(Header == 232)){
-                    logger->trace("[HandleResponse] Self check or read opto states detected, searching more info");
+                    SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] Self check or read opto states detected, searching more info");
                     Res = HandleResponseInfo(Response,Rdlen);
                 }
                 else if((Header == 231)|(Header == 254)|(Header == 1)){
-                    logger->trace("[HandleResponse] No more information to check!");
+                    SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] No more information to check!");
                     Res = 0;
                 }
                 else{
@@ -809,7 +771,7 @@ namespace ValidatorAzkoyen{
             }
         }
         else{
-            logger->debug("[HandleResponse] Message is NOT complete!!!");
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponse] Message is NOT complete!!!");
             Res = 2;
         }
         return Res;
@@ -840,10 +802,11 @@ namespace ValidatorAzkoyen{
 
         ActOCoin = 0;
         ActOChannel = 0;
+        PollCoins.clear();
 
         if (Response[6] == 11){
 
-            logger->trace("[HandleResponsePolling] Data is correct!");
+            SPDLOG_LOGGER_TRACE(logger,"[HandleResponsePolling] Data is correct!");
             
             CoinEvent = Response[9];
 
@@ -851,20 +814,20 @@ namespace ValidatorAzkoyen{
                 
                 Remaining = CoinEvent-CoinEventPrev;
 
-                logger->debug("[HandleResponsePolling] CoinEvent: {0} CoinEventPrev: {1}",CoinEvent,CoinEventPrev);
+                SPDLOG_LOGGER_DEBUG(logger,"[HandleResponsePolling] CoinEvent: {0} CoinEventPrev: {1}",CoinEvent,CoinEventPrev);
 
                 if (Remaining > 1){
-                    logger->debug("[HandleResponsePolling] Remaining events: {0}",Remaining);
+                    SPDLOG_LOGGER_DEBUG(logger,"[HandleResponsePolling] Remaining events: {0} Data: {1:n}",Remaining,Logging::Hex(Response,2*Remaining,10));
                     for (int i = 0; i<2*Remaining; i++){
-                        logger->debug("[HandleResponsePolling] Counters, i:{0} k:{1}",i,k);
                         Data = Response[10+i];
-                        logger->debug("[HandleResponsePolling] Data: {0}",Data);
                         if( (Data == 0) & (i== 2*(k-1) ) ){
                             ErrorHappened = true;
                         }
                         else if( ( ((Data >= 4) & (Data <= 7)) | ((Data >= 10) & (Data <= 16)) ) & (i== 2*(k-1)) ){
                             ActCoin = SearchCoin(Data);
-                            logger->debug("[HandleResponsePolling] Coin: {0}",ActCoin.Coin);
+                            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponsePolling] Coin: {0}",ActCoin.Coin);
+                            // El buffer trae primero el evento mas reciente
+                            PollCoins.insert(PollCoins.begin(), ActCoin);
                             if (ActCoin.Coin == 50){
                                 CoinCinc++;
                             }
@@ -929,36 +892,41 @@ namespace ValidatorAzkoyen{
                     logger->error("[HandleResponsePolling] ----------> Error happened!");
                     logger->error("[HandleResponsePolling] Error code: {0}",ErrP.Code);
                     logger->error("[HandleResponsePolling] Error message: {0}",ErrP.Message);
-                    logger->trace("[HandleResponsePolling] Error rejected: {0}",ErrP.Static);
-                    logger->trace("[HandleResponsePolling] Error critical: {0}",ErrP.Critical);
+                    SPDLOG_LOGGER_TRACE(logger,"[HandleResponsePolling] Error rejected: {0}",ErrP.Static);
+                    SPDLOG_LOGGER_TRACE(logger,"[HandleResponsePolling] Error critical: {0}",ErrP.Critical);
+
+                    if (ErrP.Critical == 1){
+                        DumpRecorder("Critical polling error");
+                    }
+
                     Res = 4;
                 }
                 else{
 
                     ActOCoin = ActCoin.Coin;
                     ActOChannel = ActCoin.Channel;
+                    if ((Remaining <= 1) & (ActCoin.Coin != 0)){
+                        PollCoins.push_back(ActCoin);
+                    }
 
-                    logger->trace("[HandleResponsePolling] ----------> Coin detected");
-                    logger->debug("[HandleResponsePolling] Coin: {0}",ActCoin.Coin);
-                    logger->trace("[HandleResponsePolling] Coin Channel: {0}",ActCoin.Channel);
+                    SPDLOG_LOGGER_TRACE(logger,"[HandleResponsePolling] ----------> Coin detected");
+                    SPDLOG_LOGGER_DEBUG(logger,"[HandleResponsePolling] Coin: {0}",ActCoin.Coin);
+                    SPDLOG_LOGGER_TRACE(logger,"[HandleResponsePolling] Coin Channel: {0}",ActCoin.Channel);
 
                     Res = 0;
                 }
                 
-                for (int i = 0; i<10; i++){
-                    Data = Response[10+i];
-                    logger->debug("[HandleResponsePolling] Data: {0}",Data);
-                }
+                SPDLOG_LOGGER_DEBUG(logger,"[HandleResponsePolling] Data: {0:n}",Logging::Hex(Response,10,10));
 
                 CoinEventPrev = CoinEvent;
             }   
             else{
-                logger->trace("[HandleResponsePolling] Actual coin event is identical to coin event prev");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponsePolling] Actual coin event is identical to coin event prev");
                 Res = 0;
             }
         }
         else{
-            logger->debug("[HandleResponsePolling] Data is not correct!");
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponsePolling] Data is not correct!");
             Res = 3;
         }
         return Res;
@@ -970,21 +938,21 @@ namespace ValidatorAzkoyen{
         int FaultCode = -1;
 
         if (Response[3] == 232){
-            logger->trace("[HandleResponseInfo] Self check detected, checking fault code");
+            SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Self check detected, checking fault code");
 
             FaultCode = Response[9];
             FaultC = SearchFaultCode(FaultCode);
             FaultOCode = FaultC.Code;
             FaultOMsg = FaultC.Message;
 
-            logger->debug("[HandleResponseInfo] Fault code: {0}",FaultC.Code);
-            logger->debug("[HandleResponseInfo] Fault message: {0}",FaultC.Message);
-            logger->debug("[HandleResponseInfo] Fault code complementary: {0}",Response[10]);
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponseInfo] Fault code: {0}",FaultC.Code);
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponseInfo] Fault message: {0}",FaultC.Message);
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponseInfo] Fault code complementary: {0}",Response[10]);
             
             Res = 0;
         }
         else if(Response[3] == 236){
-            logger->trace("[HandleResponseInfo] Read opto states detected, checking bit mask");
+            SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Read opto states detected, checking bit mask");
             int StateMask = 0;
             StateMask = Response[9];
 
@@ -996,31 +964,31 @@ namespace ValidatorAzkoyen{
             COSAlert = Bits[3];
 
             if(NoUsedBit){
-                logger->trace("[HandleResponseInfo] Error NoUsedBit change!");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Error NoUsedBit change!");
             }
             else{
-                logger->trace("[HandleResponseInfo] NoUsedBit is set OK");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] NoUsedBit is set OK");
             }
 
             if(MeasurePhotoBlocked){
-                logger->trace("[HandleResponseInfo] Measue phototransistor is blocked!");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Measue phototransistor is blocked!");
             }
             else{
-                logger->trace("[HandleResponseInfo] Measue phototransistor is free");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Measue phototransistor is free");
             }
 
             if(OutPhotoBlocked){
-                logger->trace("[HandleResponseInfo] Out phototransistor is blocked!");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Out phototransistor is blocked!");
             }
             else{
-                logger->trace("[HandleResponseInfo] Out phototransistor is free");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Out phototransistor is free");
             }
 
             if(COSAlert){
-                logger->trace("[HandleResponseInfo] COS alert activated");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] COS alert activated");
             }
             else{
-                logger->trace("[HandleResponseInfo] COS alert deactivated");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] COS alert deactivated");
             }
 
             Res = 0;
@@ -1033,8 +1001,8 @@ namespace ValidatorAzkoyen{
 
         int Response  = -2;
 
-        logger->debug("[CheckOptoStates] Reading opto states");
-        logger->trace("[CheckOptoStates] Running CMDREADOPTOST");
+        SPDLOG_LOGGER_DEBUG(logger,"[CheckOptoStates] Reading opto states");
+        SPDLOG_LOGGER_TRACE(logger,"[CheckOptoStates] Running CMDREADOPTOST");
         
         Response = SendingCommand(CMDREADOPTOST);
         
@@ -1059,7 +1027,7 @@ namespace ValidatorAzkoyen{
             }
         }
 
-        logger->trace("[CheckOptoStates] Optostates return: Everything is OK");
+        SPDLOG_LOGGER_TRACE(logger,"[CheckOptoStates] Optostates return: Everything is OK");
         return Response;
     }
 
@@ -1067,8 +1035,8 @@ namespace ValidatorAzkoyen{
 
         int Response  = -1;
 
-        logger->debug("[SimplePoll] Checking communication");
-        logger->trace("[SimplePoll] Running CMDSIMPLEPOLL");
+        SPDLOG_LOGGER_DEBUG(logger,"[SimplePoll] Checking communication");
+        SPDLOG_LOGGER_TRACE(logger,"[SimplePoll] Running CMDSIMPLEPOLL");
         
         Response = SendingCommand(CMDSIMPLEPOLL);
 
@@ -1085,7 +1053,7 @@ namespace ValidatorAzkoyen{
             }
         }
 
-        logger->trace("[SimplePoll] Acceptor return ACK successfully");
+        SPDLOG_LOGGER_TRACE(logger,"[SimplePoll] Acceptor return ACK successfully");
         return 0;
     }
 
@@ -1093,8 +1061,8 @@ namespace ValidatorAzkoyen{
         
         int Response = -1;
 
-        logger->debug("[SelfCheck] Running initial revision");
-        logger->trace("[SelfCheck] Running CMDSELFCHECK");
+        SPDLOG_LOGGER_DEBUG(logger,"[SelfCheck] Running initial revision");
+        SPDLOG_LOGGER_TRACE(logger,"[SelfCheck] Running CMDSELFCHECK");
         
         Response = SendingCommand(CMDSELFCHECK);
 
@@ -1123,7 +1091,7 @@ namespace ValidatorAzkoyen{
             }
         }
 
-        logger->trace("[SelfCheck] Acceptor return faultcode: OK");
+        SPDLOG_LOGGER_TRACE(logger,"[SelfCheck] Acceptor return faultcode: OK");
         return 0;
     }
 
@@ -1131,8 +1099,8 @@ namespace ValidatorAzkoyen{
         
         int Response  = -1;
 
-        logger->debug("[EnableChannels] Enabling coins");
-        logger->trace("[EnableChannels] Running CMDENABLE");
+        SPDLOG_LOGGER_DEBUG(logger,"[EnableChannels] Enabling coins");
+        SPDLOG_LOGGER_TRACE(logger,"[EnableChannels] Running CMDENABLE");
 
         Response = SendingCommand(CMDENABLE);
         //Response = SendingCommand(CMDINHIBIT50);
@@ -1142,7 +1110,7 @@ namespace ValidatorAzkoyen{
             return -1;
         }
 
-        logger->trace("[EnableChannels] All coins enabled");
+        SPDLOG_LOGGER_TRACE(logger,"[EnableChannels] All coins enabled");
         return 0;
     }
 
@@ -1150,14 +1118,14 @@ namespace ValidatorAzkoyen{
         
         int Response = 2;
 
-        logger->debug("[CheckEventReset] Reading coin event");
-        logger->trace("[CheckEventReset] Running CMDSTARTPOLL");
+        SPDLOG_LOGGER_DEBUG(logger,"[CheckEventReset] Reading coin event");
+        SPDLOG_LOGGER_TRACE(logger,"[CheckEventReset] Running CMDSTARTPOLL");
 
         Response = SendingCommand(CMDSTARTPOLL);
 
         if ((Response == 0)|(Response == -2)){
             if ((CoinEvent == 0)|(CoinEvent == 1)){
-                logger->debug("[CheckEventReset] CoinEvent is OK: {0}",CoinEvent);
+                SPDLOG_LOGGER_DEBUG(logger,"[CheckEventReset] CoinEvent is OK: {0}",CoinEvent);
             }
             else{
                 logger->error("[CheckEventReset] CoinEvent is not OK {0}",CoinEvent);
@@ -1175,7 +1143,7 @@ namespace ValidatorAzkoyen{
             }
         }
 
-        logger->trace("[CheckEventReset] Coin event is ready");
+        SPDLOG_LOGGER_TRACE(logger,"[CheckEventReset] Coin event is ready");
         return 0;
         
     }
@@ -1184,8 +1152,8 @@ namespace ValidatorAzkoyen{
 
         int Response  = -1;
 
-        logger->debug("[ResetDevice] Reset device running");
-        logger->trace("[ResetDevice] Running CMDRESETDEVICE");
+        SPDLOG_LOGGER_DEBUG(logger,"[ResetDevice] Reset device running");
+        SPDLOG_LOGGER_TRACE(logger,"[ResetDevice] Running CMDRESETDEVICE");
 
         Response = SendingCommand(CMDRESETDEVICE);
 
@@ -1194,7 +1162,7 @@ namespace ValidatorAzkoyen{
             return -1;
         }
         
-        logger->trace("[ResetDevice] Device was rebooted");
+        SPDLOG_LOGGER_TRACE(logger,"[ResetDevice] Device was rebooted");
 
         return 0;
     }
@@ -1219,13 +1187,13 @@ namespace ValidatorAzkoyen{
         // Calcular el checksum del mensaje (suma de todos los bytes hasta ahora)
         unsigned char checksum = 0;
         for (size_t i = 0; i < command.size(); i++) {
-            logger->debug("Custom command {0}",command[i]);
             checksum += command[i];
         }
         checksum = 256-checksum;
 
         // Checksum al final del mensaje
         command.push_back(checksum);
+        SPDLOG_LOGGER_DEBUG(logger,"Custom command {0:n}",Logging::Hex(command,command.size()));
 
         return command;
     }
@@ -1234,8 +1202,8 @@ namespace ValidatorAzkoyen{
 
         int Response  = -1;
 
-        logger->debug("[ChangeInhibitChannels] Changing inhibit channels");
-        logger->trace("[ChangeInhibitChannels] Running BuildCmdModifyInhibit");
+        SPDLOG_LOGGER_DEBUG(logger,"[ChangeInhibitChannels] Changing inhibit channels");
+        SPDLOG_LOGGER_TRACE(logger,"[ChangeInhibitChannels] Running BuildCmdModifyInhibit");
 
         std::vector<unsigned char> command = BuildCmdModifyInhibit(InhibitMask1,InhibitMask2);
 
@@ -1246,7 +1214,7 @@ namespace ValidatorAzkoyen{
             return -1;
         }
         
-        logger->trace("[ChangeInhibitChannels] Inhibited custom channels");
+        SPDLOG_LOGGER_TRACE(logger,"[ChangeInhibitChannels] Inhibited custom channels");
 
         return 0;
     }
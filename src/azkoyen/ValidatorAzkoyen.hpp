@@ -19,23 +19,28 @@
 #include <termios.h> // Contains POSIX terminal control definitions
 #include <unistd.h> // write(), read(), close()
 #include <sys/ioctl.h> //To use flush
+#include <sys/file.h> //To use flock
+#include <atomic>
 #include <bitset> //To use bitset in HandleResponseInfo
 
 #include "spdlog/spdlog.h" //Logging library
-#include "spdlog/sinks/daily_file_sink.h" //Logging library - daily file
+#include "../common/Logging.hpp" //Logging library - async logger and hex dump
+#include "../common/FlightRecorder.hpp"
+#include "../common/SerialCapture.hpp"
 
 #include <vector>
+#include <string_view>
 
 namespace ValidatorAzkoyen{
 
     struct SpdlogLevels_t{
         int Code;
-        std::string Message;
+        std::string_view Message;
     };
 
     struct ErrorCodePolling_t{
         int Code;
-        std::string Message;
+        std::string_view Message;
         int Static;
         int Critical;
     };
@@ -47,12 +52,12 @@ namespace ValidatorAzkoyen{
 
     struct ErrorCodeExComm_t{
         int Code;
-        std::string Message;
+        std::string_view Message;
     };
 
     struct FaultCode_t{
         int Code;
-        std::string Message;
+        std::string_view Message;
     };
 
 
@@ -179,6 +184,12 @@ namespace ValidatorAzkoyen{
              */
             int ActOChannel;
 
+            /**
+             * @brief Monedas aceptadas en el ultimo polling, en el orden en que entraron. Con varios eventos en el
+             * mismo polling ActOCoin solo guarda la ultima
+             */
+            std::vector<CoinPolling_t> PollCoins;
+
             // WRITE ONLY
 
             /**
@@ -196,6 +207,48 @@ namespace ValidatorAzkoyen{
              */
             int MaxPorts;
 
+            // --------------- INTERNAL VARIABLES --------------------//
+
+            /**
+             * @brief Bandera que indica si se estan escaneando los puertos (ScanPorts)
+             */
+            bool Scanning;
+
+            /**
+             * @brief Ultimo error de polling reportado por el validador
+             */
+            ErrorCodePolling_t ErrP;
+
+            /**
+             * @brief Error de polling anterior
+             */
+            ErrorCodePolling_t ErrPPrev;
+
+            /**
+             * @brief Ultima falla general reportada por el validador
+             */
+            FaultCode_t FaultC;
+
+            /**
+             * @brief Ultima moneda reconocida con su canal
+             */
+            CoinPolling_t ActCoin;
+
+            /**
+             * @brief Logger de esta instancia del validador
+             */
+            std::shared_ptr<spdlog::logger> logger;
+
+            /**
+             * @brief Registro en memoria de las ultimas tramas, transiciones y resultados de esta instancia del validador
+             */
+            FlightRecorder::FlightRecorderClass Recorder;
+
+            /**
+             * @brief Captura binaria de las tramas enviadas y recibidas (inactiva hasta StartCapture)
+             */
+            SerialCapture::SerialCaptureClass Capture;
+
             // --------------- CONSTRUCTOR FUNCTIONS --------------------//
 
             /**
@@ -309,10 +362,30 @@ namespace ValidatorAzkoyen{
             // --------------- MAIN FUNCTIONS --------------------//
             
             /**
-            * @brief Abre el archivo donde se van a guardar los logs
+            * @brief Abre el archivo donde se van a guardar los logs con un logger propio de la instancia. Si la
+            * instancia ya tenia logger lo da de baja antes de crear el nuevo
             * @param Path Ruta donde se debe guardar el log de Spdlog
             */
             void InitLogger(const std::string& Path);
+
+            /**
+            * @brief Vuelca el flight recorder al archivo <ruta del log>.flight
+            * @param Reason Motivo del volcado
+            * @return long Numero de entradas escritas, -1 si no se pudo escribir el archivo
+            */
+            long DumpRecorder(const char *Reason);
+
+            /**
+            * @brief Hook de entrada al estado ST_ERROR, vuelca el flight recorder
+            */
+            void DumpRecorderOnError();
+
+            /**
+            * @brief Empieza a guardar cada trama enviada y recibida en un archivo de captura binario
+            * @param Path Ruta del archivo de captura (se agrega al final si ya existe)
+            * @return int 0 si se pudo abrir el archivo, 1 si no
+            */
+            int StartCapture(const std::string& Path);
             
             /**
             * @brief Se conecta al puerto con las caracteristicas definidas en la hoja de datos del validador
@@ -0,0 +1,45 @@
+/**
+ * @file AddonData.hpp
+ * @brief Datos del addon asociados a cada entorno (napi_env). Se guardan con napi_set_instance_data para que
+ * el addon pueda cargarse en varios worker_threads sin compartir estado
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef ADDONDATA_HPP
+#define ADDONDATA_HPP
+
+#include <napi.h>
+#include "ResultCache.hpp"
+
+namespace AddonData {
+
+    class AddonDataClass{
+        public:
+
+            /**
+             * @brief Construct a new Addon Data Class object
+             * @param env Entorno de N-API
+             */
+            AddonDataClass(Napi::Env env) : Cache(env) {}
+
+            /**
+             * @brief Cache de llaves y mensajes para construir los resultados
+             */
+            ResultCache::ResultCacheClass Cache;
+
+            /**
+             * @brief Constructores de las clases expuestas a JS en este entorno
+             */
+            Napi::FunctionReference PelicanoConstructor;
+            Napi::FunctionReference AzkoyenConstructor;
+            Napi::FunctionReference DispenserConstructor;
+            Napi::FunctionReference NV10Constructor;
+    };
+
+};
+
+#endif /* ADDONDATA_HPP */
@@ -0,0 +1,99 @@
+/**
+ * @file CodeTable.hpp
+ * @brief Tablas de codigos de acceso directo. A partir de las filas { codigo, mensaje, banderas } de cada
+ * dispositivo se construye en tiempo de compilacion un arreglo de 256 posiciones indexado por el codigo, de modo
+ * que buscar un codigo recibido del validador es un solo acceso sin recorrer la tabla ni copiar cadenas
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef CODETABLE_HPP
+#define CODETABLE_HPP
+
+#include <cstddef>
+
+namespace CodeTable {
+
+    /**
+     * @brief Numero de posiciones de la tabla (un byte de codigo)
+     */
+    static constexpr size_t TABLESIZE = 256;
+
+    /**
+     * @brief Tabla densa de codigos. Rows[Codigo - Offset] guarda la fila del codigo o la fila por defecto
+     */
+    template <typename Row_t>
+    struct DenseTable_t{
+        Row_t Rows[TABLESIZE];
+        int Offset;
+    };
+
+    /**
+     * @brief Revisa en tiempo de compilacion que todos los codigos quepan en la tabla
+     * @tparam Key Campo de la fila que tiene el codigo (Code, Channel, ...)
+     * @param Rows Filas de la tabla
+     * @param Offset Codigo que corresponde a la posicion 0 (negativo si hay codigos negativos)
+     * @return true Si todos los codigos estan en [Offset, Offset + 256)
+     */
+    template <typename Row_t, int Row_t::*Key, size_t NROWS>
+    constexpr bool IsValid(const Row_t (&Rows)[NROWS], int Offset = 0){
+        for (size_t i = 0; i < NROWS; i++){
+            if ((Rows[i].*Key < Offset) || (Rows[i].*Key >= Offset + static_cast<int>(TABLESIZE))){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Construye la tabla densa. Las posiciones sin fila quedan con la fila por defecto, con el codigo de
+     * su posicion. Si un codigo se repite se conserva la primera fila, igual que la busqueda lineal
+     * @tparam Key Campo de la fila que tiene el codigo
+     * @param Rows Filas de la tabla
+     * @param Default Fila que se regresa cuando el codigo no existe
+     * @param Offset Codigo que corresponde a la posicion 0
+     * @return DenseTable_t Tabla de 256 posiciones
+     */
+    template <typename Row_t, int Row_t::*Key, size_t NROWS>
+    constexpr DenseTable_t<Row_t> BuildTable(const Row_t (&Rows)[NROWS], const Row_t &Default, int Offset = 0){
+        DenseTable_t<Row_t> Table{};
+        bool Filled[TABLESIZE] = {};
+        Table.Offset = Offset;
+        for (size_t i = 0; i < TABLESIZE; i++){
+            Table.Rows[i] = Default;
+            Table.Rows[i].*Key = static_cast<int>(i) + Offset;
+        }
+        for (size_t i = 0; i < NROWS; i++){
+            size_t Index = static_cast<size_t>(Rows[i].*Key - Offset);
+            if (!Filled[Index]){
+                Table.Rows[Index] = Rows[i];
+                Filled[Index] = true;
+            }
+        }
+        return Table;
+    }
+
+    /**
+     * @brief Busca un codigo en la tabla densa
+     * @param Table Tabla densa
+     * @param Code Codigo a buscar
+     * @param Default Fila por defecto, solo se usa si el codigo esta fuera del rango de la tabla
+     * @return Row_t Fila del codigo (copia de enteros y string_view, sin reservar memoria)
+     */
+    template <typename Row_t, int Row_t::*Key>
+    inline Row_t Lookup(const DenseTable_t<Row_t> &Table, int Code, const Row_t &Default){
+        size_t Index = static_cast<size_t>(Code - Table.Offset);
+        if (Index < TABLESIZE){
+            return Table.Rows[Index];
+        }
+        Row_t Row = Default;
+        Row.*Key = Code;
+        return Row;
+    }
+
+};
+
+#endif /* CODETABLE_HPP */
@@ -0,0 +1,79 @@
+/**
+ * @file CommandScheduler.cpp
+ * @brief Planificador de comandos por dispositivo con clases de prioridad
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "CommandScheduler.hpp"
+
+namespace CommandScheduler {
+
+    CommandSchedulerClass::CommandSchedulerClass(){
+        Busy = false;
+        Depth = 0;
+        for (int i = 0; i < PRIORITY_COUNT; i++){
+            NextTicket[i] = 0;
+            ServingTicket[i] = 0;
+            Stats[i] = {0, 0, 0};
+        }
+    }
+
+    void CommandSchedulerClass::Acquire(Priority_t Priority){
+        std::unique_lock<std::mutex> Lock(Mutex);
+
+        // Llamada anidada desde el mismo hilo (ej. StartReader -> Connect)
+        if (Busy && (Owner == std::this_thread::get_id())){
+            Depth++;
+            return;
+        }
+
+        auto Start = std::chrono::steady_clock::now();
+        unsigned long Ticket = NextTicket[Priority]++;
+
+        Cond.wait(Lock, [this, Priority, Ticket]{
+            if (Busy || (ServingTicket[Priority] != Ticket)){
+                return false;
+            }
+            // Los comandos de mayor prioridad que esten esperando pasan primero
+            for (int i = 0; i < Priority; i++){
+                if (NextTicket[i] != ServingTicket[i]){
+                    return false;
+                }
+            }
+            return true;
+        });
+
+        ServingTicket[Priority]++;
+        Busy = true;
+        Owner = std::this_thread::get_id();
+        Depth = 1;
+
+        unsigned long WaitUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Start).count();
+        Stats[Priority].Count++;
+        Stats[Priority].TotalWaitUs += WaitUs;
+        if (WaitUs > Stats[Priority].MaxWaitUs){
+            Stats[Priority].MaxWaitUs = WaitUs;
+        }
+    }
+
+    void CommandSchedulerClass::Release(){
+        std::unique_lock<std::mutex> Lock(Mutex);
+        if (--Depth > 0){
+            return;
+        }
+        Busy = false;
+        Owner = std::thread::id();
+        Lock.unlock();
+        Cond.notify_all();
+    }
+
+    QueueStats_t CommandSchedulerClass::GetStats(Priority_t Priority){
+        std::unique_lock<std::mutex> Lock(Mutex);
+        return Stats[Priority];
+    }
+
+};
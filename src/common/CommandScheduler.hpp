@@ -0,0 +1,96 @@
+/**
+ * @file CommandScheduler.hpp
+ * @brief Planificador de comandos por dispositivo. Serializa el acceso al puerto serial entre el hilo de
+ * polling (onCoin/onBill/onDispense) y las llamadas desde JS, dando prioridad a los comandos urgentes
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef COMMANDSCHEDULER_HPP
+#define COMMANDSCHEDULER_HPP
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+namespace CommandScheduler {
+
+    /**
+     * @brief Clases de prioridad. Un numero menor tiene mayor prioridad
+     */
+    enum Priority_t{
+        PRIORITY_URGENT,    // Inhibir canales, detener lector, rechazar
+        PRIORITY_NORMAL,    // Comandos de control (connect, reset, testStatus, ...)
+        PRIORITY_POLL,      // Polling de rutina (getCoin, getBill, checkDevice del dispensador)
+        PRIORITY_COUNT
+    };
+
+    /**
+     * @brief Estadisticas del tiempo de espera en cola de una clase de prioridad
+     */
+    struct QueueStats_t{
+        unsigned long Count;
+        unsigned long TotalWaitUs;
+        unsigned long MaxWaitUs;
+    };
+
+    class CommandSchedulerClass{
+        public:
+
+            CommandSchedulerClass();
+
+            /**
+             * @brief Espera el turno de la clase indicada. Solo entra cuando el dispositivo esta libre y no hay
+             * comandos de mayor prioridad esperando; dentro de la misma clase se respeta el orden de llegada.
+             * Si el hilo que llama ya tiene el turno (llamadas anidadas) entra de inmediato
+             * @param Priority Clase de prioridad del comando
+             */
+            void Acquire(Priority_t Priority);
+
+            /**
+             * @brief Libera el turno y despierta a los comandos en espera
+             */
+            void Release();
+
+            /**
+             * @brief Regresa las estadisticas de espera de una clase de prioridad
+             * @param Priority Clase de prioridad
+             * @return QueueStats_t Cantidad de comandos, tiempo total y tiempo maximo de espera en microsegundos
+             */
+            QueueStats_t GetStats(Priority_t Priority);
+
+        private:
+            std::mutex Mutex;
+            std::condition_variable Cond;
+            bool Busy;
+            std::thread::id Owner;
+            int Depth;
+            unsigned long NextTicket[PRIORITY_COUNT];
+            unsigned long ServingTicket[PRIORITY_COUNT];
+            QueueStats_t Stats[PRIORITY_COUNT];
+    };
+
+    /**
+     * @brief Turno RAII: adquiere el dispositivo en el constructor y lo libera al salir del bloque
+     */
+    class CommandTicket{
+        public:
+            CommandTicket(CommandSchedulerClass &Scheduler, Priority_t Priority) : Scheduler(Scheduler) {
+                Scheduler.Acquire(Priority);
+            }
+            ~CommandTicket() {
+                Scheduler.Release();
+            }
+            CommandTicket(const CommandTicket&) = delete;
+            CommandTicket& operator=(const CommandTicket&) = delete;
+        private:
+            CommandSchedulerClass &Scheduler;
+    };
+
+};
+
+#endif /* COMMANDSCHEDULER_HPP */
@@ -0,0 +1,51 @@
+/**
+ * @file Crc32.hpp
+ * @brief CRC32 (IEEE 802.3, el mismo de zlib) para validar los registros de los archivos binarios del addon
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef CRC32_HPP
+#define CRC32_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Crc32 {
+
+    struct CrcTable_t{
+        uint32_t Values[256];
+        CrcTable_t(){
+            for (uint32_t i = 0; i < 256; i++){
+                uint32_t Crc = i;
+                for (int j = 0; j < 8; j++){
+                    Crc = (Crc & 1) ? (0xEDB88320 ^ (Crc >> 1)) : (Crc >> 1);
+                }
+                Values[i] = Crc;
+            }
+        }
+    };
+
+    /**
+     * @brief Calcula el CRC32 de un bloque de bytes
+     * @param Data Bytes a revisar
+     * @param Length Numero de bytes
+     * @param Previous CRC de los bloques anteriores, para calcularlo por partes (0 para el primer bloque)
+     * @return uint32_t CRC32 acumulado
+     */
+    inline uint32_t Compute(const void *Data, size_t Length, uint32_t Previous = 0){
+        static const CrcTable_t Table;
+        const unsigned char *Bytes = static_cast<const unsigned char *>(Data);
+        uint32_t Crc = Previous ^ 0xFFFFFFFF;
+        for (size_t i = 0; i < Length; i++){
+            Crc = Table.Values[(Crc ^ Bytes[i]) & 0xFF] ^ (Crc >> 8);
+        }
+        return Crc ^ 0xFFFFFFFF;
+    }
+
+};
+
+#endif /* CRC32_HPP */
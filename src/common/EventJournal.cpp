@@ -0,0 +1,239 @@
+/**
+ * @file EventJournal.cpp
+ * @brief Diario de eventos mapeado en memoria, con recuperacion al abrir
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <fcntl.h> // Contains file controls like O_RDWR
+#include <sys/mman.h> // mmap, msync
+#include <sys/stat.h> // fstat
+#include <unistd.h> // pread, pwrite, ftruncate, fsync, close
+#include "Crc32.hpp"
+#include "EventJournal.hpp"
+
+namespace EventJournal {
+
+    static const char MAGIC[8] = "OINKJRN";
+
+    // Bytes del registro que cubre el CRC (todo menos el propio CRC)
+    static const size_t CRCBYTES = offsetof(Event_t, Crc);
+
+    struct JournalFile_t{
+        std::mutex Mutex;                   // Protege el mapa y el contador de registros
+        int Fd = -1;
+        unsigned char *Map = nullptr;
+        size_t MapSize = 0;
+        size_t Capacity = 0;                // Registros que caben en el archivo actual
+        size_t Count = 0;                   // Registros validos
+        uint64_t FirstSequence = 1;         // Secuencia del primer registro del archivo
+
+        ~JournalFile_t(){
+            if (Map != nullptr){
+                munmap(Map, MapSize);
+            }
+            if (Fd >= 0){
+                close(Fd);
+            }
+        }
+
+        Event_t *Record(size_t Index) const {
+            return reinterpret_cast<Event_t *>(Map + sizeof(JournalHeader_t) + Index * sizeof(Event_t));
+        }
+
+        // Crece el archivo GROWRECORDS registros y lo vuelve a mapear
+        bool Grow(){
+            size_t NewCapacity = Capacity + GROWRECORDS;
+            size_t NewSize = sizeof(JournalHeader_t) + NewCapacity * sizeof(Event_t);
+            if ((ftruncate(Fd, NewSize) != 0) || (fsync(Fd) != 0)){
+                return false;
+            }
+            void *NewMap = mmap(nullptr, NewSize, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+            if (NewMap == MAP_FAILED){
+                return false;
+            }
+            if (Map != nullptr){
+                munmap(Map, MapSize);
+            }
+            Map = static_cast<unsigned char *>(NewMap);
+            MapSize = NewSize;
+            Capacity = NewCapacity;
+            return true;
+        }
+    };
+
+    // Protege el registro de diarios abiertos
+    static std::mutex RegistryMutex;
+
+    // Diarios abiertos por ruta. weak_ptr para que el archivo se cierre con el ultimo dispositivo
+    static std::map<std::string, std::weak_ptr<JournalFile_t>> Files;
+
+    static std::shared_ptr<JournalFile_t> OpenFile(const std::string &Path){
+        auto File = std::make_shared<JournalFile_t>();
+        File->Fd = open(Path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (File->Fd < 0){
+            return nullptr;
+        }
+
+        struct stat Stat;
+        if (fstat(File->Fd, &Stat) != 0){
+            return nullptr;
+        }
+
+        JournalHeader_t Header;
+        if (Stat.st_size == 0){
+            memset(&Header, 0, sizeof(Header));
+            memcpy(Header.Magic, MAGIC, sizeof(Header.Magic));
+            Header.Version = JOURNALVERSION;
+            Header.RecordSize = sizeof(Event_t);
+            if (pwrite(File->Fd, &Header, sizeof(Header), 0) != sizeof(Header)){
+                return nullptr;
+            }
+            return File->Grow() ? File : nullptr;
+        }
+
+        if ((pread(File->Fd, &Header, sizeof(Header), 0) != sizeof(Header)) || (memcmp(Header.Magic, MAGIC, sizeof(MAGIC)) != 0) ||
+            (Header.RecordSize != sizeof(Event_t))){
+            return nullptr;
+        }
+
+        // Si el archivo quedo con un tamaño que no es multiplo del registro se ignora el pedazo final
+        File->Capacity = (static_cast<size_t>(Stat.st_size) - sizeof(JournalHeader_t)) / sizeof(Event_t);
+        File->MapSize = sizeof(JournalHeader_t) + File->Capacity * sizeof(Event_t);
+        void *Map = mmap(nullptr, File->MapSize, PROT_READ | PROT_WRITE, MAP_SHARED, File->Fd, 0);
+        if (Map == MAP_FAILED){
+            File->Map = nullptr;
+            return nullptr;
+        }
+        File->Map = static_cast<unsigned char *>(Map);
+
+        // Recuperacion: los registros validos son los primeros del archivo, con CRC correcto y secuencia continua
+        size_t Count = 0;
+        for (; Count < File->Capacity; Count++){
+            const Event_t *Event = File->Record(Count);
+            if ((Event->Sequence == 0) || (Event->Crc != Crc32::Compute(Event, CRCBYTES))){
+                break;
+            }
+            if (Count == 0){
+                File->FirstSequence = Event->Sequence;
+            }
+            else if (Event->Sequence != File->FirstSequence + Count){
+                break;
+            }
+        }
+        File->Count = Count;
+
+        if ((File->Count == File->Capacity) && !File->Grow()){
+            return nullptr;
+        }
+        return File;
+    }
+
+    EventJournalClass::EventJournalClass() : File(nullptr) {}
+
+    EventJournalClass::~EventJournalClass(){
+        Close();
+    }
+
+    int EventJournalClass::Open(const std::string &Path){
+        Close();
+        std::lock_guard<std::mutex> Lock(RegistryMutex);
+
+        std::shared_ptr<JournalFile_t> Shared = Files[Path].lock();
+        if (Shared == nullptr){
+            Shared = OpenFile(Path);
+            if (Shared == nullptr){
+                Files.erase(Path);
+                return 1;
+            }
+            Files[Path] = Shared;
+        }
+        File = Shared;
+        return 0;
+    }
+
+    void EventJournalClass::Close(){
+        if (File == nullptr){
+            return;
+        }
+        std::lock_guard<std::mutex> Lock(RegistryMutex);
+        File.reset();
+        for (auto It = Files.begin(); It != Files.end();){
+            It = It->second.expired() ? Files.erase(It) : std::next(It);
+        }
+    }
+
+    uint64_t EventJournalClass::Append(SerialCapture::Device_t Device, EventType_t Type, int Value, int Channel, int StatusCode){
+        if (File == nullptr){
+            return 0;
+        }
+        std::lock_guard<std::mutex> Lock(File->Mutex);
+        if ((File->Count == File->Capacity) && !File->Grow()){
+            return 0;
+        }
+
+        Event_t Event;
+        memset(&Event, 0, sizeof(Event));
+        Event.Sequence = File->FirstSequence + File->Count;
+        Event.TimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        Event.Device = static_cast<uint8_t>(Device);
+        Event.Type = static_cast<uint8_t>(Type);
+        Event.Channel = static_cast<uint16_t>(Channel);
+        Event.Value = Value;
+        Event.StatusCode = StatusCode;
+        Event.Crc = Crc32::Compute(&Event, CRCBYTES);
+
+        Event_t *Slot = File->Record(File->Count);
+        memcpy(Slot, &Event, sizeof(Event));
+
+        // msync solo acepta direcciones alineadas a pagina
+        static const size_t PageSize = sysconf(_SC_PAGESIZE);
+        size_t Offset = reinterpret_cast<unsigned char *>(Slot) - File->Map;
+        size_t Start = Offset & ~(PageSize - 1);
+        if (msync(File->Map + Start, Offset + sizeof(Event_t) - Start, MS_SYNC) != 0){
+            return 0;
+        }
+        File->Count++;
+        return Event.Sequence;
+    }
+
+    size_t EventJournalClass::ReadSince(uint64_t Since, std::vector<Event_t> &Out, size_t Max) const {
+        Out.clear();
+        if (File == nullptr){
+            return 0;
+        }
+        std::lock_guard<std::mutex> Lock(File->Mutex);
+        // Las secuencias son continuas, el primer evento pedido se ubica sin buscar
+        size_t First = (Since < File->FirstSequence) ? 0 : static_cast<size_t>(Since - File->FirstSequence + 1);
+        if (First >= File->Count){
+            return 0;
+        }
+        size_t Count = File->Count - First;
+        if (Count > Max){
+            Count = Max;
+        }
+        Out.assign(File->Record(First), File->Record(First) + Count);
+        return Count;
+    }
+
+    uint64_t EventJournalClass::LastSequence() const {
+        if (File == nullptr){
+            return 0;
+        }
+        std::lock_guard<std::mutex> Lock(File->Mutex);
+        return (File->Count > 0) ? File->FirstSequence + File->Count - 1 : 0;
+    }
+
+    const char *EventTypeName(int Type){
+        static const char *Names[] = { "unknown", "coinAccepted", "coinRejected", "billAccepted", "billRejected", "dispense", "speedChange" };
+        return ((Type > 0) && (Type <= EVENT_SPEED_CHANGE)) ? Names[Type] : Names[0];
+    }
+
+};
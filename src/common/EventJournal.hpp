@@ -0,0 +1,136 @@
+/**
+ * @file EventJournal.hpp
+ * @brief Diario binario de solo agregar (append-only) con las monedas y billetes aceptados, los rechazos y las
+ * tarjetas dispensadas. El archivo se mapea en memoria y cada registro es de tamaño fijo con numero de secuencia,
+ * hora y CRC, asi despues de una caida la aplicacion puede pedir los eventos desde la secuencia N y conciliar sin
+ * leer los logs de texto. Los dispositivos con la misma ruta comparten el diario (una sola secuencia)
+ *
+ * Formato (enteros en el orden de bytes del equipo):
+ * - Cabecera (JournalHeader_t, 64 bytes): "OINKJRN", version, tamaño de registro
+ * - Registros (Event_t, 32 bytes) contiguos. El archivo crece en bloques de GROWRECORDS registros en cero; al abrir
+ *   se recorre hasta el primer registro con CRC invalido o fuera de secuencia (bloque sin usar o escritura cortada)
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef EVENTJOURNAL_HPP
+#define EVENTJOURNAL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "SerialCapture.hpp"
+
+namespace EventJournal {
+
+    static const uint32_t JOURNALVERSION = 1;
+
+    /**
+     * @brief Registros que se agregan al archivo cada vez que se llena (128 KB)
+     */
+    static const size_t GROWRECORDS = 4096;
+
+    /**
+     * @brief Maximo de eventos que regresa getEvents en una llamada. Para leer el resto se vuelve a pedir desde la
+     * ultima secuencia recibida
+     */
+    static const size_t READLIMIT = 1024;
+
+    enum EventType_t{
+        EVENT_COIN_ACCEPTED = 1,    // Moneda aceptada (getCoin 202)
+        EVENT_COIN_REJECTED,        // Moneda rechazada (getCoin 302)
+        EVENT_BILL_ACCEPTED,        // Billete acreditado (evento CREDIT del NV10)
+        EVENT_BILL_REJECTED,        // Billete rechazado (getBill 305)
+        EVENT_DISPENSE,             // Intento de dispensar una tarjeta, el resultado va en StatusCode
+        EVENT_SPEED_CHANGE,         // Cambio de velocidad del disco: Value la nueva, Channel la anterior, StatusCode el motivo
+    };
+
+    struct JournalHeader_t{
+        char Magic[8];              // "OINKJRN\0"
+        uint32_t Version;           // JOURNALVERSION
+        uint32_t RecordSize;        // sizeof(Event_t)
+        uint8_t Reserved[48];
+    };
+
+    struct Event_t{
+        uint64_t Sequence;          // 1, 2, 3... sin huecos, continua despues de reiniciar
+        uint64_t TimeMs;            // Hora del sistema en milisegundos desde 1970
+        uint8_t Device;             // SerialCapture::Device_t
+        uint8_t Type;               // EventType_t
+        uint16_t Channel;           // Canal de la moneda o billete (0 si no aplica)
+        int32_t Value;              // Valor de la moneda o billete (0 si no aplica)
+        int32_t StatusCode;         // Codigo que se regreso a JS
+        uint32_t Crc;               // CRC32 de los bytes anteriores del registro
+    };
+
+    static_assert(sizeof(JournalHeader_t) == 64, "JournalHeader_t debe ocupar 64 bytes");
+    static_assert(sizeof(Event_t) == 32, "Event_t debe ocupar 32 bytes");
+
+    struct JournalFile_t;
+
+    class EventJournalClass{
+        public:
+
+            EventJournalClass();
+            ~EventJournalClass();
+
+            /**
+             * @brief Abre (o crea) el diario y recupera la ultima secuencia valida. Si otro dispositivo del proceso
+             * ya lo tiene abierto se comparte
+             * @param Path Ruta del archivo del diario
+             * @return int 0 si se pudo abrir, 1 si no se pudo abrir/mapear o el archivo no es un diario
+             */
+            int Open(const std::string &Path);
+
+            /**
+             * @brief Deja de usar el diario. El archivo se cierra cuando ningun dispositivo lo usa
+             */
+            void Close();
+
+            /**
+             * @brief Agrega un evento y espera a que llegue al disco (msync de la pagina del registro)
+             * @param Device Dispositivo que genero el evento
+             * @param Type Tipo de evento
+             * @param Value Valor de la moneda o billete
+             * @param Channel Canal de la moneda o billete
+             * @param StatusCode Codigo que se regreso a JS
+             * @return uint64_t Secuencia asignada, 0 si el diario no esta abierto o no se pudo escribir
+             */
+            uint64_t Append(SerialCapture::Device_t Device, EventType_t Type, int Value, int Channel, int StatusCode);
+
+            /**
+             * @brief Copia los eventos con secuencia mayor a Since, en orden
+             * @param Since Ultima secuencia que ya se tiene (0 para todos)
+             * @param Out Eventos encontrados
+             * @param Max Maximo numero de eventos a copiar
+             * @return size_t Numero de eventos copiados
+             */
+            size_t ReadSince(uint64_t Since, std::vector<Event_t> &Out, size_t Max) const;
+
+            /**
+             * @brief Secuencia del ultimo evento guardado, 0 si el diario esta vacio o no esta abierto
+             */
+            uint64_t LastSequence() const;
+
+            /**
+             * @brief Indica si el diario esta abierto
+             */
+            bool IsOpen() const { return File != nullptr; }
+
+        private:
+            std::shared_ptr<JournalFile_t> File;
+    };
+
+    /**
+     * @brief Nombre del tipo de evento ("coinAccepted", "coinRejected", "billAccepted", "billRejected", "dispense")
+     */
+    const char *EventTypeName(int Type);
+
+};
+
+#endif /* EVENTJOURNAL_HPP */
@@ -0,0 +1,136 @@
+/**
+ * @file FlightRecorder.cpp
+ * @brief Registro en memoria de tramas, transiciones y resultados por dispositivo
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include "FlightRecorder.hpp"
+
+namespace FlightRecorder {
+
+    static const char *TypeNames[] = { "TX", "RX", "SM", "EX" };
+
+    FlightRecorderClass::FlightRecorderClass() : Start(std::chrono::steady_clock::now()), Head(0) {
+        for (size_t i = 0; i < RECORDERSIZE; i++){
+            Slots[i].Seq.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    Entry_t &FlightRecorderClass::Begin(EntryType_t Type, uint64_t &Ticket){
+        Ticket = Head.fetch_add(1, std::memory_order_relaxed);
+        Slot_t &Slot = Slots[Ticket % RECORDERSIZE];
+        Slot.Seq.store(2 * Ticket + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        Entry_t &Entry = Slot.Entry;
+        Entry.TimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count();
+        Entry.Sequence = static_cast<uint32_t>(Ticket);
+        Entry.Type = static_cast<uint16_t>(Type);
+        return Entry;
+    }
+
+    void FlightRecorderClass::Commit(uint64_t Ticket){
+        Slots[Ticket % RECORDERSIZE].Seq.store(2 * Ticket + 2, std::memory_order_release);
+    }
+
+    void FlightRecorderClass::RecordFrame(EntryType_t Type, const unsigned char *Frame, long Length){
+        if (Length <= 0){
+            return;
+        }
+        uint64_t Ticket;
+        Entry_t &Entry = Begin(Type, Ticket);
+        Entry.Length = static_cast<uint16_t>(Length);
+        memcpy(Entry.Data, Frame, (static_cast<size_t>(Length) < FRAMESIZE) ? Length : FRAMESIZE);
+        Commit(Ticket);
+    }
+
+    void FlightRecorderClass::RecordTransition(const char *From, int Event, const char *To, int Response){
+        uint64_t Ticket;
+        Entry_t &Entry = Begin(ENTRY_TRANSITION, Ticket);
+        Entry.Length = 0;
+        Entry.Values[0] = Event;
+        Entry.Values[1] = Response;
+        Entry.Names[0] = From;
+        Entry.Names[1] = To;
+        Commit(Ticket);
+    }
+
+    void FlightRecorderClass::RecordResult(int Code, const char *Message){
+        uint64_t Ticket;
+        Entry_t &Entry = Begin(ENTRY_RESULT, Ticket);
+        Entry.Length = 0;
+        Entry.Values[0] = Code;
+        Entry.Names[0] = Message;
+        Commit(Ticket);
+    }
+
+    size_t FlightRecorderClass::Snapshot(Entry_t *Out, size_t Max) const {
+        uint64_t End = Head.load(std::memory_order_acquire);
+        uint64_t First = (End > RECORDERSIZE) ? End - RECORDERSIZE : 0;
+        if (End - First > Max){
+            First = End - Max;
+        }
+        size_t Count = 0;
+        for (uint64_t Ticket = First; Ticket < End; Ticket++){
+            const Slot_t &Slot = Slots[Ticket % RECORDERSIZE];
+            uint64_t Before = Slot.Seq.load(std::memory_order_acquire);
+            if (Before != 2 * Ticket + 2){
+                continue;
+            }
+            Out[Count] = Slot.Entry;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (Slot.Seq.load(std::memory_order_relaxed) == Before){
+                Count++;
+            }
+        }
+        return Count;
+    }
+
+    long FlightRecorderClass::Dump(const char *Reason) const {
+        if (Path.empty()){
+            return -1;
+        }
+        static thread_local Entry_t Entries[RECORDERSIZE];
+        size_t Count = Snapshot(Entries, RECORDERSIZE);
+
+        FILE *File = fopen(Path.c_str(), "w");
+        if (File == nullptr){
+            return -1;
+        }
+
+        char Now[32];
+        time_t Wall = time(nullptr);
+        strftime(Now, sizeof(Now), "%Y-%m-%d %H:%M:%S", localtime(&Wall));
+        fprintf(File, "# Flight recorder: %s (%s), %zu entradas\n", Reason, Now, Count);
+
+        for (size_t i = 0; i < Count; i++){
+            const Entry_t &Entry = Entries[i];
+            fprintf(File, "%10u %12.6f %s ", Entry.Sequence, Entry.TimeNs / 1e9, TypeNames[Entry.Type]);
+            if ((Entry.Type == ENTRY_TX) || (Entry.Type == ENTRY_RX)){
+                size_t Shown = (Entry.Length < FRAMESIZE) ? Entry.Length : FRAMESIZE;
+                for (size_t j = 0; j < Shown; j++){
+                    fprintf(File, "%02x ", Entry.Data[j]);
+                }
+                if (Shown < Entry.Length){
+                    fprintf(File, "... (%u bytes)", Entry.Length);
+                }
+            }
+            else if (Entry.Type == ENTRY_TRANSITION){
+                fprintf(File, "%s -(%d)-> %s = %d", Entry.Names[0], Entry.Values[0], Entry.Names[1], Entry.Values[1]);
+            }
+            else {
+                fprintf(File, "%d %s", Entry.Values[0], (Entry.Names[0] != nullptr) ? Entry.Names[0] : "");
+            }
+            fprintf(File, "\n");
+        }
+        fclose(File);
+        return static_cast<long>(Count);
+    }
+
+};
@@ -0,0 +1,118 @@
+/**
+ * @file FlightRecorder.hpp
+ * @brief Registro en memoria (flight recorder) de las ultimas tramas TX/RX, transiciones de la maquina de estados y
+ * resultados de ExecuteCommand de un dispositivo. Es un buffer circular de tamaño fijo sin locks: escribir una
+ * entrada es reservar una posicion con un contador atomico y copiar unos bytes, asi se puede dejar activo todo el
+ * tiempo en lugar de correr con logging en trace. El contenido se vuelca a un archivo cuando hay un error
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef FLIGHTRECORDER_HPP
+#define FLIGHTRECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace FlightRecorder {
+
+    /**
+     * @brief Numero de entradas que guarda cada dispositivo
+     */
+    static const size_t RECORDERSIZE = 256;
+
+    /**
+     * @brief Bytes que se guardan de cada trama (las tramas mas largas se recortan)
+     */
+    static const size_t FRAMESIZE = 48;
+
+    enum EntryType_t{
+        ENTRY_TX,           // Trama enviada al dispositivo
+        ENTRY_RX,           // Trama recibida del dispositivo
+        ENTRY_TRANSITION,   // Transicion de la maquina de estados
+        ENTRY_RESULT,       // Resultado de ExecuteCommand (ErrorCodeExComm)
+    };
+
+    struct Entry_t{
+        uint64_t TimeNs;            // Tiempo monotono desde que se creo el registro
+        uint32_t Sequence;          // Numero de entrada desde que se creo el registro
+        uint16_t Type;              // EntryType_t
+        uint16_t Length;            // Longitud real de la trama (puede ser mayor a FRAMESIZE)
+        int32_t Values[3];          // Transicion: evento, respuesta. Resultado: codigo
+        const char *Names[2];       // Transicion: estado origen y destino. Resultado: mensaje (cadenas estaticas)
+        unsigned char Data[FRAMESIZE];
+    };
+
+    class FlightRecorderClass{
+        public:
+
+            FlightRecorderClass();
+
+            /**
+             * @brief Guarda una trama enviada o recibida
+             * @param Type ENTRY_TX o ENTRY_RX
+             * @param Frame Bytes de la trama
+             * @param Length Numero de bytes validos (si es menor o igual a 0 no se guarda nada)
+             */
+            void RecordFrame(EntryType_t Type, const unsigned char *Frame, long Length);
+
+            /**
+             * @brief Guarda una transicion de la maquina de estados
+             * @param From Nombre del estado origen (cadena estatica de la tabla de estados)
+             * @param Event Evento que produjo la transicion
+             * @param To Nombre del estado destino
+             * @param Response Respuesta de la funcion del estado destino
+             */
+            void RecordTransition(const char *From, int Event, const char *To, int Response);
+
+            /**
+             * @brief Guarda el resultado de un comando
+             * @param Code Codigo de ErrorCodeExComm
+             * @param Message Mensaje del codigo (cadena estatica de la tabla)
+             */
+            void RecordResult(int Code, const char *Message);
+
+            /**
+             * @brief Copia las entradas completas, de la mas antigua a la mas reciente. Las entradas que se estan
+             * escribiendo en ese momento se omiten
+             * @param Out Arreglo destino
+             * @param Max Tamaño del arreglo destino
+             * @return size_t Numero de entradas copiadas
+             */
+            size_t Snapshot(Entry_t *Out, size_t Max) const;
+
+            /**
+             * @brief Escribe el contenido del registro en un archivo de texto (sobrescribe el volcado anterior)
+             * @param Reason Motivo del volcado, se escribe en la cabecera
+             * @return long Numero de entradas escritas, -1 si no hay ruta o no se pudo abrir el archivo
+             */
+            long Dump(const char *Reason) const;
+
+            /**
+             * @brief Ruta del archivo de volcado
+             */
+            std::string Path;
+
+        private:
+            struct Slot_t{
+                std::atomic<uint64_t> Seq;  // Impar mientras se escribe, 2*(turno+1) cuando la entrada esta completa
+                Entry_t Entry;
+            };
+
+            std::chrono::steady_clock::time_point Start;
+            std::atomic<uint64_t> Head;
+            Slot_t Slots[RECORDERSIZE];
+
+            Entry_t &Begin(EntryType_t Type, uint64_t &Ticket);
+            void Commit(uint64_t Ticket);
+    };
+
+};
+
+#endif /* FLIGHTRECORDER_HPP */
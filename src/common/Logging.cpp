@@ -0,0 +1,78 @@
+/**
+ * @file Logging.cpp
+ * @brief Loggers asincronos con cola preasignada y flush en hilo de fondo
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include "Logging.hpp"
+#include "spdlog/async.h" //Logging library - async
+#include "spdlog/sinks/daily_file_sink.h" //Logging library - daily file
+
+namespace Logging {
+
+    static std::once_flag PoolFlag;
+
+    // Protege el registro de sinks y la eleccion de nombres
+    static std::mutex RegistryMutex;
+
+    // Sinks abiertos por ruta. Se guardan como weak_ptr para que el archivo se cierre con el ultimo logger
+    static std::map<std::string, std::weak_ptr<spdlog::sinks::sink>> Sinks;
+
+    static void InitPool(){
+        // Un solo hilo de fondo para todos los dispositivos, el orden de los mensajes de cada logger se conserva
+        spdlog::init_thread_pool(QUEUESIZE, 1);
+        spdlog::flush_every(std::chrono::seconds(FLUSHINTERVAL));
+    }
+
+    std::shared_ptr<spdlog::logger> CreateLogger(const std::string &BaseName, const std::string &Path){
+        std::call_once(PoolFlag, InitPool);
+        std::lock_guard<std::mutex> Lock(RegistryMutex);
+
+        std::shared_ptr<spdlog::sinks::sink> Sink = Sinks[Path].lock();
+        if (Sink == nullptr){
+            Sink = std::make_shared<spdlog::sinks::daily_file_sink_mt>(Path, 23, 59);
+            Sinks[Path] = Sink;
+        }
+
+        std::string Name = BaseName;
+        for (int Id = 1; spdlog::get(Name) != nullptr; Id++){
+            Name = BaseName + std::to_string(Id);
+        }
+
+        auto Logger = std::make_shared<spdlog::async_logger>(Name, Sink, spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+        spdlog::initialize_logger(Logger);
+        Logger->flush_on(spdlog::level::warn);
+        return Logger;
+    }
+
+    void DropLogger(std::shared_ptr<spdlog::logger> &Logger){
+        if (Logger == nullptr){
+            return;
+        }
+        std::lock_guard<std::mutex> Lock(RegistryMutex);
+        try {
+            Logger->flush();
+        }
+        catch (const spdlog::spdlog_ex &) {
+            // El hilo de fondo ya no existe (spdlog::shutdown al salir), no hay nada que vaciar
+        }
+        spdlog::drop(Logger->name());
+        Logger.reset();
+        for (auto It = Sinks.begin(); It != Sinks.end();){
+            It = It->second.expired() ? Sinks.erase(It) : std::next(It);
+        }
+    }
+
+    size_t DroppedMessages(){
+        auto Pool = spdlog::thread_pool();
+        return (Pool != nullptr) ? Pool->overrun_counter() : 0;
+    }
+
+};
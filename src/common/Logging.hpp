@@ -0,0 +1,73 @@
+/**
+ * @file Logging.hpp
+ * @brief Loggers asincronos para los dispositivos. Los mensajes se encolan en una cola preasignada y un hilo de
+ * fondo los escribe y hace flush al archivo diario, asi el hilo que habla con el puerto serial nunca espera al
+ * disco. Si la cola se llena se descartan los mensajes mas antiguos en lugar de bloquear. Cada instancia de un
+ * dispositivo tiene su propio logger (nombre y nivel independientes); los loggers con la misma ruta comparten el sink
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef LOGGING_HPP
+#define LOGGING_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "spdlog/spdlog.h" //Logging library
+#include "spdlog/fmt/bin_to_hex.h" //Logging library - hex dump
+
+namespace Logging {
+
+    /**
+     * @brief Numero de mensajes que caben en la cola compartida por todos los loggers (se reserva al iniciar)
+     */
+    static const size_t QUEUESIZE = 8192;
+
+    /**
+     * @brief Cada cuantos segundos el hilo de fondo hace flush de todos los loggers
+     */
+    static const int FLUSHINTERVAL = 2;
+
+    /**
+     * @brief Crea un logger asincrono que escribe en un archivo diario (rota a las 23:59). La primera llamada crea
+     * la cola y el hilo de fondo. Los mensajes de nivel warn o mayor piden flush al hilo de fondo sin esperar.
+     * Si ya hay un logger con la misma ruta se reutiliza su sink, asi un archivo solo se abre una vez
+     * @param BaseName Nombre base del logger. Si ya esta registrado se agrega un numero (ValidatorPelicano1, ...)
+     * @param Path Ruta del archivo de log
+     * @return std::shared_ptr<spdlog::logger> Logger registrado en spdlog
+     */
+    std::shared_ptr<spdlog::logger> CreateLogger(const std::string &BaseName, const std::string &Path);
+
+    /**
+     * @brief Da de baja un logger del registro de spdlog y libera la referencia. Los mensajes que sigan en la cola
+     * se escriben igual; el sink se cierra cuando ningun logger lo usa. No hace nada si Logger es nulo
+     * @param Logger Logger a dar de baja, queda en nullptr
+     */
+    void DropLogger(std::shared_ptr<spdlog::logger> &Logger);
+
+    /**
+     * @brief Numero de mensajes descartados porque la cola estaba llena
+     * @return size_t Mensajes descartados desde que se creo la cola
+     */
+    size_t DroppedMessages();
+
+    /**
+     * @brief Da formato hexadecimal a los primeros bytes de una trama, para usar con "{0:n}" (una sola linea)
+     * @param Frame Trama enviada o recibida
+     * @param Length Numero de bytes a mostrar, se recorta al tamaño de la trama (negativo muestra 0 bytes)
+     * @param Offset Primer byte a mostrar
+     */
+    inline auto Hex(const std::vector<unsigned char> &Frame, long Length, long Offset = 0) -> decltype(spdlog::to_hex(Frame.begin(), Frame.end())) {
+        long Size = static_cast<long>(Frame.size());
+        long Begin = (Offset < 0) ? 0 : ((Offset > Size) ? Size : Offset);
+        long End = (Length < 0) ? Begin : ((Begin + Length > Size) ? Size : Begin + Length);
+        return spdlog::to_hex(Frame.begin() + Begin, Frame.begin() + End);
+    }
+
+};
+
+#endif /* LOGGING_HPP */
@@ -0,0 +1,47 @@
+/**
+ * @file PollOptions.hpp
+ * @brief Lectura de la opcion pollRate que reciben los constructores de JS. Va aparte de PollScheduler.hpp porque
+ * depende de N-API y el planificador tambien se compila en los benchmarks sin node
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef POLLOPTIONS_HPP
+#define POLLOPTIONS_HPP
+
+#include <napi.h>
+#include "PollScheduler.hpp"
+
+namespace PollScheduler {
+
+    /**
+     * @brief Lee pollRate ({ fastMs, maxMs, activeWindowMs }) de los parametros del constructor. Los campos que no
+     * vienen conservan el valor que ya tenia Config; los limites del protocolo los aplica Configure
+     * @param Params Objeto de parametros del constructor
+     * @param Config Configuracion actual del planificador, se actualiza con los campos que vengan
+     * @return true Si venia pollRate y se debe llamar Configure
+     * @return false Si no venia pollRate
+     */
+    inline bool ParseConfig(Napi::Object Params, Config_t &Config){
+        if (!Params.Has("pollRate") || !Params.Get("pollRate").IsObject()){
+            return false;
+        }
+        Napi::Object Rate = Params.Get("pollRate").As<Napi::Object>();
+        if (Rate.Has("fastMs")){
+            Config.FastMs = Rate.Get("fastMs").ToNumber().Int32Value();
+        }
+        if (Rate.Has("maxMs")){
+            Config.MaxMs = Rate.Get("maxMs").ToNumber().Int32Value();
+        }
+        if (Rate.Has("activeWindowMs")){
+            Config.ActiveWindowMs = Rate.Get("activeWindowMs").ToNumber().Int32Value();
+        }
+        return true;
+    }
+
+};
+
+#endif /* POLLOPTIONS_HPP */
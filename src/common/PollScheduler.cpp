@@ -0,0 +1,87 @@
+/**
+ * @file PollScheduler.cpp
+ * @brief Ritmo de polling adaptativo por dispositivo
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "PollScheduler.hpp"
+
+namespace PollScheduler {
+
+    // Tiempo con intervalo rapido despues de la ultima actividad cuando no se configura
+    static const int ACTIVEWINDOWMS = 5000;
+
+    static int Clamp(int Value, int Min, int Max){
+        return (Value < Min) ? Min : ((Value > Max) ? Max : Value);
+    }
+
+    PollSchedulerClass::PollSchedulerClass(int MinMs, int MaxMs) : LimitMin(MinMs), LimitMax(MaxMs), Current(MinMs), Busy(false),
+                                                                   Polls(0), FastPolls(0) {
+        Cfg.FastMs = MinMs;
+        Cfg.MaxMs = MaxMs;
+        Cfg.ActiveWindowMs = ACTIVEWINDOWMS;
+    }
+
+    void PollSchedulerClass::Configure(const Config_t &Config){
+        Cfg.FastMs = Clamp(Config.FastMs, LimitMin, LimitMax);
+        Cfg.MaxMs = Clamp(Config.MaxMs, Cfg.FastMs, LimitMax);
+        Cfg.ActiveWindowMs = (Config.ActiveWindowMs >= 0) ? Config.ActiveWindowMs : ACTIVEWINDOWMS;
+        Current = Cfg.FastMs;
+    }
+
+    void PollSchedulerClass::Start(Time_t Now){
+        Polls = 0;
+        FastPolls = 0;
+        Busy = false;
+        Activity(Now);
+    }
+
+    void PollSchedulerClass::Activity(Time_t Now){
+        LastActivity = Now;
+        Current = Cfg.FastMs;
+    }
+
+    void PollSchedulerClass::SetBusy(bool _Busy, Time_t Now){
+        // Al terminar la actividad larga empieza la ventana activa, no el retroceso
+        if (Busy & !_Busy){
+            LastActivity = Now;
+        }
+        Busy = _Busy;
+        if (Busy){
+            Current = Cfg.FastMs;
+        }
+    }
+
+    bool PollSchedulerClass::IsActive(Time_t Now) const {
+        return Busy || (Now - LastActivity < std::chrono::milliseconds(Cfg.ActiveWindowMs));
+    }
+
+    int PollSchedulerClass::Next(Time_t Now){
+        Polls++;
+        if (IsActive(Now)){
+            FastPolls++;
+            Current = Cfg.FastMs;
+        }
+        else {
+            // Retroceso exponencial: se duplica la espera en cada poll sin actividad hasta MaxMs
+            int Doubled = (Current > 0) ? 2 * Current : 1;
+            Current = (Doubled < Cfg.MaxMs) ? Doubled : Cfg.MaxMs;
+        }
+        return Current;
+    }
+
+    Stats_t PollSchedulerClass::Stats(Time_t Now) const {
+        Stats_t Stats;
+        Stats.Active = IsActive(Now);
+        Stats.IntervalMs = Current;
+        Stats.Config = Cfg;
+        Stats.Polls = Polls;
+        Stats.FastPolls = FastPolls;
+        return Stats;
+    }
+
+};
@@ -0,0 +1,144 @@
+/**
+ * @file PollScheduler.hpp
+ * @brief Ritmo de polling adaptativo por dispositivo: intervalo corto mientras hay actividad (monedas entrando, billete
+ * en custodia) y espera que se duplica en cada poll sin actividad hasta el limite del protocolo
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef POLLSCHEDULER_HPP
+#define POLLSCHEDULER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace PollScheduler {
+
+    /**
+     * @brief ccTalk: el validador guarda solo los ultimos 5 eventos en su buffer. Cada comando espera 200 ms la
+     * respuesta, asi que con 600 ms de espera un ciclo dura 800 ms: 4 monedas con el disco a 5 monedas por segundo,
+     * un evento de margen antes de perder monedas
+     */
+    static const int CCTALKMINMS = 10;
+    static const int CCTALKMAXMS = 600;
+
+    /**
+     * @brief SSP: el billetero se deshabilita solo si deja de recibir POLL unos segundos y no se debe preguntar mas
+     * rapido que cada 100 ms. 1 s deja margen de sobra para mantenerlo habilitado
+     */
+    static const int SSPMINMS = 100;
+    static const int SSPMAXMS = 1000;
+
+    /**
+     * @brief Dispensador: no guarda eventos ni se deshabilita, el maximo solo acota cuanto tarda en verse una tarjeta
+     * puesta o retirada sin que haya un dispensado en curso
+     */
+    static const int DISPENSERMINMS = 20;
+    static const int DISPENSERMAXMS = 2000;
+
+    /**
+     * @brief Paso de la espera entre polls: la espera larga (sin actividad) se parte en pasos de este tamaño para
+     * responder rapido a finish y a la actividad
+     */
+    static const int WAITSLICEMS = 10;
+
+    typedef std::chrono::steady_clock::time_point Time_t;
+
+    struct Config_t{
+        int FastMs;                 // Espera entre polls durante la actividad
+        int MaxMs;                  // Espera maxima sin actividad
+        int ActiveWindowMs;         // Tiempo que se mantiene FastMs despues de la ultima actividad
+    };
+
+    struct Stats_t{
+        bool Active;                // Hay actividad o no ha pasado ActiveWindowMs desde la ultima
+        int IntervalMs;             // Espera actual entre polls
+        Config_t Config;
+        uint64_t Polls;             // Polls desde que se inicio el lector
+        uint64_t FastPolls;         // Polls hechos con FastMs
+    };
+
+    class PollSchedulerClass{
+        public:
+
+            /**
+             * @brief Crea el planificador con los limites del protocolo, la configuracion se ajusta siempre a ellos
+             * @param MinMs Espera minima entre polls
+             * @param MaxMs Espera maxima entre polls
+             */
+            PollSchedulerClass(int MinMs, int MaxMs);
+
+            /**
+             * @brief Cambia la configuracion (opcion pollRate). Los valores se ajustan a los limites del protocolo
+             */
+            void Configure(const Config_t &Config);
+
+            /**
+             * @brief Reinicia contadores y arranca en el intervalo rapido. Se llama al iniciar el lector
+             */
+            void Start(Time_t Now);
+
+            /**
+             * @brief Registra actividad (moneda, billete, error del validador): vuelve al intervalo rapido
+             */
+            void Activity(Time_t Now);
+
+            /**
+             * @brief Marca una actividad que dura varios polls (billete en custodia o en lectura). Mientras este
+             * activa el intervalo no sube
+             */
+            void SetBusy(bool Busy, Time_t Now);
+
+            /**
+             * @brief Calcula la espera antes del siguiente poll. Se llama despues de cada poll
+             * @return int Espera en ms
+             */
+            int Next(Time_t Now);
+
+            /**
+             * @brief Espera actual, sin lock: la lee el hilo de onCoin/onBill entre polls
+             */
+            int Interval() const { return Current; }
+
+            const Config_t &GetConfig() const { return Cfg; }
+
+            Stats_t Stats(Time_t Now) const;
+
+        private:
+            int LimitMin;
+            int LimitMax;
+            Config_t Cfg;
+            std::atomic<int> Current;
+            bool Busy;
+            Time_t LastActivity;
+            uint64_t Polls;
+            uint64_t FastPolls;
+
+            bool IsActive(Time_t Now) const;
+    };
+
+    /**
+     * @brief Espera antes del siguiente poll en pasos de WAITSLICEMS. Termina antes si Running se baja o si la
+     * espera del dispositivo baja (hubo actividad y el planificador regreso al intervalo rapido)
+     * @param Delay Funcion que regresa la espera actual del dispositivo en ms (PollDelayMs del control)
+     * @param Running Bandera del hilo que hace el polling
+     */
+    template <typename Delay_t>
+    void WaitNextPoll(Delay_t Delay, const std::atomic<bool> &Running){
+        int Total = Delay();
+        for (int Waited = 0; (Waited < Total) && Running; Waited += WAITSLICEMS){
+            std::this_thread::sleep_for(std::chrono::milliseconds(WAITSLICEMS));
+            if (Delay() < Total){
+                break;
+            }
+        }
+    }
+
+};
+
+#endif /* POLLSCHEDULER_HPP */
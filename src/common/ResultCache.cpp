@@ -0,0 +1,225 @@
+/**
+ * @file ResultCache.cpp
+ * @brief Cache por entorno (napi_env) de las llaves y mensajes usados para construir los resultados que se
+ * regresan a JS
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "ResultCache.hpp"
+#include "AddonData.hpp"
+
+namespace ResultCache {
+
+    static const char *KeyNames[KEY_COUNT] = {
+        "statusCode",
+        "message",
+        "event",
+        "coin",
+        "bill",
+        "remaining",
+        "insertedCoins",
+        "version",
+        "device",
+        "errorType",
+        "errorCode",
+        "aditionalInfo",
+        "priority",
+        "50",
+        "100",
+        "200",
+        "500",
+        "1000",
+        "rficCardInG",
+        "recyclingBoxF",
+        "cardInG",
+        "cardsInD",
+        "dispenserF",
+        "urgent",
+        "normal",
+        "poll",
+        "count",
+        "avgWaitUs",
+        "maxWaitUs",
+        "path",
+        "sequence",
+        "time",
+        "type",
+        "value",
+        "channel",
+        "commands",
+        "retries",
+        "timeouts",
+        "crcErrors",
+        "failures",
+        "resyncs",
+        "avgRecoveryUs",
+        "maxRecoveryUs",
+        "cleanMs",
+        "idle",
+        "activeMs",
+        "idleMs",
+        "wakeups",
+        "active",
+        "intervalMs",
+        "fastMs",
+        "maxMs",
+        "activeWindowMs",
+        "polls",
+        "fastPolls",
+        "flag",
+        "index",
+        "taken",
+        "dispenseMs",
+        "takenMs",
+    };
+
+    ResultCacheClass::ResultCacheClass(Napi::Env env){
+        for (int i = 0; i < KEY_COUNT; i++){
+            Keys[i] = Napi::Persistent(Napi::String::New(env, KeyNames[i]));
+        }
+    }
+
+    ResultCacheClass *ResultCacheClass::Get(Napi::Env env){
+        return &env.GetInstanceData<AddonData::AddonDataClass>()->Cache;
+    }
+
+    napi_value ResultCacheClass::String(Napi::Env env, const std::string &Text){
+        auto It = Messages.find(Text);
+        if (It != Messages.end()){
+            return It->second.Value();
+        }
+        Napi::String Value = Napi::String::New(env, Text);
+        if (Messages.size() < MAXMESSAGES){
+            Messages.emplace(Text, Napi::Persistent(Value));
+        }
+        return Value;
+    }
+
+    napi_value ResultCacheClass::Text(Napi::Env env, const std::string &Text){
+        return Napi::String::New(env, Text);
+    }
+
+    // Codigos cuyo mensaje se arma con datos que cambian: contadores de errores (401/402/403), monedas insertadas
+    // (206), codigo y mensaje de la falla (500/504/510/515)
+    static bool IsVariableMessage(int StatusCode){
+        return (StatusCode == 206) | (StatusCode == 401) | (StatusCode == 402) | (StatusCode == 403) |
+               (StatusCode == 500) | (StatusCode == 504) | (StatusCode == 510) | (StatusCode == 515);
+    }
+
+    napi_value ResultCacheClass::Message(Napi::Env env, int StatusCode, const std::string &Message){
+        if (IsVariableMessage(StatusCode)){
+            return Text(env, Message);
+        }
+        return String(env, Message);
+    }
+
+    napi_value ResultCacheClass::Number(Napi::Env env, double Value){
+        napi_value Result;
+        napi_status status = napi_create_double(env, Value, &Result);
+        NAPI_THROW_IF_FAILED(env, status, nullptr);
+        return Result;
+    }
+
+    napi_value ResultCacheClass::Boolean(Napi::Env env, bool Value){
+        napi_value Result;
+        napi_status status = napi_get_boolean(env, Value, &Result);
+        NAPI_THROW_IF_FAILED(env, status, nullptr);
+        return Result;
+    }
+
+    Napi::Object ResultCacheClass::Build(Napi::Env env, const Field_t *Fields, size_t Count){
+        napi_value Object;
+        napi_status status = napi_create_object(env, &Object);
+        NAPI_THROW_IF_FAILED(env, status, Napi::Object());
+
+        // Mismos atributos que una asignacion object["llave"] = valor
+        const napi_property_attributes Attributes = static_cast<napi_property_attributes>(napi_writable | napi_enumerable | napi_configurable);
+        napi_property_descriptor Descriptors[MAXFIELDS];
+        if (Count > MAXFIELDS){
+            NAPI_THROW(Napi::Error::New(env, "Result object has more fields than MAXFIELDS"), Napi::Object());
+        }
+        for (size_t i = 0; i < Count; i++){
+            Descriptors[i] = { nullptr, Keys[Fields[i].Key].Value(), nullptr, nullptr, nullptr, Fields[i].Value, Attributes, nullptr };
+        }
+
+        status = napi_define_properties(env, Object, Count, Descriptors);
+        NAPI_THROW_IF_FAILED(env, status, Napi::Object());
+        return Napi::Object(env, Object);
+    }
+
+    Napi::Object ResultCacheClass::Response(Napi::Env env, int StatusCode, const std::string &Message){
+        Field_t Fields[] = {
+            { KEY_MESSAGE,      this->Message(env, StatusCode, Message) },
+            { KEY_STATUS_CODE,  Number(env, StatusCode) },
+        };
+        return Build(env, Fields);
+    }
+
+    Napi::Object ResultCacheClass::MessageTable(Napi::Env env, const StatusMessage_t *Table, size_t Count){
+        Napi::Object Object = Napi::Object::New(env);
+        for (size_t i = 0; i < Count; i++){
+            Object.Set(static_cast<uint32_t>(Table[i].StatusCode), Napi::String::New(env, Table[i].Message));
+        }
+        Object.Freeze();
+        return Object;
+    }
+
+    Napi::Object ResultCacheClass::QueueStats(Napi::Env env, CommandScheduler::CommandSchedulerClass &Scheduler){
+        const Key_t ClassKeys[CommandScheduler::PRIORITY_COUNT] = { KEY_URGENT, KEY_NORMAL, KEY_POLL };
+        Field_t Classes[CommandScheduler::PRIORITY_COUNT];
+        for (int i = 0; i < CommandScheduler::PRIORITY_COUNT; i++){
+            CommandScheduler::QueueStats_t Stats = Scheduler.GetStats(static_cast<CommandScheduler::Priority_t>(i));
+            Field_t Fields[] = {
+                { KEY_QUEUE_COUNT,  Number(env, Stats.Count) },
+                { KEY_AVG_WAIT_US,  Number(env, (Stats.Count > 0) ? (double)Stats.TotalWaitUs / Stats.Count : 0) },
+                { KEY_MAX_WAIT_US,  Number(env, Stats.MaxWaitUs) },
+            };
+            Classes[i] = { ClassKeys[i], Build(env, Fields) };
+        }
+        return Build(env, Classes);
+    }
+
+    Napi::Object ResultCacheClass::PollStats(Napi::Env env, const PollScheduler::Stats_t &Stats){
+        Field_t Fields[] = {
+            { KEY_ACTIVE,           Boolean(env, Stats.Active) },
+            { KEY_INTERVAL_MS,      Number(env, Stats.IntervalMs) },
+            { KEY_FAST_MS,          Number(env, Stats.Config.FastMs) },
+            { KEY_MAX_MS,           Number(env, Stats.Config.MaxMs) },
+            { KEY_ACTIVE_WINDOW_MS, Number(env, Stats.Config.ActiveWindowMs) },
+            { KEY_POLLS,            Number(env, static_cast<double>(Stats.Polls)) },
+            { KEY_FAST_POLLS,       Number(env, static_cast<double>(Stats.FastPolls)) },
+        };
+        return Build(env, Fields);
+    }
+
+    Napi::Object ResultCacheClass::RecorderDump(Napi::Env env, long Count, const std::string &Path){
+        Field_t Fields[] = {
+            { KEY_QUEUE_COUNT,  Number(env, Count) },
+            { KEY_PATH,         Napi::String::New(env, Path) },
+        };
+        return Build(env, Fields);
+    }
+
+    Napi::Array ResultCacheClass::JournalEvents(Napi::Env env, const std::vector<EventJournal::Event_t> &Events){
+        Napi::Array Array = Napi::Array::New(env, Events.size());
+        for (size_t i = 0; i < Events.size(); i++){
+            const EventJournal::Event_t &Event = Events[i];
+            Field_t Fields[] = {
+                { KEY_SEQUENCE,     Number(env, static_cast<double>(Event.Sequence)) },
+                { KEY_TIME,         Number(env, static_cast<double>(Event.TimeMs)) },
+                { KEY_DEVICE,       String(env, SerialCapture::DeviceName(Event.Device)) },
+                { KEY_TYPE,         String(env, EventJournal::EventTypeName(Event.Type)) },
+                { KEY_VALUE,        Number(env, Event.Value) },
+                { KEY_CHANNEL,      Number(env, Event.Channel) },
+                { KEY_STATUS_CODE,  Number(env, Event.StatusCode) },
+            };
+            Array.Set(static_cast<uint32_t>(i), Build(env, Fields));
+        }
+        return Array;
+    }
+
+};
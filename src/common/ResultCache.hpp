@@ -0,0 +1,245 @@
+/**
+ * @file ResultCache.hpp
+ * @brief Cache por entorno (napi_env) de las llaves y mensajes usados para construir los resultados que se
+ * regresan a JS, evitando crear las mismas cadenas en cada llamada
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef RESULTCACHE_HPP
+#define RESULTCACHE_HPP
+
+#include <napi.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CommandScheduler.hpp"
+#include "EventJournal.hpp"
+#include "PollScheduler.hpp"
+
+namespace ResultCache {
+
+    /**
+     * @brief Llaves (nombres de propiedad) de los objetos que se regresan a JS
+     */
+    enum Key_t{
+        KEY_STATUS_CODE,
+        KEY_MESSAGE,
+        KEY_EVENT,
+        KEY_COIN,
+        KEY_BILL,
+        KEY_REMAINING,
+        KEY_INSERTED_COINS,
+        KEY_VERSION,
+        KEY_DEVICE,
+        KEY_ERROR_TYPE,
+        KEY_ERROR_CODE,
+        KEY_ADITIONAL_INFO,
+        KEY_PRIORITY,
+        KEY_COIN_50,
+        KEY_COIN_100,
+        KEY_COIN_200,
+        KEY_COIN_500,
+        KEY_COIN_1000,
+        KEY_RFIC_CARD_IN_G,
+        KEY_RECYCLING_BOX_F,
+        KEY_CARD_IN_G,
+        KEY_CARDS_IN_D,
+        KEY_DISPENSER_F,
+        KEY_URGENT,
+        KEY_NORMAL,
+        KEY_POLL,
+        KEY_QUEUE_COUNT,
+        KEY_AVG_WAIT_US,
+        KEY_MAX_WAIT_US,
+        KEY_PATH,
+        KEY_SEQUENCE,
+        KEY_TIME,
+        KEY_TYPE,
+        KEY_VALUE,
+        KEY_CHANNEL,
+        KEY_COMMANDS,
+        KEY_RETRIES,
+        KEY_TIMEOUTS,
+        KEY_CRC_ERRORS,
+        KEY_FAILURES,
+        KEY_RESYNCS,
+        KEY_AVG_RECOVERY_US,
+        KEY_MAX_RECOVERY_US,
+        KEY_CLEAN_MS,
+        KEY_IDLE,
+        KEY_ACTIVE_MS,
+        KEY_IDLE_MS,
+        KEY_WAKEUPS,
+        KEY_ACTIVE,
+        KEY_INTERVAL_MS,
+        KEY_FAST_MS,
+        KEY_MAX_MS,
+        KEY_ACTIVE_WINDOW_MS,
+        KEY_POLLS,
+        KEY_FAST_POLLS,
+        KEY_FLAG,
+        KEY_INDEX,
+        KEY_TAKEN,
+        KEY_DISPENSE_MS,
+        KEY_TAKEN_MS,
+        KEY_COUNT
+    };
+
+    /**
+     * @brief Par llave/valor de una propiedad del objeto resultado
+     */
+    struct Field_t{
+        Key_t Key;
+        napi_value Value;
+    };
+
+    /**
+     * @brief Par codigo/mensaje usado para exportar las tablas de mensajes del modo compacto
+     */
+    struct StatusMessage_t{
+        int StatusCode;
+        const char *Message;
+    };
+
+    class ResultCacheClass{
+        public:
+
+            /**
+             * @brief Maximo numero de campos que puede tener un objeto resultado
+             */
+            static const size_t MAXFIELDS = 8;
+
+            /**
+             * @brief Maximo numero de textos fijos que se guardan en cache. Solo se guardan textos fijos (ver String),
+             * el limite es un tope de seguridad por si algun llamador pasa un texto que cambia
+             */
+            static const size_t MAXMESSAGES = 256;
+
+            /**
+             * @brief Construct a new Result Cache Class object. Crea las llaves internadas del entorno
+             * @param env Entorno de N-API
+             */
+            ResultCacheClass(Napi::Env env);
+
+            /**
+             * @brief Obtiene el cache asociado al entorno (AddonDataClass), se crea una sola vez en InitAll
+             * @param env Entorno de N-API
+             * @return ResultCacheClass* Apuntador al cache del entorno
+             */
+            static ResultCacheClass *Get(Napi::Env env);
+
+            /**
+             * @brief Regresa la cadena de JS de un texto fijo (mensajes literales de los drivers, version, nombres de
+             * banderas o dispositivos). Si el texto ya se habia creado se reutiliza. Los textos que llevan contadores
+             * o codigos de error se crean con Text para no llenar el cache
+             * @param env Entorno de N-API
+             * @param Text Texto fijo a convertir
+             * @return napi_value Cadena de JS
+             */
+            napi_value String(Napi::Env env, const std::string &Text);
+
+            /**
+             * @brief Crea la cadena de JS sin pasar por el cache, para textos que cambian entre llamadas
+             */
+            napi_value Text(Napi::Env env, const std::string &Text);
+
+            /**
+             * @brief Regresa la cadena de JS del mensaje de un resultado. Los codigos cuyo mensaje lleva datos que
+             * cambian (contadores, codigos de falla, monedas insertadas) se crean sin cache, el resto usa String
+             * @param env Entorno de N-API
+             * @param StatusCode Codigo del resultado
+             * @param Message Mensaje del resultado
+             * @return napi_value Cadena de JS
+             */
+            napi_value Message(Napi::Env env, int StatusCode, const std::string &Message);
+
+            /**
+             * @brief Crea un numero de JS
+             */
+            napi_value Number(Napi::Env env, double Value);
+
+            /**
+             * @brief Crea un booleano de JS
+             */
+            napi_value Boolean(Napi::Env env, bool Value);
+
+            /**
+             * @brief Construye el objeto resultado definiendo todas sus propiedades en una sola llamada (napi_define_properties)
+             * @param env Entorno de N-API
+             * @param Fields Arreglo de campos del objeto
+             * @param Count Numero de campos, lanza un error de JS si es mayor a MAXFIELDS
+             * @return Napi::Object Objeto resultado
+             */
+            Napi::Object Build(Napi::Env env, const Field_t *Fields, size_t Count);
+
+            /**
+             * @brief Igual que Build con un arreglo de tamaño fijo, revisa en compilacion que no pase de MAXFIELDS
+             */
+            template <size_t N>
+            Napi::Object Build(Napi::Env env, const Field_t (&Fields)[N]){
+                static_assert(N <= MAXFIELDS, "Result object has more fields than MAXFIELDS");
+                return Build(env, Fields, N);
+            }
+
+            /**
+             * @brief Construye el resultado { message, statusCode } usado por la mayoria de los comandos
+             */
+            Napi::Object Response(Napi::Env env, int StatusCode, const std::string &Message);
+
+            /**
+             * @brief Construye el objeto { [statusCode]: message } que se exporta una sola vez para el modo compacto
+             * @param env Entorno de N-API
+             * @param Table Tabla de mensajes
+             * @param Count Numero de elementos de la tabla
+             * @return Napi::Object Objeto con la tabla de mensajes
+             */
+            Napi::Object MessageTable(Napi::Env env, const StatusMessage_t *Table, size_t Count);
+
+            /**
+             * @brief Construye { urgent, normal, poll } con la cantidad de comandos y el tiempo de espera en cola
+             * (promedio y maximo en microsegundos) de cada clase de prioridad
+             * @param env Entorno de N-API
+             * @param Scheduler Planificador de comandos del dispositivo
+             * @return Napi::Object Estadisticas por clase de prioridad
+             */
+            Napi::Object QueueStats(Napi::Env env, CommandScheduler::CommandSchedulerClass &Scheduler);
+
+            /**
+             * @brief Construye { active, intervalMs, fastMs, maxMs, activeWindowMs, polls, fastPolls } con el ritmo de
+             * polling del dispositivo
+             * @param env Entorno de N-API
+             * @param Stats Estado del planificador de polling
+             * @return Napi::Object Ritmo de polling
+             */
+            Napi::Object PollStats(Napi::Env env, const PollScheduler::Stats_t &Stats);
+
+            /**
+             * @brief Construye { count, path } con el resultado de volcar el flight recorder
+             * @param env Entorno de N-API
+             * @param Count Entradas escritas, -1 si no se pudo escribir el archivo
+             * @param Path Ruta del archivo de volcado
+             * @return Napi::Object Resultado del volcado
+             */
+            Napi::Object RecorderDump(Napi::Env env, long Count, const std::string &Path);
+
+            /**
+             * @brief Construye el arreglo [{ sequence, time, device, type, value, channel, statusCode }] con los
+             * eventos leidos del diario
+             * @param env Entorno de N-API
+             * @param Events Eventos del diario
+             * @return Napi::Array Eventos en orden de secuencia
+             */
+            Napi::Array JournalEvents(Napi::Env env, const std::vector<EventJournal::Event_t> &Events);
+
+        private:
+            Napi::Reference<Napi::String> Keys[KEY_COUNT];
+            std::unordered_map<std::string, Napi::Reference<Napi::String>> Messages;
+    };
+
+};
+
+#endif /* RESULTCACHE_HPP */
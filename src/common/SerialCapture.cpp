@@ -0,0 +1,176 @@
+/**
+ * @file SerialCapture.cpp
+ * @brief Captura binaria del trafico serial y lectura de archivos de captura
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include "SerialCapture.hpp"
+
+namespace SerialCapture {
+
+    static const char MAGIC[8] = "OINKCAP";
+
+    struct CaptureFile_t{
+        std::mutex Mutex;                       // Un registro (cabecera + datos) se escribe completo
+        FILE *Stream = nullptr;
+        uint16_t NextInstance[DEVICE_COUNT] = {};
+
+        ~CaptureFile_t(){
+            if (Stream != nullptr){
+                fclose(Stream);
+            }
+        }
+    };
+
+    // Protege el registro de archivos abiertos
+    static std::mutex RegistryMutex;
+
+    // Archivos abiertos por ruta. weak_ptr para que el archivo se cierre con la ultima captura
+    static std::map<std::string, std::weak_ptr<CaptureFile_t>> Files;
+
+    static std::shared_ptr<CaptureFile_t> OpenFile(const std::string &Path){
+        auto File = std::make_shared<CaptureFile_t>();
+        File->Stream = fopen(Path.c_str(), "a+b");
+        if (File->Stream == nullptr){
+            return nullptr;
+        }
+
+        FileHeader_t Header;
+        fseek(File->Stream, 0, SEEK_END);
+        if (ftell(File->Stream) == 0){
+            memcpy(Header.Magic, MAGIC, sizeof(Header.Magic));
+            Header.Version = CAPTUREVERSION;
+            Header.HeaderSize = sizeof(FileHeader_t);
+            fwrite(&Header, sizeof(Header), 1, File->Stream);
+            fflush(File->Stream);
+        }
+        else {
+            // No se agregan registros a un archivo que no es una captura
+            rewind(File->Stream);
+            if ((fread(&Header, sizeof(Header), 1, File->Stream) != 1) || (memcmp(Header.Magic, MAGIC, sizeof(MAGIC)) != 0)){
+                return nullptr;
+            }
+        }
+        return File;
+    }
+
+    SerialCaptureClass::SerialCaptureClass() : Instance(0), File(nullptr), Device(DEVICE_PELICANO) {}
+
+    SerialCaptureClass::~SerialCaptureClass(){
+        Close();
+    }
+
+    int SerialCaptureClass::Open(const std::string &Path, Device_t _Device){
+        Close();
+        std::lock_guard<std::mutex> Lock(RegistryMutex);
+
+        std::shared_ptr<CaptureFile_t> Shared = Files[Path].lock();
+        if (Shared == nullptr){
+            Shared = OpenFile(Path);
+            if (Shared == nullptr){
+                Files.erase(Path);
+                return 1;
+            }
+            Files[Path] = Shared;
+        }
+
+        Device = _Device;
+        {
+            std::lock_guard<std::mutex> FileLock(Shared->Mutex);
+            Instance = Shared->NextInstance[Device]++;
+        }
+        File = Shared;
+        return 0;
+    }
+
+    void SerialCaptureClass::Close(){
+        if (File == nullptr){
+            return;
+        }
+        std::lock_guard<std::mutex> Lock(RegistryMutex);
+        File.reset();
+        for (auto It = Files.begin(); It != Files.end();){
+            It = It->second.expired() ? Files.erase(It) : std::next(It);
+        }
+    }
+
+    void SerialCaptureClass::Record(Direction_t Direction, const unsigned char *Data, long Length){
+        if ((File == nullptr) || (Length <= 0)){
+            return;
+        }
+        RecordHeader_t Header;
+        Header.TimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        Header.Device = static_cast<uint8_t>(Device);
+        Header.Direction = static_cast<uint8_t>(Direction);
+        Header.Instance = Instance;
+
+        std::lock_guard<std::mutex> Lock(File->Mutex);
+        // Los trozos mas grandes que MAXRECORDBYTES se guardan en varios registros con la misma hora
+        for (long Offset = 0; Offset < Length; Offset += MAXRECORDBYTES){
+            Header.Length = static_cast<uint32_t>(((Length - Offset) < MAXRECORDBYTES) ? (Length - Offset) : MAXRECORDBYTES);
+            fwrite(&Header, sizeof(Header), 1, File->Stream);
+            fwrite(Data + Offset, 1, Header.Length, File->Stream);
+        }
+        fflush(File->Stream);
+    }
+
+    int ReadCapture(const std::string &Path, std::vector<Record_t> &Records){
+        Records.clear();
+        FILE *Stream = fopen(Path.c_str(), "rb");
+        if (Stream == nullptr){
+            return 1;
+        }
+
+        FileHeader_t Header;
+        if ((fread(&Header, sizeof(Header), 1, Stream) != 1) || (memcmp(Header.Magic, MAGIC, sizeof(MAGIC)) != 0) || (Header.HeaderSize < sizeof(Header))){
+            fclose(Stream);
+            return 1;
+        }
+        fseek(Stream, 0, SEEK_END);
+        long FileSize = ftell(Stream);
+        fseek(Stream, Header.HeaderSize, SEEK_SET);
+
+        int Res = 0;
+        Record_t Record;
+        size_t Read;
+        while ((Read = fread(&Record.Header, 1, sizeof(Record.Header), Stream)) == sizeof(Record.Header)){
+            // Un Length mayor al maximo no lo escribe Record: el archivo esta dañado y no se puede saber donde empieza
+            // el siguiente registro
+            if (Record.Header.Length > MAXRECORDBYTES){
+                Res = 3;
+                break;
+            }
+            // Datos que no alcanzan a estar en el archivo: ultimo registro cortado
+            if (static_cast<long>(Record.Header.Length) > FileSize - ftell(Stream)){
+                Res = 2;
+                break;
+            }
+            Record.Data.resize(Record.Header.Length);
+            if ((Record.Header.Length > 0) && (fread(&Record.Data[0], 1, Record.Header.Length, Stream) != Record.Header.Length)){
+                Res = 2;
+                break;
+            }
+            Records.push_back(Record);
+        }
+        if ((Res == 0) && (Read != 0)){
+            // Cabecera del ultimo registro incompleta
+            Res = 2;
+        }
+        fclose(Stream);
+        return Res;
+    }
+
+    const char *DeviceName(int Device){
+        static const char *Names[] = { "unknown", "pelicano", "azkoyen", "nv10", "dispenser" };
+        return ((Device > 0) && (Device < DEVICE_COUNT)) ? Names[Device] : Names[0];
+    }
+
+};
@@ -0,0 +1,140 @@
+/**
+ * @file SerialCapture.hpp
+ * @brief Captura binaria del trafico serial de los dispositivos. Cada trozo escrito o leido en ExecuteCommand se
+ * agrega a un archivo con su hora, el tipo de dispositivo y la instancia, para reproducir incidentes de campo y
+ * armar pruebas de rendimiento con trafico real (test/replay-capture.cpp). Los dispositivos con la misma ruta
+ * comparten el archivo
+ *
+ * Formato (enteros en el orden de bytes del equipo, little endian en los equipos actuales):
+ * - Cabecera de archivo (FileHeader_t, una sola vez): "OINKCAP", version, tamaño de la cabecera
+ * - Por cada trozo: RecordHeader_t (16 bytes) seguido de Length bytes de datos
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef SERIALCAPTURE_HPP
+#define SERIALCAPTURE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SerialCapture {
+
+    static const uint32_t CAPTUREVERSION = 1;
+
+    /**
+     * @brief Maximo de bytes de datos de un registro. Los trozos de los drivers son de una lectura del puerto (unos
+     * cientos de bytes); Record parte los trozos mas grandes y ReadCapture toma un Length mayor como archivo dañado
+     */
+    static const uint32_t MAXRECORDBYTES = 4096;
+
+    enum Device_t{
+        DEVICE_PELICANO = 1,
+        DEVICE_AZKOYEN,
+        DEVICE_NV10,
+        DEVICE_DISPENSER,
+        DEVICE_COUNT
+    };
+
+    enum Direction_t{
+        DIRECTION_TX,       // Trozo escrito al puerto
+        DIRECTION_RX,       // Trozo leido del puerto
+    };
+
+    struct FileHeader_t{
+        char Magic[8];              // "OINKCAP\0"
+        uint32_t Version;           // CAPTUREVERSION
+        uint32_t HeaderSize;        // sizeof(FileHeader_t), para poder agregar campos
+    };
+
+    struct RecordHeader_t{
+        uint64_t TimeNs;            // Hora del sistema en nanosegundos desde 1970 (se conserva entre reinicios)
+        uint8_t Device;             // Device_t
+        uint8_t Direction;          // Direction_t
+        uint16_t Instance;          // Numero de instancia del dispositivo dentro del proceso (0, 1, ...)
+        uint32_t Length;            // Bytes de datos que siguen a la cabecera
+    };
+
+    static_assert(sizeof(RecordHeader_t) == 16, "RecordHeader_t debe ocupar 16 bytes");
+
+    struct CaptureFile_t;
+
+    /**
+     * @brief Captura de un dispositivo. Inactiva hasta que se llama Open
+     */
+    class SerialCaptureClass{
+        public:
+
+            SerialCaptureClass();
+            ~SerialCaptureClass();
+
+            /**
+             * @brief Empieza a capturar en un archivo. Si el archivo ya existe se agrega al final; si otro dispositivo
+             * del proceso ya lo tiene abierto se comparte
+             * @param Path Ruta del archivo de captura
+             * @param Device Tipo de dispositivo que se guarda en cada registro
+             * @return int 0 si se pudo abrir, 1 si no se pudo abrir o el archivo no es una captura
+             */
+            int Open(const std::string &Path, Device_t Device);
+
+            /**
+             * @brief Deja de capturar. El archivo se cierra cuando ningun dispositivo lo usa
+             */
+            void Close();
+
+            /**
+             * @brief Agrega un trozo al archivo (escribe y hace flush, para no perderlo si el proceso se cae). No hace
+             * nada si la captura no esta activa o Length es menor o igual a 0
+             * @param Direction DIRECTION_TX o DIRECTION_RX
+             * @param Data Bytes del trozo
+             * @param Length Numero de bytes
+             */
+            void Record(Direction_t Direction, const unsigned char *Data, long Length);
+
+            /**
+             * @brief Indica si la captura esta activa
+             */
+            bool IsOpen() const { return File != nullptr; }
+
+            /**
+             * @brief Instancia asignada al abrir (se guarda en cada registro)
+             */
+            uint16_t Instance;
+
+        private:
+            std::shared_ptr<CaptureFile_t> File;
+            Device_t Device;
+    };
+
+    /**
+     * @brief Registro leido de un archivo de captura
+     */
+    struct Record_t{
+        RecordHeader_t Header;
+        std::vector<unsigned char> Data;
+    };
+
+    /**
+     * @brief Lee todos los registros de un archivo de captura
+     * @param Path Ruta del archivo
+     * @param Records Registros en el orden en que se escribieron
+     * @return int 0 si se leyo completo, 1 si no se pudo abrir o la cabecera no es valida, 2 si el ultimo registro
+     * esta cortado (el proceso se cayo escribiendo), 3 si un registro tiene un Length mayor a MAXRECORDBYTES (archivo
+     * dañado, se deja de leer ahi). En 2 y 3 los registros completos anteriores quedan en Records
+     */
+    int ReadCapture(const std::string &Path, std::vector<Record_t> &Records);
+
+    /**
+     * @brief Nombre del tipo de dispositivo ("pelicano", "azkoyen", "nv10", "dispenser")
+     */
+    const char *DeviceName(int Device);
+
+};
+
+#endif /* SERIALCAPTURE_HPP */
@@ -0,0 +1,127 @@
+/**
+ * @file StateFile.cpp
+ * @brief Archivo de estado mapeado en memoria con dos copias
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <cstring>
+#include <fcntl.h> // Contains file controls like O_RDWR
+#include <sys/mman.h> // mmap, msync
+#include <sys/stat.h> // fstat
+#include <unistd.h> // ftruncate, close
+#include "Crc32.hpp"
+#include "StateFile.hpp"
+
+namespace StateFile {
+
+    static const char MAGIC[8] = "OINKSTA";
+
+    // Bytes de la cabecera que cubre el CRC (todo menos el propio CRC)
+    static const size_t CRCBYTES = offsetof(SlotHeader_t, Crc);
+
+    StateFileClass::StateFileClass() : Fd(-1), Map(nullptr), MapSize(0), Size(0), SlotSize(0), Current(-1), Generation(0) {}
+
+    StateFileClass::~StateFileClass(){
+        Close();
+    }
+
+    int StateFileClass::Open(const std::string &Path, size_t _Size){
+        Close();
+
+        Size = _Size;
+        SlotSize = sizeof(SlotHeader_t) + ((Size + 7) & ~static_cast<size_t>(7));
+        MapSize = 2 * SlotSize;
+
+        Fd = open(Path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (Fd < 0){
+            return -1;
+        }
+
+        // Si el tamaño de los datos cambio entre versiones ninguna copia sera valida y se empieza de cero
+        struct stat Stat;
+        if ((fstat(Fd, &Stat) != 0) || ((static_cast<size_t>(Stat.st_size) != MapSize) && (ftruncate(Fd, MapSize) != 0))){
+            Close();
+            return -1;
+        }
+
+        void *NewMap = mmap(nullptr, MapSize, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+        if (NewMap == MAP_FAILED){
+            Close();
+            return -1;
+        }
+        Map = static_cast<unsigned char *>(NewMap);
+
+        for (int Slot = 0; Slot < 2; Slot++){
+            const SlotHeader_t *Header = reinterpret_cast<const SlotHeader_t *>(Map + Slot * SlotSize);
+            if (SlotValid(Slot) && ((Current < 0) || (Header->Generation > Generation))){
+                Current = Slot;
+                Generation = Header->Generation;
+            }
+        }
+        return (Current >= 0) ? 0 : 1;
+    }
+
+    void StateFileClass::Close(){
+        if (Map != nullptr){
+            munmap(Map, MapSize);
+            Map = nullptr;
+        }
+        if (Fd >= 0){
+            close(Fd);
+            Fd = -1;
+        }
+        Current = -1;
+        Generation = 0;
+    }
+
+    bool StateFileClass::SlotValid(int Slot) const {
+        const SlotHeader_t *Header = reinterpret_cast<const SlotHeader_t *>(Map + Slot * SlotSize);
+        if ((memcmp(Header->Magic, MAGIC, sizeof(MAGIC)) != 0) || (Header->Version != STATEVERSION) || (Header->Size != Size)){
+            return false;
+        }
+        uint32_t Crc = Crc32::Compute(Header, CRCBYTES);
+        Crc = Crc32::Compute(Map + Slot * SlotSize + sizeof(SlotHeader_t), Size, Crc);
+        return Header->Crc == Crc;
+    }
+
+    bool StateFileClass::Load(void *Data) const {
+        if ((Map == nullptr) || (Current < 0)){
+            return false;
+        }
+        memcpy(Data, Map + Current * SlotSize + sizeof(SlotHeader_t), Size);
+        return true;
+    }
+
+    int StateFileClass::Save(const void *Data){
+        if (Map == nullptr){
+            return 1;
+        }
+        int Slot = (Current == 0) ? 1 : 0;
+        unsigned char *Base = Map + Slot * SlotSize;
+
+        SlotHeader_t Header;
+        memset(&Header, 0, sizeof(Header));
+        memcpy(Header.Magic, MAGIC, sizeof(Header.Magic));
+        Header.Version = STATEVERSION;
+        Header.Size = static_cast<uint32_t>(Size);
+        Header.Generation = Generation + 1;
+        Header.Crc = Crc32::Compute(&Header, CRCBYTES);
+        Header.Crc = Crc32::Compute(Data, Size, Header.Crc);
+
+        memcpy(Base + sizeof(SlotHeader_t), Data, Size);
+        memcpy(Base, &Header, sizeof(Header));
+
+        // El archivo ocupa pocas paginas, se sincroniza completo
+        if (msync(Map, MapSize, MS_SYNC) != 0){
+            return 1;
+        }
+        Current = Slot;
+        Generation = Header.Generation;
+        return 0;
+    }
+
+};
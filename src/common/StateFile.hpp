@@ -0,0 +1,94 @@
+/**
+ * @file StateFile.hpp
+ * @brief Archivo pequeño mapeado en memoria donde un dispositivo guarda su estado (contadores, cursor de eventos,
+ * mascaras) para retomar el trabajo despues de reiniciar el proceso sin reiniciar el equipo
+ *
+ * Formato: dos copias (slots) del estado, cada una con cabecera (SlotHeader_t) y los datos. Cada guardado escribe
+ * la copia mas vieja con la siguiente generacion y el CRC; al abrir se usa la copia valida con la generacion mas
+ * alta, asi una escritura cortada por una caida deja intacta la copia anterior
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef STATEFILE_HPP
+#define STATEFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace StateFile {
+
+    static const uint32_t STATEVERSION = 1;
+
+    struct SlotHeader_t{
+        char Magic[8];              // "OINKSTA\0"
+        uint32_t Version;           // STATEVERSION
+        uint32_t Size;              // Bytes de datos que siguen a la cabecera
+        uint64_t Generation;        // Aumenta en cada guardado, gana la copia valida mas alta
+        uint32_t Crc;               // CRC32 de los campos anteriores y de los datos
+        uint32_t Reserved;
+    };
+
+    static_assert(sizeof(SlotHeader_t) == 32, "SlotHeader_t debe ocupar 32 bytes");
+
+    class StateFileClass{
+        public:
+
+            StateFileClass();
+            ~StateFileClass();
+
+            /**
+             * @brief Abre (o crea) el archivo de estado y lo mapea en memoria
+             * @param Path Ruta del archivo
+             * @param Size Tamaño de los datos del dispositivo
+             * @return int 0 si hay un estado guardado valido, 1 si el archivo es nuevo o ninguna copia es valida
+             * (por ejemplo si cambio el tamaño de los datos), -1 si no se pudo abrir/mapear
+             */
+            int Open(const std::string &Path, size_t Size);
+
+            /**
+             * @brief Desmapea y cierra el archivo
+             */
+            void Close();
+
+            /**
+             * @brief Copia el ultimo estado valido
+             * @param Data Destino de los datos (Size bytes)
+             * @return bool true si habia un estado valido
+             */
+            bool Load(void *Data) const;
+
+            /**
+             * @brief Guarda el estado en la copia mas vieja y espera a que llegue al disco (msync)
+             * @param Data Datos del dispositivo (Size bytes)
+             * @return int 0 si se guardo, 1 si el archivo no esta abierto o no se pudo sincronizar
+             */
+            int Save(const void *Data);
+
+            /**
+             * @brief Indica si el archivo esta abierto
+             */
+            bool IsOpen() const { return Map != nullptr; }
+
+        private:
+            int Fd;
+            unsigned char *Map;
+            size_t MapSize;
+            size_t Size;                // Tamaño de los datos
+            size_t SlotSize;            // Cabecera + datos alineados a 8 bytes
+            int Current;                // Copia con el ultimo estado valido, -1 si no hay
+            uint64_t Generation;
+
+            /**
+             * @brief Revisa magic, version, tamaño y CRC de una copia
+             */
+            bool SlotValid(int Slot) const;
+    };
+
+};
+
+#endif /* STATEFILE_HPP */
@@ -0,0 +1,225 @@
+/**
+ * @file StateMachine.hpp
+ * @brief Plantilla de maquina de estados compartida por todos los dispositivos. Cada instancia guarda el
+ * apuntador a su propio validador, las tablas de estados y transiciones del dispositivo, los hooks de
+ * entrada/salida de cada estado y un buffer circular con las ultimas transiciones. Si se asigna un flight recorder
+ * cada transicion tambien se guarda ahi
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef STATEMACHINE_HPP_COMMON
+#define STATEMACHINE_HPP_COMMON
+
+#include <cstddef>
+#include <cstdint>
+#include "StateTable.hpp"
+#include "FlightRecorder.hpp"
+
+namespace StateMachineBase {
+
+    /**
+     * @brief Maquina de estados generica
+     * @tparam Driver Clase del validador que implementa las funciones de cada estado
+     * @tparam State_t Enum de estados, debe terminar en ST_COUNT
+     * @tparam Event_t Enum de eventos, debe terminar en EV_COUNT
+     */
+    template <typename Driver, typename State_t, typename Event_t>
+    class StateMachine{
+        public:
+
+            static const size_t NSTATES = State_t::ST_COUNT;
+            static const size_t NEVENTS = Event_t::EV_COUNT;
+
+            /**
+             * @brief Numero de transiciones que se guardan en el buffer de trazas
+             */
+            static const size_t TRACESIZE = 32;
+
+            typedef int (Driver::*StateFunction_t)(void);
+            typedef void (Driver::*Hook_t)(void);
+            typedef StateTable::TransitionTable_t<NSTATES, NEVENTS> Table_t;
+
+            /**
+             * @brief Fila de la tabla de estados: nombre y funcion del validador que corre el estado
+             */
+            struct StateRow_t{
+                const char * name;
+                StateFunction_t func;
+            };
+
+            struct StateMachine_t{
+                State_t CurrState;
+            };
+
+            /**
+             * @brief Transicion guardada en el buffer de trazas
+             */
+            struct Trace_t{
+                uint32_t Sequence;      // Numero de transicion desde que se creo la maquina de estados
+                State_t From;
+                Event_t Event;
+                State_t To;
+                int Response;           // Respuesta de la funcion del estado destino
+            };
+
+            /**
+             * @brief Construct a new State Machine object
+             * @param _Object Apuntador al validador que controla esta maquina de estados
+             * @param _States Tabla de estados (una fila por estado, en el orden del enum)
+             * @param _Table Tabla densa de transiciones del dispositivo
+             * @param _NoTransition Valor que regresa StateMachineRun cuando el evento no tiene transicion
+             */
+            StateMachine(Driver *_Object, const StateRow_t *_States, const Table_t *_Table, int _NoTransition)
+                : Object(_Object), States(_States), Table(_Table), NoTransition(_NoTransition), Recorder(nullptr), TraceHead(0), TraceCount(0), TraceSequence(0) {
+                SM.CurrState = static_cast<State_t>(0);
+                LS.CurrState = static_cast<State_t>(0);
+                for (size_t i = 0; i < NSTATES; i++){
+                    EntryHooks[i] = nullptr;
+                    ExitHooks[i] = nullptr;
+                }
+            }
+
+            /**
+             * @brief Estado actual de la maquina de estados
+             */
+            StateMachine_t SM;
+
+            /**
+             * @brief Estado ultimo de la maquina de estados
+             */
+            StateMachine_t LS;
+
+            /**
+             * @brief Inicia la maquina de estados en el primer estado del enum y corre su funcion asociada
+             */
+            void InitStateMachine() {
+                SM.CurrState = static_cast<State_t>(0);
+                RunEntry(SM.CurrState);
+                (Object->*(States[SM.CurrState].func))();
+            }
+
+            /**
+             * @brief Corre la maquina de estados dependiendo del evento ingresado y del estado que tenga actualmente.
+             * Al cambiar de estado corre el hook de salida del estado anterior y el de entrada del nuevo
+             * @param Event Evento que ingresa para hacer el cambio de estado
+             * @return int Respuesta de la funcion del nuevo estado, o NoTransition si el evento no tiene transicion
+             */
+            int StateMachineRun(Event_t Event) {
+                State_t NextState;
+                if (!StateTable::Lookup(*Table, SM.CurrState, Event, NextState)) {
+                    return NoTransition;
+                }
+                State_t PrevState = SM.CurrState;
+                if (NextState != PrevState) {
+                    RunExit(PrevState);
+                    SM.CurrState = NextState;
+                    RunEntry(NextState);
+                }
+                int Response = (Object->*(States[SM.CurrState].func))();
+                Record(PrevState, Event, NextState, Response);
+                return Response;
+            }
+
+            /**
+             * @brief Corre la funcion de un estado sin cambiar de estado (se restaura el estado actual al terminar).
+             * No corre hooks ni se guarda en las trazas
+             * @param State Estado a correr
+             * @return int Respuesta de la funcion del estado
+             */
+            int RunState(State_t State) {
+                LS.CurrState = SM.CurrState;
+                SM.CurrState = State;
+                int Response = (Object->*(States[SM.CurrState].func))();
+                SM.CurrState = LS.CurrState;
+                return Response;
+            }
+
+            /**
+             * @brief Funcion para conocer el nombre de un estado
+             * @param State Se introduce un enum del estado
+             * @return const char* Regresa una cadena de caracteres con el nombre del estado
+             */
+            const char * StateMachineGetStateName(State_t State) const {
+                return States[State].name;
+            }
+
+            /**
+             * @brief Asigna el hook que se corre al entrar a un estado (nullptr para quitarlo)
+             */
+            void SetEntryHook(State_t State, Hook_t Hook) {
+                EntryHooks[State] = Hook;
+            }
+
+            /**
+             * @brief Asigna el hook que se corre al salir de un estado (nullptr para quitarlo)
+             */
+            void SetExitHook(State_t State, Hook_t Hook) {
+                ExitHooks[State] = Hook;
+            }
+
+            /**
+             * @brief Asigna el flight recorder donde se guardan las transiciones (nullptr para quitarlo)
+             */
+            void SetRecorder(FlightRecorder::FlightRecorderClass *_Recorder) {
+                Recorder = _Recorder;
+            }
+
+            /**
+             * @brief Copia las ultimas transiciones, de la mas antigua a la mas reciente
+             * @param Out Arreglo destino
+             * @param Max Tamaño del arreglo destino
+             * @return size_t Numero de transiciones copiadas
+             */
+            size_t GetTrace(Trace_t *Out, size_t Max) const {
+                size_t Count = (TraceCount < Max) ? TraceCount : Max;
+                size_t Start = (TraceHead + TRACESIZE - Count) % TRACESIZE;
+                for (size_t i = 0; i < Count; i++){
+                    Out[i] = Trace[(Start + i) % TRACESIZE];
+                }
+                return Count;
+            }
+
+        private:
+            Driver *Object;
+            const StateRow_t *States;
+            const Table_t *Table;
+            int NoTransition;
+            FlightRecorder::FlightRecorderClass *Recorder;
+            Hook_t EntryHooks[NSTATES];
+            Hook_t ExitHooks[NSTATES];
+            Trace_t Trace[TRACESIZE];
+            size_t TraceHead;
+            size_t TraceCount;
+            uint32_t TraceSequence;
+
+            void RunEntry(State_t State) {
+                if (EntryHooks[State] != nullptr){
+                    (Object->*EntryHooks[State])();
+                }
+            }
+
+            void RunExit(State_t State) {
+                if (ExitHooks[State] != nullptr){
+                    (Object->*ExitHooks[State])();
+                }
+            }
+
+            void Record(State_t From, Event_t Event, State_t To, int Response) {
+                Trace[TraceHead] = { TraceSequence++, From, Event, To, Response };
+                TraceHead = (TraceHead + 1) % TRACESIZE;
+                if (TraceCount < TRACESIZE){
+                    TraceCount++;
+                }
+                if (Recorder != nullptr){
+                    Recorder->RecordTransition(States[From].name, Event, States[To].name, Response);
+                }
+            }
+    };
+
+};
+
+#endif /* STATEMACHINE_HPP_COMMON */
@@ -0,0 +1,111 @@
+/**
+ * @file StateTable.hpp
+ * @brief Tabla de transiciones densa [estado][evento] compartida por las maquinas de estados de los dispositivos.
+ * La tabla se construye en tiempo de compilacion a partir de las filas { estado, evento, siguiente estado }, de
+ * modo que cada despacho es un solo acceso indexado en lugar de recorrer todas las filas
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef STATETABLE_HPP
+#define STATETABLE_HPP
+
+#include <cstddef>
+
+namespace StateTable {
+
+    /**
+     * @brief Valor de la tabla cuando no existe transicion para el par estado/evento
+     */
+    static constexpr signed char NO_TRANSITION = -1;
+
+    /**
+     * @brief Fila de la tabla de transiciones, igual a la que usaban las maquinas de estados
+     */
+    template <typename State_t, typename Event_t>
+    struct TransitionRow_t{
+        State_t CurrState;
+        Event_t Event;
+        State_t NextState;
+    };
+
+    /**
+     * @brief Tabla densa de transiciones. Next[estado][evento] guarda el siguiente estado o NO_TRANSITION
+     */
+    template <size_t NSTATES, size_t NEVENTS>
+    struct TransitionTable_t{
+        signed char Next[NSTATES][NEVENTS];
+    };
+
+    /**
+     * @brief Construye la tabla densa a partir de las filas de transicion. Si un par estado/evento aparece mas de
+     * una vez se conserva la primera fila, igual que la busqueda lineal anterior
+     * @param Rows Filas de transicion
+     * @return TransitionTable_t Tabla densa [estado][evento]
+     */
+    template <size_t NSTATES, size_t NEVENTS, typename State_t, typename Event_t, size_t NROWS>
+    constexpr TransitionTable_t<NSTATES, NEVENTS> BuildTable(const TransitionRow_t<State_t, Event_t> (&Rows)[NROWS]){
+        TransitionTable_t<NSTATES, NEVENTS> Table{};
+        for (size_t s = 0; s < NSTATES; s++){
+            for (size_t e = 0; e < NEVENTS; e++){
+                Table.Next[s][e] = NO_TRANSITION;
+            }
+        }
+        for (size_t i = 0; i < NROWS; i++){
+            if (Table.Next[Rows[i].CurrState][Rows[i].Event] == NO_TRANSITION){
+                Table.Next[Rows[i].CurrState][Rows[i].Event] = static_cast<signed char>(Rows[i].NextState);
+            }
+        }
+        return Table;
+    }
+
+    /**
+     * @brief Revisa en tiempo de compilacion que las filas sean validas: estados y eventos dentro de rango y sin
+     * pares estado/evento repetidos (una fila repetida nunca se ejecutaria)
+     * @param Rows Filas de transicion
+     * @return true Si todas las filas son validas
+     */
+    template <size_t NSTATES, size_t NEVENTS, typename State_t, typename Event_t, size_t NROWS>
+    constexpr bool IsValid(const TransitionRow_t<State_t, Event_t> (&Rows)[NROWS]){
+        for (size_t i = 0; i < NROWS; i++){
+            if ((static_cast<size_t>(Rows[i].CurrState) >= NSTATES) || (static_cast<size_t>(Rows[i].NextState) >= NSTATES) || (static_cast<size_t>(Rows[i].Event) >= NEVENTS)){
+                return false;
+            }
+            for (size_t j = 0; j < i; j++){
+                if ((Rows[j].CurrState == Rows[i].CurrState) && (Rows[j].Event == Rows[i].Event)){
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Busca el siguiente estado en la tabla
+     * @param Table Tabla densa de transiciones
+     * @param CurrState Estado actual
+     * @param Event Evento que ingresa
+     * @param NextState Siguiente estado si existe la transicion
+     * @return true Si existe la transicion
+     * @return false Si el par estado/evento no tiene transicion
+     */
+    template <size_t NSTATES, size_t NEVENTS, typename State_t, typename Event_t>
+    inline bool Lookup(const TransitionTable_t<NSTATES, NEVENTS> &Table, State_t CurrState, Event_t Event, State_t &NextState){
+        // Con los limites revisados aqui el compilador sabe que States[NextState] y los hooks quedan dentro del arreglo
+        if ((static_cast<size_t>(CurrState) >= NSTATES) || (static_cast<size_t>(Event) >= NEVENTS)){
+            return false;
+        }
+        signed char Next = Table.Next[CurrState][Event];
+        if ((Next == NO_TRANSITION) || (static_cast<size_t>(Next) >= NSTATES)){
+            return false;
+        }
+        NextState = static_cast<State_t>(Next);
+        return true;
+    }
+
+};
+
+#endif /* STATETABLE_HPP */
@@ -10,40 +10,12 @@
  */
 
 #include "Dispenser.hpp"
+#include "../common/CodeTable.hpp"
 
 namespace Dispenser{
 
-    // --------------- EXTERNAL VARIABLES --------------------//
-    
-    //READ ONLY
-
-    int SerialPort;
-    bool SuccessConnect;
-    bool Initialized;
-    int PortO;
-
-    bool CardsInDispenser;
-    bool CardInGate;
-    bool RFICCardInGate;
-    bool DispenserFull;
-    bool RecyclingBoxFull;
-
-    std::string ErrorOCode;
-    std::string ErrorOMsg;
-    int ErrorOPriority;
-
-    //WRITE ONLY
-
-    int LoggerLevel;
-    std::string LogFilePath;
-    int MaxPorts;
-    int MaxInitAttempts;
-    int ShortTime;
-    int LongTime;
-
     // --------------- INTERNAL VARIABLES --------------------//
 
-    bool Scanning;
 
     std::vector<unsigned char> MSGINIT          = {0xF2, 0x00, 0x00, 0x03, 0x43, 0x30, 0x33, 0x03, 0xB2};
     std::vector<unsigned char> MSGDISPENSECARD  = {0xF2, 0x00, 0x00, 0x03, 0x43, 0x32, 0x30, 0x03, 0xB3};
@@ -52,95 +24,90 @@ namespace Dispenser{
     std::vector<unsigned char> ACK              = {0x06};
 
 
-    std::string DEFAULTERROR = "Error por defecto";
+    const std::string DEFAULTERROR = "Error por defecto";
     
-    ErrorCodesRow_t ErrO;
-    StatusCodesRow_t GateState;
-    StatusCodesRow_t BoxState;
-    StatusCodesRow_t RecyclingBoxState;
     
-    std::shared_ptr<spdlog::logger> logger;
 
     // --------------- STRUCTS --------------------//
 
-    static ErrorCodesRow_t ErrorCodesDispenser[] = {
-        //CODE//MSG               //FOUND
-        { "00","Undefined command",1},
-        { "01","Errors in command parameters",1},
-        { "02","Error in the command execution order",1},
-        { "03","Hardware does not support commands",1},
-        { "04","Command data error (error in communication packets DATA)",1},
-        { "05","IC card is contacted but not released",1},
-        { "06","IC card is contacted but not released",1},
-        { "07","IC card is contacted but not released",1},
-        { "08","IC card is contacted but not released",1},
-        { "09","IC card is contacted but not released",1},
-        { "10","Clogged card",1},
-        { "11","Code not found, may be code is Clogged card",1},
-        { "12","Sensor error",1},
-        { "13","Long card error",1},
-        { "14","Short card error",1},
-        { "40","The card has been pulled away when recycling card",1},
-        { "41","IC card electromagnet error",1},
-        { "42","IC card electromagnet error",1},
-        { "43","Card cannot be moved from IC card slot",1},
-        { "44","Card cannot be moved from IC card slot",1},
-        { "45","Cards are artificially moved",1},
-        { "46","Cards are artificially moved",1},
-        { "47","Cards are artificially moved",1},
-        { "48","Cards are artificially moved",1},
-        { "49","Cards are artificially moved",1},
-        { "50","Recycled cards‟ counter overflows",1},
-        { "51","Motor error",1},
-        { "52","Motor error",1},
-        { "53","Motor error",1},
-        { "54","Motor error",1},
-        { "55","Motor error",1},
-        { "56","Motor error",1},
-        { "57","Motor error",1},
-        { "58","Motor error",1},
-        { "59","Motor error",1},
-        { "60","IC card power supply is short-circuited",1},
-        { "61","IC card activation failed",1},
-        { "62","IC card does not support the current command",1},
-        { "63","IC card does not support the current command",1},
-        { "64","IC card does not support the current command",1},
-        { "65","IC card is not activated",1},
-        { "66","The current IC card does not support the command",1},
-        { "67","Transmission IC card data error",1},
-        { "68","Transmission IC card data timeout",1},
-        { "69","CPU / SAM card does not comply with EMV standard",1},
-        { "A0","Card dispensing stack (box) is empty, there is no card in card stack",1},
-        { "A1","Card collection box is full",2},
-        { "A2","Card collection box is full",2},
-        { "A3","Card collection box is full",2},
-        { "A4","Card collection box is full",2},
-        { "A5","Card collection box is full",2},
-        { "A6","Card collection box is full",2},
-        { "A7","Card collection box is full",2},
-        { "A8","Card collection box is full",2},
-        { "A9","Card collection box is full",2},
-        { "B0","Card dispenser is not reset",3},
+    static constexpr ErrorCodesRow_t ErrorCodesDispenser[] = {
+        //CODE//MSG               //PRIORITY
+        { 0x00,"Undefined command",1},
+        { 0x01,"Errors in command parameters",1},
+        { 0x02,"Error in the command execution order",1},
+        { 0x03,"Hardware does not support commands",1},
+        { 0x04,"Command data error (error in communication packets DATA)",1},
+        { 0x05,"IC card is contacted but not released",1},
+        { 0x06,"IC card is contacted but not released",1},
+        { 0x07,"IC card is contacted but not released",1},
+        { 0x08,"IC card is contacted but not released",1},
+        { 0x09,"IC card is contacted but not released",1},
+        { 0x10,"Clogged card",1},
+        { 0x11,"Code not found, may be code is Clogged card",1},
+        { 0x12,"Sensor error",1},
+        { 0x13,"Long card error",1},
+        { 0x14,"Short card error",1},
+        { 0x40,"The card has been pulled away when recycling card",1},
+        { 0x41,"IC card electromagnet error",1},
+        { 0x42,"IC card electromagnet error",1},
+        { 0x43,"Card cannot be moved from IC card slot",1},
+        { 0x44,"Card cannot be moved from IC card slot",1},
+        { 0x45,"Cards are artificially moved",1},
+        { 0x46,"Cards are artificially moved",1},
+        { 0x47,"Cards are artificially moved",1},
+        { 0x48,"Cards are artificially moved",1},
+        { 0x49,"Cards are artificially moved",1},
+        { 0x50,"Recycled cards‟ counter overflows",1},
+        { 0x51,"Motor error",1},
+        { 0x52,"Motor error",1},
+        { 0x53,"Motor error",1},
+        { 0x54,"Motor error",1},
+        { 0x55,"Motor error",1},
+        { 0x56,"Motor error",1},
+        { 0x57,"Motor error",1},
+        { 0x58,"Motor error",1},
+        { 0x59,"Motor error",1},
+        { 0x60,"IC card power supply is short-circuited",1},
+        { 0x61,"IC card activation failed",1},
+        { 0x62,"IC card does not support the current command",1},
+        { 0x63,"IC card does not support the current command",1},
+        { 0x64,"IC card does not support the current command",1},
+        { 0x65,"IC card is not activated",1},
+        { 0x66,"The current IC card does not support the command",1},
+        { 0x67,"Transmission IC card data error",1},
+        { 0x68,"Transmission IC card data timeout",1},
+        { 0x69,"CPU / SAM card does not comply with EMV standard",1},
+        { 0xA0,"Card dispensing stack (box) is empty, there is no card in card stack",1},
+        { 0xA1,"Card collection box is full",2},
+        { 0xA2,"Card collection box is full",2},
+        { 0xA3,"Card collection box is full",2},
+        { 0xA4,"Card collection box is full",2},
+        { 0xA5,"Card collection box is full",2},
+        { 0xA6,"Card collection box is full",2},
+        { 0xA7,"Card collection box is full",2},
+        { 0xA8,"Card collection box is full",2},
+        { 0xA9,"Card collection box is full",2},
+        { 0xB0,"Card dispenser is not reset",3},
     };
 
-    static StatusCodesRow_t Status0CodesDispenser[] = {
-        { "0","There is no card in gate",0},
-        { "1","There is a card at exit slot of card dispenser channel",0},
-        { "2","There is a card at RF / IC card slot of card dispenser channel",1},
+    static constexpr StatusCodesRow_t Status0CodesDispenser[] = {
+        { '0',"There is no card in gate",0},
+        { '1',"There is a card at exit slot of card dispenser channel",0},
+        { '2',"There is a card at RF / IC card slot of card dispenser channel",1},
     };
     
-    static StatusCodesRow_t Status1CodesDispenser[] = {
-        { "0","There are no cards in dispenser",1},
-        { "1","There are few cards in card dispensing box",0},
-        { "2","There are enough cards in card dispensing box",0},
+    static constexpr StatusCodesRow_t Status1CodesDispenser[] = {
+        { '0',"There are no cards in dispenser",1},
+        { '1',"There are few cards in card dispensing box",0},
+        { '2',"There are enough cards in card dispensing box",0},
     };
     
-    static StatusCodesRow_t Status2CodesDispenser[] = {
-        { "0","Recycling box is not full of cards",0},
-        { "1","Recycling bin is full of cards",1},
+    static constexpr StatusCodesRow_t Status2CodesDispenser[] = {
+        { '0',"Recycling box is not full of cards",0},
+        { '1',"Recycling bin is full of cards",1},
     };
     
-    static ErrorCodeExComm_t ErrorCodesExComm[] = {
+    static constexpr ErrorCodeExComm_t ErrorCodesExComm[] = {
         {-6,"Function ExComm was not executed",2},
         {-5,"Writing successful but cannot read",1},
         {-4,"Writing length different, writing error",1},
@@ -155,7 +122,7 @@ namespace Dispenser{
         { 5,"Device does not return ACK",1},
     };
 
-    static SpdlogLevels_t SpdlogLvl[] = {
+    static constexpr SpdlogLevels_t SpdlogLvl[] = {
         {0,"trace"},
         {1,"debug"},
         {2,"info"},
@@ -165,9 +132,32 @@ namespace Dispenser{
         {6,"off"},
     };
     
+    // Tablas de acceso directo por codigo, construidas en compilacion a partir de las tablas anteriores
+
+    static constexpr StatusCodesRow_t StatusTableDefault = {0,"Code not found!!!",1,false};
+    static_assert(CodeTable::IsValid<StatusCodesRow_t, &StatusCodesRow_t::Status>(Status0CodesDispenser), "Codigo fuera de la tabla Status0CodesDispenser");
+    static_assert(CodeTable::IsValid<StatusCodesRow_t, &StatusCodesRow_t::Status>(Status1CodesDispenser), "Codigo fuera de la tabla Status1CodesDispenser");
+    static_assert(CodeTable::IsValid<StatusCodesRow_t, &StatusCodesRow_t::Status>(Status2CodesDispenser), "Codigo fuera de la tabla Status2CodesDispenser");
+    static constexpr CodeTable::DenseTable_t<StatusCodesRow_t> Status0Table = CodeTable::BuildTable<StatusCodesRow_t, &StatusCodesRow_t::Status>(Status0CodesDispenser, StatusTableDefault);
+    static constexpr CodeTable::DenseTable_t<StatusCodesRow_t> Status1Table = CodeTable::BuildTable<StatusCodesRow_t, &StatusCodesRow_t::Status>(Status1CodesDispenser, StatusTableDefault);
+    static constexpr CodeTable::DenseTable_t<StatusCodesRow_t> Status2Table = CodeTable::BuildTable<StatusCodesRow_t, &StatusCodesRow_t::Status>(Status2CodesDispenser, StatusTableDefault);
+
+    static constexpr ErrorCodesRow_t ErrorTableDefault = {0,"ErrorCode not found!!!",1,false};
+    static_assert(CodeTable::IsValid<ErrorCodesRow_t, &ErrorCodesRow_t::ErrorCode>(ErrorCodesDispenser), "Codigo fuera de la tabla ErrorCodesDispenser");
+    static constexpr CodeTable::DenseTable_t<ErrorCodesRow_t> ErrorTable = CodeTable::BuildTable<ErrorCodesRow_t, &ErrorCodesRow_t::ErrorCode>(ErrorCodesDispenser, ErrorTableDefault);
+    static constexpr SpdlogLevels_t SpdlogTableDefault = {0,"SpdlogLvl not found!!!"};
+    static_assert(CodeTable::IsValid<SpdlogLevels_t, &SpdlogLevels_t::Code>(SpdlogLvl), "Codigo fuera de la tabla SpdlogLvl");
+    static constexpr CodeTable::DenseTable_t<SpdlogLevels_t> SpdlogTable = CodeTable::BuildTable<SpdlogLevels_t, &SpdlogLevels_t::Code>(SpdlogLvl, SpdlogTableDefault);
+
+    static constexpr ErrorCodeExComm_t ExCommTableDefault = {0,"ErrorCode not found!!!",1};
+    static_assert(CodeTable::IsValid<ErrorCodeExComm_t, &ErrorCodeExComm_t::Code>(ErrorCodesExComm, -128), "Codigo fuera de la tabla ErrorCodesExComm");
+    static constexpr CodeTable::DenseTable_t<ErrorCodeExComm_t> ExCommTable = CodeTable::BuildTable<ErrorCodeExComm_t, &ErrorCodeExComm_t::Code>(ErrorCodesExComm, ExCommTableDefault, -128);
+
     // --------------- CONSTRUCTOR FUNCTIONS --------------------//
 
     DispenserClass::DispenserClass(){
+        Scanning = false;
+        ErrorOPriority = 0;
         
         SerialPort = 0;
         SuccessConnect = false;
@@ -185,169 +175,106 @@ namespace Dispenser{
         ErrorOPriority = 0;
     }
 
-    DispenserClass::~DispenserClass(){}
+    DispenserClass::~DispenserClass(){
+        // Cerrar el puerto libera el flock, otra instancia puede tomarlo
+        if (SerialPort > 0){
+            close(SerialPort);
+            SerialPort = -1;
+        }
+        Logging::DropLogger(logger);
+    }
 
     // --------------- LOGGER FUNCTIONS --------------------//
 
-    SpdlogLevels_t DispenserClass::SearchSpdlogLevel(int Code){
-        SpdlogLevels_t SPLvl;
-        SPLvl.Message = "SpdlogLvl not found!!!"; 
-
-        for (long unsigned int i = 0; i < sizeof(SpdlogLvl)/sizeof(SpdlogLvl[0]); i++) {
-            if (SpdlogLvl[i].Code == Code) {
-                SPLvl.Message = SpdlogLvl[i].Message;
-                break;
-            }
-        }
-        
-        SPLvl.Code = Code;
-        return SPLvl;
+    SpdlogLevels_t DispenserClass::SearchSpdlogLevel (int Code){
+        return CodeTable::Lookup<SpdlogLevels_t, &SpdlogLevels_t::Code>(SpdlogTable, Code, SpdlogTableDefault);
     }
 
     void DispenserClass::SetSpdlogLevel(){
-        spdlog::set_level(static_cast<spdlog::level::level_enum>(LoggerLevel)); // Set global log level
+        logger->set_level(static_cast<spdlog::level::level_enum>(LoggerLevel)); // Set instance log level
     }
 
     // --------------- SEARCH FUNCTIONS --------------------//
 
-    StatusCodesRow_t DispenserClass::SearchSuccessCode0 (std::string SCode){
-        
-        StatusCodesRow_t SucC;
-        
-        SucC.Message = "Code not found!!!";
-        SucC.Priority = 1;
+    StatusCodesRow_t DispenserClass::SearchSuccessCode0 (int SCode){
 
-        for (long unsigned int i = 0; i < sizeof(Status0CodesDispenser)/sizeof(Status0CodesDispenser[0]); i++) {
-            if (Status0CodesDispenser[i].Status == SCode) {
-                SucC.Message = Status0CodesDispenser[i].Message;
-                SucC.Priority = Status0CodesDispenser[i].Priority;
+        StatusCodesRow_t SucC = CodeTable::Lookup<StatusCodesRow_t, &StatusCodesRow_t::Status>(Status0Table, SCode, StatusTableDefault);
 
-                if (SCode == "0"){
-                    CardInGate = false;
-                    RFICCardInGate = false;
-                }
-                else if (SCode == "1"){
-                    RFICCardInGate = false;
-                    CardInGate = true;
-                }
-                else if (SCode == "2"){
-                    CardInGate = false;
-                    RFICCardInGate = true;
-                }
-                
-                break;
-            }
+        if (SCode == '0'){
+            CardInGate = false;
+            RFICCardInGate = false;
+        }
+        else if (SCode == '1'){
+            RFICCardInGate = false;
+            CardInGate = true;
+        }
+        else if (SCode == '2'){
+            CardInGate = false;
+            RFICCardInGate = true;
         }
-        
-        SucC.Status = SCode;
 
         return SucC;
-
     }
 
-    StatusCodesRow_t DispenserClass::SearchSuccessCode1 (std::string SCode){
-        
-        StatusCodesRow_t SucC;
-        
-        SucC.Message = "Code not found!!!";
-        SucC.Priority = 1;
+    StatusCodesRow_t DispenserClass::SearchSuccessCode1 (int SCode){
 
-        for (long unsigned int i = 0; i < sizeof(Status1CodesDispenser)/sizeof(Status1CodesDispenser[0]); i++) {
-            if (Status1CodesDispenser[i].Status == SCode) {
-                SucC.Message = Status1CodesDispenser[i].Message;
-                SucC.Priority = Status1CodesDispenser[i].Priority;
+        StatusCodesRow_t SucC = CodeTable::Lookup<StatusCodesRow_t, &StatusCodesRow_t::Status>(Status1Table, SCode, StatusTableDefault);
 
-                if (SCode == "0"){
-                    CardsInDispenser = false;
-                    DispenserFull = false;
-                }
-                else if (SCode == "1"){
-                    DispenserFull = false;
-                    CardsInDispenser = true;
-                }
-                else if (SCode == "2"){
-                    CardsInDispenser = true;
-                    DispenserFull = true;
-                }    
-                
-                break;
-            }
+        if (SCode == '0'){
+            CardsInDispenser = false;
+            DispenserFull = false;
+        }
+        else if (SCode == '1'){
+            DispenserFull = false;
+            CardsInDispenser = true;
+        }
+        else if (SCode == '2'){
+            CardsInDispenser = true;
+            DispenserFull = true;
         }
-        
-        SucC.Status = SCode;
 
         return SucC;
-
     }
 
-    StatusCodesRow_t DispenserClass::SearchSuccessCode2 (std::string SCode){
-        
-        StatusCodesRow_t SucC;
-        
-        SucC.Message = "Code not found!!!";
-        SucC.Priority = 1;
+    StatusCodesRow_t DispenserClass::SearchSuccessCode2 (int SCode){
 
-        for (long unsigned int i = 0; i < sizeof(Status2CodesDispenser)/sizeof(Status2CodesDispenser[0]); i++) {
-            if (Status2CodesDispenser[i].Status == SCode) {
-                SucC.Message = Status2CodesDispenser[i].Message;
-                SucC.Priority = Status2CodesDispenser[i].Priority;
+        StatusCodesRow_t SucC = CodeTable::Lookup<StatusCodesRow_t, &StatusCodesRow_t::Status>(Status2Table, SCode, StatusTableDefault);
 
-                if (SCode == "0"){
-                    RecyclingBoxFull = false;
-                }
-                else if (SCode == "1"){
-                    RecyclingBoxFull = true;
-                }
-                
-                break;
-            }
+        if (SCode == '0'){
+            RecyclingBoxFull = false;
+        }
+        else if (SCode == '1'){
+            RecyclingBoxFull = true;
         }
-        
-        SucC.Status = SCode;
 
         return SucC;
-
     }
-    
-    ErrorCodesRow_t DispenserClass::SearchErrorCode (std::string ErrorC){
-        
-        ErrorCodesRow_t Error;
-        
-        Error.Message = "ErrorCode not found!!!";
-        Error.Priority = 1;
-        
-        for (long unsigned int i = 0; i < sizeof(ErrorCodesDispenser)/sizeof(ErrorCodesDispenser[0]); i++) {
-            if (ErrorCodesDispenser[i].ErrorCode == ErrorC) {
-                Error.Message = ErrorCodesDispenser[i].Message;
-                Error.Priority = ErrorCodesDispenser[i].Priority;
-                break;
-            }
-        }
-        
-        Error.ErrorCode = ErrorC;
 
-        return Error;
+    ErrorCodesRow_t DispenserClass::SearchErrorCode (int ErrorC){
+        return CodeTable::Lookup<ErrorCodesRow_t, &ErrorCodesRow_t::ErrorCode>(ErrorTable, ErrorC, ErrorTableDefault);
     }
 
-    ErrorCodeExComm_t DispenserClass::SearchErrorCodeExComm (int Code){
-        
-        ErrorCodeExComm_t CodeMsg;
-        
-        CodeMsg.Message = "ErrorCode not found!!!";
-        CodeMsg.Priority = 1;
-
-        for (long unsigned int i = 0; i < sizeof(ErrorCodesExComm)/sizeof(ErrorCodesExComm[0]); i++) {
-            if (ErrorCodesExComm[i].Code == Code) {
-                CodeMsg.Message = ErrorCodesExComm[i].Message;
-                CodeMsg.Priority = ErrorCodesExComm[i].Priority;
-                break;
+    int DispenserClass::ErrorKey(unsigned char High, unsigned char Low){
+        auto Nibble = [](unsigned char Char) -> int {
+            if ((Char >= '0') && (Char <= '9')){
+                return Char - '0';
+            }
+            if ((Char >= 'A') && (Char <= 'F')){
+                return Char - 'A' + 10;
             }
+            return -1;
+        };
+        int H = Nibble(High);
+        int L = Nibble(Low);
+        if ((H < 0) || (L < 0)){
+            return -1;
         }
-        
-        CodeMsg.Code = Code;
+        return (H << 4) | L;
+    }
 
-        return CodeMsg;
-    }    
+    ErrorCodeExComm_t DispenserClass::SearchErrorCodeExComm (int Code){
+        return CodeTable::Lookup<ErrorCodeExComm_t, &ErrorCodeExComm_t::Code>(ExCommTable, Code, ExCommTableDefault);
+    }
 
     // --------------- STATES OF MACHINE STATE (FUNCTIONS) --------------------//
     
@@ -359,8 +286,8 @@ namespace Dispenser{
         
         logger->critical("[E0:STIDLE] Setting spdlog level in {}",SpdlogLvl.Message);
 
-        logger->trace("   [E0:STIDLE] --------------------------------------------------------------------------");
-        logger->debug("   [E0:STIDLE] --------------------------------------------------------------------------");
+        SPDLOG_LOGGER_TRACE(logger,"   [E0:STIDLE] --------------------------------------------------------------------------");
+        SPDLOG_LOGGER_DEBUG(logger,"   [E0:STIDLE] --------------------------------------------------------------------------");
         logger->info("    [E0:STIDLE] --------------------------------------------------------------------------");
         logger->warn(" [E0:STIDLE] --------------------------------------------------------------------------");
         logger->error("   [E0:STIDLE] --------------------------------------------------------------------------");
@@ -376,11 +303,11 @@ namespace Dispenser{
         PortO = ScanPorts();
 
         if (PortO >= 0){
-            logger->debug("[E1:STCONNECT] Port was found in /dev/ttyUSB{0:d}",PortO);
+            SPDLOG_LOGGER_DEBUG(logger,"[E1:STCONNECT] Port was found in /dev/ttyUSB{0:d}",PortO);
             return 0;
         }
         else {
-            logger->debug("[E1:STCONNECT] Port was NOT found ......");
+            SPDLOG_LOGGER_DEBUG(logger,"[E1:STCONNECT] Port was NOT found ......");
             return 1;
         }
     }
@@ -390,11 +317,11 @@ namespace Dispenser{
         int Response = -1;
 
         if (Initialized){
-            logger->debug("[E2:STINIT] Dispenser was initialized");
+            SPDLOG_LOGGER_DEBUG(logger,"[E2:STINIT] Dispenser was initialized");
             Response = 0;
         }
         else {
-            logger->debug("[E2:STINIT] Running InitDispenser");
+            SPDLOG_LOGGER_DEBUG(logger,"[E2:STINIT] Running InitDispenser");
             Response = InitDispenser();
         }
         return Response;
@@ -404,7 +331,7 @@ namespace Dispenser{
 
         int Response = -1;
 
-         logger->debug("[E3:STWAIT] Running CheckStatus");
+         SPDLOG_LOGGER_DEBUG(logger,"[E3:STWAIT] Running CheckStatus");
 
         Response = CheckStatus();
 
@@ -427,13 +354,13 @@ namespace Dispenser{
         
         if ( CardsInDispenser | DispenserFull ){
 
-            logger->debug("[E4:STMOVINGMOTOR] Running DispenseCard");
+            SPDLOG_LOGGER_DEBUG(logger,"[E4:STMOVINGMOTOR] Running DispenseCard");
 
             ResponseDisp = DispenseCard();
 
             if (ResponseDisp == 0){
                 if (CardInGate){
-                    logger->debug("[E4:STMOVINGMOTOR] Card is in gate");
+                    SPDLOG_LOGGER_DEBUG(logger,"[E4:STMOVINGMOTOR] Card is in gate");
                     Response = 0;
                 }
                 else if (RFICCardInGate){
@@ -450,7 +377,7 @@ namespace Dispenser{
                 Response = 2;
             }
             else {
-                logger->debug("[E5:STHANDINGCARD] Running CheckStatus");
+                SPDLOG_LOGGER_DEBUG(logger,"[E5:STHANDINGCARD] Running CheckStatus");
 
                 ResponseCheck = CheckStatus();
 
@@ -478,25 +405,25 @@ namespace Dispenser{
 
         if (CardInGate){
 
-            logger->debug("[E5:STHANDINGCARD] Running ReturnCardToBox");
+            SPDLOG_LOGGER_DEBUG(logger,"[E5:STHANDINGCARD] Running ReturnCardToBox");
 
             Response = ReturnCardToBox();
 
             if (Response == 0){
-                logger->debug("[E5:STHANDINGCARD] Card is in recycling box");
+                SPDLOG_LOGGER_DEBUG(logger,"[E5:STHANDINGCARD] Card is in recycling box");
                 Res = 0;
             }
             else if (Response == 2){
-                logger->debug("[E5:STHANDINGCARD] There was an error running ReturnCardToBox, check ErrorCode");
+                SPDLOG_LOGGER_DEBUG(logger,"[E5:STHANDINGCARD] There was an error running ReturnCardToBox, check ErrorCode");
                 Res = 2;
             }
             else {
-                logger->debug("[E5:STHANDINGCARD] Running CheckStatus");
+                SPDLOG_LOGGER_DEBUG(logger,"[E5:STHANDINGCARD] Running CheckStatus");
 
                 Response = CheckStatus();
 
                 if ((CardInGate == false) & (Response == 0) & (RFICCardInGate == false)){
-                    logger->debug("[E5:STHANDINGCARD] Problem solved!");
+                    SPDLOG_LOGGER_DEBUG(logger,"[E5:STHANDINGCARD] Problem solved!");
                     Res = 0;
                 }
                 else {
@@ -510,7 +437,7 @@ namespace Dispenser{
             Res = 2;
         }
         else {
-            logger->debug("[E5:STHANDINGCARD] There is not a card in gate");
+            SPDLOG_LOGGER_DEBUG(logger,"[E5:STHANDINGCARD] There is not a card in gate");
             Res = 3;
         }
 
@@ -524,7 +451,7 @@ namespace Dispenser{
         logger->error("[EE:STERROR] In error state :(");
         logger->error("[EE:STERROR] Checking last status.....");
 
-        logger->debug("[EE:STERROR] Running CheckStatus");
+        SPDLOG_LOGGER_DEBUG(logger,"[EE:STERROR] Running CheckStatus");
 
         Response = CheckStatus();
 
@@ -542,8 +469,35 @@ namespace Dispenser{
 
     // Función para inicializar el logger
     void DispenserClass::InitLogger(const std::string& Path) {
-        // Crear el daily_logger y asignarlo a la variable logger
-        logger = spdlog::daily_logger_mt("ValidatorDispenser", Path, 23, 59);
+        // Crear el logger asincrono (archivo diario) de esta instancia y asignarlo a la variable logger
+        // Si ya existia (InitLog despues de reconectar) se da de baja primero para no dejarlo registrado
+        Logging::DropLogger(logger);
+        logger = Logging::CreateLogger("ValidatorDispenser", Path);
+        Recorder.Path = Path + ".flight";
+    }
+
+    long DispenserClass::DumpRecorder(const char *Reason){
+        long Entries = Recorder.Dump(Reason);
+        if (Entries >= 0){
+            logger->warn("[DumpRecorder] {0}: {1} entries written to {2}",Reason,Entries,Recorder.Path);
+        }
+        else {
+            logger->error("[DumpRecorder] {0}: could not write {1}",Reason,Recorder.Path);
+        }
+        return Entries;
+    }
+
+    void DispenserClass::DumpRecorderOnError(){
+        DumpRecorder("ST_ERROR");
+    }
+
+    int DispenserClass::StartCapture(const std::string& Path){
+        if (Capture.Open(Path, SerialCapture::DEVICE_DISPENSER) != 0){
+            logger->error("[StartCapture] Could not open capture file {0}",Path);
+            return 1;
+        }
+        logger->info("[StartCapture] Capturing serial traffic to {0} (instance {1})",Path,Capture.Instance);
+        return 0;
     }
     
     //Connects to port /dev/ttyUSB% where % is the port number (Port)
@@ -554,11 +508,19 @@ namespace Dispenser{
             return 1;
         }
         else {
-            logger->debug("[ConnectSerial] Connecting to /dev/ttyUSB{0:d} port",Port);
+            SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] Connecting to /dev/ttyUSB{0:d} port",Port);
             char DeviceName [50];
             sprintf (DeviceName,"/dev/ttyUSB%d",Port);
             SerialPort = open(DeviceName, O_RDWR | O_NOCTTY );
 
+            // Bloqueo exclusivo del puerto para que otra instancia (o proceso) no lo tome mientras se usa
+            if ((SerialPort > 0) && (flock(SerialPort, LOCK_EX | LOCK_NB) != 0)){
+                SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] /dev/ttyUSB{0:d} is already in use",Port);
+                close(SerialPort);
+                SerialPort = -1;
+                return 5;
+            }
+
             if (SerialPort > 0){
 
                 struct termios Tty;
@@ -568,6 +530,8 @@ namespace Dispenser{
                 if (tcgetattr(SerialPort, &Tty) != 0) {
                     logger->error("[ConnectSerial] Error reading actual settings in this port. Error: {0:d}, from tcgetattr: {1}",errno,strerror(errno));
                     SuccessConnect = false;
+                    close(SerialPort);
+                    SerialPort = -1;
                     return 2;
                 }
 
@@ -600,15 +564,17 @@ namespace Dispenser{
                 if (tcsetattr(SerialPort, TCSANOW, &Tty) != 0) {
                     logger->error("[ConnectSerial] Error writing new settings in this port. Error: {0:d}, from tcgetattr: {1}",errno,strerror(errno));
                     SuccessConnect = false;
+                    close(SerialPort);
+                    SerialPort = -1;
                     return 3;
                 }
 
-                logger->debug("[ConnectSerial] Successfully connected to /dev/ttyUSB{0:d}",Port);
+                SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] Successfully connected to /dev/ttyUSB{0:d}",Port);
                 SuccessConnect = true;
                 return 0;
             }
             else {
-                logger->debug("[ConnectSerial] Could no connect to /dev/ttyUSB{0:d}",Port);
+                SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] Could no connect to /dev/ttyUSB{0:d}",Port);
                 return 4;
             }
         }
@@ -619,23 +585,29 @@ namespace Dispenser{
         int Port = -1;
         int Response = -1;
 
+        // Al reconectar se cierra el puerto que ya se tenia, tambien libera el flock y el puerto se puede volver a tomar
+        if (SerialPort > 0){
+            close(SerialPort);
+            SerialPort = -1;
+        }
+
         for (int i = 1; i < MaxPorts ; i++)
         {   
-            logger->debug("[ScanPorts] Trying connection to /dev/ttyUSB{0:d}",i-1);
+            SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Trying connection to /dev/ttyUSB{0:d}",i-1);
             Response = ConnectSerial(i-1);
 
             if (Response == 0){   
 
-                logger->debug("[ScanPorts] Connection successfull");
+                SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Connection successfull");
                 Response = -1;
                 Scanning = true;
-                logger->debug("[ScanPorts] Sending Init Command");
+                SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Sending Init Command");
 
                 Response = InitDispenser();
                 
                 if (Response == 0){
                     Port = i-1;
-                    logger->debug("[ScanPorts] Dispenser found in port /dev/ttyUSB{0:d}",Port);
+                    SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Dispenser found in port /dev/ttyUSB{0:d}",Port);
                     i=MaxPorts;
                     Scanning = false;
                     return Port;
@@ -645,7 +617,8 @@ namespace Dispenser{
                 }
 
                 logger->info("[ScanPorts] Clossing connection in /dev/ttyUSB{0:d}",i-1);
-                close(SerialPort);            
+                close(SerialPort);
+                SerialPort = -1;
             }
         }
         Scanning = false;
@@ -662,23 +635,24 @@ namespace Dispenser{
 
         ErrorCodeExComm_t Err;
         Err = SearchErrorCodeExComm(Response);
+        Recorder.RecordResult(Err.Code, Err.Message.data());
 
-        logger->debug("[SendingCommand] Execute command returns: {0:d} with message: {1}",Err.Code,Err.Message);
+        SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Execute command returns: {0:d} with message: {1}",Err.Code,Err.Message);
 
         if (Err.Priority == 0){
-            logger->trace("[SendingCommand] Everything is OK");
+            SPDLOG_LOGGER_TRACE(logger,"[SendingCommand] Everything is OK");
             Res = 0;
         }
         else if (Err.Priority == 1){
-            logger->debug("[SendingCommand] Error with comand");
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Error with comand");
             Res = -1;
         }
         else if (Err.Priority == 2){
-            logger->debug("[SendingCommand] Repeat command");
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Repeat command");
             Res = 1;
         }
         else {
-            logger->debug("[SendingCommand] Fail response detected");
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Fail response detected");
             Res = 2;
         }
 
@@ -698,10 +672,13 @@ namespace Dispenser{
         int LongTime = 0;
 
         int PrevRdlen = 0;
+        int Ready = 0;
 
         int Xlen = Comm.size();
 
-        logger->trace("[ExecuteCommand] Writting command");
+        SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Writting command: {0:n}",Logging::Hex(Comm,Xlen));
+        Recorder.RecordFrame(FlightRecorder::ENTRY_TX, &Comm[0], Xlen);
+        Capture.Record(SerialCapture::DIRECTION_TX, &Comm[0], Xlen);
         Wrlen = write(SerialPort, &Comm[0], Xlen);
 
         if (Wrlen!=Xlen){
@@ -709,30 +686,39 @@ namespace Dispenser{
             Res = -4;
         }
         else {
-            logger->debug("[ExecuteCommand] Length expected is the same: {0:d}",Wrlen);
+            SPDLOG_LOGGER_DEBUG(logger,"[ExecuteCommand] Length expected is the same: {0:d}",Wrlen);
             
             std::vector<unsigned char> Response(100);
             std::vector<unsigned char> Buffer(100);
             std::vector<unsigned char> BufferAditional(100);
 
-            usleep(300000);
-
+            // El tiempo fijo (300 ms + AdTime) pasa a ser el maximo: la tarjeta llega a la puerta o el estado se
+            // lee en cuanto el dispensador responde
             if (AdTime > 10){
                 ShortTime = AdTime;
-                usleep(ShortTime);
+                Ready = WaitReply(REPLYWAITUS + ShortTime, Buffer);
             }
             else {
                 LongTime = AdTime;
-                sleep(LongTime);
+                Ready = WaitReply(REPLYWAITUS + LongTime * 1000000L, Buffer);
             }
 
-            logger->debug("[ExecuteCommand] Reading response");
+            SPDLOG_LOGGER_DEBUG(logger,"[ExecuteCommand] Reading response");
 
             for (int counter = 0; counter < MaxInitAttempts ; counter++){
                 
-                Rdlen = read(SerialPort, &Buffer[0], Buffer.size());
+                // La primera lectura es la que ya hizo WaitReply
+                if ((counter == 0) & (Ready > 0)){
+                    Rdlen = Ready;
+                }
+                else {
+                    Rdlen = read(SerialPort, &Buffer[0], Buffer.size());
+                }
+                Recorder.RecordFrame(FlightRecorder::ENTRY_RX, &Buffer[0], Rdlen);
+                Capture.Record(SerialCapture::DIRECTION_RX, &Buffer[0], Rdlen);
 
-                logger->debug("[ExecuteCommand] Reading length: {0:d}",Rdlen);
+                SPDLOG_LOGGER_DEBUG(logger,"[ExecuteCommand] Reading length: {0:d}",Rdlen);
+                SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Data read: {0:n}",Logging::Hex(Buffer,Rdlen));
 
                 if ( ((Rdlen >= 10) & (PrevRdlen == 0)) | (PrevRdlen >= 10) ){
                     
@@ -744,9 +730,7 @@ namespace Dispenser{
                         //std::copy(BufferAditional.begin(), BufferAditional.end(), Response.begin());
                         Response = BufferAditional;
 
-                        for (int i = 0; i < PrevRdlen ; i++){
-                            logger->warn("[ExecuteCommand] Data BufferAditional: {0}",Response[i]);
-                        }
+                        logger->warn("[ExecuteCommand] Data BufferAditional: {0:n}",Logging::Hex(Response,PrevRdlen));
                     }
 
                     if (Response[0] == 6){
@@ -754,7 +738,7 @@ namespace Dispenser{
                         Cm = Comm[5];
                         Pm = Comm[6];
 
-                        logger->debug("[ExecuteCommand] Reading length greater than 10 with ACK, handling response... ");
+                        SPDLOG_LOGGER_DEBUG(logger,"[ExecuteCommand] Reading length greater than 10 with ACK, handling response... ");
 
                         Res = HandleResponse(Response,Cm,Pm);
 
@@ -769,9 +753,7 @@ namespace Dispenser{
                     }
                     else {
 
-                        for (int i = 0; i < Rdlen ; i++){
-                            logger->error("[ExecuteCommand] Data: {0}",Response[i]);
-                        }
+                        logger->error("[ExecuteCommand] Data: {0:n}",Logging::Hex(Response,Rdlen));
 
                         logger->error("[ExecuteCommand] Message is not complete!");
                         Res = 5;
@@ -797,9 +779,7 @@ namespace Dispenser{
                     std::copy(Buffer.begin(), Buffer.begin() + Rdlen, BufferAditional.begin() + PrevRdlen);
                     PrevRdlen = PrevRdlen + Rdlen;
 
-                    for (int i = 0; i < Rdlen ; i++){
-                        logger->error("[ExecuteCommand] Data: {0}",Buffer[i]);
-                    }
+                    logger->error("[ExecuteCommand] Data: {0:n}",Logging::Hex(Buffer,Rdlen));
 
                     logger->error("[ExecuteCommand] Message is not complete!");
                     Res = 3;
@@ -827,7 +807,53 @@ namespace Dispenser{
         return Res;
     }
 
-    int DispenserClass::HandleResponse(std::vector<unsigned char> Response, int Cm, int Pm){
+    int DispenserClass::WaitReply(long TimeoutUs, std::vector<unsigned char> &Buffer){
+        std::chrono::steady_clock::time_point Deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(TimeoutUs);
+        std::chrono::steady_clock::time_point LastByte = std::chrono::steady_clock::now();
+        int Length = 0;
+
+        while (std::chrono::steady_clock::now() < Deadline){
+            usleep(REPLYPOLLUS);
+            int Available = 0;
+            if (ioctl(SerialPort, FIONREAD, &Available) != 0){
+                // Sin FIONREAD se espera el tiempo completo, como antes
+                std::chrono::steady_clock::duration Left = Deadline - std::chrono::steady_clock::now();
+                if (Left > std::chrono::steady_clock::duration::zero()){
+                    usleep(std::chrono::duration_cast<std::chrono::microseconds>(Left).count());
+                }
+                return Length;
+            }
+
+            int Space = static_cast<int>(Buffer.size()) - Length;
+            if ((Available > 0) & (Space > 0)){
+                int Rdlen = read(SerialPort, &Buffer[Length], (Available < Space) ? Available : Space);
+                if (Rdlen < 0){
+                    return Length;
+                }
+                Length += Rdlen;
+                LastByte = std::chrono::steady_clock::now();
+            }
+            if (Length == 0){
+                continue;
+            }
+
+            // NAK y EOT son de un byte, despues del ACK el largo de los datos dice cuantos bytes faltan
+            if ((Buffer[0] == 21) | (Buffer[0] == 4) | (Length == static_cast<int>(Buffer.size()))){
+                return Length;
+            }
+            if (Buffer[0] == 6){
+                if ((Length >= REPLYHEADERBYTES) && (Length >= REPLYHEADERBYTES + Buffer[4] + REPLYTRAILERBYTES)){
+                    return Length;
+                }
+            }
+            else if (std::chrono::steady_clock::now() - LastByte >= std::chrono::microseconds(REPLYQUIETUS)){
+                return Length;
+            }
+        }
+        return Length;
+    }
+
+    int DispenserClass::HandleResponse(const std::vector<unsigned char> &Response, int Cm, int Pm){
 
         int Res = -6;
         int Ack = -6;
@@ -842,7 +868,7 @@ namespace Dispenser{
         }
 
         if ((DataStart == 242) & (CodeError == 80)){
-            logger->debug("[HandleResponse] DataStart correct and dispenser returns success code");
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponse] DataStart correct and dispenser returns success code");
             if (FlagSameCmd){
                 Res = HandleResponseSuccess(Response);
                 if (Res == 0){
@@ -890,7 +916,9 @@ namespace Dispenser{
         
         std::vector<unsigned char> Comm = ACK;
         
-        logger->trace("[WriteAck] Writting ACK");
+        SPDLOG_LOGGER_TRACE(logger,"[WriteAck] Writting ACK");
+        Recorder.RecordFrame(FlightRecorder::ENTRY_TX, &Comm[0], 1);
+        Capture.Record(SerialCapture::DIRECTION_TX, &Comm[0], 1);
         Wrlen = write(SerialPort, &Comm[0], 1);
 
         if (Wrlen != 1){
@@ -904,25 +932,20 @@ namespace Dispenser{
         return Res;
     }
 
-    int DispenserClass::HandleResponseSuccess(std::vector<unsigned char> Response){
+    int DispenserClass::HandleResponseSuccess(const std::vector<unsigned char> &Response){
 
         int Res = -6;
-        std::string DefaultMessage = "Code not found!!!";
 
-        std::string Status0 = std::string(1, static_cast<char>(Response[8]));
-        std::string Status1 = std::string(1, static_cast<char>(Response[9]));
-        std::string Status2 = std::string(1, static_cast<char>(Response[10]));
+        StatusCodesRow_t St0 = SearchSuccessCode0(Response[8]);
+        StatusCodesRow_t St1 = SearchSuccessCode1(Response[9]);
+        StatusCodesRow_t St2 = SearchSuccessCode2(Response[10]);
 
-        StatusCodesRow_t St0 = SearchSuccessCode0(Status0);
-        StatusCodesRow_t St1 = SearchSuccessCode1(Status1);
-        StatusCodesRow_t St2 = SearchSuccessCode2(Status2);
+        SPDLOG_LOGGER_TRACE(logger,"[HandleResponseSuccess] Status code 0: {0:c} Message: {1}",St0.Status,St0.Message);
+        SPDLOG_LOGGER_TRACE(logger,"[HandleResponseSuccess] Status code 1: {0:c} Message: {1}",St1.Status,St1.Message);
+        SPDLOG_LOGGER_TRACE(logger,"[HandleResponseSuccess] Status code 2: {0:c} Message: {1}",St2.Status,St2.Message);
 
-        logger->trace("[HandleResponseSuccess] Status code 0: {0} Message: {1}",St0.Status,St0.Message);
-        logger->trace("[HandleResponseSuccess] Status code 1: {0} Message: {1}",St1.Status,St1.Message);
-        logger->trace("[HandleResponseSuccess] Status code 2: {0} Message: {1}",St2.Status,St2.Message);
-
-        if ((St0.Message != DefaultMessage) & (St1.Message != DefaultMessage) & (St2.Message != DefaultMessage)){
-            logger->trace("[HandleResponseSuccess] Print the next flags (1-true / 0-false) -> CardInGate {0:b} DispenserFull: {1:b} RecyclingBoxFull: {2:b}",CardInGate,DispenserFull,RecyclingBoxFull);
+        if (St0.Found & St1.Found & St2.Found){
+            SPDLOG_LOGGER_TRACE(logger,"[HandleResponseSuccess] Print the next flags (1-true / 0-false) -> CardInGate {0:b} DispenserFull: {1:b} RecyclingBoxFull: {2:b}",CardInGate,DispenserFull,RecyclingBoxFull);
             Res = 0;
         }
         else {
@@ -933,25 +956,19 @@ namespace Dispenser{
         return Res;
     } 
     
-    int DispenserClass::HandleResponseError(std::vector<unsigned char> Response){
+    int DispenserClass::HandleResponseError(const std::vector<unsigned char> &Response){
         
         int Res = -6;
-        std::string DefaultMessage = "ErrorCode not found!!!";
-        
-        std::string ErrorCode1 = std::string(1, static_cast<char>(Response[8]));
-        std::string ErrorCode0 = std::string(1, static_cast<char>(Response[9]));
-
-        std::string ErrorCode = ErrorCode1 + ErrorCode0;
 
-        ErrO = SearchErrorCode(ErrorCode);
+        ErrO = SearchErrorCode(ErrorKey(Response[8], Response[9]));
 
-        ErrorOCode = ErrO.ErrorCode;
+        ErrorOCode.assign(reinterpret_cast<const char*>(&Response[8]), 2);
         ErrorOMsg = ErrO.Message;
         ErrorOPriority = ErrO.Priority;
 
-        logger->trace("[HandleResponseError] Code: {0} Message: {1}",ErrO.ErrorCode,ErrO.Message);
+        SPDLOG_LOGGER_TRACE(logger,"[HandleResponseError] Code: {0} Message: {1}",ErrorOCode,ErrO.Message);
 
-        if (ErrO.Message != DefaultMessage){
+        if (ErrO.Found){
             Res = 1;
         }
         else {
@@ -1067,11 +1084,11 @@ namespace Dispenser{
     }
     
     void DispenserClass::PrintCheck(){
-        logger->trace("[PrintCheck] Print the next 5 flags (1-true / 0-false)");
-        logger->trace("[PrintCheck] Card in gate: {0:b}",CardInGate);
-        logger->trace("[PrintCheck] RF/IC Card in gate: {0:b}",RFICCardInGate);
-        logger->trace("[PrintCheck] Cards in dispenser: {0:b}",CardsInDispenser);
-        logger->trace("[PrintCheck] Dispenser full: {0:b}",DispenserFull);
-        logger->trace("[PrintCheck] Recycling box full: {0:b}",RecyclingBoxFull);
+        SPDLOG_LOGGER_TRACE(logger,"[PrintCheck] Print the next 5 flags (1-true / 0-false)");
+        SPDLOG_LOGGER_TRACE(logger,"[PrintCheck] Card in gate: {0:b}",CardInGate);
+        SPDLOG_LOGGER_TRACE(logger,"[PrintCheck] RF/IC Card in gate: {0:b}",RFICCardInGate);
+        SPDLOG_LOGGER_TRACE(logger,"[PrintCheck] Cards in dispenser: {0:b}",CardsInDispenser);
+        SPDLOG_LOGGER_TRACE(logger,"[PrintCheck] Dispenser full: {0:b}",DispenserFull);
+        SPDLOG_LOGGER_TRACE(logger,"[PrintCheck] Recycling box full: {0:b}",RecyclingBoxFull);
     }
 }
\ No newline at end of file
@@ -19,36 +19,67 @@
 #include <termios.h> // Contains POSIX terminal control definitions
 #include <unistd.h> // write(), read(), close()
 #include <sys/ioctl.h> //To use flush
+#include <sys/file.h> //To use flock
+#include <atomic>
+#include <chrono>
 #include <vector>
+#include <string_view>
 
 #include "spdlog/spdlog.h" //Logging library
-#include "spdlog/sinks/daily_file_sink.h" //Logging library - daily file
+#include "../common/Logging.hpp" //Logging library - async logger and hex dump
+#include "../common/FlightRecorder.hpp"
+#include "../common/SerialCapture.hpp"
 
 #include <string>   //To include string definitions
 
 namespace Dispenser{
+
+    /**
+     * @brief Tiempo fijo que se esperaba antes de leer cada respuesta. Ahora es solo parte del tiempo maximo de espera
+     */
+    static const int REPLYWAITUS = 300000;
+
+    /**
+     * @brief Cada cuanto se revisan los bytes recibidos mientras se espera la respuesta
+     */
+    static const int REPLYPOLLUS = 5000;
+
+    /**
+     * @brief Bytes antes de los datos (ACK, STX 0xF2, direccion de 2 bytes, largo) y despues (ETX, BCC). Con el largo
+     * se sabe cuando llego la trama completa
+     */
+    static const int REPLYHEADERBYTES = 5;
+    static const int REPLYTRAILERBYTES = 2;
+
+    /**
+     * @brief Si la respuesta no empieza con ACK/NAK/EOT no se conoce su largo: se da por completa cuando pasa este
+     * tiempo sin bytes nuevos. Mucho mayor que el latency timer de los adaptadores USB-serial (16 ms en FTDI)
+     */
+    static const int REPLYQUIETUS = 50000;
     
     struct StatusCodesRow_t{
-        std::string Status;
-        std::string Message;
+        int Status;                 // Byte ASCII de estado ('0' / '1' / '2')
+        std::string_view Message;
         int Priority;
+        bool Found = true;          // false en la fila por defecto (codigo no encontrado)
     };
 
     struct ErrorCodesRow_t{
-        std::string ErrorCode;
-        std::string Message;
+        int ErrorCode;              // Codigo de dos caracteres leido como byte hexadecimal ("A1" -> 0xA1)
+        std::string_view Message;
         int Priority;
+        bool Found = true;          // false en la fila por defecto (codigo no encontrado)
     };
 
     struct ErrorCodeExComm_t{
         int Code;
-        std::string Message;
+        std::string_view Message;
         int Priority;
     };
 
     struct SpdlogLevels_t{
         int Code;
-        std::string Message;
+        std::string_view Message;
     };
 
     class DispenserClass{
@@ -144,6 +175,53 @@ namespace Dispenser{
              */
             int LongTime;
 
+            // --------------- INTERNAL VARIABLES --------------------//
+
+            /**
+             * @brief Prioridad del ultimo error del dispensador
+             */
+            int ErrorOPriority;
+
+            /**
+             * @brief Bandera que indica si se estan escaneando los puertos (ScanPorts)
+             */
+            bool Scanning;
+
+            /**
+             * @brief Ultimo error reportado por el dispensador
+             */
+            ErrorCodesRow_t ErrO;
+
+            /**
+             * @brief Estado de la compuerta del dispensador
+             */
+            StatusCodesRow_t GateState;
+
+            /**
+             * @brief Estado de la caja de tarjetas
+             */
+            StatusCodesRow_t BoxState;
+
+            /**
+             * @brief Estado de la caja de reciclaje
+             */
+            StatusCodesRow_t RecyclingBoxState;
+
+            /**
+             * @brief Logger de esta instancia del dispensador
+             */
+            std::shared_ptr<spdlog::logger> logger;
+
+            /**
+             * @brief Registro en memoria de las ultimas tramas, transiciones y resultados de esta instancia del dispensador
+             */
+            FlightRecorder::FlightRecorderClass Recorder;
+
+            /**
+             * @brief Captura binaria de las tramas enviadas y recibidas (inactiva hasta StartCapture)
+             */
+            SerialCapture::SerialCaptureClass Capture;
+
             // --------------- CONSTRUCTOR FUNCTIONS --------------------//
 
              /**
@@ -174,31 +252,39 @@ namespace Dispenser{
 
             /**
             * @brief Busca la informacion adicional que entrega el dispensador cuando retorna un codigo de exito (Asociado a la tarjeta atorada o en puerta)
-            * @param SCode Codigo que puede ser '0' / '1' / '2'
-            * @return StatusCodesRow_t Estructura que tiene el codigo de estado, un mensaje asociado y la prioridad del mensaje
+            * @param SCode Byte de estado que puede ser '0' / '1' / '2'
+            * @return StatusCodesRow_t Estructura que tiene el codigo de estado, un mensaje asociado, la prioridad del mensaje y si se encontro
             */
-            StatusCodesRow_t SearchSuccessCode0 (std::string SCode);
+            StatusCodesRow_t SearchSuccessCode0 (int SCode);
 
             /**
             * @brief Busca la informacion adicional que entrega el dispensador cuando retorna un codigo de exito (Asociado a las tarjetas disponibles)
-            * @param SCode Codigo que puede ser '0' / '1' / '2'
-            * @return StatusCodesRow_t Estructura que tiene el codigo de estado, un mensaje asociado y la prioridad del mensaje
+            * @param SCode Byte de estado que puede ser '0' / '1' / '2'
+            * @return StatusCodesRow_t Estructura que tiene el codigo de estado, un mensaje asociado, la prioridad del mensaje y si se encontro
             */
-            StatusCodesRow_t SearchSuccessCode1 (std::string SCode);
+            StatusCodesRow_t SearchSuccessCode1 (int SCode);
 
             /**
             * @brief Busca la informacion adicional que entrega el dispensador cuando retorna un codigo de exito (Asociado a las tarjetas en la caja de reciclaje)
-            * @param SCode Codigo que puede ser '0' / '1'
-            * @return StatusCodesRow_t Estructura que tiene el codigo de estado, un mensaje asociado y la prioridad del mensaje
+            * @param SCode Byte de estado que puede ser '0' / '1'
+            * @return StatusCodesRow_t Estructura que tiene el codigo de estado, un mensaje asociado, la prioridad del mensaje y si se encontro
             */
-            StatusCodesRow_t SearchSuccessCode2 (std::string SCode);
+            StatusCodesRow_t SearchSuccessCode2 (int SCode);
 
             /**
             * @brief Busca el codigo de error asociado al ultimop comando enviado
-            * @param ErrorC Codigo de error Encontrado
-            * @return ErrorCodesRow_t Estrcutura que tiene el codigo de error, el mensaje asociado y la prioridad del mensaje
+            * @param ErrorC Codigo de error leido como byte hexadecimal (ver ErrorKey), -1 si no es valido
+            * @return ErrorCodesRow_t Estrcutura que tiene el codigo de error, el mensaje asociado, la prioridad del mensaje y si se encontro
             */
-            ErrorCodesRow_t SearchErrorCode (std::string ErrorC);
+            ErrorCodesRow_t SearchErrorCode (int ErrorC);
+
+            /**
+            * @brief Convierte los dos caracteres del codigo de error ("00".."B0") en un entero sin construir cadenas
+            * @param High Primer caracter del codigo
+            * @param Low Segundo caracter del codigo
+            * @return int Codigo como byte hexadecimal ("A1" -> 0xA1) o -1 si algun caracter no es hexadecimal
+            */
+            static int ErrorKey(unsigned char High, unsigned char Low);
 
             /**
             * @brief Busca el codigo de error entero que devuelve la funcion ExecuteCommand
@@ -262,11 +348,31 @@ namespace Dispenser{
             // --------------- MAIN FUNCTIONS --------------------//  
             
            /**
-            * @brief Abre el archivo donde se van a guardar los logs
+            * @brief Abre el archivo donde se van a guardar los logs con un logger propio de la instancia. Si la
+            * instancia ya tenia logger lo da de baja antes de crear el nuevo
             * @param Path Ruta donde se debe guardar el log de Spdlog
             */
             void InitLogger(const std::string& Path);
 
+            /**
+            * @brief Vuelca el flight recorder al archivo <ruta del log>.flight
+            * @param Reason Motivo del volcado
+            * @return long Numero de entradas escritas, -1 si no se pudo escribir el archivo
+            */
+            long DumpRecorder(const char *Reason);
+
+            /**
+            * @brief Hook de entrada al estado ST_ERROR, vuelca el flight recorder
+            */
+            void DumpRecorderOnError();
+
+            /**
+            * @brief Empieza a guardar cada trama enviada y recibida en un archivo de captura binario
+            * @param Path Ruta del archivo de captura (se agrega al final si ya existe)
+            * @return int 0 si se pudo abrir el archivo, 1 si no
+            */
+            int StartCapture(const std::string& Path);
+
             /**
             * @brief Se conecta al puerto con las caracteristicas definidas en la hoja de datos del dispensador
             * @brief Cambia bandera de conexion exitosa/fallida
@@ -318,6 +424,15 @@ namespace Dispenser{
             * @return Si retorna  5 -> [EC] El dispositivo no retorna ACK
             */
             int ExecuteCommand(std::vector<unsigned char> Comm, int AdTime);   
+
+            /**
+            * @brief Espera la respuesta de un comando y la lee: regresa en cuanto llega la trama completa segun su campo
+            * de largo (o el NAK/EOT de un byte), o al cumplirse el tiempo maximo (el que antes se esperaba siempre)
+            * @param TimeoutUs Tiempo maximo de espera en microsegundos
+            * @param Buffer Donde se guardan los bytes leidos
+            * @return int Bytes leidos, 0 si no llego nada o el puerto no soporta FIONREAD (ExecuteCommand lee como antes)
+            */
+            int WaitReply(long TimeoutUs, std::vector<unsigned char> &Buffer);
             
             /**
             * @brief Maneja la respuesta que llega, asegura la integridad de los datos, clasifica la respuesta en exito o fallo y envia ACK de confirmacion
@@ -332,7 +447,7 @@ namespace Dispenser{
             * @return Si retorna  2 -> [HRS/E] Codigo de respuesta desconocido
             * @return Si retorna  3 -> [HR] Respuesta no identificada, datos llegaron mal
             */
-            int HandleResponse(std::vector<unsigned char> Response, int Cm, int Pm);
+            int HandleResponse(const std::vector<unsigned char> &Response, int Cm, int Pm);
 
             /**
             * @brief Escribe un ACK al dispensador cuando el comando fue reconocido por el host
@@ -348,7 +463,7 @@ namespace Dispenser{
             * @return Si retorna 0 -> Respuesta de exito identificada
             * @return Si retorna 2 -> Codigo de respuesta desconocido
             */
-            int HandleResponseSuccess(std::vector<unsigned char> Response);
+            int HandleResponseSuccess(const std::vector<unsigned char> &Response);
 
             /**
             * @brief Maneja la respuesta de error y busca el codigo asociado
@@ -357,7 +472,7 @@ namespace Dispenser{
             * @return Si retorna 1 -> Respuesta de fallo identificada
             * @return Si retorna 2 -> Codigo de respuesta desconocido
             */
-            int HandleResponseError(std::vector<unsigned char> Response);
+            int HandleResponseError(const std::vector<unsigned char> &Response);
 
             /**
             * @brief Corre la funcion ExecuteCommand enviando el comando MSGINIT
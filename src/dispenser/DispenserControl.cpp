@@ -9,6 +9,8 @@
  * 
  */
 
+#include <chrono>
+#include <thread>
 #include "DispenserControl.hpp"
 
 namespace DispenserControl{
@@ -16,29 +18,12 @@ namespace DispenserControl{
     using namespace DispenserStateMachine;
     using namespace Dispenser;
 
-    // --------------- EXTERNAL VARIABLES --------------------//
-
-    // READ ONLY
-    int PortO;
-
-    // WRITE ONLY
-    std::string Path;
-    int LogLvl;
-    int MaximumPorts;
-    int MaxInitAttempts;
-    int ShortTime;
-    int LongTime;
-    
     // --------------- INTERNAL VARIABLES --------------------//
     
-    std::string VERSION = "1.1";
-    std::string DEFAULTERROR = "DefaultError";
-    
-    Response_t Response;
-
-    bool FlagCanRecycle = false;
+    const std::string VERSION = "1.1";
+    const std::string DEFAULTERROR = "DefaultError";
     
-    DispenserControlClass::DispenserControlClass(){
+    DispenserControlClass::DispenserControlClass() : PollRate(PollScheduler::DISPENSERMINMS, PollScheduler::DISPENSERMAXMS) {
         
         PortO = 0;
 
@@ -51,6 +36,12 @@ namespace DispenserControl{
 
         Response.StatusCode = 404;
         Response.Message = DEFAULTERROR;
+        FlagCanRecycle = false;
+        for (int i = 0; i < FLAG_COUNT; i++){
+            Tracked[i] = false;
+        }
+        TrackedKnown = false;
+        Tracking = false;
     }
 
     DispenserControlClass::~DispenserControlClass(){}
@@ -62,9 +53,21 @@ namespace DispenserControl{
         Globals.DispenserObject.MaxInitAttempts = MaxInitAttempts;
         Globals.DispenserObject.ShortTime = ShortTime;
         Globals.DispenserObject.LongTime = LongTime;
+        if (!CapturePath.empty()){
+            Globals.DispenserObject.StartCapture(CapturePath);
+        }
+        if (!JournalPath.empty()){
+            if (Journal.Open(JournalPath) == 0){
+                Globals.DispenserObject.logger->info("[InitLog] Event journal {0} opened, last sequence {1}",JournalPath,Journal.LastSequence());
+            }
+            else {
+                Globals.DispenserObject.logger->error("[InitLog] Could not open event journal {0}",JournalPath);
+            }
+        }
     }
 
     Response_t DispenserControlClass::Connect() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
         
         int Connection = -1;
         int Init = -1;
@@ -131,6 +134,7 @@ namespace DispenserControl{
     }
 
     Response_t DispenserControlClass::CheckDevice() {
+        CommandTicket Ticket(Scheduler, PRIORITY_POLL);
 
         int Check = -1;
 
@@ -138,6 +142,8 @@ namespace DispenserControl{
         Response.Message = DEFAULTERROR;
 
         Check = Globals.SMObject.RunCheck();
+        // Con 2 el dispensador respondio con un error, las banderas del estado siguen siendo validas
+        TrackFlags(Check != 1);
         
         if (Check == 0){
             Response = CheckCodes();
@@ -209,7 +215,8 @@ namespace DispenserControl{
         return Response;
     }
 
-    Response_t DispenserControlClass::DispenseCard(){
+    Response_t DispenserControlClass::DispenseCard(bool Checked){
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         bool FlagReady = false;
         bool FlagSaveCard = false;
@@ -222,7 +229,7 @@ namespace DispenserControl{
         //Deberia entrar aca desde el estado ST_WAIT
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
 
-        if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_WAIT") == 0){
+        if (Globals.SMObject.SM.CurrState == DispenserSMClass::ST_WAIT){
             FlagReady = true;
         }
         else {
@@ -234,7 +241,13 @@ namespace DispenserControl{
 
         if (FlagReady){
             
-            Response = CheckDevice();
+            // En un lote el estado se acaba de leer al confirmar que se retiro la tarjeta anterior
+            if (Checked & (Globals.SMObject.SM.CurrState == DispenserSMClass::ST_WAIT)){
+                Response = CheckCodes();
+            }
+            else {
+                Response = CheckDevice();
+            }
             
             if ((Response.StatusCode == 201) | (Response.StatusCode == 202) | (Response.StatusCode == 302) | (Response.StatusCode == 303)){
 
@@ -319,10 +332,99 @@ namespace DispenserControl{
             //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
         }
 
+        // Se registra todo intento en que se movio el motor, con el resultado que se regresa a JS
+        if (Dispense != -1){
+            Journal.Append(SerialCapture::DEVICE_DISPENSER, EventJournal::EVENT_DISPENSE, 0, 0, Response.StatusCode);
+        }
+        // La respuesta del dispensado trae el estado: la tarjeta en puerta se ve sin esperar otra lectura
+        TrackFlags(Response.StatusCode != 507);
+
         return Response;
     }
 
+    Response_t DispenserControlClass::DispenseCards(int Count, const BatchOptions_t &Options, const CardCallback_t &OnCard, const std::atomic<bool> &Running){
+
+        Response_t Result;
+        Result.StatusCode = 205;
+        Result.Message = "Dispensador entregó todas las tarjetas del lote";
+
+        // La lectura que confirma que se retiro una tarjeta sirve de revision antes de dispensar la siguiente
+        bool Checked = false;
+
+        for (int Index = 1; Index <= Count; Index++){
+
+            if (!Running){
+                Result.StatusCode = 306;
+                Result.Message = "Lote detenido. No se entregaron todas las tarjetas";
+                break;
+            }
+
+            CardResult_t Card;
+            Card.Index = Index;
+            Card.Taken = false;
+            Card.TakenMs = 0;
+
+            std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+            Response_t Dispensed = DispenseCard(Checked);
+            std::chrono::steady_clock::time_point AtGate = std::chrono::steady_clock::now();
+
+            Card.DispenseMs = std::chrono::duration_cast<std::chrono::milliseconds>(AtGate - Start).count();
+            Card.StatusCode = Dispensed.StatusCode;
+            Card.Message = Dispensed.Message;
+            OnCard(Card);
+
+            if ((Dispensed.StatusCode != 203) & (Dispensed.StatusCode != 304) & (Dispensed.StatusCode != 305)){
+                Result = Dispensed;
+                break;
+            }
+
+            Response_t Status = WaitCardTaken(Options.TakeTimeoutMs, Running);
+
+            Card.TakenMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - AtGate).count();
+            Card.StatusCode = Status.StatusCode;
+            Card.Message = Status.Message;
+            // 505/506: se retiro la tarjeta pero no quedan mas, el siguiente dispensado responde 510
+            Card.Taken = (Status.StatusCode == 201) | (Status.StatusCode == 202) | (Status.StatusCode == 302) |
+                         (Status.StatusCode == 303) | (Status.StatusCode == 505) | (Status.StatusCode == 506);
+            OnCard(Card);
+
+            if (!Card.Taken){
+                Result = Status;
+                break;
+            }
+            Checked = true;
+        }
+
+        return Result;
+    }
+
+    Response_t DispenserControlClass::WaitCardTaken(int TimeoutMs, const std::atomic<bool> &Running){
+
+        // EV_FINISH vuelve a ST_WAIT leyendo el estado, es la primera revision de la puerta
+        Response_t Status = EndProcess();
+        std::chrono::steady_clock::time_point Since = std::chrono::steady_clock::now();
+
+        while (Status.StatusCode == 301){
+            if (!Running){
+                Status.StatusCode = 306;
+                Status.Message = "Lote detenido. No se entregaron todas las tarjetas";
+                break;
+            }
+            if ((TimeoutMs > 0) && (std::chrono::steady_clock::now() - Since >= std::chrono::milliseconds(TimeoutMs))){
+                Status.StatusCode = 517;
+                Status.Message = "Dispensador con tarjeta en puerta. No se retiró antes del tiempo límite";
+                break;
+            }
+            // Con tarjeta en puerta el planificador esta en el intervalo rapido
+            PollScheduler::WaitNextPoll([this] { return PollDelayMs(); }, Running);
+            Status = CheckDevice();
+        }
+
+        return Status;
+    }
+
     Response_t DispenserControlClass::RecycleCard(){
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         bool FlagReady = false;
         int Recycle = -1;
@@ -333,7 +435,7 @@ namespace DispenserControl{
         //Deberia entrar aca desde el estado ST_MOVING_MOTOR
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
 
-        if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_MOVING_MOTOR") == 0){
+        if (Globals.SMObject.SM.CurrState == DispenserSMClass::ST_MOVING_MOTOR){
             FlagReady = true;
         }
         else {
@@ -437,12 +539,13 @@ namespace DispenserControl{
             Response.StatusCode = 514;
             Response.Message = "Dispensador con caja de reciclaje llena. No se puede reciclar la tarjeta";
         }
-
+        TrackFlags(Response.StatusCode != 507);
 
         return Response;
     }
 
     Response_t DispenserControlClass::EndProcess(){
+        CommandTicket Ticket(Scheduler, PRIORITY_URGENT);
 
         int Check = -1;
         bool FlagReady = false;
@@ -453,10 +556,10 @@ namespace DispenserControl{
         //Deberia entrar aca desde el estado ST_MOVING_MOTOR o ST_HANDING_CARD
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
 
-        if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_MOVING_MOTOR") == 0){
+        if (Globals.SMObject.SM.CurrState == DispenserSMClass::ST_MOVING_MOTOR){
             FlagReady = true;
         }
-        else if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_HANDING_CARD") == 0){
+        else if (Globals.SMObject.SM.CurrState == DispenserSMClass::ST_HANDING_CARD){
             FlagReady = true;
         }
 
@@ -486,6 +589,7 @@ namespace DispenserControl{
     }
 
     Flags_t DispenserControlClass::GetDispenserFlags() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         Flags_t DispenserFlags;
 
@@ -499,6 +603,7 @@ namespace DispenserControl{
     }
 
     TestStatus_t DispenserControlClass::TestStatus() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         TestStatus_t Status;
 
@@ -518,7 +623,7 @@ namespace DispenserControl{
         else {
             Status.ErrorType = 1;
             if ((Response.StatusCode == 201) | (Response.StatusCode == 202)){
-                if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_ERROR") != 0){
+                if (Globals.SMObject.SM.CurrState != DispenserSMClass::ST_ERROR){
                     Status.Priority = 0;
                 }
                 else {
@@ -534,5 +639,95 @@ namespace DispenserControl{
         
         return Status;
     }
-}
 
+    long DispenserControlClass::DumpFlightRecorder() {
+        // Sin turno del planificador: el flight recorder se lee sin locks y no usa el puerto serial
+        return Globals.DispenserObject.DumpRecorder("N-API");
+    }
+
+    size_t DispenserControlClass::GetEvents(uint64_t Since, std::vector<EventJournal::Event_t> &Events) {
+        // Sin turno del planificador: el diario tiene su propio mutex y no usa el puerto serial
+        return Journal.ReadSince(Since, Events, EventJournal::READLIMIT);
+    }
+
+    void DispenserControlClass::TrackFlags(bool Responding) {
+        bool Current[FLAG_COUNT];
+
+        // Sin respuesta se conservan las ultimas banderas conocidas, solo cambia FLAG_RESPONDING
+        Flags_t Flags = GetDispenserFlags();
+        Current[FLAG_RFIC_CARD_IN_G] = Responding ? Flags.RFICCardInG : Tracked[FLAG_RFIC_CARD_IN_G];
+        Current[FLAG_RECYCLING_BOX_F] = Responding ? Flags.RecyclingBoxF : Tracked[FLAG_RECYCLING_BOX_F];
+        Current[FLAG_CARD_IN_G] = Responding ? Flags.CardInG : Tracked[FLAG_CARD_IN_G];
+        Current[FLAG_CARDS_IN_D] = Responding ? Flags.CardsInD : Tracked[FLAG_CARDS_IN_D];
+        Current[FLAG_DISPENSER_F] = Responding ? Flags.DispenserF : Tracked[FLAG_DISPENSER_F];
+        Current[FLAG_RESPONDING] = Responding;
+
+        // Antes de la primera respuesta no hay banderas que conservar
+        if (!TrackedKnown & !Responding){
+            return;
+        }
+
+        int64_t TimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        bool Changed = false;
+        for (int i = 0; i < FLAG_COUNT; i++){
+            // La primera lectura se entrega completa para que onStatus parta del estado actual
+            if (TrackedKnown & (Current[i] == Tracked[i])){
+                continue;
+            }
+            Tracked[i] = Current[i];
+            Changed = true;
+            if (Tracking){
+                if (Changes.size() == MAXCHANGES){
+                    Changes.pop_front();
+                }
+                Changes.push_back({TimeMs, static_cast<Flag_t>(i), Current[i]});
+            }
+        }
+        TrackedKnown = true;
+
+        // Mientras hay tarjeta en puerta o el motor se mueve se lee rapido, es cuando el usuario la retira
+        std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+        int State = Globals.SMObject.SM.CurrState;
+        PollRate.SetBusy(Tracked[FLAG_CARD_IN_G] | (State == DispenserSMClass::ST_MOVING_MOTOR) | (State == DispenserSMClass::ST_HANDING_CARD), Now);
+        if (Changed){
+            PollRate.Activity(Now);
+        }
+    }
+
+    void DispenserControlClass::StartTracking() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
+        Changes.clear();
+        TrackedKnown = false;
+        Tracking = true;
+        PollRate.Start(std::chrono::steady_clock::now());
+    }
+
+    void DispenserControlClass::StopTracking() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
+        Tracking = false;
+        Changes.clear();
+    }
+
+    Response_t DispenserControlClass::TrackStatus(std::vector<FlagChange_t> &Out) {
+        CommandTicket Ticket(Scheduler, PRIORITY_POLL);
+        Response_t Status = CheckDevice();
+        Out.assign(Changes.begin(), Changes.end());
+        Changes.clear();
+        PollRate.Next(std::chrono::steady_clock::now());
+        return Status;
+    }
+
+    PollScheduler::Stats_t DispenserControlClass::GetPollStats() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
+        return PollRate.Stats(std::chrono::steady_clock::now());
+    }
+
+    int DispenserControlClass::PollDelayMs() {
+        return PollRate.Interval();
+    }
+
+    const char *FlagName(Flag_t Flag) {
+        static const char *Names[] = { "rficCardInG", "recyclingBoxF", "cardInG", "cardsInD", "dispenserF", "responding" };
+        return ((Flag >= 0) && (Flag < FLAG_COUNT)) ? Names[Flag] : "unknown";
+    }
+}
@@ -15,13 +15,21 @@
 #include <stdio.h>
 #include <string>
 #include <iostream>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <vector>
 
 #include "StateMachine.hpp"
+#include "../common/CommandScheduler.hpp"
+#include "../common/EventJournal.hpp"
+#include "../common/PollScheduler.hpp"
 #include "Dispenser.hpp"
 
 namespace DispenserControl{
 
     using namespace DispenserStateMachine;
+    using namespace CommandScheduler;
     using namespace Dispenser;
 
     struct Response_t{
@@ -37,6 +45,52 @@ namespace DispenserControl{
         bool DispenserF;
     };
 
+    /**
+     * @brief Banderas del estado que se siguen (mismo orden que GetDispenserFlags) mas FLAG_RESPONDING, que cambia
+     * cuando el dispensador deja de responder o vuelve a hacerlo
+     */
+    enum Flag_t{
+        FLAG_RFIC_CARD_IN_G = 0,
+        FLAG_RECYCLING_BOX_F,
+        FLAG_CARD_IN_G,
+        FLAG_CARDS_IN_D,
+        FLAG_DISPENSER_F,
+        FLAG_RESPONDING,
+        FLAG_COUNT
+    };
+
+    /**
+     * @brief Cambio de una bandera detectado al leer el estado
+     */
+    struct FlagChange_t{
+        int64_t TimeMs;             // Milisegundos desde 1970, hora en que se leyo el estado
+        Flag_t Flag;
+        bool Value;
+    };
+
+    /**
+     * @brief Cambios que se guardan sin que onStatus los lea, se descartan los mas viejos
+     */
+    static const size_t MAXCHANGES = 64;
+
+    /**
+     * @brief Avance de cada tarjeta de DispenseCards. Se entrega al llegar a la puerta y al retirarse
+     */
+    struct CardResult_t{
+        int Index;                  // Numero de la tarjeta en el lote, desde 1
+        bool Taken;                 // true: se confirmo que el usuario retiro la tarjeta
+        int StatusCode;
+        std::string Message;
+        int64_t DispenseMs;         // Desde la orden hasta que la tarjeta llego a la puerta
+        int64_t TakenMs;            // Desde que llego a la puerta hasta que se retiro
+    };
+
+    struct BatchOptions_t{
+        int TakeTimeoutMs;          // Espera maxima a que se retire cada tarjeta, 0 sin limite
+    };
+
+    typedef std::function<void(const CardResult_t &)> CardCallback_t;
+
     struct TestStatus_t{
         std::string Version;
         int Device;
@@ -63,13 +117,26 @@ namespace DispenserControl{
 
             //WRITE ONLY
             std::string Path;
+            std::string CapturePath;    // Vacio: sin captura binaria del trafico serial
+            std::string JournalPath;    // Vacio: sin diario de eventos
             int LogLvl;
             int MaximumPorts;
             int MaxInitAttempts;
             int ShortTime;
             int LongTime;
 
+            //INTERNAL
+            Response_t Response;
+            bool FlagCanRecycle;
+            bool Tracked[FLAG_COUNT];               // Ultimo valor de cada bandera
+            bool TrackedKnown;                      // false hasta la primera lectura del estado
+            bool Tracking;                          // onStatus activo, solo entonces se guardan los cambios
+            std::deque<FlagChange_t> Changes;       // Cambios pendientes de entregar a onStatus
+
             GlobalVariables Globals;
+            CommandSchedulerClass Scheduler;
+            EventJournal::EventJournalClass Journal;
+            PollScheduler::PollSchedulerClass PollRate; // Espera entre lecturas del estado (onStatus/onDispense)
             
             DispenserControlClass();
             ~DispenserControlClass();
@@ -78,12 +145,27 @@ namespace DispenserControl{
             Response_t Connect();
             Response_t CheckDevice();
             Response_t CheckCodes();
-            Response_t DispenseCard();
+            Response_t DispenseCard(bool Checked = false);
+            Response_t DispenseCards(int Count, const BatchOptions_t &Options, const CardCallback_t &OnCard, const std::atomic<bool> &Running);
+            Response_t WaitCardTaken(int TimeoutMs, const std::atomic<bool> &Running);
             Response_t RecycleCard();
             Response_t EndProcess();
             Flags_t GetDispenserFlags();
             TestStatus_t TestStatus();
+            long DumpFlightRecorder();
+            size_t GetEvents(uint64_t Since, std::vector<EventJournal::Event_t> &Events);
+            void TrackFlags(bool Responding);
+            void StartTracking();
+            void StopTracking();
+            Response_t TrackStatus(std::vector<FlagChange_t> &Out);
+            PollScheduler::Stats_t GetPollStats();
+            int PollDelayMs();
     };
+
+    /**
+     * @brief Nombre de la bandera que se entrega a JS
+     */
+    const char *FlagName(Flag_t Flag);
 }
 
 #endif /* DISPENSERCONTROL */
\ No newline at end of file
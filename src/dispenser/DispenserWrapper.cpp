@@ -1,12 +1,5 @@
 #include "DispenserWrapper.hpp"
 
-std::thread nativeThreadDispenser;
-Napi::ThreadSafeFunction tsfnDispenser;
-static bool isRunningDispenser = true;
-static bool threadEndedDispenser = true;
-
-Napi::FunctionReference DispenserWrapper::constructor;
-
 Napi::Object DispenserWrapper::Init(Napi::Env env, Napi::Object exports) {
   Napi::HandleScope scope(env);
   Napi::Function func = DefineClass(env, "Dispenser", {
@@ -18,9 +11,14 @@ Napi::Object DispenserWrapper::Init(Napi::Env env, Napi::Object exports) {
     InstanceMethod("getDispenserFlags", &DispenserWrapper::GetDispenserFlags),
     InstanceMethod("testStatus", &DispenserWrapper::TestStatus),
     InstanceMethod("onDispense", &DispenserWrapper::OnDispense),
+    InstanceMethod("getQueueStats", &DispenserWrapper::GetQueueStats),
+    InstanceMethod("dumpFlightRecorder", &DispenserWrapper::DumpFlightRecorder),
+    InstanceMethod("getEvents", &DispenserWrapper::GetEvents),
+    InstanceMethod("onStatus", &DispenserWrapper::OnStatus),
+    InstanceMethod("getPollStats", &DispenserWrapper::GetPollStats),
+    InstanceMethod("dispenseCards", &DispenserWrapper::DispenseCards),
   });
-  constructor = Napi::Persistent(func);
-  constructor.SuppressDestruct();
+  env.GetInstanceData<AddonData::AddonDataClass>()->DispenserConstructor = Napi::Persistent(func);
   exports.Set("Dispenser", func);
   return exports;
 }
@@ -55,93 +53,116 @@ DispenserWrapper::DispenserWrapper(const Napi::CallbackInfo& info) : Napi::Objec
 
   this->dispenserControl_ = new DispenserControlClass();
   this->dispenserControl_->Path = LogFilePath.Utf8Value();
+  if (params.Has("capturePath")) {
+    this->dispenserControl_->CapturePath = params.Get("capturePath").ToString().Utf8Value();
+  }
+  if (params.Has("journalPath")) {
+    this->dispenserControl_->JournalPath = params.Get("journalPath").ToString().Utf8Value();
+  }
   this->dispenserControl_->LogLvl = LogLvl.Uint32Value();
   this->dispenserControl_->MaximumPorts = MaximumPorts.Int32Value();
   this->dispenserControl_->MaxInitAttempts = MaxInitAttempts.Int32Value();
   this->dispenserControl_->ShortTime = ShortTime.Int32Value();
   this->dispenserControl_->LongTime = LongTime.Int32Value();
+  PollScheduler::Config_t config = this->dispenserControl_->PollRate.GetConfig();
+  if (PollScheduler::ParseConfig(params, config)) {
+    this->dispenserControl_->PollRate.Configure(config);
+  }
+
+  this->isRunning_ = true;
+  this->threadEnded_ = true;
+  this->statusRunning_ = false;
+  this->statusEnded_ = true;
+  this->batchRunning_ = false;
+  this->batchEnded_ = true;
 
   this->dispenserControl_->InitLog();
 }
 
+// Igual que Pelicano: los hilos ya terminaron (Ref/Unref) y al borrar el control se libera el puerto
+DispenserWrapper::~DispenserWrapper() {
+  this->isRunning_ = false;
+  this->statusRunning_ = false;
+  this->batchRunning_ = false;
+  if (this->nativeThread_.joinable()) {
+    this->nativeThread_.join();
+  }
+  if (this->statusThread_.joinable()) {
+    this->statusThread_.join();
+  }
+  if (this->batchThread_.joinable()) {
+    this->batchThread_.join();
+  }
+  delete this->dispenserControl_;
+}
+
 Napi::Value DispenserWrapper::Connect(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->dispenserControl_->Connect();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value DispenserWrapper::CheckDevice(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->dispenserControl_->CheckDevice();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value DispenserWrapper::DispenseCard(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->dispenserControl_->DispenseCard();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value DispenserWrapper::RecycleCard(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
-  isRunningDispenser = false;
+  this->isRunning_ = false;
   Response_t response = this->dispenserControl_->RecycleCard();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value DispenserWrapper::EndProcess(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
-  isRunningDispenser = false;
+  this->isRunning_ = false;
   Response_t response = this->dispenserControl_->EndProcess();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value DispenserWrapper::GetDispenserFlags(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Flags_t response = this->dispenserControl_->GetDispenserFlags();
-  Napi::Object object = Napi::Object::New(env);
-  object["rficCardInG"] = Napi::Boolean::New(env, response.RFICCardInG);
-  object["recyclingBoxF"] = Napi::Boolean::New(env, response.RecyclingBoxF);
-  object["cardInG"] = Napi::Boolean::New(env, response.CardInG);
-  object["cardsInD"] = Napi::Boolean::New(env, response.CardsInD);
-  object["dispenserF"] = Napi::Boolean::New(env, response.DispenserF);
-  return object;
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  Field_t fields[] = {
+    { KEY_RFIC_CARD_IN_G,   cache->Boolean(env, response.RFICCardInG) },
+    { KEY_RECYCLING_BOX_F,  cache->Boolean(env, response.RecyclingBoxF) },
+    { KEY_CARD_IN_G,        cache->Boolean(env, response.CardInG) },
+    { KEY_CARDS_IN_D,       cache->Boolean(env, response.CardsInD) },
+    { KEY_DISPENSER_F,      cache->Boolean(env, response.DispenserF) },
+  };
+  return cache->Build(env, fields);
 }
 
 Napi::Value DispenserWrapper::TestStatus(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   TestStatus_t response = this->dispenserControl_->TestStatus();
-  Napi::Object object = Napi::Object::New(env);
-  object["version"] = Napi::String::New(env, response.Version);
-  object["device"] = Napi::Number::New(env, response.Device);
-  object["errorType"] = Napi::Number::New(env, response.ErrorType);
-  object["errorCode"] = Napi::Number::New(env, response.ErrorCode);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["aditionalInfo"] = Napi::String::New(env, response.AditionalInfo);
-  object["priority"] = Napi::Number::New(env, response.Priority);
-  return object;
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  Field_t fields[] = {
+    { KEY_VERSION,        cache->String(env, response.Version) },
+    { KEY_DEVICE,         cache->Number(env, response.Device) },
+    { KEY_ERROR_TYPE,     cache->Number(env, response.ErrorType) },
+    { KEY_ERROR_CODE,     cache->Number(env, response.ErrorCode) },
+    { KEY_MESSAGE,        cache->Text(env, response.Message) },
+    { KEY_ADITIONAL_INFO, cache->Text(env, response.AditionalInfo) },
+    { KEY_PRIORITY,       cache->Number(env, response.Priority) },
+  };
+  return cache->Build(env, fields);
 }
 
 Napi::Value DispenserWrapper::OnDispense(const Napi::CallbackInfo &info)
@@ -154,46 +175,254 @@ Napi::Value DispenserWrapper::OnDispense(const Napi::CallbackInfo &info)
   }
   
   Napi::Function napiFunction = info[0].As<Napi::Function>();
-  tsfnDispenser = Napi::ThreadSafeFunction::New(
+  // El hilo usa this: el objeto no se libera hasta el finalizador del tsfn (Unref)
+  this->Ref();
+  this->tsfn_ = Napi::ThreadSafeFunction::New(
     env, 
     napiFunction, 
     "Callback", 
     0, 
     1,
-    []( Napi::Env ) {
-      nativeThreadDispenser.join();
+    [this]( Napi::Env ) {
+      this->nativeThread_.join();
+      this->Unref();
     });
 
-  nativeThreadDispenser = std::thread ( [this] {
+  this->nativeThread_ = std::thread ( [this] {
     auto callback = [](Napi::Env env, Napi::Function jsCallback, Response_t* status) {
-      Napi::Object object = Napi::Object::New(env);
-      object["statusCode"] = Napi::Number::New(env, status->StatusCode);
-      object["message"] = Napi::String::New(env, status->Message);
-      jsCallback.Call({object});
+      jsCallback.Call({ResultCacheClass::Get(env)->Response(env, status->StatusCode, status->Message)});
       delete status;
     };
-    isRunningDispenser = true;
-    threadEndedDispenser = false;
-    while (isRunningDispenser) {
-      std::this_thread::sleep_for( std::chrono::milliseconds(10));
+    this->isRunning_ = true;
+    this->threadEnded_ = false;
+    while (this->isRunning_) {
+      // Con tarjeta en puerta el planificador esta en el intervalo rapido
+      PollScheduler::WaitNextPoll([this] { return this->dispenserControl_->PollDelayMs(); }, this->isRunning_);
       Response_t response = this->dispenserControl_->CheckDevice();
       if (response.StatusCode == 301) continue;
       Response_t *value = new Response_t(response);
-      napi_status status = tsfnDispenser.BlockingCall(value, callback);
+      napi_status status = this->tsfn_.BlockingCall(value, callback);
       if ( status != napi_ok ) break;
-      isRunningDispenser = false;
+      this->isRunning_ = false;
       break;
     }
-    threadEndedDispenser = true;
-    tsfnDispenser.Release();
+    this->threadEnded_ = true;
+    this->tsfn_.Release();
   });
 
-  auto finishFn = [] (const Napi::CallbackInfo& info) {
-    isRunningDispenser = false;
-    while (!threadEndedDispenser);
+  auto finishFn = [this] (const Napi::CallbackInfo& info) {
+    this->isRunning_ = false;
+    while (!this->threadEnded_);
     std::this_thread::sleep_for( std::chrono::milliseconds(50));
     return;
   };
 
   return Napi::Function::New(env, finishFn);
 }
+
+Napi::Value DispenserWrapper::GetQueueStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  return ResultCacheClass::Get(env)->QueueStats(env, this->dispenserControl_->Scheduler);
+}
+
+Napi::Value DispenserWrapper::DumpFlightRecorder(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  long count = this->dispenserControl_->DumpFlightRecorder();
+  return ResultCacheClass::Get(env)->RecorderDump(env, count, this->dispenserControl_->Globals.DispenserObject.Recorder.Path);
+}
+
+Napi::Value DispenserWrapper::GetEvents(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  uint64_t since = (info.Length() > 0 && info[0].IsNumber()) ? static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value()) : 0;
+  std::vector<EventJournal::Event_t> events;
+  this->dispenserControl_->GetEvents(since, events);
+  return ResultCacheClass::Get(env)->JournalEvents(env, events);
+}
+
+Napi::Value DispenserWrapper::OnStatus(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (info.Length() != 1 || !info[0].IsFunction()) {
+    Napi::TypeError::New(env, "Invalid params").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!this->statusEnded_) {
+    Napi::Error::New(env, "onStatus is already running").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  // El hilo anterior ya termino, pero su finalizador puede no haber corrido todavia
+  if (this->statusThread_.joinable()) {
+    this->statusThread_.join();
+  }
+
+  Napi::Function napiFunction = info[0].As<Napi::Function>();
+  // El hilo usa this: el objeto no se libera hasta el finalizador del tsfn (Unref)
+  this->Ref();
+  this->statusTsfn_ = Napi::ThreadSafeFunction::New(
+    env,
+    napiFunction,
+    "Callback",
+    0,
+    1,
+    [this]( Napi::Env ) {
+      // Solo si el hilo termino: si ya se llamo onStatus otra vez el hilo es el nuevo
+      if (this->statusEnded_ && this->statusThread_.joinable()) {
+        this->statusThread_.join();
+      }
+      this->Unref();
+    });
+
+  this->dispenserControl_->StartTracking();
+  this->statusRunning_ = true;
+  this->statusEnded_ = false;
+  this->statusThread_ = std::thread ( [this] {
+    auto callback = [](Napi::Env env, Napi::Function jsCallback, std::vector<FlagChange_t>* changes) {
+      ResultCacheClass *cache = ResultCacheClass::Get(env);
+      for (const FlagChange_t &change : *changes) {
+        Field_t fields[] = {
+          { KEY_TIME,   cache->Number(env, static_cast<double>(change.TimeMs)) },
+          { KEY_FLAG,   cache->String(env, FlagName(change.Flag)) },
+          { KEY_VALUE,  cache->Boolean(env, change.Value) },
+        };
+        jsCallback.Call({cache->Build(env, fields)});
+      }
+      delete changes;
+    };
+    std::vector<FlagChange_t> changes;
+    while (this->statusRunning_) {
+      this->dispenserControl_->TrackStatus(changes);
+      if (!changes.empty()) {
+        std::vector<FlagChange_t> *value = new std::vector<FlagChange_t>(changes);
+        napi_status status = this->statusTsfn_.BlockingCall(value, callback);
+        if ( status != napi_ok ) break;
+      }
+      PollScheduler::WaitNextPoll([this] { return this->dispenserControl_->PollDelayMs(); }, this->statusRunning_);
+    }
+    this->dispenserControl_->StopTracking();
+    this->statusEnded_ = true;
+    this->statusTsfn_.Release();
+  });
+
+  auto finishFn = [this] (const Napi::CallbackInfo& info) {
+    this->statusRunning_ = false;
+    if (this->statusThread_.joinable()) {
+      this->statusThread_.join();
+    }
+    return;
+  };
+
+  return Napi::Function::New(env, finishFn);
+}
+
+Napi::Value DispenserWrapper::GetPollStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  return ResultCacheClass::Get(env)->PollStats(env, this->dispenserControl_->GetPollStats());
+}
+
+// Evento del hilo de dispenseCards: avance de una tarjeta o resultado del lote
+struct BatchEvent_t {
+  bool End;
+  CardResult_t Card;
+  Response_t Result;
+};
+
+Napi::Value DispenserWrapper::DispenseCards(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (info.Length() != 2 || !info[0].IsNumber() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "Invalid params").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Object options = info[1].As<Napi::Object>();
+  if (!options.Has("onCard") || !options.Get("onCard").IsFunction()) {
+    Napi::TypeError::New(env, "Invalid params").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  if (!this->batchEnded_) {
+    Napi::Error::New(env, "dispenseCards is already running").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  // El lote anterior ya termino, pero su finalizador puede no haber corrido todavia
+  if (this->batchThread_.joinable()) {
+    this->batchThread_.join();
+  }
+
+  int count = info[0].As<Napi::Number>().Int32Value();
+  BatchOptions_t batch;
+  batch.TakeTimeoutMs = options.Has("takeTimeout") ? options.Get("takeTimeout").ToNumber().Int32Value() : 0;
+  if (options.Has("onEnd") && options.Get("onEnd").IsFunction()) {
+    this->batchEnd_ = Napi::Persistent(options.Get("onEnd").As<Napi::Function>());
+  }
+  else {
+    this->batchEnd_.Reset();
+  }
+
+  // El hilo usa this: el objeto no se libera hasta el finalizador del tsfn (Unref)
+  this->Ref();
+  this->batchTsfn_ = Napi::ThreadSafeFunction::New(
+    env,
+    options.Get("onCard").As<Napi::Function>(),
+    "Callback",
+    0,
+    1,
+    [this]( Napi::Env ) {
+      // Solo si el hilo termino: si ya se llamo dispenseCards otra vez el hilo es el nuevo
+      if (this->batchEnded_ && this->batchThread_.joinable()) {
+        this->batchThread_.join();
+      }
+      this->Unref();
+    });
+
+  this->batchRunning_ = true;
+  this->batchEnded_ = false;
+  this->batchThread_ = std::thread ( [this, count, batch] {
+    auto callback = [this](Napi::Env env, Napi::Function jsCallback, BatchEvent_t* event) {
+      ResultCacheClass *cache = ResultCacheClass::Get(env);
+      if (event->End) {
+        if (!this->batchEnd_.IsEmpty()) {
+          this->batchEnd_.Value().Call({cache->Response(env, event->Result.StatusCode, event->Result.Message)});
+        }
+      }
+      else {
+        Field_t fields[] = {
+          { KEY_INDEX,        cache->Number(env, event->Card.Index) },
+          { KEY_TAKEN,        cache->Boolean(env, event->Card.Taken) },
+          { KEY_STATUS_CODE,  cache->Number(env, event->Card.StatusCode) },
+          { KEY_MESSAGE,      cache->Message(env, event->Card.StatusCode, event->Card.Message) },
+          { KEY_DISPENSE_MS,  cache->Number(env, static_cast<double>(event->Card.DispenseMs)) },
+          { KEY_TAKEN_MS,     cache->Number(env, static_cast<double>(event->Card.TakenMs)) },
+        };
+        jsCallback.Call({cache->Build(env, fields)});
+      }
+      delete event;
+    };
+    auto onCard = [this, callback](const CardResult_t &card) {
+      this->batchTsfn_.BlockingCall(new BatchEvent_t{false, card, {0, ""}}, callback);
+    };
+    Response_t result = this->dispenserControl_->DispenseCards(count, batch, onCard, this->batchRunning_);
+    this->batchTsfn_.BlockingCall(new BatchEvent_t{true, CardResult_t(), result}, callback);
+    this->batchEnded_ = true;
+    this->batchTsfn_.Release();
+  });
+
+  // Espera a que termine el comando en curso (un dispensado o una lectura del estado), el hilo no bloquea a JS
+  // porque la cola del TSFN no tiene limite
+  auto finishFn = [this] (const Napi::CallbackInfo& info) {
+    this->batchRunning_ = false;
+    if (this->batchThread_.joinable()) {
+      this->batchThread_.join();
+    }
+    return;
+  };
+
+  return Napi::Function::New(env, finishFn);
+}
\ No newline at end of file
@@ -1,16 +1,20 @@
 #include <napi.h>
 #include <thread>
 #include <chrono>
+#include <atomic>
 #include "DispenserControl.hpp"
+#include "../common/AddonData.hpp"
+#include "../common/PollOptions.hpp"
 
 using namespace DispenserControl;
+using namespace ResultCache;
 
 class DispenserWrapper : public Napi::ObjectWrap<DispenserWrapper> {
   public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     DispenserWrapper(const Napi::CallbackInfo& info);
+    ~DispenserWrapper();
   private:
-    static Napi::FunctionReference constructor;
     Napi::Value Connect(const Napi::CallbackInfo& info);
     Napi::Value CheckDevice(const Napi::CallbackInfo& info);
     Napi::Value DispenseCard(const Napi::CallbackInfo& info);
@@ -19,5 +23,24 @@ class DispenserWrapper : public Napi::ObjectWrap<DispenserWrapper> {
     Napi::Value GetDispenserFlags(const Napi::CallbackInfo& info);
     Napi::Value TestStatus(const Napi::CallbackInfo& info);
     Napi::Value OnDispense(const Napi::CallbackInfo& info);
+    Napi::Value GetQueueStats(const Napi::CallbackInfo& info);
+    Napi::Value DumpFlightRecorder(const Napi::CallbackInfo& info);
+    Napi::Value GetEvents(const Napi::CallbackInfo& info);
+    Napi::Value OnStatus(const Napi::CallbackInfo& info);
+    Napi::Value GetPollStats(const Napi::CallbackInfo& info);
+    Napi::Value DispenseCards(const Napi::CallbackInfo& info);
     DispenserControlClass *dispenserControl_;
+    std::thread nativeThread_;
+    Napi::ThreadSafeFunction tsfn_;
+    std::atomic<bool> isRunning_;
+    std::atomic<bool> threadEnded_;
+    std::thread statusThread_;
+    Napi::ThreadSafeFunction statusTsfn_;
+    std::atomic<bool> statusRunning_;
+    std::atomic<bool> statusEnded_;
+    std::thread batchThread_;
+    Napi::ThreadSafeFunction batchTsfn_;
+    Napi::FunctionReference batchEnd_;
+    std::atomic<bool> batchRunning_;
+    std::atomic<bool> batchEnded_;
 };
\ No newline at end of file
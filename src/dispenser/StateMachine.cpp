@@ -15,19 +15,9 @@ namespace DispenserStateMachine{
 
     using namespace Dispenser;
 
-    DispenserClass *DispenserObject;
+    typedef StateMachineBase::StateMachine<DispenserClass, DispenserSMTypes::State_t, DispenserSMTypes::Event_t> Base_t;
 
-    DispenserSMClass::DispenserSMClass(Dispenser::DispenserClass *_DispenserClass_p){
-        DispenserObject = _DispenserClass_p;
-        SM.CurrState = DispenserSMClass::ST_IDLE;
-    };
-
-    struct StateFunctionRow_t{
-        const char * name;
-        int (DispenserClass::*func)(void);
-    };
-
-    static StateFunctionRow_t StateFunctionDispenser[] = {
+    static const Base_t::StateRow_t StateFunctionDispenser[] = {
             // NAME             // FUNC
         { "ST_IDLE",            &DispenserClass::StIdle },
         { "ST_CONNECT",         &DispenserClass::StConnect },      
@@ -37,14 +27,11 @@ namespace DispenserStateMachine{
         { "ST_HANDING_CARD",    &DispenserClass::StHandingCard },      
         { "ST_ERROR",           &DispenserClass::StError },
     };
+    static_assert(sizeof(StateFunctionDispenser)/sizeof(StateFunctionDispenser[0]) == DispenserSMClass::ST_COUNT, "Falta la funcion de algun estado");
+
+    typedef StateTable::TransitionRow_t<DispenserSMClass::State_t, DispenserSMClass::Event_t> StateTransitionRow_t;
 
-    struct StateTransitionRow_t{
-        DispenserSMClass::State_t CurrState;
-        DispenserSMClass::Event_t Event;
-        DispenserSMClass::State_t NextState;
-    } ;
-    
-    static StateTransitionRow_t StateTransition[] = {
+    static constexpr StateTransitionRow_t StateTransition[] = {
         // CURR STATE       // EVENT            // NEXT STATE
         { DispenserSMClass::ST_IDLE,          DispenserSMClass::EV_ANY,             DispenserSMClass::ST_CONNECT},
 
@@ -68,38 +55,19 @@ namespace DispenserStateMachine{
 
         { DispenserSMClass::ST_ERROR,         DispenserSMClass::EV_RESET,           DispenserSMClass::ST_IDLE },
     };
+    static_assert(StateTable::IsValid<DispenserSMClass::ST_COUNT, DispenserSMClass::EV_COUNT>(StateTransition), "Transicion fuera de rango o repetida");
 
-    void DispenserSMClass::InitStateMachine() {
-        SM.CurrState = DispenserSMClass::ST_IDLE; 
-        (DispenserObject[0].*(StateFunctionDispenser[SM.CurrState].func))();
+    // Tabla densa [estado][evento] construida en compilacion a partir de StateTransition
+    static constexpr Base_t::Table_t Transitions = StateTable::BuildTable<DispenserSMClass::ST_COUNT, DispenserSMClass::EV_COUNT>(StateTransition);
+
+    DispenserSMClass::DispenserSMClass(Dispenser::DispenserClass *_DispenserClass_p)
+        : Base_t(_DispenserClass_p, StateFunctionDispenser, &Transitions, 0) {
+        SetRecorder(&_DispenserClass_p->Recorder);
+        SetEntryHook(ST_ERROR, &DispenserClass::DumpRecorderOnError);
     }
 
     int DispenserSMClass::RunCheck() {
-        int Response = -1;
-        LS.CurrState = SM.CurrState; 
-        SM.CurrState = DispenserSMClass::ST_WAIT; 
-        Response = (DispenserObject[0].*(StateFunctionDispenser[SM.CurrState].func))();
-        SM.CurrState = LS.CurrState;
-        return Response;
-    }
-    
-    int DispenserSMClass::StateMachineRun(Event_t Event) {
-        int Response = -1;
-        for (long unsigned int i = 0; i < sizeof(StateTransition)/sizeof(StateTransition[0]); i++) {
-            if (StateTransition[i].CurrState == SM.CurrState) {
-                if (StateTransition[i].Event == Event) {
-                    SM.CurrState =  StateTransition[i].NextState;
-                    Response = (DispenserObject[0].*(StateFunctionDispenser[SM.CurrState].func))();
-                    return Response;
-                    break;
-                }
-            }
-        }
-        return 0;
+        return RunState(DispenserSMClass::ST_WAIT);
     }
-    
-    const char * DispenserSMClass::StateMachineGetStateName(State_t State) {
-        return StateFunctionDispenser[State].name;
-    }
-    
+
 };
\ No newline at end of file
@@ -3,8 +3,10 @@
 #include "pelicano/Pelicano.hpp"
 #include "dispenser/DispenserWrapper.hpp"
 #include "nv10/NV10Wrapper.hpp"
+#include "common/AddonData.hpp"
 
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+  env.SetInstanceData(new AddonData::AddonDataClass(env));
   Pelicano::Init(env, exports);
   Azkoyen::Init(env, exports);
   DispenserWrapper::Init(env, exports);
@@ -0,0 +1,65 @@
+/**
+ * @file EscrowPolicy.cpp
+ * @brief Politica de custodia (escrow) del NV10
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "EscrowPolicy.hpp"
+
+namespace EscrowPolicy {
+
+    // Por defecto un billete en custodia se rechaza si JS no decide en 10 s
+    static const int DEFAULTHOLDTIMEOUTMS = 10000;
+
+    EscrowPolicyClass::EscrowPolicyClass() : Total(0) {
+        Clear();
+    }
+
+    void EscrowPolicyClass::Clear(){
+        for (int i = 0; i < MAXCHANNELS; i++){
+            Rules[i] = ACTION_ACCEPT;
+        }
+        Max = 0;
+        HoldTimeoutMs = DEFAULTHOLDTIMEOUTMS;
+    }
+
+    int EscrowPolicyClass::SetRule(int Channel, Action_t Action){
+        if ((Channel < 1) || (Channel > MAXCHANNELS)){
+            return 1;
+        }
+        Rules[Channel - 1] = Action;
+        return 0;
+    }
+
+    void EscrowPolicyClass::SetSessionMax(long _Max){
+        Max = (_Max > 0) ? _Max : 0;
+    }
+
+    void EscrowPolicyClass::SetHoldTimeout(int Ms){
+        HoldTimeoutMs = (Ms > 0) ? Ms : DEFAULTHOLDTIMEOUTMS;
+    }
+
+    Decision_t EscrowPolicyClass::Decide(int Channel, int Bill) const {
+        Action_t Rule = ((Channel >= 1) && (Channel <= MAXCHANNELS)) ? Rules[Channel - 1] : ACTION_ACCEPT;
+        if (Rule == ACTION_REJECT){
+            return {ACTION_REJECT, REASON_RULE};
+        }
+        if ((Max > 0) && (Total + Bill > Max)){
+            return {ACTION_REJECT, REASON_SESSION_MAX};
+        }
+        return {Rule, REASON_NONE};
+    }
+
+    void EscrowPolicyClass::Credit(int Bill){
+        Total += Bill;
+    }
+
+    void EscrowPolicyClass::ResetSession(){
+        Total = 0;
+    }
+
+};
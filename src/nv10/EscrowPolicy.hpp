@@ -0,0 +1,105 @@
+/**
+ * @file EscrowPolicy.hpp
+ * @brief Politica de custodia (escrow) del NV10: decide en el addon si un billete leido se acepta, se rechaza o se
+ * mantiene en custodia esperando la decision de JS, sin esperar un viaje de ida y vuelta a JS mientras el billete
+ * esta en la entrada
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef ESCROWPOLICY_HPP
+#define ESCROWPOLICY_HPP
+
+namespace EscrowPolicy {
+
+    /**
+     * @brief Canales que admite la politica (1 a MAXCHANNELS)
+     */
+    static const int MAXCHANNELS = 24;
+
+    /**
+     * @brief Cada cuanto se reenvia HOLD mientras un billete esta en custodia. El billetero acepta el billete con el
+     * siguiente poll, asi que mientras se espera la decision de JS solo se envia HOLD
+     */
+    static const int HOLDREFRESHMS = 500;
+
+    enum Action_t{
+        ACTION_ACCEPT = 0,          // El siguiente poll acepta el billete
+        ACTION_REJECT,              // Se envia REJECT apenas se conoce el canal
+        ACTION_HOLD,                // Se mantiene en custodia hasta acceptEscrow/reject o hasta HoldTimeout
+    };
+
+    enum Reason_t{
+        REASON_NONE = 0,
+        REASON_RULE,                // Regla del canal
+        REASON_SESSION_MAX,         // El billete supera el maximo de la sesion
+    };
+
+    struct Decision_t{
+        Action_t Action;
+        Reason_t Reason;
+    };
+
+    class EscrowPolicyClass{
+        public:
+
+            EscrowPolicyClass();
+
+            /**
+             * @brief Deja la politica sin reglas: todos los canales se aceptan y no hay maximo de sesion
+             */
+            void Clear();
+
+            /**
+             * @brief Asigna la accion de un canal
+             * @param Channel Canal del billete (1 a MAXCHANNELS)
+             * @param Action Accion cuando se lee un billete de ese canal
+             * @return int 0 si se asigno, 1 si el canal esta fuera de rango
+             */
+            int SetRule(int Channel, Action_t Action);
+
+            /**
+             * @brief Maximo en COP que se puede aceptar en la sesion, 0 sin maximo
+             */
+            void SetSessionMax(long Max);
+
+            /**
+             * @brief Tiempo maximo en custodia antes de rechazar el billete, en milisegundos
+             */
+            void SetHoldTimeout(int Ms);
+
+            /**
+             * @brief Decide que hacer con un billete leido
+             * @param Channel Canal del billete
+             * @param Bill Valor en COP del billete
+             * @return Decision_t Accion y motivo
+             */
+            Decision_t Decide(int Channel, int Bill) const;
+
+            /**
+             * @brief Suma un billete apilado al total de la sesion
+             */
+            void Credit(int Bill);
+
+            /**
+             * @brief Pone en cero el total de la sesion
+             */
+            void ResetSession();
+
+            long SessionTotal() const { return Total; }
+            long SessionMax() const { return Max; }
+            int HoldTimeout() const { return HoldTimeoutMs; }
+
+        private:
+            Action_t Rules[MAXCHANNELS];
+            long Max;                   // 0 sin maximo
+            long Total;                 // Suma de los billetes apilados desde ResetSession
+            int HoldTimeoutMs;
+    };
+
+};
+
+#endif /* ESCROWPOLICY_HPP */
@@ -16,37 +16,46 @@ namespace NV10Control{
     using namespace NV10StateMachine;
     using namespace ValidatorNV10;
 
-    // --------------- EXTERNAL VARIABLES --------------------//
-
-    // READ ONLY
-    int PortO;
-
-    // WRITE ONLY
-    std::string Path;
-    int LogLvl;
-    int MaximumPorts;
-    
     // --------------- INTERNAL VARIABLES --------------------//
     
-    std::string VERSION = "1.1";
-    std::string DEFAULTERROR = "DeafaultError";
-    bool FlagReading;
-    int Inhibit;
-    
-    Response_t Response;
-    BillError_t ResponseBEdef;
-    BillError_t LastResponseBE;
+    const std::string VERSION = "1.1";
+    const std::string DEFAULTERROR = "DeafaultError";
+
+    // Codigos que el billetero repite en cada poll mientras dura el estado (lectura, apilado, rechazo en curso,
+    // custodia, sin respuesta). Los demas son eventos de una vez (credito, apilado, rechazo, fraude) y nunca se omiten
+    static bool IsRepeatingStatus(int StatusCode){
+        switch (StatusCode){
+            case 301: case 302: case 303: case 304: case 305: case 307: case 315:
+            case 501: case 503: case 504: case 505: case 507:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Fallas que el billetero sigue reportando en cada poll mientras no se corrigen (atasco, caja llena, canal
+    // desconocido). Se entregan de nuevo solo si cambia el evento que las genera
+    static bool IsFaultStatus(int StatusCode){
+        return (StatusCode == 508) | (StatusCode == 510) | (StatusCode == 511);
+    }
     
-    NV10ControlClass::NV10ControlClass(){
+    NV10ControlClass::NV10ControlClass() : PollRate(PollScheduler::SSPMINMS, PollScheduler::SSPMAXMS) {
         
         PortO = 0;
 
         Path = "logs/NV10.log";
         LogLvl = 1;             
         MaximumPorts = 10;
+        RetryTimeoutMs = RETRYTIMEOUTMS;
+        MaxRetries = MAXRETRIES;
+        SyncAfter = SYNCAFTER;
 
         FlagReading = false;
-        Inhibit = 255;
+        Inhibit = (1 << MAXCHANNELS) - 1;
+        ActBill = 0;
+        ActChannel = 0;
+        Holding = false;
+        BillsPending = false;
         Response.StatusCode = 404;
         Response.Message = DEFAULTERROR;
 
@@ -65,9 +74,34 @@ namespace NV10Control{
         Globals.NV10Object.LoggerLevel = LogLvl;
         Globals.NV10Object.InitLogger(Path);
         Globals.NV10Object.MaxPorts = MaximumPorts;
+        Globals.NV10Object.RetryTimeoutMs = RetryTimeoutMs;
+        Globals.NV10Object.MaxRetries = MaxRetries;
+        Globals.NV10Object.SyncAfter = SyncAfter;
+        if (!CapturePath.empty()){
+            Globals.NV10Object.StartCapture(CapturePath);
+        }
+        if (!JournalPath.empty()){
+            if (Journal.Open(JournalPath) == 0){
+                Globals.NV10Object.logger->info("[InitLog] Event journal {0} opened, last sequence {1}",JournalPath,Journal.LastSequence());
+            }
+            else {
+                Globals.NV10Object.logger->error("[InitLog] Could not open event journal {0}",JournalPath);
+            }
+        }
+        if (!ChannelCachePath.empty()){
+            ChannelSetup_t Cached;
+            int Open = ChannelCache.Open(ChannelCachePath, sizeof(ChannelSetup_t));
+            if (Open < 0){
+                Globals.NV10Object.logger->error("[InitLog] Could not open channel cache {0}",ChannelCachePath);
+            }
+            else if ((Open == 0) && ChannelCache.Load(&Cached) && (Globals.NV10Object.SetChannelTable(Cached) == 0)){
+                Globals.NV10Object.logger->info("[InitLog] Channel cache {0} loaded, dataset {1} with {2} channels",ChannelCachePath,Cached.Dataset,Cached.Count);
+            }
+        }
     }
 
     Response_t NV10ControlClass::Connect() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
         
         int Connection = -1;
         int Disable = -1;
@@ -90,6 +124,8 @@ namespace NV10Control{
             //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
 
             if (Disable == 0){
+                // Si falla se sigue con la tabla de canales que ya estaba cargada
+                LoadChannels();
                 Response.StatusCode = 200;
                 Response.Message = "Billetero OK. Se sincronizo exitosamente";
             }
@@ -112,7 +148,39 @@ namespace NV10Control{
         return Response;
     }
 
+    int NV10ControlClass::LoadChannels() {
+        NV10Class &Validator = Globals.NV10Object;
+
+        // La version del dataset es la llave de la tabla: si no cambio, la tabla cargada (del cache o de la conexion
+        // anterior) sigue valida y no se pide SETUP_REQUEST. Se compara tal como se guarda en Setup.Dataset
+        std::string Dataset;
+        if (Validator.DatasetRequest() == 0){
+            Dataset = Validator.DatasetVersion.substr(0, Validator.DatasetVersion.find('\0'));
+            Dataset = Dataset.substr(0, MAXDATASET);
+            if (Dataset == Validator.Setup.Dataset){
+                Validator.logger->info("[LoadChannels] Dataset {0} unchanged, using {1} cached channels",Dataset,Validator.Setup.Count);
+                return 0;
+            }
+        }
+        else {
+            // Billeteros sin GET_DATASET_VERSION: siempre se lee la tabla, sin comparar con el cache
+            Validator.logger->warn("[LoadChannels] Dataset version unknown, requesting channels with SETUP_REQUEST");
+        }
+        if (Validator.SetupRequest() != 0){
+            return 1;
+        }
+
+        memset(Validator.Setup.Dataset, 0, sizeof(Validator.Setup.Dataset));
+        memcpy(Validator.Setup.Dataset, Dataset.data(), Dataset.size());
+        Validator.logger->info("[LoadChannels] Dataset {0}, firmware {1}: {2} channels loaded",Validator.Setup.Dataset,Validator.Setup.Firmware,Validator.Setup.Count);
+        if (ChannelCache.IsOpen() && (ChannelCache.Save(&Validator.Setup) != 0)){
+            Validator.logger->error("[LoadChannels] Could not save channel cache {0}",ChannelCachePath);
+        }
+        return 0;
+    }
+
     Response_t NV10ControlClass::CheckDevice() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         int Check = -1;
 
@@ -139,6 +207,7 @@ namespace NV10Control{
     }
 
     Response_t NV10ControlClass::StartReader() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
         
         int Enable = -1;
         int Poll = -1;
@@ -149,10 +218,10 @@ namespace NV10Control{
 
         //Deberia entrar aca desde el estado ST_DISABLE
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
-        if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_DISABLE") == 0){
+        if (Globals.SMObject.SM.CurrState == NV10SMClass::ST_DISABLE){
             FlagReady = true;
         }
-        else if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_POLLING") == 0){
+        else if (Globals.SMObject.SM.CurrState == NV10SMClass::ST_POLLING){
             FlagInState = true;
         }
         else {
@@ -177,6 +246,7 @@ namespace NV10Control{
                     Response.StatusCode = 202;
                     Response.Message = "Billetero OK. Listo para iniciar a leer billetes";
                     FlagFinish = true;
+                    PollRate.Start(std::chrono::steady_clock::now());
                 }
             }
         }
@@ -201,6 +271,17 @@ namespace NV10Control{
     }
 
     BillError_t NV10ControlClass::GetBill() {
+        CommandTicket Ticket(Scheduler, PRIORITY_POLL);
+
+        // Primero se entregan los eventos que quedaron de un poll anterior, sin volver a preguntar al billetero
+        if (!PendingBills.empty()){
+            return NextBill();
+        }
+
+        // Con un billete en custodia no se hace poll, porque el poll lo acepta
+        if (Holding & (Globals.SMObject.SM.CurrState == NV10SMClass::ST_POLLING)){
+            return HoldBill();
+        }
 
         BillError_t ResponseBE;
 
@@ -211,15 +292,11 @@ namespace NV10Control{
         int Poll = -1;
         int Length = 0;
         int ErrorC = 0;
-        int EventC = 0;
-        int AdEventC = 0;
-        int Bill = 0;
-        int BillC = 0;
 
         //Deberia entrar aca desde el estado ST_POLLING
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
 
-        if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_POLLING") == 0){
+        if (Globals.SMObject.SM.CurrState == NV10SMClass::ST_POLLING){
 
             //Cambio de estado: ST_POLLING ---> ST_POLLING
             Poll = Globals.SMObject.StateMachineRun(NV10SMClass::EV_POLL);
@@ -247,202 +324,315 @@ namespace NV10Control{
                         ResponseBE.Message = "No hay billete. Comando no puede ser procesado";
                     }
                 }
-                //Si la longitud es igual o mayor a 2 se puede comenzar a revisar los eventos
-                else if (Length >= 2){
-                    EventC = Globals.NV10Object.EventOCode;
-                    //Si el codigo de evento es READ-239 significa que detecto un billete en la entrada
-                    if (EventC == 239){
-                        Bill = Globals.NV10Object.Bill;
-                        ResponseBE.Bill = Bill;
-                        // Si el billete es 0 esta en el estado inicial de READ
-                        if (Bill == 0){
-                            // El estado normal de FlagReading en este punto es false, si es true es porque algo salio mal antes
-                            if (FlagReading == false){
-                                ResponseBE.StatusCode = 303;
-                                ResponseBE.Message = "Leyendo billete. Se desconoce su valor";
-                            }
-                            else {
-                                ResponseBE.StatusCode = 507;
-                                ResponseBE.Message = "Error en secuencia del billetero. El anterior billete se pudo perder";
-                            }
+                //Si la longitud es igual o mayor a 2 se revisan todos los eventos del poll, en orden
+                else if ((Length >= 2) & (!Globals.NV10Object.Events.empty())){
+                    // Solo los eventos nuevos cuentan como actividad, una falla repetida no mantiene el intervalo corto
+                    bool Queued = false;
+                    for (size_t i = 0; i < Globals.NV10Object.Events.size(); i++){
+                        if (QueueBill(HandleBillEvent(i))){
+                            Queued = true;
                         }
-                        else {
-                            BillC = Globals.NV10Object.Channel;
-                            if ((BillC >= 1) & (BillC <= 7)){
-                                std::bitset<8> Bits(Inhibit);
-                                if (Bits[BillC-1] == 0){
-                                    Response = Reject();
-                                    if (Response.StatusCode == 206){
-                                        ResponseBE.StatusCode = 311;
-                                        ResponseBE.Message = "Billete inhibido. Esperando a que el usuario retire el billete";
-                                        FlagReading = false;
-                                    }
-                                    else {
-                                        ResponseBE.StatusCode = 501;
-                                        ResponseBE.Message = "Fallo con el billetero. No responde";
-                                        FlagReading = false;
-                                    }
-                                }
-                                else {
-                                    ResponseBE.StatusCode = 304;
-                                    ResponseBE.Message = "Leyendo billete. Billete detectado exitosamente";
-                                    FlagReading = true;
-                                }
-                            }
-                            else {
-                                ResponseBE.StatusCode = 511;
-                                ResponseBE.Message = "Fallo con el codigo. Canal de billete desconocido";
-                                FlagReading = false;
-                            }
-                        }
-                    }
-                    //Si el codigo de evento es REJECTING-237 significa que rechazo el billete que detecto pero no lo han retirado
-                    else if (EventC == 237){
-                        ResponseBE.StatusCode = 305;
-                        ResponseBE.Message = "Billete rechazado. Esperando a que el usuario retire el billete";
-                        FlagReading = false;
                     }
-                    //Si el codigo de evento es REJECTED-236 significa que el cliente retiro el billete que se rechazo
-                    else if (EventC == 236){
-                        ResponseBE.StatusCode = 306;
-                        ResponseBE.Message = "Billete rechazado. Usuario retiro el billete";
-                        FlagReading = false;
+                    SchedulePoll(Queued);
+                    return NextBill();
+                }
+                // Aca entra unicamente cuando la longitud es 0
+                else {
+                    ResponseBE.StatusCode = 505;
+                    ResponseBE.Message = "Fallo en la respuesta. Longitud invalida";
+                }
+            }
+            //Si el billetero envia un comando repetido [Poll = 2], quiere decir que no hay que volver a leer la respuesta
+            else if (Poll == 2){
+                ResponseBE.StatusCode = 301;
+                ResponseBE.Message = "Billetero OK. Comando repetido, la respuesta ya fue vista anteriormente";
+            }
+            //Si Poll da un error de lectura, significa que el billetero no responde
+            else {
+                ResponseBE.StatusCode = 501;
+                ResponseBE.Message = "Fallo con el billetero. No responde";
+            }
+            SchedulePoll(false);
+        }
+        else {
+            ResponseBE.StatusCode = 503;
+            ResponseBE.Message = "No se ha iniciado el lector (StartReader)";
+        }
 
-                    }
-                    //Si el codigo de evento es STACKING-204 significa que esta apilando el billete que ya leyo
-                    else if (EventC == 204){
-                        Bill = Globals.NV10Object.Bill;
-                        ResponseBE.Bill = Bill;
-                        FlagReading = true;
-                        ResponseBE.StatusCode = 307;
-                        ResponseBE.Message = "Billete leido. Apilando billete";                    
-                    }
-                    //Si el codigo de evento es STACKED-235 significa que apilo el billete leido
-                    else if (EventC == 235){
-                        if (FlagReading){
-                            if (LastResponseBE.StatusCode != 312){
-                                Bill = Globals.NV10Object.Bill;
-                                ResponseBE.Bill = Bill;
-                                ResponseBE.StatusCode = 308;
-                                ResponseBE.Message = "Billete apilado";
-                                FlagReading = false;
-                            }
-                            else{
-                                ResponseBE.StatusCode = 302;
-                                ResponseBE.Message = "Billetero OK. No hay nueva informacion";
-                            }
+        QueueBill(ResponseBE);
+        return NextBill();
+    }
+
+    void NV10ControlClass::SchedulePoll(bool Events) {
+        std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+        if (Events){
+            PollRate.Activity(Now);
+        }
+        // Un billete en lectura o en custodia mantiene el intervalo corto hasta que se apila o se devuelve
+        PollRate.SetBusy(FlagReading | Holding, Now);
+        PollRate.Next(Now);
+    }
+
+    BillError_t NV10ControlClass::HandleBillEvent(size_t &Index) {
+        const std::vector<PollEvent_t> &Events = Globals.NV10Object.Events;
+        const PollEvent_t &Event = Events[Index];
+
+        BillError_t ResponseBE;
+
+        ResponseBE.StatusCode = 404;
+        ResponseBE.Bill = 0;
+        ResponseBE.Message = DEFAULTERROR;
+
+        int EventC = Event.Code;
+        int AdEventC = 0;
+        int BillC = 0;
+
+        ResponseBE.Event = EventC;
+
+        // Los eventos con canal actualizan el billete en curso, STACKING y STACKED se refieren a ese billete
+        if (Event.Channel > 0){
+            ActBill = Event.Bill;
+            ActChannel = Event.Channel;
+        }
+
+        //Si el codigo de evento es READ-239 significa que detecto un billete en la entrada
+        if (EventC == 239){
+            ResponseBE.Bill = Event.Bill;
+            // Si el billete es 0 esta en el estado inicial de READ
+            if (Event.Bill == 0){
+                // El estado normal de FlagReading en este punto es false, si es true es porque algo salio mal antes
+                if (FlagReading == false){
+                    ResponseBE.StatusCode = 303;
+                    ResponseBE.Message = "Leyendo billete. Se desconoce su valor";
+                }
+                else {
+                    ResponseBE.StatusCode = 507;
+                    ResponseBE.Message = "Error en secuencia del billetero. El anterior billete se pudo perder";
+                }
+            }
+            else {
+                BillC = Event.Channel;
+                if ((BillC >= 1) & (BillC <= Globals.NV10Object.Setup.Count)){
+                    std::bitset<MAXCHANNELS> Bits(Inhibit);
+                    if (Bits[BillC-1] == 0){
+                        Response = Reject();
+                        if (Response.StatusCode == 206){
+                            ResponseBE.StatusCode = 311;
+                            ResponseBE.Message = "Billete inhibido. Esperando a que el usuario retire el billete";
+                            FlagReading = false;
                         }
                         else {
-                            ResponseBE.StatusCode = 302;
-                            ResponseBE.Message = "Billetero OK. No hay nueva informacion";
+                            ResponseBE.StatusCode = 501;
+                            ResponseBE.Message = "Fallo con el billetero. No responde";
+                            FlagReading = false;
                         }
                     }
-                    // Si el codigo de evento es CREDIT-238 significa que reconocio el billete y probablemente ya esta apilado
-                    else if (EventC == 238){
-                        Bill = Globals.NV10Object.Bill;
-                        ResponseBE.Bill = Bill;
-                        //Si la longitud es 3 no hay evento de codigo adicional
-                        if (Length == 3){
-                            ResponseBE.StatusCode = 309;
-                            ResponseBE.Message = "Billete acreditado, listo para apilar";
-                        }
-                        //Si la longitud es 4, hay evento de codigo adicional
-                        else if (Length == 4){
-                            AdEventC = Globals.NV10Object.AdEventOCode;
-                            // Si el codigo de evento adicional es STACKED-235 significa que apilo el billete leido
-                            if ((AdEventC == 204) | (AdEventC == 235)){
-                                if (FlagReading){
-                                    ResponseBE.StatusCode = 312;
-                                    ResponseBE.Message = "Billete acreditado y apilado";
-                                    FlagReading = false;
-                                }
-                                else {
-                                    ResponseBE.Bill = 0;
-                                    ResponseBE.StatusCode = 302;
-                                    ResponseBE.Message = "Billetero OK. No hay nueva informacion";
-                                }
+                    else {
+                        // La politica de custodia decide en el mismo poll en que se conoce el canal
+                        EscrowPolicy::Decision_t Decision = Policy.Decide(BillC, Event.Bill);
+                        if (Decision.Action == EscrowPolicy::ACTION_REJECT){
+                            Response = Reject();
+                            if ((Response.StatusCode == 206) & (Decision.Reason == EscrowPolicy::REASON_SESSION_MAX)){
+                                ResponseBE.StatusCode = 314;
+                                ResponseBE.Message = "Billete rechazado. Supera el maximo de la sesion";
+                            }
+                            else if (Response.StatusCode == 206){
+                                ResponseBE.StatusCode = 313;
+                                ResponseBE.Message = "Billete rechazado por la politica de custodia";
                             }
-                            // Si el evento adicional no es ni STACKING ni STACKED, hubo un error grave con la respuesta
                             else {
-                                ResponseBE.StatusCode = 508;
-                                ResponseBE.Message = "Billete acreditado, pero con error: " + Globals.NV10Object.AdEventOMsg;
+                                ResponseBE.StatusCode = 501;
+                                ResponseBE.Message = "Fallo con el billetero. No responde";
                             }
-                        }
-                        // Para un evento CREDIT la longitud no puede ser diferente de 3 o de 4
-                        else {
-                            ResponseBE.StatusCode = 508;
-                            ResponseBE.Message = "Billete acreditado, pero con error: " + Globals.NV10Object.AdEventOMsg;
-                        }
-                        FlagReading = false;
-                    }
-                    // Si el codigo de evento es STACKED-235 significa que apilo el billete que anteriormente leyo y acredito
-                    else if (EventC == 235){
-                        Bill = Globals.NV10Object.Bill;
-                        ResponseBE.Bill = Bill;
-                        if ((FlagReading) & (Bill > 0)){
-                            ResponseBE.StatusCode = 308;
-                            ResponseBE.Message = "Billete apilado";   
-                            FlagReading = false; 
-                        }
-                        else if (FlagReading == false){
-                            ResponseBE.StatusCode = 310;
-                            ResponseBE.Message = "Billetero OK. Billete apilado. No hay nueva informacion"; 
-                        }
-                        else {
-                            ResponseBE.StatusCode = 509;
-                            ResponseBE.Message = "Billete apilado pero no se sabe su valor";
                             FlagReading = false;
                         }
-                    }
-                    // Otro codigo de evento significa que hubo un error grave
-                    else {
-                        if(Length == 3){
-                            Bill = Globals.NV10Object.Bill;
-                            ResponseBE.Bill = Bill;
+                        else if (Decision.Action == EscrowPolicy::ACTION_HOLD){
+                            if (Globals.NV10Object.Hold() == 0){
+                                Holding = true;
+                                HoldStart = std::chrono::steady_clock::now();
+                                LastHold = HoldStart;
+                                ResponseBE.StatusCode = 315;
+                                ResponseBE.Message = "Billete en custodia. Esperando acceptEscrow o reject";
+                                FlagReading = true;
+                            }
+                            else {
+                                ResponseBE.StatusCode = 501;
+                                ResponseBE.Message = "Fallo con el billetero. No responde";
+                                FlagReading = false;
+                            }
                         }
                         else {
-                            ResponseBE.Bill = 0;
+                            ResponseBE.StatusCode = 304;
+                            ResponseBE.Message = "Leyendo billete. Billete detectado exitosamente";
+                            FlagReading = true;
                         }
-                        std::string BillStr = std::to_string(ResponseBE.Bill);
-                        ResponseBE.StatusCode = 510;
-                        ResponseBE.Message = "Error grave en el Billetero: " + Globals.NV10Object.EventOMsg; + "con  el billete: " + BillStr;
                     }
                 }
-                // Aca entra unicamente cuando la longitud es 0
                 else {
-                    ResponseBE.StatusCode = 505;
-                    ResponseBE.Message = "Fallo en la respuesta. Longitud invalida";
+                    ResponseBE.StatusCode = 511;
+                    ResponseBE.Message = "Fallo con el codigo. Canal de billete desconocido";
+                    FlagReading = false;
                 }
             }
-            //Si el billetero envia un comando repetido [Poll = 2], quiere decir que no hay que volver a leer la respuesta
-            else if (Poll == 2){
-                ResponseBE.StatusCode = 301;
-                ResponseBE.Message = "Billetero OK. Comando repetido, la respuesta ya fue vista anteriormente";
+        }
+        //Si el codigo de evento es REJECTING-237 significa que rechazo el billete que detecto pero no lo han retirado
+        else if (EventC == 237){
+            ResponseBE.StatusCode = 305;
+            ResponseBE.Message = "Billete rechazado. Esperando a que el usuario retire el billete";
+            FlagReading = false;
+        }
+        //Si el codigo de evento es REJECTED-236 significa que el cliente retiro el billete que se rechazo
+        else if (EventC == 236){
+            ResponseBE.StatusCode = 306;
+            ResponseBE.Message = "Billete rechazado. Usuario retiro el billete";
+            FlagReading = false;
+
+        }
+        //Si el codigo de evento es STACKING-204 significa que esta apilando el billete que ya leyo
+        else if (EventC == 204){
+            ResponseBE.Bill = ActBill;
+            FlagReading = true;
+            ResponseBE.StatusCode = 307;
+            ResponseBE.Message = "Billete leido. Apilando billete";                    
+        }
+        //Si el codigo de evento es STACKED-235 significa que apilo el billete leido
+        else if (EventC == 235){
+            if (FlagReading){
+                if (LastResponseBE.StatusCode != 312){
+                    ResponseBE.Bill = ActBill;
+                    ResponseBE.StatusCode = 308;
+                    ResponseBE.Message = "Billete apilado";
+                    FlagReading = false;
+                }
+                else{
+                    ResponseBE.StatusCode = 302;
+                    ResponseBE.Message = "Billetero OK. No hay nueva informacion";
+                }
             }
-            //Si Poll da un error de lectura, significa que el billetero no responde
             else {
-                ResponseBE.StatusCode = 501;
-                ResponseBE.Message = "Fallo con el billetero. No responde";
+                ResponseBE.StatusCode = 302;
+                ResponseBE.Message = "Billetero OK. No hay nueva informacion";
             }
         }
+        // Si el codigo de evento es CREDIT-238 significa que reconocio el billete y probablemente ya esta apilado
+        else if (EventC == 238){
+            ResponseBE.Bill = Event.Bill;
+            // Si el canal no corresponde a ningun billete no se sabe que se acredito
+            if (Event.Bill == 0){
+                ResponseBE.StatusCode = 508;
+                ResponseBE.Message = "Billete acreditado, pero con error: canal desconocido";
+            }
+            //Si no sigue un evento de apilado el billete queda acreditado y el apilado llega despues
+            else if ((Index + 1) >= Events.size()){
+                ResponseBE.StatusCode = 309;
+                ResponseBE.Message = "Billete acreditado, listo para apilar";
+            }
+            else {
+                AdEventC = Events[Index + 1].Code;
+                // Si el evento siguiente es STACKING-204 o STACKED-235 se reporta junto con el credito y se consume
+                if ((AdEventC == 204) | (AdEventC == 235)){
+                    Index++;
+                    if (FlagReading){
+                        ResponseBE.StatusCode = 312;
+                        ResponseBE.Message = "Billete acreditado y apilado";
+                    }
+                    else {
+                        ResponseBE.Bill = 0;
+                        ResponseBE.StatusCode = 302;
+                        ResponseBE.Message = "Billetero OK. No hay nueva informacion";
+                    }
+                }
+                else {
+                    ResponseBE.StatusCode = 309;
+                    ResponseBE.Message = "Billete acreditado, listo para apilar";
+                }
+            }
+            // El billetero envia un CREDIT por billete: se acredita aqui aunque el apilado llegue en otro poll
+            if (Event.Bill != 0){
+                Journal.Append(SerialCapture::DEVICE_NV10, EventJournal::EVENT_BILL_ACCEPTED, Event.Bill, Event.Channel, ResponseBE.StatusCode);
+                Policy.Credit(Event.Bill);
+            }
+            FlagReading = false;
+        }
+        // Otro codigo de evento significa que hubo un error grave
         else {
-            ResponseBE.StatusCode = 503;
-            ResponseBE.Message = "No se ha iniciado el lector (StartReader)";
+            ResponseBE.Bill = Event.Bill;
+            std::string BillStr = std::to_string(ResponseBE.Bill);
+            ResponseBE.StatusCode = 510;
+            ResponseBE.Message = "Error grave en el Billetero: " + std::string(Event.Message) + " con el billete: " + BillStr;
+        }
+        return ResponseBE;
+    }
+
+    bool NV10ControlClass::QueueBill(const BillError_t &ResponseBE) {
+        // Dos billetes iguales en el mismo poll llegan como dos eventos con el mismo codigo y los dos se entregan
+        if (IsRepeatingStatus(ResponseBE.StatusCode) & (LastResponseBE.StatusCode == ResponseBE.StatusCode)){
+            return false;
+        }
+        if (IsFaultStatus(ResponseBE.StatusCode) & (LastResponseBE.StatusCode == ResponseBE.StatusCode) & (LastResponseBE.Event == ResponseBE.Event)){
+            return false;
+        }
+        if (ResponseBE.StatusCode == 303){
+            std::cout<<"-----------------------------------------------------------------------------------------------------"<<std::endl;
         }
+        // Los billetes aceptados se anotan en HandleBillEvent con el CREDIT, aqui solo los rechazos
+        if (ResponseBE.StatusCode == 305){
+            Journal.Append(SerialCapture::DEVICE_NV10, EventJournal::EVENT_BILL_REJECTED, 0, 0, ResponseBE.StatusCode);
+        }
+        LastResponseBE = ResponseBE;
+        PendingBills.push_back(ResponseBE);
+        BillsPending = true;
+        return true;
+    }
 
-        if (LastResponseBE.StatusCode == ResponseBE.StatusCode){
+    BillError_t NV10ControlClass::NextBill() {
+        if (PendingBills.empty()){
             return ResponseBEdef;
         }
-        else{
-            if (ResponseBE.StatusCode == 303){
-                std::cout<<"-----------------------------------------------------------------------------------------------------"<<std::endl;
-            }
-            LastResponseBE = ResponseBE;
-            return ResponseBE;
-        }   
+        BillError_t ResponseBE = PendingBills.front();
+        PendingBills.pop_front();
+        BillsPending = !PendingBills.empty();
+        return ResponseBE;
     }
     
+    BillError_t NV10ControlClass::HoldBill() {
+        std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+
+        // Si JS no decide a tiempo el billete se rechaza
+        if (Now - HoldStart >= std::chrono::milliseconds(Policy.HoldTimeout())){
+            BillError_t ResponseBE;
+            ResponseBE.Bill = ActBill;
+            Response = Reject();
+            if (Response.StatusCode == 206){
+                ResponseBE.StatusCode = 316;
+                ResponseBE.Message = "Tiempo de custodia agotado. Billete rechazado";
+            }
+            else {
+                ResponseBE.StatusCode = 501;
+                ResponseBE.Message = "Fallo con el billetero. No responde";
+            }
+            Holding = false;
+            FlagReading = false;
+            QueueBill(ResponseBE);
+            return NextBill();
+        }
+
+        if (Now - LastHold >= std::chrono::milliseconds(EscrowPolicy::HOLDREFRESHMS)){
+            LastHold = Now;
+            if (Globals.NV10Object.Hold() != 0){
+                BillError_t ResponseBE;
+                ResponseBE.StatusCode = 501;
+                ResponseBE.Bill = ActBill;
+                ResponseBE.Message = "Fallo con el billetero. No responde";
+                QueueBill(ResponseBE);
+                return NextBill();
+            }
+        }
+        return ResponseBEdef;
+    }
+
     Response_t NV10ControlClass::ModifyChannels(int InhibitMask1) {
+        CommandTicket Ticket(Scheduler, PRIORITY_URGENT);
 
         Inhibit = InhibitMask1;
 
@@ -453,14 +643,18 @@ namespace NV10Control{
     }
 
     Response_t NV10ControlClass::StopReader() {
+        CommandTicket Ticket(Scheduler, PRIORITY_URGENT);
               
         //Deberia entrar aca desde el estado ST_POLLING
 
         int Check = -1;
         int Disable = -1;
 
+        // Si quedo un billete en custodia, al deshabilitar el billetero lo devuelve
+        Holding = false;
+
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
-        if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_POLLING") == 0){
+        if (Globals.SMObject.SM.CurrState == NV10SMClass::ST_POLLING){
             //Cambio de estado: ST_POLLING ---> ST_CHECK
             Check = Globals.SMObject.StateMachineRun(NV10SMClass::EV_FINISH_POLL);
             //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
@@ -497,10 +691,12 @@ namespace NV10Control{
     }
 
     Response_t NV10ControlClass::Reject() {
+        CommandTicket Ticket(Scheduler, PRIORITY_URGENT);
 
         int Reject = Globals.NV10Object.Reject();
 
         if (Reject == 0){
+            Holding = false;
             Response.StatusCode = 206;
             Response.Message = "Billetero OK. Reject corrio exitosamente";
         }
@@ -512,7 +708,59 @@ namespace NV10Control{
         return Response;
     }
 
+    Response_t NV10ControlClass::SetEscrowPolicy(const std::vector<EscrowPolicy::Action_t> &Rules, long SessionMax, int HoldTimeoutMs) {
+        CommandTicket Ticket(Scheduler, PRIORITY_URGENT);
+
+        if (Rules.size() > static_cast<size_t>(EscrowPolicy::MAXCHANNELS)){
+            Response.StatusCode = 514;
+            Response.Message = "Politica de custodia invalida. Demasiados canales";
+            return Response;
+        }
+
+        // La politica nueva reemplaza la anterior, el total de la sesion se conserva
+        Policy.Clear();
+        for (size_t i = 0; i < Rules.size(); i++){
+            Policy.SetRule(i + 1, Rules[i]);
+        }
+        Policy.SetSessionMax(SessionMax);
+        Policy.SetHoldTimeout(HoldTimeoutMs);
+
+        Response.StatusCode = 207;
+        Response.Message = "Billetero OK. Politica de custodia configurada";
+
+        return Response;
+    }
+
+    Response_t NV10ControlClass::AcceptEscrow() {
+        CommandTicket Ticket(Scheduler, PRIORITY_URGENT);
+
+        // El siguiente poll acepta el billete que esta en custodia
+        if (Holding){
+            Holding = false;
+            Response.StatusCode = 208;
+            Response.Message = "Billetero OK. Billete en custodia aceptado";
+        }
+        else {
+            Response.StatusCode = 515;
+            Response.Message = "No hay billete en custodia";
+        }
+
+        return Response;
+    }
+
+    Response_t NV10ControlClass::ResetEscrowSession() {
+        CommandTicket Ticket(Scheduler, PRIORITY_URGENT);
+
+        Policy.ResetSession();
+
+        Response.StatusCode = 209;
+        Response.Message = "Billetero OK. Sesion de custodia reiniciada";
+
+        return Response;
+    }
+
     TestStatus_t NV10ControlClass::TestStatus() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         TestStatus_t Status;
         
@@ -543,5 +791,33 @@ namespace NV10Control{
         }
         return Status;
     }
-}
 
+    long NV10ControlClass::DumpFlightRecorder() {
+        // Sin turno del planificador: el flight recorder se lee sin locks y no usa el puerto serial
+        return Globals.NV10Object.DumpRecorder("N-API");
+    }
+
+    size_t NV10ControlClass::GetEvents(uint64_t Since, std::vector<EventJournal::Event_t> &Events) {
+        // Sin turno del planificador: el diario tiene su propio mutex y no usa el puerto serial
+        return Journal.ReadSince(Since, Events, EventJournal::READLIMIT);
+    }
+
+    LinkStats_t NV10ControlClass::GetLinkStats() {
+        // Los contadores los actualiza el hilo que tiene el puerto, se copian con turno para leerlos completos
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
+        return Globals.NV10Object.Link;
+    }
+
+    PollScheduler::Stats_t NV10ControlClass::GetPollStats() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
+        return PollRate.Stats(std::chrono::steady_clock::now());
+    }
+
+    int NV10ControlClass::PollDelayMs() {
+        // Los eventos que quedaron de un poll se entregan seguidos, sin esperar el intervalo entre polls
+        if (BillsPending){
+            return 0;
+        }
+        return PollRate.Interval();
+    }
+}
@@ -16,12 +16,21 @@
 #include <string>
 #include <iostream>
 #include <bitset> //To use bitset in GetBill()
+#include <deque>
+#include <chrono>
+#include <atomic>
 #include "StateMachine.hpp"
+#include "../common/CommandScheduler.hpp"
+#include "../common/EventJournal.hpp"
+#include "../common/PollScheduler.hpp"
+#include "../common/StateFile.hpp"
 #include "ValidatorNV10.hpp"
+#include "EscrowPolicy.hpp"
 
 namespace NV10Control{
 
     using namespace NV10StateMachine;
+    using namespace CommandScheduler;
     using namespace ValidatorNV10;
 
     struct Response_t{
@@ -33,6 +42,7 @@ namespace NV10Control{
         int StatusCode;
         int Bill;
         std::string Message;
+        int Event = 0;          // Codigo de evento SSP que genero el reporte, 0 si no viene de un evento del poll
     };
 
     struct TestStatus_t{
@@ -61,22 +71,61 @@ namespace NV10Control{
 
             //WRITE ONLY
             std::string Path;
+            std::string CapturePath;    // Vacio: sin captura binaria del trafico serial
+            std::string JournalPath;    // Vacio: sin diario de eventos
+            std::string ChannelCachePath;   // Vacio: sin cache, la tabla de canales se pide en cada conexion
             int LogLvl;
             int MaximumPorts;
+            int RetryTimeoutMs;         // Espera de cada intento SSP (ms)
+            int MaxRetries;             // Reenvios de la misma trama
+            int SyncAfter;              // Comandos fallidos seguidos antes de SYNC
+
+            //INTERNAL
+            bool FlagReading;
+            int Inhibit;                            // Bit i en 0: canal i + 1 inhibido (hasta MAXCHANNELS canales)
+            Response_t Response;
+            BillError_t ResponseBEdef;
+            BillError_t LastResponseBE;
+            std::deque<BillError_t> PendingBills;  // Eventos de un poll que aun no se entregan a JS
+            std::atomic<bool> BillsPending;        // PendingBills no esta vacia, se lee sin turno desde PollDelayMs
+            int ActBill;                            // Billete en curso (ultimo READ/CREDIT con canal)
+            int ActChannel;
+            EscrowPolicy::EscrowPolicyClass Policy;
+            bool Holding;                           // Hay un billete en custodia esperando la decision de JS
+            std::chrono::steady_clock::time_point HoldStart;
+            std::chrono::steady_clock::time_point LastHold;
 
             GlobalVariables Globals;
+            CommandSchedulerClass Scheduler;
+            EventJournal::EventJournalClass Journal;
+            StateFile::StateFileClass ChannelCache;
+            PollScheduler::PollSchedulerClass PollRate; // Espera entre polls de onBill
             
             NV10ControlClass();
             ~NV10ControlClass();
             void InitLog();
             Response_t Connect();
+            int LoadChannels();
             Response_t CheckDevice();
             Response_t StartReader();
             BillError_t GetBill();
+            BillError_t HandleBillEvent(size_t &Index);
+            bool QueueBill(const BillError_t &ResponseBE);
+            BillError_t NextBill();
+            BillError_t HoldBill();
             Response_t ModifyChannels(int InhibitMask1);
             Response_t StopReader();
             Response_t Reject();
+            Response_t SetEscrowPolicy(const std::vector<EscrowPolicy::Action_t> &Rules, long SessionMax, int HoldTimeoutMs);
+            Response_t AcceptEscrow();
+            Response_t ResetEscrowSession();
             TestStatus_t TestStatus();
+            long DumpFlightRecorder();
+            size_t GetEvents(uint64_t Since, std::vector<EventJournal::Event_t> &Events);
+            LinkStats_t GetLinkStats();
+            void SchedulePoll(bool Events);
+            PollScheduler::Stats_t GetPollStats();
+            int PollDelayMs();
     };
 }
 
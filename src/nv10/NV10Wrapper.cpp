@@ -1,11 +1,52 @@
 #include "NV10Wrapper.hpp"
 
-std::thread nativeThreadNv10;
-Napi::ThreadSafeFunction tsfnNv10;
-static bool isRunningNv10 = true;
-static bool threadEndedNv10 = true;
+// Mensajes de getBill/onBill para el modo compacto. Los codigos 504/508/510 llevan el detalle del error en el
+// mensaje completo, por eso aqui solo se deja su descripcion general
+static const StatusMessage_t BillMessages[] = {
+  { 301, "Billetero OK. Comando repetido, la respuesta ya fue vista anteriormente" },
+  { 302, "Billetero OK. No hay nueva informacion" },
+  { 303, "Leyendo billete. Se desconoce su valor" },
+  { 304, "Leyendo billete. Billete detectado exitosamente" },
+  { 305, "Billete rechazado. Esperando a que el usuario retire el billete" },
+  { 306, "Billete rechazado. Usuario retiro el billete" },
+  { 307, "Billete leido. Apilando billete" },
+  { 308, "Billete apilado" },
+  { 309, "Billete acreditado, listo para apilar" },
+  { 310, "Billetero OK. Billete apilado. No hay nueva informacion" },
+  { 311, "Billete inhibido. Esperando a que el usuario retire el billete" },
+  { 312, "Billete acreditado y apilado" },
+  { 313, "Billete rechazado por la politica de custodia" },
+  { 314, "Billete rechazado. Supera el maximo de la sesion" },
+  { 315, "Billete en custodia. Esperando acceptEscrow o reject" },
+  { 316, "Tiempo de custodia agotado. Billete rechazado" },
+  { 404, "DeafaultError" },
+  { 501, "Fallo con el billetero. No responde" },
+  { 503, "No se ha iniciado el lector (StartReader)" },
+  { 504, "Falla en el comando" },
+  { 505, "Fallo en la respuesta. Comando no puede ser procesado" },
+  { 507, "Error en secuencia del billetero. El anterior billete se pudo perder" },
+  { 508, "Billete acreditado, pero con error" },
+  { 509, "Billete apilado pero no se sabe su valor" },
+  { 510, "Error grave en el Billetero" },
+  { 511, "Fallo con el codigo. Canal de billete desconocido" },
+};
 
-Napi::FunctionReference NV10Wrapper::constructor;
+static Napi::Object BillResult(Napi::Env env, const BillError_t &bill, bool compact) {
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  if (compact) {
+    Field_t fields[] = {
+      { KEY_STATUS_CODE,  cache->Number(env, bill.StatusCode) },
+      { KEY_BILL,         cache->Number(env, bill.Bill) },
+    };
+    return cache->Build(env, fields);
+  }
+  Field_t fields[] = {
+    { KEY_STATUS_CODE,  cache->Number(env, bill.StatusCode) },
+    { KEY_BILL,         cache->Number(env, bill.Bill) },
+    { KEY_MESSAGE,      cache->Message(env, bill.StatusCode, bill.Message) },
+  };
+  return cache->Build(env, fields);
+}
 
 Napi::Object NV10Wrapper::Init(Napi::Env env, Napi::Object exports) {
   Napi::HandleScope scope(env);
@@ -19,9 +60,17 @@ Napi::Object NV10Wrapper::Init(Napi::Env env, Napi::Object exports) {
     InstanceMethod("reject", &NV10Wrapper::Reject),
     InstanceMethod("testStatus", &NV10Wrapper::TestStatus),
     InstanceMethod("onBill", &NV10Wrapper::OnBill),
+    InstanceMethod("getQueueStats", &NV10Wrapper::GetQueueStats),
+    InstanceMethod("dumpFlightRecorder", &NV10Wrapper::DumpFlightRecorder),
+    InstanceMethod("getEvents", &NV10Wrapper::GetEvents),
+    InstanceMethod("setEscrowPolicy", &NV10Wrapper::SetEscrowPolicy),
+    InstanceMethod("acceptEscrow", &NV10Wrapper::AcceptEscrow),
+    InstanceMethod("resetEscrowSession", &NV10Wrapper::ResetEscrowSession),
+    InstanceMethod("getLinkStats", &NV10Wrapper::GetLinkStats),
+    InstanceMethod("getPollStats", &NV10Wrapper::GetPollStats),
+    StaticValue("messages", ResultCacheClass::Get(env)->MessageTable(env, BillMessages, sizeof(BillMessages)/sizeof(BillMessages[0]))),
   });
-  constructor = Napi::Persistent(func);
-  constructor.SuppressDestruct();
+  env.GetInstanceData<AddonData::AddonDataClass>()->NV10Constructor = Napi::Persistent(func);
   exports.Set("NV10", func);
   return exports;
 }
@@ -52,49 +101,71 @@ NV10Wrapper::NV10Wrapper(const Napi::CallbackInfo& info) : Napi::ObjectWrap<NV10
   this->nv10Control_->MaximumPorts = MaximumPorts.Int32Value();
   this->nv10Control_->LogLvl = LogLvl.Uint32Value();
   this->nv10Control_->Path = LogFilePath.Utf8Value();
+  if (params.Has("capturePath")) {
+    this->nv10Control_->CapturePath = params.Get("capturePath").ToString().Utf8Value();
+  }
+  if (params.Has("retryTimeout")) {
+    this->nv10Control_->RetryTimeoutMs = params.Get("retryTimeout").ToNumber().Int32Value();
+  }
+  if (params.Has("maxRetries")) {
+    this->nv10Control_->MaxRetries = params.Get("maxRetries").ToNumber().Int32Value();
+  }
+  if (params.Has("syncAfter")) {
+    this->nv10Control_->SyncAfter = params.Get("syncAfter").ToNumber().Int32Value();
+  }
+  if (params.Has("journalPath")) {
+    this->nv10Control_->JournalPath = params.Get("journalPath").ToString().Utf8Value();
+  }
+  if (params.Has("channelCachePath")) {
+    this->nv10Control_->ChannelCachePath = params.Get("channelCachePath").ToString().Utf8Value();
+  }
+  PollScheduler::Config_t config = this->nv10Control_->PollRate.GetConfig();
+  if (PollScheduler::ParseConfig(params, config)) {
+    this->nv10Control_->PollRate.Configure(config);
+  }
+  this->compact_ = params.Has("compact") && params.Get("compact").ToBoolean().Value();
+
+  this->isRunning_ = true;
+  this->threadEnded_ = true;
 
   this->nv10Control_->InitLog();
 }
 
+// Igual que Pelicano: los hilos ya terminaron (Ref/Unref) y al borrar el control se libera el puerto
+NV10Wrapper::~NV10Wrapper() {
+  this->isRunning_ = false;
+  if (this->nativeThread_.joinable()) {
+    this->nativeThread_.join();
+  }
+  delete this->nv10Control_;
+}
+
 Napi::Value NV10Wrapper::Connect(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->nv10Control_->Connect();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value NV10Wrapper::CheckDevice(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->nv10Control_->CheckDevice();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value NV10Wrapper::StartReader(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->nv10Control_->StartReader();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value NV10Wrapper::GetBill(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   BillError_t response = this->nv10Control_->GetBill();
-  Napi::Object object = Napi::Object::New(env);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  object["bill"] = Napi::Number::New(env, response.Bill);
-  object["message"] = Napi::String::New(env, response.Message);
-  return object;
+  return BillResult(env, response, this->compact_);
 }
 
 Napi::Value NV10Wrapper::ModifyChannels(const Napi::CallbackInfo& info) {
@@ -107,46 +178,39 @@ Napi::Value NV10Wrapper::ModifyChannels(const Napi::CallbackInfo& info) {
   Napi::Number InhibitMask1 = info[0].As<Napi::Number>();
 
   Response_t response = this->nv10Control_->ModifyChannels(InhibitMask1.Int32Value());
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value NV10Wrapper::StopReader(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
-  isRunningNv10 = false;
+  this->isRunning_ = false;
   Response_t response = this->nv10Control_->StopReader();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value NV10Wrapper::Reject(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->nv10Control_->Reject();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value NV10Wrapper::TestStatus(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   TestStatus_t response = this->nv10Control_->TestStatus();
-  Napi::Object object = Napi::Object::New(env);
-  object["version"] = Napi::String::New(env, response.Version);
-  object["device"] = Napi::Number::New(env, response.Device);
-  object["errorType"] = Napi::Number::New(env, response.ErrorType);
-  object["errorCode"] = Napi::Number::New(env, response.ErrorCode);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["aditionalInfo"] = Napi::String::New(env, response.AditionalInfo);
-  object["priority"] = Napi::Number::New(env, response.Priority);
-  return object;
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  Field_t fields[] = {
+    { KEY_VERSION,        cache->String(env, response.Version) },
+    { KEY_DEVICE,         cache->Number(env, response.Device) },
+    { KEY_ERROR_TYPE,     cache->Number(env, response.ErrorType) },
+    { KEY_ERROR_CODE,     cache->Number(env, response.ErrorCode) },
+    { KEY_MESSAGE,        cache->Text(env, response.Message) },
+    { KEY_ADITIONAL_INFO, cache->Text(env, response.AditionalInfo) },
+    { KEY_PRIORITY,       cache->Number(env, response.Priority) },
+  };
+  return cache->Build(env, fields);
 }
 
 
@@ -160,45 +224,138 @@ Napi::Value NV10Wrapper::OnBill(const Napi::CallbackInfo &info)
   }
   
   Napi::Function napiFunction = info[0].As<Napi::Function>();
-  tsfnNv10 = Napi::ThreadSafeFunction::New(
+  // El hilo usa this: el objeto no se libera hasta el finalizador del tsfn (Unref)
+  this->Ref();
+  this->tsfn_ = Napi::ThreadSafeFunction::New(
     env, 
     napiFunction, 
     "Callback", 
     0, 
     1,
-    []( Napi::Env ) {
-      nativeThreadNv10.join();
+    [this]( Napi::Env ) {
+      this->nativeThread_.join();
+      this->Unref();
     });
 
-  nativeThreadNv10 = std::thread ( [this] {
-    auto callback = [](Napi::Env env, Napi::Function jsCallback, BillError_t* bill) {
-      Napi::Object object = Napi::Object::New(env);
-      object["statusCode"] = Napi::Number::New(env, bill->StatusCode);
-      object["bill"] = Napi::Number::New(env, bill->Bill);
-      object["message"] = Napi::String::New(env, bill->Message);
-      jsCallback.Call({object});
+  this->nativeThread_ = std::thread ( [this] {
+    bool compact = this->compact_;
+    auto callback = [compact](Napi::Env env, Napi::Function jsCallback, BillError_t* bill) {
+      jsCallback.Call({BillResult(env, *bill, compact)});
       delete bill;
     };
-    isRunningNv10 = true;
-    threadEndedNv10 = false;
-    while (isRunningNv10) {
-      std::this_thread::sleep_for( std::chrono::milliseconds(10));
+    this->isRunning_ = true;
+    this->threadEnded_ = false;
+    while (this->isRunning_) {
+      // La espera larga (sin actividad) va en pasos de 10 ms para responder rapido a finish y a la custodia
+      PollScheduler::WaitNextPoll([this] { return this->nv10Control_->PollDelayMs(); }, this->isRunning_);
       BillError_t response = this->nv10Control_->GetBill();
       if (response.StatusCode == 302) continue;
       BillError_t *value = new BillError_t(response);
-      napi_status status = tsfnNv10.BlockingCall(value, callback);
+      napi_status status = this->tsfn_.BlockingCall(value, callback);
       if ( status != napi_ok ) break;
     }
-    threadEndedNv10 = true;
-    tsfnNv10.Release();
+    this->threadEnded_ = true;
+    this->tsfn_.Release();
   });
 
-  auto finishFn = [] (const Napi::CallbackInfo& info) {
-    isRunningNv10 = false;
-    while (!threadEndedNv10);
+  auto finishFn = [this] (const Napi::CallbackInfo& info) {
+    this->isRunning_ = false;
+    while (!this->threadEnded_);
     std::this_thread::sleep_for( std::chrono::milliseconds(50));
     return;
   };
 
   return Napi::Function::New(env, finishFn);
+}
+
+Napi::Value NV10Wrapper::GetQueueStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  return ResultCacheClass::Get(env)->QueueStats(env, this->nv10Control_->Scheduler);
+}
+
+Napi::Value NV10Wrapper::DumpFlightRecorder(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  long count = this->nv10Control_->DumpFlightRecorder();
+  return ResultCacheClass::Get(env)->RecorderDump(env, count, this->nv10Control_->Globals.NV10Object.Recorder.Path);
+}
+
+Napi::Value NV10Wrapper::GetEvents(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  uint64_t since = (info.Length() > 0 && info[0].IsNumber()) ? static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value()) : 0;
+  std::vector<EventJournal::Event_t> events;
+  this->nv10Control_->GetEvents(since, events);
+  return ResultCacheClass::Get(env)->JournalEvents(env, events);
+}
+
+Napi::Value NV10Wrapper::SetEscrowPolicy(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (info.Length() != 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Invalid params").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Object policy = info[0].As<Napi::Object>();
+
+  // rules[i] es la accion del canal i + 1: "accept", "reject" o "hold"
+  std::vector<EscrowPolicy::Action_t> rules;
+  if (policy.Has("rules") && policy.Get("rules").IsArray()) {
+    Napi::Array array = policy.Get("rules").As<Napi::Array>();
+    for (uint32_t i = 0; i < array.Length(); i++) {
+      std::string action = array.Get(i).ToString().Utf8Value();
+      if (action == "accept") rules.push_back(EscrowPolicy::ACTION_ACCEPT);
+      else if (action == "reject") rules.push_back(EscrowPolicy::ACTION_REJECT);
+      else if (action == "hold") rules.push_back(EscrowPolicy::ACTION_HOLD);
+      else {
+        Napi::TypeError::New(env, "Invalid escrow action: " + action).ThrowAsJavaScriptException();
+        return env.Null();
+      }
+    }
+  }
+  long sessionMax = policy.Has("sessionMax") ? policy.Get("sessionMax").ToNumber().Int64Value() : 0;
+  int holdTimeout = policy.Has("holdTimeout") ? policy.Get("holdTimeout").ToNumber().Int32Value() : 0;
+
+  Response_t response = this->nv10Control_->SetEscrowPolicy(rules, sessionMax, holdTimeout);
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
+}
+
+Napi::Value NV10Wrapper::AcceptEscrow(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  Response_t response = this->nv10Control_->AcceptEscrow();
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
+}
+
+Napi::Value NV10Wrapper::ResetEscrowSession(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  Response_t response = this->nv10Control_->ResetEscrowSession();
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
+}
+
+Napi::Value NV10Wrapper::GetLinkStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  LinkStats_t stats = this->nv10Control_->GetLinkStats();
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  Field_t fields[] = {
+    { KEY_COMMANDS,         cache->Number(env, stats.Commands) },
+    { KEY_RETRIES,          cache->Number(env, stats.Retries) },
+    { KEY_TIMEOUTS,         cache->Number(env, stats.Timeouts) },
+    { KEY_CRC_ERRORS,       cache->Number(env, stats.CrcErrors) },
+    { KEY_FAILURES,         cache->Number(env, stats.Failures) },
+    { KEY_RESYNCS,          cache->Number(env, stats.Resyncs) },
+    { KEY_AVG_RECOVERY_US,  cache->Number(env, (stats.Recovered > 0) ? (double)stats.RecoveryUs / stats.Recovered : 0) },
+    { KEY_MAX_RECOVERY_US,  cache->Number(env, stats.MaxRecoveryUs) },
+  };
+  return cache->Build(env, fields);
+}
+
+Napi::Value NV10Wrapper::GetPollStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  return ResultCacheClass::Get(env)->PollStats(env, this->nv10Control_->GetPollStats());
 }
\ No newline at end of file
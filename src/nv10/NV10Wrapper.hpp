@@ -1,16 +1,20 @@
 #include <napi.h>
 #include <thread>
 #include <chrono>
+#include <atomic>
 #include "NV10Control.hpp"
+#include "../common/AddonData.hpp"
+#include "../common/PollOptions.hpp"
 
 using namespace NV10Control;
+using namespace ResultCache;
 
 class NV10Wrapper : public Napi::ObjectWrap<NV10Wrapper> {
   public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     NV10Wrapper(const Napi::CallbackInfo& info);
+    ~NV10Wrapper();
   private:
-    static Napi::FunctionReference constructor;
     Napi::Value Connect(const Napi::CallbackInfo& info);
     Napi::Value CheckDevice(const Napi::CallbackInfo& info);
     Napi::Value StartReader(const Napi::CallbackInfo& info);
@@ -20,5 +24,18 @@ class NV10Wrapper : public Napi::ObjectWrap<NV10Wrapper> {
     Napi::Value Reject(const Napi::CallbackInfo& info);
     Napi::Value TestStatus(const Napi::CallbackInfo& info);
     Napi::Value OnBill(const Napi::CallbackInfo& info);
+    Napi::Value GetQueueStats(const Napi::CallbackInfo& info);
+    Napi::Value DumpFlightRecorder(const Napi::CallbackInfo& info);
+    Napi::Value GetEvents(const Napi::CallbackInfo& info);
+    Napi::Value SetEscrowPolicy(const Napi::CallbackInfo& info);
+    Napi::Value AcceptEscrow(const Napi::CallbackInfo& info);
+    Napi::Value ResetEscrowSession(const Napi::CallbackInfo& info);
+    Napi::Value GetLinkStats(const Napi::CallbackInfo& info);
+    Napi::Value GetPollStats(const Napi::CallbackInfo& info);
     NV10ControlClass *nv10Control_;
+    std::thread nativeThread_;
+    Napi::ThreadSafeFunction tsfn_;
+    std::atomic<bool> isRunning_;
+    std::atomic<bool> threadEnded_;
+    bool compact_;
 };
\ No newline at end of file
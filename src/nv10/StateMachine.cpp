@@ -16,19 +16,9 @@ namespace NV10StateMachine{
 
     using namespace ValidatorNV10;
 
-    NV10Class *NV10Object;
+    typedef StateMachineBase::StateMachine<NV10Class, NV10SMTypes::State_t, NV10SMTypes::Event_t> Base_t;
 
-    NV10SMClass::NV10SMClass(ValidatorNV10::NV10Class *_NV10Class_p){
-        NV10Object = _NV10Class_p;
-        SM.CurrState = NV10SMClass::ST_IDLE;
-    };
-
-    struct StateFunctionRow_t{
-        const char * name;
-        int (NV10Class::*func)(void);
-    };
-
-    static StateFunctionRow_t StateFunctionValidatorNV10[] = {
+    static const Base_t::StateRow_t StateFunctionValidatorNV10[] = {
             // NAME         // FUNC
         { "ST_IDLE",       &NV10Class::StIdle },      
         { "ST_CONNECT",    &NV10Class::StConnect }, 
@@ -38,14 +28,11 @@ namespace NV10StateMachine{
         { "ST_CHECK",      &NV10Class::StCheck },
         { "ST_ERROR",      &NV10Class::StError }, 
     };
+    static_assert(sizeof(StateFunctionValidatorNV10)/sizeof(StateFunctionValidatorNV10[0]) == NV10SMClass::ST_COUNT, "Falta la funcion de algun estado");
+
+    typedef StateTable::TransitionRow_t<NV10SMClass::State_t, NV10SMClass::Event_t> StateTransitionRow_t;
 
-    struct StateTransitionRow_t{
-        NV10SMClass::State_t CurrState;
-        NV10SMClass::Event_t Event;
-        NV10SMClass::State_t NextState;
-    } ;
-    
-    static StateTransitionRow_t StateTransition[] = {
+    static constexpr StateTransitionRow_t StateTransition[] = {
         // CURR STATE       // EVENT            // NEXT STATE
         { NV10SMClass::ST_IDLE,          NV10SMClass::EV_ANY,             NV10SMClass::ST_CONNECT},
 
@@ -68,37 +55,19 @@ namespace NV10StateMachine{
         { NV10SMClass::ST_ERROR,         NV10SMClass::EV_RESET,           NV10SMClass::ST_IDLE},
 
     };
+    static_assert(StateTable::IsValid<NV10SMClass::ST_COUNT, NV10SMClass::EV_COUNT>(StateTransition), "Transicion fuera de rango o repetida");
 
-    void NV10SMClass::InitStateMachine() {
-        SM.CurrState = NV10SMClass::ST_IDLE; 
-        (NV10Object[0].*(StateFunctionValidatorNV10[SM.CurrState].func))();
+    // Tabla densa [estado][evento] construida en compilacion a partir de StateTransition
+    static constexpr Base_t::Table_t Transitions = StateTable::BuildTable<NV10SMClass::ST_COUNT, NV10SMClass::EV_COUNT>(StateTransition);
+
+    NV10SMClass::NV10SMClass(ValidatorNV10::NV10Class *_NV10Class_p)
+        : Base_t(_NV10Class_p, StateFunctionValidatorNV10, &Transitions, 0) {
+        SetRecorder(&_NV10Class_p->Recorder);
+        SetEntryHook(ST_ERROR, &NV10Class::DumpRecorderOnError);
     }
-    
+
     int NV10SMClass::RunCheck() {
-        int Response = -1;
-        LS.CurrState = SM.CurrState; 
-        SM.CurrState = NV10SMClass::ST_CHECK; 
-        Response = (NV10Object[0].*(StateFunctionValidatorNV10[SM.CurrState].func))();
-        SM.CurrState = LS.CurrState;
-        return Response;
+        return RunState(NV10SMClass::ST_CHECK);
     }
 
-    int NV10SMClass::StateMachineRun(Event_t Event) {
-        int Response = -1;
-        for(long unsigned int i = 0; i < sizeof(StateTransition)/sizeof(StateTransition[0]); i++) {
-            if(StateTransition[i].CurrState == SM.CurrState) {
-                if(StateTransition[i].Event == Event) {
-                    SM.CurrState =  StateTransition[i].NextState;
-                    Response = (NV10Object[0].*(StateFunctionValidatorNV10[SM.CurrState].func))();
-                    return Response;
-                    break;
-                }
-            }
-        }
-        return 0;
-    }
-    
-    const char * NV10SMClass::StateMachineGetStateName(State_t State) {
-        return StateFunctionValidatorNV10[State].name;
-    }
 };
\ No newline at end of file
@@ -10,53 +10,18 @@
  */
 
 #include "ValidatorNV10.hpp"
+#include "../common/CodeTable.hpp"
 
 namespace ValidatorNV10{
 
-    // --------------- EXTERNAL VARIABLES --------------------//
-
-    //READ ONLY
-
-    int SerialPort;
-    bool SuccessConnect;
-    int PortO;
-
-    int PrevResponseSeq;
-    int LengthData;
-
-    int ErrorOCode;
-    std::string ErrorOMsg;
-    int ErrorOPriority;
-
-    int EventOCode;
-    std::string EventOMsg;
-    int EventOPriority;
-
-    int LROCode;
-    std::string LROMsg;
-    int LROPriority;
-
-    int AdEventOCode;
-    std::string AdEventOMsg;
-    int AdEventOPriority;
-
-    int Bill;
-    int Channel;
-
-    //WRITE ONLY
-
-    int LoggerLevel;
-    std::string LogFilePath;
-    int MaxPorts;
-
     // --------------- INTERNAL VARIABLES --------------------//
 
-    bool Scanning;
 
     std::vector<unsigned char> RESET                = {0x01};
     std::vector<unsigned char> SET_CHANNELS_ENABLE  = {0x02, 0xFF, 0xFF, 0xFF};
     std::vector<unsigned char> DISPLAY_ON           = {0x03};
     std::vector<unsigned char> DISPLAY_OFF          = {0x04};
+    std::vector<unsigned char> SETUP_REQUEST        = {0x05};
     std::vector<unsigned char> POLL                 = {0x07};
     std::vector<unsigned char> REJECT               = {0x08};
     std::vector<unsigned char> DISABLE              = {0x09};
@@ -64,21 +29,15 @@ namespace ValidatorNV10{
     std::vector<unsigned char> SYNC                 = {0x11};
     std::vector<unsigned char> LAST_REJECT          = {0x17};
     std::vector<unsigned char> HOLD                 = {0x18};
+    std::vector<unsigned char> GET_DATASET_VERSION  = {0x21};
 
-    std::string DEFAULTERROR = "Codigo de error no encontrado";
+    const std::string DEFAULTERROR = "Codigo de error no encontrado";
 
-    bool ActSequence = false;
-    bool LastRejectFlag = false;
 
-    ErrorCodes_t ErrorC;
-    ErrorCodes_t EventC;
-    ErrorCodes_t AdEventC;
-    ErrorCodes_t LRCode;
-    Bills_t BillC;
 
-    std::shared_ptr<spdlog::logger> logger;
     
-    static Bills_t Bills[] = {
+    // Tabla de canales por defecto, se usa mientras el billetero no haya respondido SETUP_REQUEST ni haya cache
+    static constexpr Bills_t Bills[] = {
         {0,0},
         {1,1000},
         {2,2000},
@@ -89,7 +48,7 @@ namespace ValidatorNV10{
         {7,100000},
     };
 
-    static ErrorCodes_t ErrorCodes[] = {
+    static constexpr ErrorCodes_t ErrorCodes[] = {
         {240,"OK",0},
         {242,"COMMAND NOT KNOWN",1},
         {243,"WRONG NO PARAMETERS",1},
@@ -100,7 +59,7 @@ namespace ValidatorNV10{
         {250,"KEY NOT SET",1},
     };
 
-    static ErrorCodes_t EventCodes[] = {
+    static constexpr ErrorCodes_t EventCodes[] = {
         //No additional params
         {240,"OK",0},
         //1 additional params
@@ -124,7 +83,7 @@ namespace ValidatorNV10{
         {238,"CREDIT",0},
     };
 
-    static SpdlogLevels_t SpdlogLvl[] = {
+    static constexpr SpdlogLevels_t SpdlogLvl[] = {
         {0,"trace"},
         {1,"debug"},
         {2,"info"},
@@ -134,7 +93,7 @@ namespace ValidatorNV10{
         {6,"off"},
     };
 
-    static ErrorCodes_t ErrorCodesExComm[] = {
+    static constexpr ErrorCodes_t ErrorCodesExComm[] = {
         {-5,"[EC] Timeout, acceptor not responding",2},
         {-4,"[EC] Writing successful but cannot read",1},
         {-3,"[EC] Writting error",1},
@@ -144,10 +103,11 @@ namespace ValidatorNV10{
         { 1,"[HC] Response code is different of OK",1},
         { 2,"[HR] Response was reviewed previosly",3},
         { 3,"[HR] Response was received shifted",2},
-        { 4,"[EC] Reading length is too short, sleep time is too short",2},        
+        { 4,"[EC] Reading length is too short, frame incomplete before timeout",2},
+        { 5,"[EC] CRC error in the response",2},
     };
 
-    static ErrorCodes_t LastRejectCodes[] = {
+    static constexpr ErrorCodes_t LastRejectCodes[] = {
         {0,"Note accepted",0},
         {1,"Note length incorrect",3},
         {2,"Reject reason 2",3},
@@ -179,9 +139,37 @@ namespace ValidatorNV10{
         {28,"Unable to stack note",1},
     };
 
+    // Tablas de acceso directo por codigo, construidas en compilacion a partir de las tablas anteriores
+    static constexpr SpdlogLevels_t SpdlogTableDefault = {0,"SpdlogLvl not found!!!"};
+    static_assert(CodeTable::IsValid<SpdlogLevels_t, &SpdlogLevels_t::Code>(SpdlogLvl), "Codigo fuera de la tabla SpdlogLvl");
+    static constexpr CodeTable::DenseTable_t<SpdlogLevels_t> SpdlogTable = CodeTable::BuildTable<SpdlogLevels_t, &SpdlogLevels_t::Code>(SpdlogLvl, SpdlogTableDefault);
+
+    static constexpr ErrorCodes_t ExCommTableDefault = {0,"ErrorCode not found!!!",1};
+    static_assert(CodeTable::IsValid<ErrorCodes_t, &ErrorCodes_t::Code>(ErrorCodesExComm, -128), "Codigo fuera de la tabla ErrorCodesExComm");
+    static constexpr CodeTable::DenseTable_t<ErrorCodes_t> ExCommTable = CodeTable::BuildTable<ErrorCodes_t, &ErrorCodes_t::Code>(ErrorCodesExComm, ExCommTableDefault, -128);
+
+    static_assert(sizeof(Bills) / sizeof(Bills[0]) <= MAXCHANNELS + 1, "La tabla Bills tiene mas canales que MAXCHANNELS");
+
+    static constexpr ErrorCodes_t ErrorTableDefault = {0,"ErrorCode not found!!!",1};
+    static_assert(CodeTable::IsValid<ErrorCodes_t, &ErrorCodes_t::Code>(ErrorCodes), "Codigo fuera de la tabla ErrorCodes");
+    static constexpr CodeTable::DenseTable_t<ErrorCodes_t> ErrorTable = CodeTable::BuildTable<ErrorCodes_t, &ErrorCodes_t::Code>(ErrorCodes, ErrorTableDefault);
+
+    static constexpr ErrorCodes_t EventTableDefault = {0,"EventCode not found!!!",1};
+    static_assert(CodeTable::IsValid<ErrorCodes_t, &ErrorCodes_t::Code>(EventCodes), "Codigo fuera de la tabla EventCodes");
+    static constexpr CodeTable::DenseTable_t<ErrorCodes_t> EventTable = CodeTable::BuildTable<ErrorCodes_t, &ErrorCodes_t::Code>(EventCodes, EventTableDefault);
+
+    static constexpr ErrorCodes_t LastRejectTableDefault = {0,"LRC not found!!!",1};
+    static_assert(CodeTable::IsValid<ErrorCodes_t, &ErrorCodes_t::Code>(LastRejectCodes), "Codigo fuera de la tabla LastRejectCodes");
+    static constexpr CodeTable::DenseTable_t<ErrorCodes_t> LastRejectTable = CodeTable::BuildTable<ErrorCodes_t, &ErrorCodes_t::Code>(LastRejectCodes, LastRejectTableDefault);
+
     // --------------- CONSTRUCTOR FUNCTIONS --------------------//
 
     NV10Class::NV10Class(){
+        Scanning = false;
+        ActSequence = false;
+        LastRejectFlag = false;
+        SetupFlag = false;
+        DatasetFlag = false;
         
         SerialPort = 0;
         SuccessConnect = false;
@@ -208,130 +196,81 @@ namespace ValidatorNV10{
 
         Bill = 0;
         Channel = 0;
+        Events.reserve(MAXPOLLEVENTS);
+        DefaultChannels();
+
+        RetryTimeoutMs = RETRYTIMEOUTMS;
+        MaxRetries = MAXRETRIES;
+        SyncAfter = SYNCAFTER;
+        Link = {};
+        FailedCommands = 0;
+        Resyncing = false;
     }
 
-    NV10Class::~NV10Class(){}
+    NV10Class::~NV10Class(){
+        // Cerrar el puerto libera el flock, otra instancia puede tomarlo
+        if (SerialPort > 0){
+            close(SerialPort);
+            SerialPort = -1;
+        }
+        Logging::DropLogger(logger);
+    }
 
     // --------------- LOGGER FUNCTIONS --------------------//
 
-    SpdlogLevels_t NV10Class::SearchSpdlogLevel(int Code){
-        SpdlogLevels_t SPLvl;
-        SPLvl.Message = "SpdlogLvl not found!!!"; 
-
-        for (long unsigned int i = 0; i < sizeof(SpdlogLvl)/sizeof(SpdlogLvl[0]); i++) {
-            if(SpdlogLvl[i].Code == Code) {
-                SPLvl.Message = SpdlogLvl[i].Message;
-                break;
-            }
-        }
-        
-        SPLvl.Code = Code;
-        return SPLvl;
+    SpdlogLevels_t NV10Class::SearchSpdlogLevel (int Code){
+        return CodeTable::Lookup<SpdlogLevels_t, &SpdlogLevels_t::Code>(SpdlogTable, Code, SpdlogTableDefault);
     }
 
     void NV10Class::SetSpdlogLevel(){
-        spdlog::set_level(static_cast<spdlog::level::level_enum>(LoggerLevel)); // Set global log level
+        logger->set_level(static_cast<spdlog::level::level_enum>(LoggerLevel)); // Set instance log level
         //logger->set_level(spdlog::level::debug);
     }
 
     // --------------- SEARCH FUNCTIONS --------------------//
 
     ErrorCodes_t NV10Class::SearchErrorCodeExComm (int Code){
-        
-        ErrorCodes_t CodeMsg;
-        
-        CodeMsg.Message = "ErrorCode not found!!!";
-        CodeMsg.Priority = 1;
-        
-        for (long unsigned int i = 0; i < sizeof(ErrorCodesExComm)/sizeof(ErrorCodesExComm[0]); i++) {
-            if(ErrorCodesExComm[i].Code == Code) {
-                CodeMsg.Message = ErrorCodesExComm[i].Message;
-                CodeMsg.Priority = ErrorCodesExComm[i].Priority;
-                break;
-            }
-        }
-        
-        CodeMsg.Code = Code;
-
-        return CodeMsg;
+        return CodeTable::Lookup<ErrorCodes_t, &ErrorCodes_t::Code>(ExCommTable, Code, ExCommTableDefault);
     }
 
     Bills_t NV10Class::SearchBill (int Channel){
-        
-        Bills_t ChannelBill;
-        
-        ChannelBill.Bill = 0;
-        
-        for (long unsigned int i = 0; i < sizeof(Bills)/sizeof(Bills[0]); i++) {
-            if(Bills[i].Channel == Channel) {
-                ChannelBill.Bill = Bills[i].Bill;
-                break;
-            }
+        if ((Channel < 1) | (Channel > Setup.Count) | (Channel > MAXCHANNELS)){
+            return {0,0};
         }
-        
-        ChannelBill.Channel = Channel;
-
-        return ChannelBill;
+        return {Channel, Setup.Values[Channel]};
     }
 
-    ErrorCodes_t NV10Class::SearchErrorCodes (int Code){
-        
-        ErrorCodes_t CodeMsg;
-        
-        CodeMsg.Message = "ErrorCode not found!!!";
-        CodeMsg.Priority = 1;
-        
-        for (long unsigned int i = 0; i < sizeof(ErrorCodes)/sizeof(ErrorCodes[0]); i++) {
-            if(ErrorCodes[i].Code == Code) {
-                CodeMsg.Message = ErrorCodes[i].Message;
-                CodeMsg.Priority = ErrorCodes[i].Priority;
-                break;
+    void NV10Class::DefaultChannels(){
+        memset(&Setup, 0, sizeof(Setup));
+        for (const Bills_t &Entry : Bills){
+            Setup.Values[Entry.Channel] = Entry.Bill;
+            if (Entry.Channel > Setup.Count){
+                Setup.Count = Entry.Channel;
             }
         }
-        
-        CodeMsg.Code = Code;
-
-        return CodeMsg;
     }
 
-    ErrorCodes_t NV10Class::SearchEventCodes (int Code){
-        
-        ErrorCodes_t CodeMsg;
-        
-        CodeMsg.Message = "EventCode not found!!!";
-        CodeMsg.Priority = 1;
-        
-        for (long unsigned int i = 0; i < sizeof(EventCodes)/sizeof(EventCodes[0]); i++) {
-            if(EventCodes[i].Code == Code) {
-                CodeMsg.Message = EventCodes[i].Message;
-                CodeMsg.Priority = EventCodes[i].Priority;
-                break;
-            }
+    int NV10Class::SetChannelTable(const ChannelSetup_t &Table){
+        if ((Table.Count < 1) | (Table.Count > MAXCHANNELS)){
+            return 1;
         }
-        
-        CodeMsg.Code = Code;
+        Setup = Table;
+        Setup.Values[0] = 0;
+        Setup.Firmware[sizeof(Setup.Firmware) - 1] = 0;
+        Setup.Dataset[sizeof(Setup.Dataset) - 1] = 0;
+        return 0;
+    }
+
+    ErrorCodes_t NV10Class::SearchErrorCodes (int Code){
+        return CodeTable::Lookup<ErrorCodes_t, &ErrorCodes_t::Code>(ErrorTable, Code, ErrorTableDefault);
+    }
 
-        return CodeMsg;
+    ErrorCodes_t NV10Class::SearchEventCodes (int Code){
+        return CodeTable::Lookup<ErrorCodes_t, &ErrorCodes_t::Code>(EventTable, Code, EventTableDefault);
     }
 
     ErrorCodes_t NV10Class::SearchLastReject (int Code){
-        
-        ErrorCodes_t CodeMsg;
-        
-        CodeMsg.Message = "LRC not found!!!";
-        CodeMsg.Priority = 1;
-        
-        for (long unsigned int i = 0; i < sizeof(LastRejectCodes)/sizeof(LastRejectCodes[0]); i++) {
-            if(LastRejectCodes[i].Code == Code) {
-                CodeMsg.Message = LastRejectCodes[i].Message;
-                CodeMsg.Priority = LastRejectCodes[i].Priority;
-                break;
-            }
-        }
-        
-        CodeMsg.Code = Code;
-
-        return CodeMsg;
+        return CodeTable::Lookup<ErrorCodes_t, &ErrorCodes_t::Code>(LastRejectTable, Code, LastRejectTableDefault);
     }
 
     // --------------- STATES OF MACHINE STATE (FUNCTIONS) --------------------//
@@ -344,8 +283,8 @@ namespace ValidatorNV10{
 
         logger->critical("[E0:STIDLE] Setting spdlog level in {}",SpdlogLvl.Message);
 
-        logger->trace("   [E0:STIDLE] --------------------------------------------------------------------------");
-        logger->debug("   [E0:STIDLE] --------------------------------------------------------------------------");
+        SPDLOG_LOGGER_TRACE(logger,"   [E0:STIDLE] --------------------------------------------------------------------------");
+        SPDLOG_LOGGER_DEBUG(logger,"   [E0:STIDLE] --------------------------------------------------------------------------");
         logger->info("    [E0:STIDLE] --------------------------------------------------------------------------");
         logger->warn(" [E0:STIDLE] --------------------------------------------------------------------------");
         logger->error("   [E0:STIDLE] --------------------------------------------------------------------------");
@@ -373,7 +312,7 @@ namespace ValidatorNV10{
 
         int Response = 1;
 
-        logger->debug("[E2:STDISABLE] Running Disable");
+        SPDLOG_LOGGER_DEBUG(logger,"[E2:STDISABLE] Running Disable");
 
         Response = Disable();
 
@@ -382,7 +321,7 @@ namespace ValidatorNV10{
             return 1;
         }
 
-        logger->debug("[E2:STDISABLE] Running DisplayOff");
+        SPDLOG_LOGGER_DEBUG(logger,"[E2:STDISABLE] Running DisplayOff");
 
         Response = DisplayOff();
 
@@ -401,7 +340,7 @@ namespace ValidatorNV10{
         Bill = 0;
         Channel = 0;
 
-        logger->debug("[E3:STENABLE] Running Sync");
+        SPDLOG_LOGGER_DEBUG(logger,"[E3:STENABLE] Running Sync");
 
         Response = Sync();
 
@@ -410,7 +349,7 @@ namespace ValidatorNV10{
             return 1;
         }
 
-        logger->debug("[E3:STENABLE] Running DisplayOn");
+        SPDLOG_LOGGER_DEBUG(logger,"[E3:STENABLE] Running DisplayOn");
 
         Response = DisplayOn();
 
@@ -419,7 +358,7 @@ namespace ValidatorNV10{
             return 1;
         }
 
-        logger->debug("[E3:STENABLE] Running SetChannels");
+        SPDLOG_LOGGER_DEBUG(logger,"[E3:STENABLE] Running SetChannels");
 
         Response = SetChannels();
 
@@ -428,7 +367,7 @@ namespace ValidatorNV10{
             return 1;
         }
 
-        logger->debug("[E3:STENABLE] Running Enable");
+        SPDLOG_LOGGER_DEBUG(logger,"[E3:STENABLE] Running Enable");
 
         Response = Enable();
 
@@ -437,7 +376,7 @@ namespace ValidatorNV10{
             return 1;
         }
 
-        logger->debug("[E3:STENABLE] Running LastReject");
+        SPDLOG_LOGGER_DEBUG(logger,"[E3:STENABLE] Running LastReject");
 
         Response = LastReject();
 
@@ -453,7 +392,7 @@ namespace ValidatorNV10{
 
         int Response = 1;
 
-        logger->debug("[E4:STPOLLING] Running Poll");
+        SPDLOG_LOGGER_DEBUG(logger,"[E4:STPOLLING] Running Poll");
 
         Response = Poll();
 
@@ -462,7 +401,7 @@ namespace ValidatorNV10{
             return 1;
         }
         else if (Response == 2){
-            logger->debug("[E4:STPOLLING] Response was viewed before");
+            SPDLOG_LOGGER_DEBUG(logger,"[E4:STPOLLING] Response was viewed before");
             return 2;
         }
 
@@ -473,7 +412,7 @@ namespace ValidatorNV10{
         
         int Response = 1;
 
-        logger->debug("[E5:STCHECK] Running LastReject");
+        SPDLOG_LOGGER_DEBUG(logger,"[E5:STCHECK] Running LastReject");
 
         Response = LastReject();
 
@@ -482,7 +421,7 @@ namespace ValidatorNV10{
             return 1;
         }
 
-        logger->debug("[E5:STCHECK] Running Poll");
+        SPDLOG_LOGGER_DEBUG(logger,"[E5:STCHECK] Running Poll");
 
         Response = Poll();
 
@@ -512,8 +451,35 @@ namespace ValidatorNV10{
 
     // Función para inicializar el logger
     void NV10Class::InitLogger(const std::string& Path) {
-        // Crear el daily_logger y asignarlo a la variable logger
-        logger = spdlog::daily_logger_mt("ValidatorNV10", Path, 23, 59);
+        // Crear el logger asincrono (archivo diario) de esta instancia y asignarlo a la variable logger
+        // Si ya existia (InitLog despues de reconectar) se da de baja primero para no dejarlo registrado
+        Logging::DropLogger(logger);
+        logger = Logging::CreateLogger("ValidatorNV10", Path);
+        Recorder.Path = Path + ".flight";
+    }
+
+    long NV10Class::DumpRecorder(const char *Reason){
+        long Entries = Recorder.Dump(Reason);
+        if (Entries >= 0){
+            logger->warn("[DumpRecorder] {0}: {1} entries written to {2}",Reason,Entries,Recorder.Path);
+        }
+        else {
+            logger->error("[DumpRecorder] {0}: could not write {1}",Reason,Recorder.Path);
+        }
+        return Entries;
+    }
+
+    void NV10Class::DumpRecorderOnError(){
+        DumpRecorder("ST_ERROR");
+    }
+
+    int NV10Class::StartCapture(const std::string& Path){
+        if (Capture.Open(Path, SerialCapture::DEVICE_NV10) != 0){
+            logger->error("[StartCapture] Could not open capture file {0}",Path);
+            return 1;
+        }
+        logger->info("[StartCapture] Capturing serial traffic to {0} (instance {1})",Path,Capture.Instance);
+        return 0;
     }
 
     //Connects to port /dev/ttyACM% where % is the port number (Port)
@@ -524,11 +490,19 @@ namespace ValidatorNV10{
             return 1;
         }
         else {
-            logger->debug("[ConnectSerial] Connecting to /dev/ttyACM{0:d} port",Port);
+            SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] Connecting to /dev/ttyACM{0:d} port",Port);
             char DeviceName [50];
             sprintf (DeviceName,"/dev/ttyACM%d",Port);
             SerialPort = open(DeviceName, O_RDWR | O_NOCTTY );
 
+            // Bloqueo exclusivo del puerto para que otra instancia (o proceso) no lo tome mientras se usa
+            if ((SerialPort > 0) && (flock(SerialPort, LOCK_EX | LOCK_NB) != 0)){
+                SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] /dev/ttyACM{0:d} is already in use",Port);
+                close(SerialPort);
+                SerialPort = -1;
+                return 5;
+            }
+
             if (SerialPort > 0){
 
                 struct termios Tty;
@@ -538,6 +512,8 @@ namespace ValidatorNV10{
                 if(tcgetattr(SerialPort, &Tty) != 0) {
                     logger->error("[ConnectSerial] Error reading actual settings in this port. Error: {0:d}, from tcgetattr: {1}",errno,strerror(errno));
                     SuccessConnect = false;
+                    close(SerialPort);
+                    SerialPort = -1;
                     return 2;
                 }
 
@@ -560,7 +536,7 @@ namespace ValidatorNV10{
                 Tty.c_lflag &= ~ECHOE;
                 Tty.c_lflag &= ~ECHOK;
 
-                Tty.c_cc[VTIME] = 10; // Wait for up to 1s (10 deciseconds), returning as soon as any data is received.
+                Tty.c_cc[VTIME] = 1; // Wait for up to 100 ms per read, ReadFrame keeps reading until RetryTimeoutMs
                 Tty.c_cc[VMIN] = 0; // Wait from time 0
 
                 cfsetispeed(&Tty, B9600); //Set IN baud rate in 9600
@@ -570,15 +546,17 @@ namespace ValidatorNV10{
                 if (tcsetattr(SerialPort, TCSANOW, &Tty) != 0) {
                     logger->error("[ConnectSerial] Error writing new settings in this port. Error: {0:d}, from tcgetattr: {1}",errno,strerror(errno));
                     SuccessConnect = false;
+                    close(SerialPort);
+                    SerialPort = -1;
                     return 3;
                 }
 
-                logger->debug("[ConnectSerial] Successfully connected to /dev/ttyACM{0:d}",Port);
+                SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] Successfully connected to /dev/ttyACM{0:d}",Port);
                 SuccessConnect = true;
                 return 0;
             }
             else {
-                logger->debug("[ConnectSerial] Could no connect to /dev/ttyACM{0:d}",Port);
+                SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] Could no connect to /dev/ttyACM{0:d}",Port);
                 return 4;
             }
         }
@@ -589,23 +567,29 @@ namespace ValidatorNV10{
         int Port = -1;
         int Response = -1;
 
+        // Al reconectar se cierra el puerto que ya se tenia, tambien libera el flock y el puerto se puede volver a tomar
+        if (SerialPort > 0){
+            close(SerialPort);
+            SerialPort = -1;
+        }
+
         for (int i = 1; i < MaxPorts; i++)
         {   
-            logger->debug("[ScanPorts] Trying connection to /dev/ttyACM{0:d}",i-1);
+            SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Trying connection to /dev/ttyACM{0:d}",i-1);
             Response = ConnectSerial(i-1);
 
             if (Response==0)
             {   
-                logger->debug("[ScanPorts] Connection successfull");
+                SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Connection successfull");
                 Response = -1;
                 Scanning = true;
-                logger->debug("[ScanPorts] Sending simple poll Command (Checking connection)");
+                SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Sending simple poll Command (Checking connection)");
 
                 Response = Sync();
 
                 if (Response == 0){
                     Port = i-1;
-                    logger->debug("[ScanPorts] Validator NV10 found in port /dev/ttyACM{0:d}",Port);
+                    SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Validator NV10 found in port /dev/ttyACM{0:d}",Port);
                     i = MaxPorts;
                     Scanning = false;
                     return Port;
@@ -614,8 +598,9 @@ namespace ValidatorNV10{
                     logger->warn("[ScanPorts] Error in writing/reading or Validator NV10 is NOT connected to /dev/ttyACM{0:d} port",i-1);
                 }
 
-                logger->debug("[ScanPorts] Clossing connection in /dev/ttyACM{0:d}",i-1);
-                close(SerialPort);            
+                SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Clossing connection in /dev/ttyACM{0:d}",i-1);
+                close(SerialPort);
+                SerialPort = -1;
             }
         }
         Scanning = false;
@@ -674,6 +659,14 @@ namespace ValidatorNV10{
 
         std::vector<unsigned char> Crc = CalcCRC(CmdCrc);
         Cmd.insert(Cmd.end(), Crc.begin(), Crc.end());
+
+        // Relleno de bytes: despues del STX cada 0x7F se envia dos veces
+        for (size_t i = 1; i < Cmd.size(); i++){
+            if (Cmd[i] == BYTE_START){
+                Cmd.insert(Cmd.begin() + i, BYTE_START);
+                i++;
+            }
+        }
         return Cmd;
     }
 
@@ -681,32 +674,77 @@ namespace ValidatorNV10{
 
         int Response = 2;
         int Res = 1;
+        int Attempt = 0;
 
+        // La trama se arma una sola vez, los reenvios llevan el mismo bit de secuencia
         std::vector<unsigned char> Cmd = BuildCmd(Comm);
-        Response = ExecuteCommand(Cmd);
-        
+        std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+        Link.Commands++;
+
         ErrorCodes_t Err;
-        Err = SearchErrorCodeExComm(Response);
+        while (true){
+            Response = ExecuteCommand(Cmd);
+            Err = SearchErrorCodeExComm(Response);
+            Recorder.RecordResult(Err.Code, Err.Message.data());
+
+            if (Response == -5){
+                Link.Timeouts++;
+            }
+            else if (Response == 5){
+                Link.CrcErrors++;
+            }
+            if ((Err.Priority != 2) | (Attempt >= MaxRetries)){
+                break;
+            }
+            Attempt++;
+            Link.Retries++;
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Retransmitting frame, attempt {0:d}: {1}",Attempt,Err.Message);
+        }
 
         if (Err.Priority == 0){
-            //logger->trace("[SendingCommand] Everything is OK");
+            //SPDLOG_LOGGER_TRACE(logger,"[SendingCommand] Everything is OK");
             Res = 0;
         }
         else if (Err.Priority == 1){
-            logger->debug("[SendingCommand] Fatal error with comand");
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Fatal error with comand");
             Res = -1;
         }
         else if (Err.Priority == 3){
-            logger->debug("[SendingCommand] Command was sent before");
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Command was sent before");
             Res = -2;
         }
         else {
-            logger->debug("[SendingCommand] Repeat command");
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Repeat command");
             Res = 1;
         }
 
         if (Res != 0){
-            logger->debug("[SendingCommand] Execute command returns: {0:d} with message: {1}",Err.Code,Err.Message);
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Execute command returns: {0:d} with message: {1}",Err.Code,Err.Message);
+        }
+
+        if (Err.Priority == 2){
+            Link.Failures++;
+            FailedCommands++;
+            // Sin respuesta valida despues de todos los reenvios: el billetero pudo perder la secuencia
+            if ((FailedCommands >= SyncAfter) & (!Resyncing) & (!Scanning)){
+                logger->warn("[SendingCommand] {0:d} commands failed in a row, running Sync",FailedCommands);
+                Resyncing = true;
+                Link.Resyncs++;
+                Sync();
+                Resyncing = false;
+                FailedCommands = 0;
+            }
+        }
+        else {
+            FailedCommands = 0;
+            if (Attempt > 0){
+                uint64_t Us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Start).count();
+                Link.Recovered++;
+                Link.RecoveryUs += Us;
+                if (Us > Link.MaxRecoveryUs){
+                    Link.MaxRecoveryUs = Us;
+                }
+            }
         }
         return Res;
     }
@@ -718,7 +756,9 @@ namespace ValidatorNV10{
         
         int Xlen = Comm.size();
 
-        //logger->trace("[ExecuteCommand] Writting command");
+        SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Writting command: {0:n}",Logging::Hex(Comm,Xlen));
+        Recorder.RecordFrame(FlightRecorder::ENTRY_TX, &Comm[0], Xlen);
+        Capture.Record(SerialCapture::DIRECTION_TX, &Comm[0], Xlen);
         Wrlen = write(SerialPort, &Comm[0], Xlen);
 
         if (Wrlen!=Xlen){
@@ -726,36 +766,39 @@ namespace ValidatorNV10{
             Res = -3;
         }
         else {
-            //logger->trace("[ExecuteCommand] Length expected is the same: {0:d}",Wrlen);
-            
-            std::vector<unsigned char> Buffer(30);
+            //SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Length expected is the same: {0:d}",Wrlen);
             
-            usleep(200000);
+            std::vector<unsigned char> Buffer(MAXFRAME);
 
-            //logger->trace("[ExecuteCommand] Reading response");
-            Rdlen = read(SerialPort,&Buffer[0],Buffer.size());
+            //SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Reading response");
+            Rdlen = ReadFrame(Buffer);
+            Recorder.RecordFrame(FlightRecorder::ENTRY_RX, &Buffer[0], Rdlen);
+            Capture.Record(SerialCapture::DIRECTION_RX, &Buffer[0], Rdlen);
 
             if (Rdlen > 0){
 
-                if (Rdlen >= 6){
-                    //logger->trace("[ExecuteCommand] Reading length greater or equal than {0}, handling response... ");
-                    Res = HandleResponse(Buffer);
+                SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Data read: {0:n}",Logging::Hex(Buffer,Rdlen));
+
+                if ((Rdlen >= 6) & (Rdlen >= 5 + Buffer[2])){
+                    std::vector<unsigned char> Body(Buffer.begin() + 1, Buffer.begin() + 3 + Buffer[2]);
+                    std::vector<unsigned char> Crc = CalcCRC(Body);
+                    if ((Crc[0] == Buffer[3 + Buffer[2]]) & (Crc[1] == Buffer[4 + Buffer[2]])){
+                        //SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Reading length greater or equal than {0}, handling response... ");
+                        Res = HandleResponse(Buffer);
+                    }
+                    else {
+                        logger->warn("[ExecuteCommand] CRC error: {0:n}",Logging::Hex(Buffer,Rdlen));
+                        Res = 5;
+                    }
                 }
                 else {
-                    logger->debug("[ExecuteCommand] Reading partial length: {0:d}",Rdlen);
-                    int i = 0;
-                    for(auto t: Buffer){
-                        if(i<Buffer.size()){
-                            logger->error("[ExecuteCommand] Partial data{0}: {1}",i,t);
-                        }
-                        i++;
-                    }
-                    logger->warn("[ExecuteCommand] Reading length less than 6, very little waiting time ");
+                    SPDLOG_LOGGER_DEBUG(logger,"[ExecuteCommand] Reading partial length: {0:d}",Rdlen);
+                    logger->warn("[ExecuteCommand] Partial data before timeout: {0:n}",Logging::Hex(Buffer,Rdlen));
                     Res = 4;
                 }
             }
             else if (Rdlen < 0){
-                logger->warn("[ExecuteCommand] Reading error, length expect: {0:d} Error: {2}",Rdlen,strerror(errno));
+                logger->warn("[ExecuteCommand] Reading error, length expect: {0:d} Error: {1}",Rdlen,strerror(errno));
                 Res = -4;
             }
             else {
@@ -771,6 +814,61 @@ namespace ValidatorNV10{
         return Res;
     }
 
+    int NV10Class::ReadFrame(std::vector<unsigned char> &Buffer){
+
+        const unsigned char BYTE_START = 0x7F;
+        unsigned char Chunk[MAXFRAME];
+        size_t Length = 0;          // Bytes de la trama ya sin relleno
+        size_t Expected = 0;        // 5 + LEN cuando ya se leyo LEN
+        bool Stuffed = false;       // El byte anterior fue un 0x7F dentro de la trama
+
+        std::chrono::steady_clock::time_point Deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(RetryTimeoutMs);
+
+        while (true){
+            int Rdlen = read(SerialPort, Chunk, sizeof(Chunk));
+            if (Rdlen < 0){
+                if ((errno != EAGAIN) & (errno != EWOULDBLOCK) & (errno != EINTR)){
+                    return (Length > 0) ? Length : -1;
+                }
+                Rdlen = 0;
+            }
+
+            for (int i = 0; i < Rdlen; i++){
+                unsigned char Byte = Chunk[i];
+                // Lo que llegue antes del STX (restos de una respuesta anterior) se descarta
+                if (Length == 0){
+                    if (Byte == BYTE_START){
+                        Buffer[Length++] = Byte;
+                    }
+                    continue;
+                }
+                if (Stuffed){
+                    Stuffed = false;
+                    // Un 0x7F sin su par es el inicio de otra trama
+                    if (Byte != BYTE_START){
+                        Length = 1;
+                        Expected = 0;
+                    }
+                }
+                else if (Byte == BYTE_START){
+                    Stuffed = true;
+                    continue;
+                }
+                Buffer[Length++] = Byte;
+                if (Length == 3){
+                    Expected = 5 + Buffer[2];
+                }
+                if (((Expected > 0) & (Length >= Expected)) | (Length >= Buffer.size())){
+                    return Length;
+                }
+            }
+
+            if (std::chrono::steady_clock::now() >= Deadline){
+                return Length;
+            }
+        }
+    }
+
     int NV10Class::HandleResponse(std::vector<unsigned char> Response){
 
         int Res = -2;
@@ -778,6 +876,7 @@ namespace ValidatorNV10{
         int ResponseSequence = Response[1];
 
         LengthData = 0;
+        Events.clear();
         
         if ((StartOfTrame == 127) & (PrevResponseSeq != ResponseSequence)){
             PrevResponseSeq = ResponseSequence;
@@ -786,16 +885,20 @@ namespace ValidatorNV10{
                 Res = HandleCode(Response);
                 if(LengthData >= 2){
                     if(LastRejectFlag){
-                        logger->trace("[HandleResponse] HandleLRC detected");
+                        SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] HandleLRC detected");
                         HandleLRC(Response);
                     }
-                    else{
-                        logger->trace("[HandleResponse] HandleEvent detected");
-                        HandleEvent(Response);
+                    else if(SetupFlag){
+                        SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] HandleSetup detected");
+                        HandleSetup(Response);
+                    }
+                    else if(DatasetFlag){
+                        SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] HandleDataset detected");
+                        HandleDataset(Response);
                     }
-                    if(LengthData >= 3){
-                        logger->trace("[HandleResponse] HandleChannel detected");
-                        HandleChannel(Response);
+                    else{
+                        SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] HandleEvents detected");
+                        HandleEvents(Response);
                     }
                 }
             }
@@ -809,14 +912,7 @@ namespace ValidatorNV10{
             Res = 2;
         }
         else {
-            logger->error("[HandleResponse] Bad response");
-            int i = 0;
-            for(auto t: Response){
-                if(i<Response.size()){
-                    logger->error("[HandleResponse] Data{0}: {1}",i,t);
-                }
-                i++;
-            }
+            logger->error("[HandleResponse] Bad response: {0:n}",Logging::Hex(Response,Response.size()));
             Res = 3;
         }
         return Res;
@@ -836,39 +932,75 @@ namespace ValidatorNV10{
             Res = 0;
         }
         else {
-            logger->debug("[HandleCode] Code: {0} message: {1}",ErrorC.Code,ErrorC.Message);
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleCode] Code: {0} message: {1}",ErrorC.Code,ErrorC.Message);
             logger->warn("[HandleCode] Response code is not OK");
             Res = 1;
         }
         return Res;
     }
 
-    int NV10Class::HandleEvent(std::vector<unsigned char> Response){
+    // Eventos que llevan un byte de canal despues del codigo
+    static bool EventHasChannel(int Event){
+        return (Event == 239) | (Event == 238) | (Event == 230) | (Event == 225) | (Event == 226);
+    }
 
-        int Res = -2;
+    int NV10Class::HandleEvents(const std::vector<unsigned char> &Response){
+
+        int Res = 0;
 
-        int Event = Response[4];
-        EventC = SearchEventCodes(Event);
-        EventOCode = EventC.Code;
-        EventOMsg = EventC.Message;
-        EventOPriority = EventC.Priority;
-        logger->debug("[HandleEvent] Event code: {0} message: {1}",EventC.Code,EventC.Message);
+        // Response[3] es el codigo de respuesta, los eventos van de Response[4] hasta el final de los datos
+        size_t End = 3 + LengthData;
+        if (End > Response.size()){
+            End = Response.size();
+        }
+
+        size_t i = 4;
+        while ((i < End) & (Events.size() < MAXPOLLEVENTS)){
+            PollEvent_t Event;
+            Event.Code = Response[i++];
+            ErrorCodes_t Found = SearchEventCodes(Event.Code);
+            Event.Message = Found.Message;
+            Event.Channel = 0;
+            Event.Bill = 0;
+
+            if (EventHasChannel(Event.Code)){
+                if (i >= End){
+                    logger->error("[HandleEvents] Event {0} without channel",Event.Code);
+                    Res = 1;
+                    break;
+                }
+                Event.Channel = Response[i++];
+                Event.Bill = SearchBill(Event.Channel).Bill;
+            }
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleEvents] Event code: {0} message: {1} channel: {2}",Event.Code,Event.Message,Event.Channel);
+            Events.push_back(Event);
 
-        if (LengthData == 4){
-            int AdEvent = Response[6];
-            AdEventC = SearchEventCodes(AdEvent);
+            // Sin conocer el evento no se sabe cuantos datos lleva, no se puede seguir decodificando
+            if (Found.Message == "EventCode not found!!!"){
+                logger->error("[HandleEvents] Event code not found");
+                Res = 1;
+                break;
+            }
+        }
+
+        if (!Events.empty()){
+            EventC = SearchEventCodes(Events[0].Code);
+            EventOCode = EventC.Code;
+            EventOMsg = EventC.Message;
+            EventOPriority = EventC.Priority;
+        }
+        if (Events.size() >= 2){
+            AdEventC = SearchEventCodes(Events[1].Code);
             AdEventOCode = AdEventC.Code;
             AdEventOMsg = AdEventC.Message;
-            AdEventOPriority  = AdEventC.Priority;
-            logger->debug("[HandleEvent] Additional event code: {0} message: {1}",AdEventC.Code,AdEventC.Message);
-        }      
-
-        if (EventC.Message == "EventCode not found!!!"){
-            logger->error("[HandleEvent] Event code not found");
-            Res = 1;
+            AdEventOPriority = AdEventC.Priority;
         }
-        else {
-            Res = 0;
+        // Bill y Channel quedan con el ultimo canal reportado en el poll
+        for (const PollEvent_t &Event : Events){
+            if (EventHasChannel(Event.Code)){
+                Channel = Event.Channel;
+                Bill = Event.Bill;
+            }
         }
 
         return Res;
@@ -883,7 +1015,7 @@ namespace ValidatorNV10{
         LROCode = LRCode.Code;
         LROMsg = LRCode.Message;
 
-        logger->debug("[HandleLRC] Last reject code: {0} message: {1}",LRCode.Code,LRCode.Message); 
+        SPDLOG_LOGGER_DEBUG(logger,"[HandleLRC] Last reject code: {0} message: {1}",LRCode.Code,LRCode.Message); 
 
         if (LRCode.Message == "LRC not found!!!"){
             logger->error("[HandleLRC] LRC not found");
@@ -896,32 +1028,74 @@ namespace ValidatorNV10{
         return Res;
     }
 
-    int NV10Class::HandleChannel(std::vector<unsigned char> Response){
-
-        int Res = -2;
-        Channel = Response[5];
+    int NV10Class::HandleSetup(const std::vector<unsigned char> &Response){
 
-        BillC = SearchBill(Channel);
+        // Datos despues del codigo OK: tipo de unidad (1), firmware (4), pais (3), multiplicador (3, big endian),
+        // canales n (1), valores de los canales (n), seguridad (n), multiplicador real (3, big endian), version de
+        // protocolo (1) y, desde el protocolo 6, codigos de pais (3n) y valores expandidos (4n, little endian).
+        // Los valores expandidos ya estan en unidades enteras; los de un byte se multiplican por el multiplicador
+        // (el multiplicador real lleva a centavos y no se usa: la tabla queda en unidades enteras como la de COP)
+        size_t End = 3 + LengthData;
+        if (End > Response.size()){
+            End = Response.size();
+        }
+        if (End < 16){
+            logger->error("[HandleSetup] Setup response too short: {0}",LengthData);
+            return 1;
+        }
 
-        Bill = BillC.Bill;
+        int Count = Response[15];
+        size_t Values = 16;
+        size_t Protocol = Values + 2 * Count + 3;
+        if ((Count < 1) | (Count > MAXCHANNELS) | (Protocol >= End)){
+            logger->error("[HandleSetup] Wrong number of channels: {0} (data length {1})",Count,LengthData);
+            return 1;
+        }
 
-        logger->debug("[HandleChannel] Bill detected: {0} Channel: {1}",BillC.Bill,BillC.Channel);
+        ChannelSetup_t Table;
+        memset(&Table, 0, sizeof(Table));
+        memcpy(Table.Firmware, &Response[5], 4);
+        memcpy(Table.Dataset, Setup.Dataset, sizeof(Table.Dataset));
+        Table.Count = Count;
 
-        if (BillC.Bill == 0){
-            logger->debug("[HandleChannel] Bill not found");
-            Res = 1;
+        long ValueMultiplier = (Response[12] << 16) | (Response[13] << 8) | Response[14];
+        // Desde el protocolo 6 el multiplicador puede venir en 0 cuando solo se usan los valores expandidos
+        if (ValueMultiplier == 0){
+            ValueMultiplier = 1;
         }
-        else {
-            Res = 0;
+        size_t Expanded = Protocol + 1 + 3 * Count;
+        bool HasExpanded = (Response[Protocol] >= 6) & (Expanded + 4 * Count <= End);
+
+        for (int i = 0; i < Count; i++){
+            if (HasExpanded){
+                size_t At = Expanded + 4 * i;
+                Table.Values[i + 1] = Response[At] | (Response[At + 1] << 8) | (Response[At + 2] << 16) | (Response[At + 3] << 24);
+            }
+            else {
+                Table.Values[i + 1] = Response[Values + i] * ValueMultiplier;
+            }
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleSetup] Channel {0}: {1}",i + 1,Table.Values[i + 1]);
         }
 
-        return Res;
-    } 
+        Setup = Table;
+        logger->info("[HandleSetup] Firmware {0}, protocol {1}, {2} channels",Setup.Firmware,Response[Protocol],Setup.Count);
+        return 0;
+    }
+
+    int NV10Class::HandleDataset(const std::vector<unsigned char> &Response){
+        size_t End = 3 + LengthData;
+        if (End > Response.size()){
+            End = Response.size();
+        }
+        DatasetVersion.assign(Response.begin() + 4, Response.begin() + End);
+        SPDLOG_LOGGER_DEBUG(logger,"[HandleDataset] Dataset version: {0}",DatasetVersion);
+        return 0;
+    }
 
     int NV10Class::DisplayOn(){
         int Response  = -1;
 
-        logger->debug("[DisplayOn] Enabling display");
+        SPDLOG_LOGGER_DEBUG(logger,"[DisplayOn] Enabling display");
         Response = SendingCommand(DISPLAY_ON);
 
         if ((Response != 0)&(Response != -2)){
@@ -935,7 +1109,7 @@ namespace ValidatorNV10{
     int NV10Class::DisplayOff(){
         int Response  = -1;
 
-        logger->debug("[DisplayOff] Disabling display");
+        SPDLOG_LOGGER_DEBUG(logger,"[DisplayOff] Disabling display");
         Response = SendingCommand(DISPLAY_OFF);
 
         if ((Response != 0)&(Response != -2)){
@@ -949,7 +1123,7 @@ namespace ValidatorNV10{
     int NV10Class::SetChannels(){
         int Response  = -1;
         
-        logger->debug("[SetChannels] Setting internal channels");
+        SPDLOG_LOGGER_DEBUG(logger,"[SetChannels] Setting internal channels");
         Response = SendingCommand(SET_CHANNELS_ENABLE);
 
         if ((Response != 0)&(Response != -2)){
@@ -963,7 +1137,7 @@ namespace ValidatorNV10{
     int NV10Class::Enable(){
         int Response  = -1;
         
-        logger->debug("[Enable] Enabling selected channels");
+        SPDLOG_LOGGER_DEBUG(logger,"[Enable] Enabling selected channels");
         Response = SendingCommand(ENABLE);
 
         if ((Response != 0)&(Response != -2)){
@@ -977,7 +1151,7 @@ namespace ValidatorNV10{
     int NV10Class::Disable(){
         int Response  = -1;
         
-        logger->debug("[Enable] Disabling selected channels");
+        SPDLOG_LOGGER_DEBUG(logger,"[Enable] Disabling selected channels");
         Response = SendingCommand(DISABLE);
 
         if ((Response != 0)&(Response != -2)){
@@ -990,12 +1164,19 @@ namespace ValidatorNV10{
 
     int NV10Class::Poll(){
         int Response  = -1;
+
+        // Se mantiene el ritmo de polling, los reenvios y el resto de comandos salen sin espera
+        std::chrono::steady_clock::duration Wait = LastPoll + std::chrono::milliseconds(POLLINTERVALMS) - std::chrono::steady_clock::now();
+        if (Wait > std::chrono::steady_clock::duration::zero()){
+            usleep(std::chrono::duration_cast<std::chrono::microseconds>(Wait).count());
+        }
+        LastPoll = std::chrono::steady_clock::now();
         
-        //logger->debug("[Poll] Polling");
+        //SPDLOG_LOGGER_DEBUG(logger,"[Poll] Polling");
         Response = SendingCommand(POLL);
 
         if (Response == -2){
-            logger->debug("[Poll] Response was viewed before");
+            SPDLOG_LOGGER_DEBUG(logger,"[Poll] Response was viewed before");
             return 2;
         }
         else if (Response != 0){
@@ -1009,7 +1190,7 @@ namespace ValidatorNV10{
     int NV10Class::LastReject(){
         int Response  = -1;
         LastRejectFlag = true;
-        logger->debug("[LastReject] Checking last reject code");
+        SPDLOG_LOGGER_DEBUG(logger,"[LastReject] Checking last reject code");
         Response = SendingCommand(LAST_REJECT);
         
         if ((Response != 0)&(Response != -2)){
@@ -1024,7 +1205,9 @@ namespace ValidatorNV10{
 
         int Response  = -1;
         ActSequence = false;
-        logger->debug("[Sync] Synchronizing with the bill acceptor");
+        // Despues de SYNC el billetero vuelve a empezar la secuencia, la respuesta no se descarta como repetida
+        PrevResponseSeq = -1;
+        SPDLOG_LOGGER_DEBUG(logger,"[Sync] Synchronizing with the bill acceptor");
         Response = SendingCommand(SYNC);
 
         if ((Response != 0)&(Response != -2)){
@@ -1038,7 +1221,7 @@ namespace ValidatorNV10{
     int NV10Class::Hold(){
         int Response  = -1;
         
-        logger->debug("[Hold] Holding the last bill");
+        SPDLOG_LOGGER_DEBUG(logger,"[Hold] Holding the last bill");
         Response = SendingCommand(HOLD);
 
         if ((Response != 0)&(Response != -2)){
@@ -1052,7 +1235,7 @@ namespace ValidatorNV10{
     int NV10Class::Reject(){
         int Response  = -1;
         
-        logger->debug("[Reject] Rejecting the last bill");
+        SPDLOG_LOGGER_DEBUG(logger,"[Reject] Rejecting the last bill");
         Response = SendingCommand(REJECT);
 
         if ((Response != 0)&(Response != -2)){
@@ -1062,4 +1245,43 @@ namespace ValidatorNV10{
 
         return 0;
     }
+
+    int NV10Class::SetupRequest(){
+        int Response  = -1;
+        int Count = Setup.Count;
+        char Firmware[sizeof(Setup.Firmware)];
+        memcpy(Firmware, Setup.Firmware, sizeof(Firmware));
+
+        // Se borra el firmware para saber si HandleSetup reemplazo la tabla
+        Setup.Firmware[0] = 0;
+        SetupFlag = true;
+        SPDLOG_LOGGER_DEBUG(logger,"[SetupRequest] Requesting channel setup");
+        Response = SendingCommand(SETUP_REQUEST);
+        SetupFlag = false;
+
+        if (((Response != 0)&(Response != -2)) | (Setup.Firmware[0] == 0)){
+            logger->error("[SetupRequest] Could not read channel setup, keeping {0} channels",Count);
+            memcpy(Setup.Firmware, Firmware, sizeof(Firmware));
+            return 1;
+        }
+
+        return 0;
+    }
+
+    int NV10Class::DatasetRequest(){
+        int Response  = -1;
+
+        DatasetVersion.clear();
+        DatasetFlag = true;
+        SPDLOG_LOGGER_DEBUG(logger,"[DatasetRequest] Requesting dataset version");
+        Response = SendingCommand(GET_DATASET_VERSION);
+        DatasetFlag = false;
+
+        if (((Response != 0)&(Response != -2)) | DatasetVersion.empty()){
+            logger->error("[DatasetRequest] Could not read dataset version");
+            return 1;
+        }
+
+        return 0;
+    }
 }
\ No newline at end of file
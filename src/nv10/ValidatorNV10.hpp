@@ -19,12 +19,19 @@
 #include <termios.h> // Contains POSIX terminal control definitions
 #include <unistd.h> // write(), read(), close()
 #include <sys/ioctl.h> //To use flush
+#include <sys/file.h> //To use flock
+#include <atomic>
+#include <cstdint>
 #include <bitset> //To use bitset in HandleResponseInfo
+#include <chrono>
 
 #include "spdlog/spdlog.h" //Logging library
-#include "spdlog/sinks/daily_file_sink.h" //Logging library - daily file
+#include "../common/Logging.hpp" //Logging library - async logger and hex dump
+#include "../common/FlightRecorder.hpp"
+#include "../common/SerialCapture.hpp"
 
 #include <vector>
+#include <string_view>
 #include <iostream>
 #include <string>
 
@@ -32,7 +39,7 @@ namespace ValidatorNV10{
 
     struct SpdlogLevels_t{
         int Code;
-        std::string Message;
+        std::string_view Message;
     };
 
     struct Bills_t{
@@ -42,10 +49,85 @@ namespace ValidatorNV10{
 
     struct ErrorCodes_t{
         int Code;
-        std::string Message;
+        std::string_view Message;
         int Priority;
     };
 
+    /**
+     * @brief Maximo de eventos que se decodifican de una respuesta de poll
+     */
+    static const size_t MAXPOLLEVENTS = 16;
+
+    struct PollEvent_t{
+        int Code;                   // Codigo del evento (tabla EventCodes)
+        std::string_view Message;   // Mensaje asociado al evento
+        int Channel;                // Canal que acompaña al evento (READ, CREDIT, FRAUD, CLEARED), 0 si no lleva canal
+        int Bill;                   // Valor en COP del canal, 0 si no lleva canal o el canal no existe
+    };
+
+    /**
+     * @brief Bytes maximos de una trama leida (STX, SEQ, LEN, hasta 255 de datos, CRC). La respuesta de
+     * SETUP_REQUEST con muchos canales supera los 59 bytes de datos de las demas respuestas
+     */
+    static const size_t MAXFRAME = 260;
+
+    /**
+     * @brief Canales que se pueden leer del billetero, SET_CHANNELS_ENABLE lleva 3 bytes de mascara
+     */
+    static const int MAXCHANNELS = 24;
+
+    /**
+     * @brief Largo maximo de la version del dataset: la respuesta lleva hasta 255 bytes de datos, uno es el codigo OK
+     */
+    static const size_t MAXDATASET = 254;
+
+    /**
+     * @brief Tabla de canales del billetero, se guarda en disco tal cual (cache de canales). Los valores estan en
+     * unidades enteras de la moneda (pesos para COP), igual que la tabla por defecto
+     */
+    struct ChannelSetup_t{
+        char Firmware[8];                   // Version de firmware reportada en SETUP_REQUEST (4 caracteres)
+        char Dataset[MAXDATASET + 2];       // Version del dataset (GET_DATASET_VERSION), vacio si es la tabla por defecto
+        int32_t Count;                      // Canales reportados por el billetero
+        int32_t Values[MAXCHANNELS + 1];    // Valor de cada canal en unidades enteras, el indice es el canal (0 sin uso)
+    };
+
+    /**
+     * @brief Espera por defecto de cada intento, en milisegundos, hasta completar la trama de respuesta
+     */
+    static const int RETRYTIMEOUTMS = 200;
+
+    /**
+     * @brief Reenvios por defecto de la misma trama cuando la respuesta no llega, llega cortada o con CRC invalido
+     */
+    static const int MAXRETRIES = 3;
+
+    /**
+     * @brief Comandos fallidos seguidos (con todos sus reenvios) despues de los cuales se envia SYNC
+     */
+    static const int SYNCAFTER = 2;
+
+    /**
+     * @brief Intervalo minimo entre POLL (limite de SSP). El ritmo real lo decide el planificador de polling del
+     * control: este minimo durante la actividad y mas lento sin billetes
+     */
+    static const int POLLINTERVALMS = 100;
+
+    /**
+     * @brief Contadores del enlace SSP
+     */
+    struct LinkStats_t{
+        uint64_t Commands;          // Comandos enviados, sin contar reenvios
+        uint64_t Retries;           // Reenvios de la misma trama
+        uint64_t Timeouts;          // Intentos sin respuesta completa
+        uint64_t CrcErrors;         // Respuestas con CRC invalido
+        uint64_t Failures;          // Comandos que agotaron los reenvios
+        uint64_t Resyncs;           // SYNC enviados despues de SyncAfter comandos fallidos seguidos
+        uint64_t Recovered;         // Comandos que respondieron despues de al menos un reenvio
+        uint64_t RecoveryUs;        // Suma del tiempo desde el primer envio hasta la respuesta de los recuperados
+        uint64_t MaxRecoveryUs;
+    };
+
     class NV10Class{
         public:
 
@@ -148,6 +230,23 @@ namespace ValidatorNV10{
              */
             int Channel;
 
+            /**
+             * @brief Eventos del ultimo poll en el orden en que los reporto el billetero. Un poll puede traer varios
+             * (por ejemplo READ, CREDIT, STACKING, STACKED); EventO* y AdEventO* son el primero y el segundo
+             */
+            std::vector<PollEvent_t> Events;
+
+            /**
+             * @brief Tabla de canales en uso: la de SETUP_REQUEST, la del cache de canales o la tabla por defecto.
+             * SearchBill la indexa directamente por canal
+             */
+            ChannelSetup_t Setup;
+
+            /**
+             * @brief Version del dataset leida con DatasetRequest
+             */
+            std::string DatasetVersion;
+
             //WRITE ONLY
 
             /**
@@ -165,6 +264,108 @@ namespace ValidatorNV10{
              */
             int MaxPorts;
 
+            /**
+             * @brief Espera de cada intento hasta completar la trama de respuesta, en milisegundos
+             */
+            int RetryTimeoutMs;
+
+            /**
+             * @brief Reenvios de la misma trama antes de dar el comando por fallido
+             */
+            int MaxRetries;
+
+            /**
+             * @brief Comandos fallidos seguidos antes de enviar SYNC
+             */
+            int SyncAfter;
+
+            /**
+             * @brief Contadores del enlace SSP (reenvios, timeouts, CRC, resincronizaciones y tiempo de recuperacion)
+             */
+            LinkStats_t Link;
+
+            // --------------- INTERNAL VARIABLES --------------------//
+
+            /**
+             * @brief Bandera que indica si se estan escaneando los puertos (ScanPorts)
+             */
+            bool Scanning;
+
+            /**
+             * @brief Bit de secuencia (0x80) del siguiente comando SSP
+             */
+            bool ActSequence;
+
+            /**
+             * @brief Bandera que indica que se debe consultar el codigo del ultimo rechazo
+             */
+            bool LastRejectFlag;
+
+            /**
+             * @brief Bandera que indica que la respuesta esperada es la de SETUP_REQUEST
+             */
+            bool SetupFlag;
+
+            /**
+             * @brief Bandera que indica que la respuesta esperada es la de GET_DATASET_VERSION
+             */
+            bool DatasetFlag;
+
+            /**
+             * @brief Comandos fallidos seguidos desde la ultima respuesta valida
+             */
+            int FailedCommands;
+
+            /**
+             * @brief Bandera que evita resincronizar desde el SYNC de la resincronizacion
+             */
+            bool Resyncing;
+
+            /**
+             * @brief Hora del ultimo POLL, para mantener POLLINTERVALMS entre polls
+             */
+            std::chrono::steady_clock::time_point LastPoll;
+
+            /**
+             * @brief Ultimo codigo de respuesta del billetero
+             */
+            ErrorCodes_t ErrorC;
+
+            /**
+             * @brief Ultimo evento reportado en el polling
+             */
+            ErrorCodes_t EventC;
+
+            /**
+             * @brief Evento adicional reportado en el polling
+             */
+            ErrorCodes_t AdEventC;
+
+            /**
+             * @brief Codigo del ultimo rechazo
+             */
+            ErrorCodes_t LRCode;
+
+            /**
+             * @brief Ultimo billete reconocido con su canal
+             */
+            Bills_t BillC;
+
+            /**
+             * @brief Logger de esta instancia del billetero
+             */
+            std::shared_ptr<spdlog::logger> logger;
+
+            /**
+             * @brief Registro en memoria de las ultimas tramas, transiciones y resultados de esta instancia del billetero
+             */
+            FlightRecorder::FlightRecorderClass Recorder;
+
+            /**
+             * @brief Captura binaria de las tramas enviadas y recibidas (inactiva hasta StartCapture)
+             */
+            SerialCapture::SerialCaptureClass Capture;
+
             // --------------- CONSTRUCTOR FUNCTIONS --------------------//
 
             /**
@@ -187,7 +388,7 @@ namespace ValidatorNV10{
             SpdlogLevels_t SearchSpdlogLevel(int Code);
 
             /**
-            * @brief Funcion que establece el nivel de logging general de acuerdo a la variable global LoggerLevel
+            * @brief Funcion que establece el nivel de logging de esta instancia de acuerdo a la variable LoggerLevel
             */
             void SetSpdlogLevel();
 
@@ -201,12 +402,24 @@ namespace ValidatorNV10{
             ErrorCodes_t SearchErrorCodeExComm (int Code);
 
             /**
-            * @brief Funcion que busca el billete asociado al canal ingresado
+            * @brief Funcion que busca el billete asociado al canal ingresado en la tabla de canales (Setup)
             * @param Channel Canal de billete que informa el validador
-            * @return Bills_t Estructura que contiene un canal y un valor de billete entero
+            * @return Bills_t Estructura que contiene un canal y un valor de billete entero, {0,0} si el canal no existe
             */
             Bills_t SearchBill (int Channel);
 
+            /**
+            * @brief Carga la tabla de canales por defecto (billetes COP de los canales 1 a 7)
+            */
+            void DefaultChannels();
+
+            /**
+            * @brief Reemplaza la tabla de canales, por ejemplo con la guardada en el cache de canales
+            * @param Table Tabla de canales
+            * @return int 0 si la tabla se cargo, 1 si el numero de canales no es valido (se conserva la anterior)
+            */
+            int SetChannelTable(const ChannelSetup_t &Table);
+
             /**
             * @brief Funcion que busca un codigo de error asociado al comando enviado
             * @param Code Codigo de fallo
@@ -282,11 +495,31 @@ namespace ValidatorNV10{
             // --------------- MAIN FUNCTIONS --------------------//
 
             /**
-            * @brief Abre el archivo donde se van a guardar los logs
+            * @brief Abre el archivo donde se van a guardar los logs con un logger propio de la instancia. Si la
+            * instancia ya tenia logger lo da de baja antes de crear el nuevo
             * @param Path Ruta donde se debe guardar el log de Spdlog
             */
             void InitLogger(const std::string& Path);
 
+            /**
+            * @brief Vuelca el flight recorder al archivo <ruta del log>.flight
+            * @param Reason Motivo del volcado
+            * @return long Numero de entradas escritas, -1 si no se pudo escribir el archivo
+            */
+            long DumpRecorder(const char *Reason);
+
+            /**
+            * @brief Hook de entrada al estado ST_ERROR, vuelca el flight recorder
+            */
+            void DumpRecorderOnError();
+
+            /**
+            * @brief Empieza a guardar cada trama enviada y recibida en un archivo de captura binario
+            * @param Path Ruta del archivo de captura (se agrega al final si ya existe)
+            * @return int 0 si se pudo abrir el archivo, 1 si no
+            */
+            int StartCapture(const std::string& Path);
+
             /**
             * @brief Se conecta al puerto con las caracteristicas definidas en la hoja de datos del validador
             * @brief Cambia bandera de conexion exitosa/fallida
@@ -329,21 +562,22 @@ namespace ValidatorNV10{
             std::vector<unsigned char> BuildCmd(std::vector<unsigned char> Comm);
 
             /**
-            * @brief Maneja la respuesta de Execute command para que solo sean 4 respuestas
+            * @brief Arma la trama una sola vez y la envia; si la respuesta no llega, llega cortada o con CRC invalido
+            * reenvia la misma trama (mismo bit de secuencia) hasta MaxRetries veces, asi el billetero repite su ultima
+            * respuesta sin volver a ejecutar el comando. Despues de SyncAfter comandos fallidos seguidos envia SYNC
             * @param Comm Comando a escribir en el puerto
             * @return Si retorna -2 -> [SC] El validador reporta que ya habia revisado el comando y no es necesario
             * @return Si retorna -1 -> [SC] Hubo un error grave enviando el comando
             * @return Si retorna  0 -> [SC] Todo funciona correctamente
-            * @return Si retorna  1 -> [SC] Hay que repetir el envio del comando, ya que el validador no lo pudo reconocer
+            * @return Si retorna  1 -> [SC] Se agotaron los reenvios sin una respuesta valida
             * @return Si retorna  2 -> [SC] No ejecuto el comando
             */
             int SendingCommand(std::vector<unsigned char> Comm);
 
             /**
-            * @brief Escribe el comando Comm en el puerto, luego lee la respuesta. 
-            * @brief Si la respuesta no es mayor o igual que la longitud del comando escrito, envia codigo diferente de 0
-            * @brief Si la longitud de la respuesta es igual a la longitud del comando escrito menos uno (longitud real), quiere decir que no reconoce el comando o la direccion de destino 
-            * @param Comm Comando a escribir en el puerto
+            * @brief Escribe la trama Comm en el puerto y lee la respuesta hasta completar la trama (STX, SEQ, LEN, datos
+            * y CRC) o hasta RetryTimeoutMs. Revisa el CRC antes de decodificar
+            * @param Comm Trama completa a escribir en el puerto
             * @return Si retorna -5 -> [EC] El validador no responde, tiempo de espera agotado
             * @return Si retorna -4 -> [EC|HRI] Hubo un error de lectura de respuesta
             * @return Si retorna -3 -> [EC] Hubo un error de escritura de comando
@@ -353,10 +587,19 @@ namespace ValidatorNV10{
             * @return Si retorna  1 -> [HC] El codigo de respuesta es diferente de OK
             * @return Si retorna  2 -> [HR] La respuesta ya se reviso anteriormente, se espera por una nueva
             * @return Si retorna  3 -> [HR] La respuesta no comienza por 127, es decir que no se puede decodificar porque llego corrida
-            * @return Si retorna  4 -> [EC] La respuesta llego muy corta, no se dio el tiempo de espera suficiente para leer
+            * @return Si retorna  4 -> [EC] La respuesta llego incompleta dentro del tiempo de espera
+            * @return Si retorna  5 -> [EC] El CRC de la respuesta no coincide
             */
             int ExecuteCommand(std::vector<unsigned char> Comm);
 
+            /**
+            * @brief Lee del puerto una trama SSP: descarta lo que llegue antes del STX, quita el relleno de bytes
+            * (0x7F 0x7F -> 0x7F) y termina cuando tiene 5 + LEN bytes o se cumple RetryTimeoutMs
+            * @param Buffer Destino de la trama sin relleno
+            * @return int Bytes de la trama leidos (puede ser una trama incompleta), 0 si no llego nada, -1 si hubo error de lectura
+            */
+            int ReadFrame(std::vector<unsigned char> &Buffer);
+
             /**
             * @brief Maneja la respuesta que llega, revisa que el mensaje llegue bien, revisa la longitud de los datos adicionales y maneja la respuesta de acuerdo a la longitud de estos datos
             * @param Response Respuesta que envia el validador
@@ -378,12 +621,13 @@ namespace ValidatorNV10{
             int HandleCode(std::vector<unsigned char> Response);
 
             /**
-            * @brief Toma el codigo del evento que envia el billetero y busca el mensaje asociado
+            * @brief Decodifica todos los eventos de la respuesta de poll en Events. READ, CREDIT, FRAUD y CLEARED
+            * llevan un byte de canal, los demas no llevan datos
             * @param Response Respuesta que envia el billetero
-            * @return Si retorna  0 -> El evento pudo ser identificado
-            * @return Si retorna  1 -> El evento no pudo ser identificado
+            * @return Si retorna  0 -> Todos los eventos pudieron ser identificados
+            * @return Si retorna  1 -> Un evento no pudo ser identificado o la trama quedo cortada, se decodifica hasta ahi
             */
-            int HandleEvent(std::vector<unsigned char> Response);
+            int HandleEvents(const std::vector<unsigned char> &Response);
 
             /**
             * @brief Toma el codigo del ultimo rechazo y busca el mensaje asociado
@@ -392,13 +636,22 @@ namespace ValidatorNV10{
             * @return Si retorna  1 -> El ultimo rechazo no pudo ser identificado
             */
             int HandleLRC(std::vector<unsigned char> Response);
+
             /**
-            * @brief Toma el canal que envia el billetero y busca el billete asociado
+            * @brief Decodifica la respuesta de SETUP_REQUEST (tipo de unidad, firmware, pais, multiplicadores, valores
+            * de los canales y, desde el protocolo 6, los valores expandidos) y reemplaza la tabla de canales
             * @param Response Respuesta que envia el billetero
-            * @return Si retorna  0 -> El billete pudo ser identificado
-            * @return Si retorna  1 -> El billete no pudo ser identificado
+            * @return Si retorna  0 -> La tabla de canales se actualizo
+            * @return Si retorna  1 -> La respuesta esta cortada o reporta un numero de canales no valido
             */
-            int HandleChannel(std::vector<unsigned char> Response);
+            int HandleSetup(const std::vector<unsigned char> &Response);
+
+            /**
+            * @brief Guarda en DatasetVersion el texto de la respuesta de GET_DATASET_VERSION
+            * @param Response Respuesta que envia el billetero
+            * @return Si retorna  0 -> Siempre
+            */
+            int HandleDataset(const std::vector<unsigned char> &Response);
 
             /**
             * @brief Corre el comando DYSPLAY_ON para encender el bezel
@@ -469,6 +722,20 @@ namespace ValidatorNV10{
             * @return Si retorna 0 -> Todo corrio exitosamente
             */
             int Reject();
+
+            /**
+            * @brief Corre el comando SETUP_REQUEST y carga la tabla de canales que reporta el billetero
+            * @return Si retorna 1 -> Error grave enviando el comando o respuesta no valida, se conserva la tabla anterior
+            * @return Si retorna 0 -> Todo corrio exitosamente
+            */
+            int SetupRequest();
+
+            /**
+            * @brief Corre el comando GET_DATASET_VERSION y guarda la version en DatasetVersion
+            * @return Si retorna 1 -> Error grave enviando el comando
+            * @return Si retorna 0 -> Todo corrio exitosamente
+            */
+            int DatasetRequest();
     };
 }
 
@@ -1,11 +1,50 @@
 #include "Pelicano.hpp"
 
-std::thread nativeThreadPelicano;
-Napi::ThreadSafeFunction tsfnPelicano;
-static bool isRunningPelicano = true;
-static bool threadEndedPelicano = true;
+// Mensajes de getCoin/onCoin para el modo compacto. Los codigos 401/402/403 llevan contadores en el mensaje
+// completo, por eso aqui solo se deja su descripcion general
+static const StatusMessage_t CoinMessages[] = {
+  { 202, "Moneda detectada" },
+  { 302, "Moneda rechazada" },
+  { 303, "No hay nueva informacion" },
+  { 401, "Error reportado por el validador" },
+  { 402, "Error reportado por el validador. Contador de errores criticos lleno" },
+  { 403, "Error reportado por el validador. Contador de alertas lleno" },
+  { 404, "DeafaultError" },
+  { 503, "Fallo con el validador. No responde" },
+  { 507, "No se ha iniciado el lector (StartReader)" },
+};
 
-Napi::FunctionReference Pelicano::constructor;
+static Napi::Object CoinResult(Napi::Env env, const CoinError_t &coin, bool compact) {
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  if (compact) {
+    Field_t fields[] = {
+      { KEY_STATUS_CODE,  cache->Number(env, coin.StatusCode) },
+      { KEY_EVENT,        cache->Number(env, coin.Event) },
+      { KEY_COIN,         cache->Number(env, coin.Coin) },
+      { KEY_REMAINING,    cache->Number(env, coin.Remaining) },
+    };
+    return cache->Build(env, fields);
+  }
+  Field_t fields[] = {
+    { KEY_STATUS_CODE,  cache->Number(env, coin.StatusCode) },
+    { KEY_EVENT,        cache->Number(env, coin.Event) },
+    { KEY_COIN,         cache->Number(env, coin.Coin) },
+    { KEY_MESSAGE,      cache->Message(env, coin.StatusCode, coin.Message) },
+    { KEY_REMAINING,    cache->Number(env, coin.Remaining) },
+  };
+  return cache->Build(env, fields);
+}
+
+// startReader, stopReader y cleanDevice pueden limpiar la bandeja, cleanMs es lo que tardo (0 si no se limpio)
+static Napi::Object CleanResult(Napi::Env env, const Response_t &response, long cleanMs) {
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  Field_t fields[] = {
+    { KEY_MESSAGE,      cache->Message(env, response.StatusCode, response.Message) },
+    { KEY_STATUS_CODE,  cache->Number(env, response.StatusCode) },
+    { KEY_CLEAN_MS,     cache->Number(env, cleanMs) },
+  };
+  return cache->Build(env, fields);
+}
 
 Napi::Object Pelicano::Init(Napi::Env env, Napi::Object exports) {
   Napi::HandleScope scope(env);
@@ -22,9 +61,15 @@ Napi::Object Pelicano::Init(Napi::Env env, Napi::Object exports) {
     InstanceMethod("cleanDevice", &Pelicano::CleanDevice),
     InstanceMethod("onCoin", &Pelicano::OnCoin),
     InstanceMethod("getInsertedCoins", &Pelicano::GetInsertedCoins),
+    InstanceMethod("getQueueStats", &Pelicano::GetQueueStats),
+    InstanceMethod("dumpFlightRecorder", &Pelicano::DumpFlightRecorder),
+    InstanceMethod("getEvents", &Pelicano::GetEvents),
+    InstanceMethod("wake", &Pelicano::Wake),
+    InstanceMethod("getPowerStats", &Pelicano::GetPowerStats),
+    InstanceMethod("getPollStats", &Pelicano::GetPollStats),
+    StaticValue("messages", ResultCacheClass::Get(env)->MessageTable(env, CoinMessages, sizeof(CoinMessages)/sizeof(CoinMessages[0]))),
   });
-  constructor = Napi::Persistent(func);
-  constructor.SuppressDestruct();
+  env.GetInstanceData<AddonData::AddonDataClass>()->PelicanoConstructor = Napi::Persistent(func);
   exports.Set("Pelicano", func);
   return exports;
 }
@@ -61,64 +106,98 @@ Pelicano::Pelicano(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Pelicano>(
   this->pelicanoControl_->MaximumPorts = MaximumPorts.Int32Value();
   this->pelicanoControl_->LogLvl = LogLvl.Uint32Value();
   this->pelicanoControl_->Path = LogFilePath.Utf8Value();
+  if (params.Has("capturePath")) {
+    this->pelicanoControl_->CapturePath = params.Get("capturePath").ToString().Utf8Value();
+  }
+  if (params.Has("journalPath")) {
+    this->pelicanoControl_->JournalPath = params.Get("journalPath").ToString().Utf8Value();
+  }
+  if (params.Has("statePath")) {
+    this->pelicanoControl_->StatePath = params.Get("statePath").ToString().Utf8Value();
+  }
+  if (params.Has("cleanTimeout")) {
+    this->pelicanoControl_->CleanTimeoutMs = params.Get("cleanTimeout").ToNumber().Int32Value();
+  }
+  if (params.Has("idleTimeout")) {
+    this->pelicanoControl_->IdleTimeoutMs = params.Get("idleTimeout").ToNumber().Int32Value();
+  }
+  if (params.Has("idlePollInterval")) {
+    this->pelicanoControl_->IdlePollMs = params.Get("idlePollInterval").ToNumber().Int32Value();
+  }
+  PollScheduler::Config_t config = this->pelicanoControl_->PollRate.GetConfig();
+  if (PollScheduler::ParseConfig(params, config)) {
+    this->pelicanoControl_->PollRate.Configure(config);
+  }
+  if (params.Has("speedControl") && params.Get("speedControl").IsObject()) {
+    Napi::Object speed = params.Get("speedControl").As<Napi::Object>();
+    SpeedControl::Config_t config = SpeedControl::DefaultConfig();
+    if (speed.Has("minSpeed")) config.MinSpeed = speed.Get("minSpeed").ToNumber().Int32Value();
+    if (speed.Has("maxSpeed")) config.MaxSpeed = speed.Get("maxSpeed").ToNumber().Int32Value();
+    if (speed.Has("windowMs")) config.WindowMs = speed.Get("windowMs").ToNumber().Int32Value();
+    if (speed.Has("idleMs")) config.IdleMs = speed.Get("idleMs").ToNumber().Int32Value();
+    if (speed.Has("upPercent")) config.UpPercent = speed.Get("upPercent").ToNumber().Int32Value();
+    if (speed.Has("rejectPercent")) config.RejectPercent = speed.Get("rejectPercent").ToNumber().Int32Value();
+    this->pelicanoControl_->Speed.Configure(config);
+  }
+  this->compact_ = params.Has("compact") && params.Get("compact").ToBoolean().Value();
+
+  this->isRunning_ = true;
+  this->threadEnded_ = true;
 
   this->pelicanoControl_->InitLog();
 }
 
+// Los hilos tienen una referencia al objeto mientras corren, asi que cuando JS lo libera ya terminaron. Al borrar
+// el control se cierra el puerto (libera el flock), se da de baja el logger y se cierran el diario y el estado
+Pelicano::~Pelicano() {
+  this->isRunning_ = false;
+  if (this->nativeThread_.joinable()) {
+    this->nativeThread_.join();
+  }
+  delete this->pelicanoControl_;
+}
+
 Napi::Value Pelicano::Connect(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->pelicanoControl_->Connect();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value Pelicano::CheckDevice(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->pelicanoControl_->CheckDevice();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value Pelicano::StartReader(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->pelicanoControl_->StartReader();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return CleanResult(env, response, this->pelicanoControl_->Globals.PelicanoObject.CleanMs);
 }
 
 Napi::Value Pelicano::GetCoin(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   CoinError_t response = this->pelicanoControl_->GetCoin();
-  Napi::Object object = Napi::Object::New(env);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  object["event"] = Napi::Number::New(env, response.Event);
-  object["coin"] = Napi::Number::New(env, response.Coin);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["remaining"] = Napi::Number::New(env, response.Remaining);
-  return object;
+  return CoinResult(env, response, this->compact_);
 }
 
 Napi::Value Pelicano::GetLostCoins(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   CoinLost_t response = this->pelicanoControl_->GetLostCoins();
-  Napi::Object object = Napi::Object::New(env);
-  object["50"] = Napi::Number::New(env, response.CoinCinc);
-  object["100"] = Napi::Number::New(env, response.CoinCien);
-  object["200"] = Napi::Number::New(env, response.CoinDosc);
-  object["500"] = Napi::Number::New(env, response.CoinQuin);
-  object["1000"] = Napi::Number::New(env, response.CoinMil);
-  return object;
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  Field_t fields[] = {
+    { KEY_COIN_50,    cache->Number(env, response.CoinCinc) },
+    { KEY_COIN_100,   cache->Number(env, response.CoinCien) },
+    { KEY_COIN_200,   cache->Number(env, response.CoinDosc) },
+    { KEY_COIN_500,   cache->Number(env, response.CoinQuin) },
+    { KEY_COIN_1000,  cache->Number(env, response.CoinMil) },
+  };
+  return cache->Build(env, fields);
 }
 
 Napi::Value Pelicano::ModifyChannels(const Napi::CallbackInfo& info) {
@@ -132,56 +211,46 @@ Napi::Value Pelicano::ModifyChannels(const Napi::CallbackInfo& info) {
   Napi::Number InhibitMask2 = info[1].As<Napi::Number>();
 
   Response_t response = this->pelicanoControl_->ModifyChannels(InhibitMask1.Int32Value(), InhibitMask2.Int32Value());
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value Pelicano::StopReader(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
-  isRunningPelicano = false;
+  this->isRunning_ = false;
   Response_t response = this->pelicanoControl_->StopReader();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return CleanResult(env, response, this->pelicanoControl_->Globals.PelicanoObject.CleanMs);
 }
 
 Napi::Value Pelicano::ResetDevice(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->pelicanoControl_->ResetDevice();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
 }
 
 Napi::Value Pelicano::TestStatus(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   TestStatus_t response = this->pelicanoControl_->TestStatus();
-  Napi::Object object = Napi::Object::New(env);
-  object["version"] = Napi::String::New(env, response.Version);
-  object["device"] = Napi::Number::New(env, response.Device);
-  object["errorType"] = Napi::Number::New(env, response.ErrorType);
-  object["errorCode"] = Napi::Number::New(env, response.ErrorCode);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["aditionalInfo"] = Napi::String::New(env, response.AditionalInfo);
-  object["priority"] = Napi::Number::New(env, response.Priority);
-  return object;
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  Field_t fields[] = {
+    { KEY_VERSION,        cache->String(env, response.Version) },
+    { KEY_DEVICE,         cache->Number(env, response.Device) },
+    { KEY_ERROR_TYPE,     cache->Number(env, response.ErrorType) },
+    { KEY_ERROR_CODE,     cache->Number(env, response.ErrorCode) },
+    { KEY_MESSAGE,        cache->Text(env, response.Message) },
+    { KEY_ADITIONAL_INFO, cache->Text(env, response.AditionalInfo) },
+    { KEY_PRIORITY,       cache->Number(env, response.Priority) },
+  };
+  return cache->Build(env, fields);
 }
 
 Napi::Value Pelicano::CleanDevice(const Napi::CallbackInfo &info) { 
   Napi::Env env = info.Env();
   Napi::HandleScope scope(env);
   Response_t response = this->pelicanoControl_->CleanDevice();
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  return object;
+  return CleanResult(env, response, this->pelicanoControl_->Globals.PelicanoObject.CleanMs);
 }
 
 Napi::Value Pelicano::GetInsertedCoins(const Napi::CallbackInfo &info)
@@ -190,11 +259,13 @@ Napi::Value Pelicano::GetInsertedCoins(const Napi::CallbackInfo &info)
   Napi::HandleScope scope(env);
   Response_t response = this->pelicanoControl_->GetInsertedCoins();
   long insertedCoins = this->pelicanoControl_->InsertedCoins;
-  Napi::Object object = Napi::Object::New(env);
-  object["message"] = Napi::String::New(env, response.Message);
-  object["statusCode"] = Napi::Number::New(env, response.StatusCode);
-  object["insertedCoins"] = Napi::Number::New(env, insertedCoins);
-  return object;
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  Field_t fields[] = {
+    { KEY_MESSAGE,        cache->Message(env, response.StatusCode, response.Message) },
+    { KEY_STATUS_CODE,    cache->Number(env, response.StatusCode) },
+    { KEY_INSERTED_COINS, cache->Number(env, insertedCoins) },
+  };
+  return cache->Build(env, fields);
 }
 
 Napi::Value Pelicano::OnCoin(const Napi::CallbackInfo &info)
@@ -207,47 +278,95 @@ Napi::Value Pelicano::OnCoin(const Napi::CallbackInfo &info)
   }
   
   Napi::Function napiFunction = info[0].As<Napi::Function>();
-  tsfnPelicano = Napi::ThreadSafeFunction::New(
+  // El hilo usa this: el objeto no se libera hasta el finalizador del tsfn (Unref)
+  this->Ref();
+  this->tsfn_ = Napi::ThreadSafeFunction::New(
     env, 
     napiFunction, 
     "Callback", 
     0, 
     1,
-    []( Napi::Env ) {
-      nativeThreadPelicano.join();
+    [this]( Napi::Env ) {
+      this->nativeThread_.join();
+      this->Unref();
     });
 
-  nativeThreadPelicano = std::thread ( [this] {
-    auto callback = [](Napi::Env env, Napi::Function jsCallback, CoinError_t* coin) {
-      Napi::Object object = Napi::Object::New(env);
-      object["statusCode"] = Napi::Number::New(env, coin->StatusCode);
-      object["event"] = Napi::Number::New(env, coin->Event);
-      object["coin"] = Napi::Number::New(env, coin->Coin);
-      object["message"] = Napi::String::New(env, coin->Message);
-      object["remaining"] = Napi::Number::New(env, coin->Remaining);
-      jsCallback.Call({object});
+  this->nativeThread_ = std::thread ( [this] {
+    bool compact = this->compact_;
+    auto callback = [compact](Napi::Env env, Napi::Function jsCallback, CoinError_t* coin) {
+      jsCallback.Call({CoinResult(env, *coin, compact)});
       delete coin;
     };
-    isRunningPelicano = true;
-    threadEndedPelicano = false;
-    while (isRunningPelicano) {
-      std::this_thread::sleep_for( std::chrono::milliseconds(10));
+    this->isRunning_ = true;
+    this->threadEnded_ = false;
+    while (this->isRunning_) {
+      // La espera larga (reposo o sin actividad) va en pasos de 10 ms para responder rapido a finish y a wake
+      PollScheduler::WaitNextPoll([this] { return this->pelicanoControl_->PollDelayMs(); }, this->isRunning_);
       CoinError_t response = this->pelicanoControl_->GetCoin();
       if (response.StatusCode == 303) continue;
       CoinError_t *value = new CoinError_t(response);
-      napi_status status = tsfnPelicano.BlockingCall(value, callback);
+      napi_status status = this->tsfn_.BlockingCall(value, callback);
       if ( status != napi_ok ) break;
     }
-    threadEndedPelicano = true;
-    tsfnPelicano.Release();
+    this->threadEnded_ = true;
+    this->tsfn_.Release();
   });
 
-  auto finishFn = [] (const Napi::CallbackInfo& info) {
-    isRunningPelicano = false;
-    while (!threadEndedPelicano);
+  auto finishFn = [this] (const Napi::CallbackInfo& info) {
+    this->isRunning_ = false;
+    while (!this->threadEnded_);
     std::this_thread::sleep_for( std::chrono::milliseconds(50));
     return;
   };
 
   return Napi::Function::New(env, finishFn);
+}
+
+Napi::Value Pelicano::GetQueueStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  return ResultCacheClass::Get(env)->QueueStats(env, this->pelicanoControl_->Scheduler);
+}
+
+Napi::Value Pelicano::DumpFlightRecorder(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  long count = this->pelicanoControl_->DumpFlightRecorder();
+  return ResultCacheClass::Get(env)->RecorderDump(env, count, this->pelicanoControl_->Globals.PelicanoObject.Recorder.Path);
+}
+
+Napi::Value Pelicano::GetEvents(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  uint64_t since = (info.Length() > 0 && info[0].IsNumber()) ? static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value()) : 0;
+  std::vector<EventJournal::Event_t> events;
+  this->pelicanoControl_->GetEvents(since, events);
+  return ResultCacheClass::Get(env)->JournalEvents(env, events);
+}
+
+Napi::Value Pelicano::Wake(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  Response_t response = this->pelicanoControl_->Wake();
+  return ResultCacheClass::Get(env)->Response(env, response.StatusCode, response.Message);
+}
+
+Napi::Value Pelicano::GetPowerStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  PowerStats_t stats = this->pelicanoControl_->GetPowerStats();
+  ResultCacheClass *cache = ResultCacheClass::Get(env);
+  Field_t fields[] = {
+    { KEY_IDLE,       cache->Boolean(env, stats.Idle) },
+    { KEY_ACTIVE_MS,  cache->Number(env, static_cast<double>(stats.ActiveMs)) },
+    { KEY_IDLE_MS,    cache->Number(env, static_cast<double>(stats.IdleMs)) },
+    { KEY_WAKEUPS,    cache->Number(env, static_cast<double>(stats.Wakeups)) },
+  };
+  return cache->Build(env, fields);
+}
+
+Napi::Value Pelicano::GetPollStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+  return ResultCacheClass::Get(env)->PollStats(env, this->pelicanoControl_->GetPollStats());
 }
\ No newline at end of file
@@ -1,16 +1,20 @@
 #include <napi.h>
 #include <thread>
 #include <chrono>
+#include <atomic>
 #include "PelicanoControl.hpp"
+#include "../common/AddonData.hpp"
+#include "../common/PollOptions.hpp"
 
 using namespace PelicanoControl;
+using namespace ResultCache;
 
 class Pelicano : public Napi::ObjectWrap<Pelicano> {
   public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
     Pelicano(const Napi::CallbackInfo& info);
+    ~Pelicano();
   private:
-    static Napi::FunctionReference constructor;
     Napi::Value Connect(const Napi::CallbackInfo& info);
     Napi::Value CheckDevice(const Napi::CallbackInfo& info);
     Napi::Value StartReader(const Napi::CallbackInfo& info);
@@ -23,5 +27,16 @@ class Pelicano : public Napi::ObjectWrap<Pelicano> {
     Napi::Value CleanDevice(const Napi::CallbackInfo& info);
     Napi::Value GetInsertedCoins(const Napi::CallbackInfo& info);
     Napi::Value OnCoin(const Napi::CallbackInfo& info);
+    Napi::Value GetQueueStats(const Napi::CallbackInfo& info);
+    Napi::Value DumpFlightRecorder(const Napi::CallbackInfo& info);
+    Napi::Value GetEvents(const Napi::CallbackInfo& info);
+    Napi::Value Wake(const Napi::CallbackInfo& info);
+    Napi::Value GetPowerStats(const Napi::CallbackInfo& info);
+    Napi::Value GetPollStats(const Napi::CallbackInfo& info);
     PelicanoControlClass *pelicanoControl_;
+    std::thread nativeThread_;
+    Napi::ThreadSafeFunction tsfn_;
+    std::atomic<bool> isRunning_;
+    std::atomic<bool> threadEnded_;
+    bool compact_;
 };
\ No newline at end of file
@@ -16,33 +16,13 @@ namespace PelicanoControl {
     using namespace PelicanoStateMachine;
     using namespace ValidatorPelicano;
 
-    // --------------- EXTERNAL VARIABLES --------------------//
-
-    // READ ONLY
-    int PortO;
-    unsigned long InsertedCoins;
-
-    // WRITE ONLY
-    int WarnToCritical;
-    int MaxCritical;
-    std::string Path;
-    int LogLvl;
-    int MaximumPorts;
-    
     // --------------- INTERNAL VARIABLES --------------------//
     
-    std::string VERSION = "1.1";
-    std::string DEFAULTERROR = "DeafaultError";
-    int Remaining;
-    bool FlagCritical;
-    bool FlagCritical2;
-    int WarnCounter;
-    int CriticalCounter;
-    int CoinEventPrev;
-    
-    Response_t Response;
+    const std::string VERSION = "1.1";
+    const std::string DEFAULTERROR = "DeafaultError";
+    const int IDLEPOLLMS = 1000;        // Intervalo de polling por defecto con el motor apagado (ms)
     
-    PelicanoControlClass::PelicanoControlClass(){
+    PelicanoControlClass::PelicanoControlClass() : PollRate(PollScheduler::CCTALKMINMS, PollScheduler::CCTALKMAXMS) {
         
         PortO = 0;
         CoinEventPrev = 0;
@@ -57,6 +37,16 @@ namespace PelicanoControl {
         LogLvl = 1;
         InsertedCoins = 0;                
         MaximumPorts = 10;
+        CleanTimeoutMs = CLEANTIMEOUTMS;
+        IdleTimeoutMs = 0;
+        IdlePollMs = IDLEPOLLMS;
+        Reading = false;
+        Idle = false;
+        Power = PowerStats_t();
+        InhibitMask1 = -1;
+        InhibitMask2 = -1;
+        ResumePending = false;
+        Saved = SavedState_t();
         Response.StatusCode = 404;
         Response.Message = DEFAULTERROR;
     }
@@ -67,9 +57,35 @@ namespace PelicanoControl {
         Globals.PelicanoObject.LoggerLevel = LogLvl;
         Globals.PelicanoObject.InitLogger(Path);
         Globals.PelicanoObject.MaxPorts = MaximumPorts;
+        Globals.PelicanoObject.CleanTimeoutMs = CleanTimeoutMs;
+        if (!CapturePath.empty()){
+            Globals.PelicanoObject.StartCapture(CapturePath);
+        }
+        if (!JournalPath.empty()){
+            if (Journal.Open(JournalPath) == 0){
+                Globals.PelicanoObject.logger->info("[InitLog] Event journal {0} opened, last sequence {1}",JournalPath,Journal.LastSequence());
+            }
+            else {
+                Globals.PelicanoObject.logger->error("[InitLog] Could not open event journal {0}",JournalPath);
+            }
+        }
+        if (!StatePath.empty()){
+            int Open = State.Open(StatePath, sizeof(SavedState_t));
+            if (Open < 0){
+                Globals.PelicanoObject.logger->error("[InitLog] Could not open state file {0}",StatePath);
+            }
+            else if ((Open == 0) && State.Load(&Saved)){
+                InhibitMask1 = Saved.InhibitMask1;
+                InhibitMask2 = Saved.InhibitMask2;
+                InsertedCoins = Saved.InsertedCoins;
+                ResumePending = (Saved.Polling == 1);
+                Globals.PelicanoObject.logger->info("[InitLog] State file {0} loaded, polling: {1} coin event: {2}",StatePath,Saved.Polling,Saved.CoinEventPrev);
+            }
+        }
     }
 
     Response_t PelicanoControlClass::Connect() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
         
         int Connection = -1;
         int Check = -1;
@@ -104,6 +120,7 @@ namespace PelicanoControl {
     }
 
     Response_t PelicanoControlClass::CheckDevice() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         int Check = -1;
 
@@ -117,12 +134,14 @@ namespace PelicanoControl {
     }
 
     Response_t PelicanoControlClass::StartReader() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
         
         int Enable = -1;
         int Poll = -1;
         int Reset = -1;
         int Check = -1;
         int CleanBowl = -1;
+        int Resume = -1;
 
         bool FlagReady = false;
         bool FlagBowlInBadState = false;
@@ -135,10 +154,14 @@ namespace PelicanoControl {
 
         FlagCritical = false;
         FlagCritical2 = false;
+        Globals.PelicanoObject.CleanMs = 0;
+
+        //Si el lector esta en reposo se enciende el motor antes de revisar la bandeja
+        WakeUp("startReader", std::chrono::steady_clock::now());
 
         //Deberia entrar aca desde el estado ST_CHECK
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
-        if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_CHECK") == 0){
+        if (Globals.SMObject.SM.CurrState == PelicanoSMClass::ST_CHECK){
             // Si la bandeja esta limpia y cerrada se activa bandera para que comience a inicar el polling
             if ((Globals.PelicanoObject.CoinPresent == false) & (Globals.PelicanoObject.TrashDoorOpen == false)){
                 FlagReady = true;
@@ -164,7 +187,7 @@ namespace PelicanoControl {
                 }
             }
         }
-        else if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_POLLING") == 0){
+        else if (Globals.SMObject.SM.CurrState == PelicanoSMClass::ST_POLLING){
             //Se revisa que el evento este reiniciado y con buen estado en el bowl para poder comenzar a hacer polling correctamente
             if ((Globals.PelicanoObject.CoinEvent <= 1) & (Globals.PelicanoObject.CoinPresent == false) & (Globals.PelicanoObject.TrashDoorOpen == false)){
                 FlagRepeat = false;
@@ -204,8 +227,42 @@ namespace PelicanoControl {
             }    
         }
 
-        if (FlagReady){
-            //Si llega hasta este punto, debe estar en el estado ST_CHECK
+        if (FlagReady & ResumePending){
+            //Arranque en caliente: el lector estaba iniciado cuando se reinicio el proceso, se intenta retomar sin reiniciar el validador
+            ResumePending = false;
+            Globals.PelicanoObject.ResumeEvent = Saved.CoinEventPrev;
+            //Cambio de estado: ST_CHECK ---> ST_RESUME
+            Resume = Globals.SMObject.StateMachineRun(PelicanoSMClass::EV_RESUME);
+            //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
+        }
+
+        if (Resume == 0){
+            //Cambio de estado: ST_RESUME ---> ST_POLLING
+            Poll = Globals.SMObject.StateMachineRun(PelicanoSMClass::EV_READY);
+            //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
+
+            if ((Poll == 0) | (Poll == -2)){
+                //Se regresa el cursor al valor guardado para que el siguiente GetCoin entregue los eventos que quedaron pendientes
+                Globals.PelicanoObject.CoinEventPrev = Saved.CoinEventPrev;
+                CoinEventPrev = (Saved.CoinEventPrev == 255) ? 0 : Saved.CoinEventPrev;
+                WarnCounter = Saved.WarnCounter;
+                CriticalCounter = Saved.CriticalCounter;
+                if ((InhibitMask1 >= 0) & (InhibitMask2 >= 0)){
+                    Globals.PelicanoObject.ChangeInhibitChannels(InhibitMask1,InhibitMask2);
+                }
+                Response.StatusCode = 207;
+                Response.Message = "Validador OK. Lector retomado sin reiniciar el validador";
+                if (Speed.Enabled()){
+                    ApplySpeed(Speed.Start(std::chrono::steady_clock::now()));
+                }
+            }
+            else {
+                Response.StatusCode = 503;
+                Response.Message = "Fallo con el validador. No responde";
+            }
+        }
+        else if (FlagReady){
+            //Si llega hasta este punto, debe estar en el estado ST_CHECK (o ST_RESUME si no se pudo retomar)
             //Cambio de estado: ST_CHECK ---> ST_ENABLE
             Enable = Globals.SMObject.StateMachineRun(PelicanoSMClass::EV_CALL_POLLING);
             //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
@@ -217,6 +274,9 @@ namespace PelicanoControl {
                 if (((Poll == 0) | (Poll == -2)) & (Globals.PelicanoObject.CoinEvent <= 1)){
                     Response.StatusCode = 201;
                     Response.Message = "Validador OK. Listo para iniciar a leer monedas";
+                    if (Speed.Enabled()){
+                        ApplySpeed(Speed.Start(std::chrono::steady_clock::now()));
+                    }
                 }
                 else {
                     Response.StatusCode = 503;
@@ -246,10 +306,15 @@ namespace PelicanoControl {
                 Response.Message = "Start reader corrio nuevamente. Listo para iniciar";
             }
         }
+        if (Globals.SMObject.SM.CurrState == PelicanoSMClass::ST_POLLING){
+            StartPower(std::chrono::steady_clock::now());
+        }
+        SaveState();
         return Response;
     }
 
     CoinError_t PelicanoControlClass::GetCoin() {
+        CommandTicket Ticket(Scheduler, PRIORITY_POLL);
         
         CoinError_t ResponseCE;
 
@@ -260,11 +325,29 @@ namespace PelicanoControl {
         ResponseCE.Remaining = 0;
 
         int Poll = -1;
+        std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
 
         //Deberia entrar aca desde el estado ST_POLLING
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
 
-        if (strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_POLLING") == 0){
+        if ((Globals.SMObject.SM.CurrState == PelicanoSMClass::ST_POLLING) & Idle){
+            //En reposo solo se leen los optosensores cada IdlePollMs: con el disco quieto las monedas se quedan en la bandeja
+            if (Now - LastIdlePoll >= std::chrono::milliseconds(IdlePollMs)){
+                LastIdlePoll = Now;
+                int Opto = Globals.PelicanoObject.CheckOptoStates();
+                if ((Opto == 1) | (Opto == 2)){
+                    WakeUp("sensor", Now);
+                }
+            }
+        }
+
+        if ((Globals.SMObject.SM.CurrState == PelicanoSMClass::ST_POLLING) & Idle){
+            ResponseCE.StatusCode = 303;
+            ResponseCE.Event = CoinEventPrev;
+            ResponseCE.Coin = 0;
+            ResponseCE.Message = "No hay nueva informacion";
+        }
+        else if (Globals.SMObject.SM.CurrState == PelicanoSMClass::ST_POLLING){
             //Cambio de estado: ST_POLLING ---> ST_POLLING
             Poll = Globals.SMObject.StateMachineRun(PelicanoSMClass::EV_POLL);
             
@@ -352,8 +435,29 @@ namespace PelicanoControl {
                     ResponseCE.Remaining = Remaining;                            
                 }
 
+                // El diario guarda solo las monedas aceptadas y rechazadas, los errores quedan en el log. Va un registro
+                // por moneda del polling, tambien cuando el mismo polling trae un error, para que cuadre con InsertedCoins
+                for (const CoinPolling_t &Coin : Globals.PelicanoObject.PollCoins){
+                    Journal.Append(SerialCapture::DEVICE_PELICANO, EventJournal::EVENT_COIN_ACCEPTED, Coin.Coin, Coin.Channel, ResponseCE.StatusCode);
+                }
+                Globals.PelicanoObject.PollCoins.clear();
+                if (ResponseCE.StatusCode == 302){
+                    Journal.Append(SerialCapture::DEVICE_PELICANO, EventJournal::EVENT_COIN_REJECTED, 0, 0, ResponseCE.StatusCode);
+                }
+
+                if (Speed.Enabled()){
+                    if (ResponseCE.StatusCode == 202){
+                        Speed.Accepted((Remaining > 1) ? Remaining : 1, std::chrono::steady_clock::now());
+                    }
+                    else if (Poll == -2){
+                        Speed.Rejected(Globals.PelicanoObject.ErrorOCode, std::chrono::steady_clock::now());
+                    }
+                }
+
                 CoinEventPrev = (Globals.PelicanoObject.CoinEvent == 255) ? 0 : Globals.PelicanoObject.CoinEvent;
-                
+                LastActivity = Now;
+                PollRate.Activity(Now);
+                SaveState();
             }
             else{
                 ResponseCE.StatusCode = 303;
@@ -361,15 +465,147 @@ namespace PelicanoControl {
                 ResponseCE.Coin = 0;
                 ResponseCE.Message = "No hay nueva informacion";
             }
+
+            if (Speed.Enabled()){
+                ApplySpeed(Speed.Update(std::chrono::steady_clock::now()));
+            }
+
+            if (Reading & (IdleTimeoutMs > 0) & (Now - LastActivity >= std::chrono::milliseconds(IdleTimeoutMs))){
+                EnterIdle(Now);
+            }
+            PollRate.Next(Now);
         }
         else{
+            //El lector salio de ST_POLLING por otro comando (reset, limpieza), se deja de contar el tiempo
+            if (Reading){
+                AccountMode(Now);
+                Reading = false;
+                Idle = false;
+            }
             ResponseCE.StatusCode = 507;
             ResponseCE.Message = "No se ha iniciado el lector (StartReader)";
         }
         return ResponseCE;
     }
 
+    void PelicanoControlClass::ApplySpeed(SpeedControl::Change_t Change){
+        static const char *Reasons[] = { "none", "start", "burst", "idle", "speed rejects", "disk blocked" };
+
+        if (Change.Speed == 0){
+            return;
+        }
+        int Previous = Speed.Speed();
+        std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+
+        if (Globals.PelicanoObject.SetSpeed(Change.Speed) != 0){
+            // La velocidad inicial se reintenta en el siguiente poll, un ajuste espera otra ventana
+            Globals.PelicanoObject.logger->error("[ApplySpeed] Could not set disk speed {0} ({1})",Change.Speed,Reasons[Change.Reason]);
+            Speed.Failed(Now);
+            return;
+        }
+        Speed.Applied(Change.Speed, Now);
+        Globals.PelicanoObject.logger->info("[ApplySpeed] Disk speed {0} -> {1} ({2})",Previous,Change.Speed,Reasons[Change.Reason]);
+        Journal.Append(SerialCapture::DEVICE_PELICANO, EventJournal::EVENT_SPEED_CHANGE, Change.Speed, Previous, Change.Reason);
+    }
+
+    void PelicanoControlClass::StartPower(std::chrono::steady_clock::time_point Now){
+        AccountMode(Now);
+        Reading = true;
+        Idle = false;
+        LastActivity = Now;
+        PollRate.Start(Now);
+    }
+
+    void PelicanoControlClass::AccountMode(std::chrono::steady_clock::time_point Now){
+        if (Reading){
+            uint64_t Ms = std::chrono::duration_cast<std::chrono::milliseconds>(Now - ModeSince).count();
+            if (Idle){
+                Power.IdleMs += Ms;
+            }
+            else {
+                Power.ActiveMs += Ms;
+            }
+            // Se avanza solo lo contado para no perder la fraccion de milisegundo en cada llamada
+            ModeSince += std::chrono::milliseconds(Ms);
+        }
+        else {
+            ModeSince = Now;
+        }
+    }
+
+    void PelicanoControlClass::EnterIdle(std::chrono::steady_clock::time_point Now){
+        if (Idle){
+            return;
+        }
+        if (Globals.PelicanoObject.StopMotor() != 0){
+            // Se vuelve a intentar despues de otro IdleTimeoutMs
+            Globals.PelicanoObject.logger->error("[EnterIdle] Could not stop motor, staying active");
+            LastActivity = Now;
+            return;
+        }
+        AccountMode(Now);
+        Idle = true;
+        LastIdlePoll = Now;
+        Globals.PelicanoObject.logger->info("[EnterIdle] No activity for {0} ms, motor stopped, polling every {1} ms",IdleTimeoutMs,IdlePollMs);
+    }
+
+    int PelicanoControlClass::WakeUp(const char *Reason, std::chrono::steady_clock::time_point Now){
+        LastActivity = Now;
+        if (!Idle){
+            return 0;
+        }
+        if (Globals.PelicanoObject.StartMotor() != 0){
+            Globals.PelicanoObject.logger->error("[WakeUp] Could not start motor ({0})",Reason);
+            return 1;
+        }
+        AccountMode(Now);
+        Idle = false;
+        PollRate.Activity(Now);
+        Power.Wakeups++;
+        Globals.PelicanoObject.logger->info("[WakeUp] Motor started ({0})",Reason);
+        return 0;
+    }
+
+    Response_t PelicanoControlClass::Wake() {
+        CommandTicket Ticket(Scheduler, PRIORITY_URGENT);
+
+        if (!Reading | (Globals.SMObject.SM.CurrState != PelicanoSMClass::ST_POLLING)){
+            Response.StatusCode = 507;
+            Response.Message = "No se ha iniciado el lector (StartReader)";
+        }
+        else if (WakeUp("wake", std::chrono::steady_clock::now()) == 0){
+            Response.StatusCode = 208;
+            Response.Message = "Validador OK. Motor encendido, lector activo";
+        }
+        else {
+            Response.StatusCode = 512;
+            Response.Message = "Fallo con el validador. No se pudo encender el motor";
+        }
+
+        return Response;
+    }
+
+    PowerStats_t PelicanoControlClass::GetPowerStats() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
+
+        // Se cierra el tramo actual para que el modo en curso quede contado
+        AccountMode(std::chrono::steady_clock::now());
+        PowerStats_t Stats = Power;
+        Stats.Idle = Idle;
+        return Stats;
+    }
+
+    PollScheduler::Stats_t PelicanoControlClass::GetPollStats() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
+        return PollRate.Stats(std::chrono::steady_clock::now());
+    }
+
+    int PelicanoControlClass::PollDelayMs() {
+        return Idle ? IdlePollMs : PollRate.Interval();
+    }
+
     CoinLost_t PelicanoControlClass::GetLostCoins() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         CoinLost_t ResponseLC;
 
@@ -379,7 +615,7 @@ namespace PelicanoControl {
         ResponseLC.CoinQuin = 0;
         ResponseLC.CoinMil = 0;
 
-        if(strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_POLLING") == 0){
+        if(Globals.SMObject.SM.CurrState == PelicanoSMClass::ST_POLLING){
             ResponseLC.CoinCinc = Globals.PelicanoObject.CoinCinc;
             ResponseLC.CoinCien = Globals.PelicanoObject.CoinCien;
             ResponseLC.CoinDosc = Globals.PelicanoObject.CoinDosc;
@@ -391,10 +627,14 @@ namespace PelicanoControl {
     }
     
     Response_t PelicanoControlClass::ModifyChannels(int InhibitMask1,int InhibitMask2) {
+        CommandTicket Ticket(Scheduler, PRIORITY_URGENT);
 
         int Inhibit = Globals.PelicanoObject.ChangeInhibitChannels(InhibitMask1,InhibitMask2);
 
         if (Inhibit == 0){
+            this->InhibitMask1 = InhibitMask1;
+            this->InhibitMask2 = InhibitMask2;
+            SaveState();
             Response.StatusCode = 203;
             Response.Message = "Validador OK. Canales inhibidos correctamente";
         }
@@ -407,16 +647,23 @@ namespace PelicanoControl {
     }
 
     Response_t PelicanoControlClass::StopReader() {
+        CommandTicket Ticket(Scheduler, PRIORITY_URGENT);
               
         //Deberia entrar aca desde el estado ST_POLLING
 
         int CleanBowl = -1;
         int Reset = -1;
         int Check = -1;
+        Globals.PelicanoObject.CleanMs = 0;
+
+        //La limpieza de la bandeja enciende y apaga el motor, el reposo termina con el lector
+        AccountMode(std::chrono::steady_clock::now());
+        Reading = false;
+        Idle = false;
 
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
 
-        if(strcmp(Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState), "ST_POLLING") == 0){
+        if(Globals.SMObject.SM.CurrState == PelicanoSMClass::ST_POLLING){
             if ((FlagCritical) | (FlagCritical2)) {
                 //Cambio de estado: ST_POLLING ---> ST_CLEANBOWL
                 Globals.SMObject.StateMachineRun(PelicanoSMClass::EV_FINISH_POLL);
@@ -464,10 +711,12 @@ namespace PelicanoControl {
             Response.Message = "No se puede detener el lector porque no se ha iniciado";
         }
 
+        SaveState();
         return Response;
     }
 
     Response_t PelicanoControlClass::ResetDevice() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         int Reset = -1;
 
@@ -488,8 +737,10 @@ namespace PelicanoControl {
     }
 
     Response_t PelicanoControlClass::CleanDevice() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         int Clean = -1;
+        Globals.PelicanoObject.CleanMs = 0;
 
         //std::cout<<"[MAIN] Estado actual: "<<Globals.SMObject.StateMachineGetStateName(Globals.SMObject.SM.CurrState)<<std::endl;
         Clean = Globals.SMObject.RunClean();
@@ -508,6 +759,7 @@ namespace PelicanoControl {
     }
 
     Response_t PelicanoControlClass::GetInsertedCoins() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
         
         int Insert = Globals.PelicanoObject.GetCountCoins();
                 
@@ -516,6 +768,7 @@ namespace PelicanoControl {
             std::string InsCoins = std::to_string(InsertedCoins);
             Response.StatusCode = 206;
             Response.Message = "Validador OK. Monedas insertadas: "+InsCoins;
+            SaveState();
         }
         else {
             Response.StatusCode = 511;
@@ -526,6 +779,7 @@ namespace PelicanoControl {
     }
 
     TestStatus_t PelicanoControlClass::TestStatus() {
+        CommandTicket Ticket(Scheduler, PRIORITY_NORMAL);
 
         TestStatus_t Status;
         
@@ -600,5 +854,31 @@ namespace PelicanoControl {
         }
         return Response;
     }
-}
 
+    void PelicanoControlClass::SaveState(){
+        if (!State.IsOpen()){
+            return;
+        }
+        // Se guarda el cursor del validador (no el de esta clase, que pasa de 255 a 0) para poder compararlo con el contador
+        Saved.Polling = (Globals.SMObject.SM.CurrState == PelicanoSMClass::ST_POLLING) ? 1 : 0;
+        Saved.CoinEventPrev = Globals.PelicanoObject.CoinEventPrev;
+        Saved.InhibitMask1 = InhibitMask1;
+        Saved.InhibitMask2 = InhibitMask2;
+        Saved.WarnCounter = WarnCounter;
+        Saved.CriticalCounter = CriticalCounter;
+        Saved.InsertedCoins = InsertedCoins;
+        if (State.Save(&Saved) != 0){
+            Globals.PelicanoObject.logger->error("[SaveState] Could not save state file {0}",StatePath);
+        }
+    }
+
+    long PelicanoControlClass::DumpFlightRecorder() {
+        // Sin turno del planificador: el flight recorder se lee sin locks y no usa el puerto serial
+        return Globals.PelicanoObject.DumpRecorder("N-API");
+    }
+
+    size_t PelicanoControlClass::GetEvents(uint64_t Since, std::vector<EventJournal::Event_t> &Events) {
+        // Sin turno del planificador: el diario tiene su propio mutex y no usa el puerto serial
+        return Journal.ReadSince(Since, Events, EventJournal::READLIMIT);
+    }
+}
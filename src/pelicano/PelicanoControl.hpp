@@ -13,14 +13,22 @@
 #define PELICANOCONTROL
 
 #include <stdio.h>
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <iostream>
 #include "StateMachine.hpp"
+#include "../common/CommandScheduler.hpp"
+#include "../common/EventJournal.hpp"
+#include "../common/PollScheduler.hpp"
+#include "../common/StateFile.hpp"
+#include "SpeedControl.hpp"
 #include "ValidatorPelicano.hpp"
 
 namespace PelicanoControl{
 
     using namespace PelicanoStateMachine;
+    using namespace CommandScheduler;
     using namespace ValidatorPelicano;
 
     struct Response_t{
@@ -54,6 +62,29 @@ namespace PelicanoControl{
         int Priority; 
     };
 
+    /**
+     * @brief Estado que se guarda en el archivo de estado para retomar el polling despues de reiniciar el proceso
+     */
+    struct SavedState_t{
+        int32_t Polling;            // 1 si el lector estaba iniciado
+        int32_t CoinEventPrev;      // Ultimo contador de eventos entregado a JS
+        int32_t InhibitMask1;       // Mascaras del ultimo ModifyChannels, -1 si no se han cambiado
+        int32_t InhibitMask2;
+        int32_t WarnCounter;
+        int32_t CriticalCounter;
+        uint64_t InsertedCoins;
+    };
+
+    /**
+     * @brief Tiempo que el lector ha pasado con el motor encendido (activo) y apagado por inactividad (reposo)
+     */
+    struct PowerStats_t{
+        bool Idle;                  // El lector esta en reposo
+        uint64_t ActiveMs;          // Tiempo con el lector iniciado y el motor encendido
+        uint64_t IdleMs;            // Tiempo con el lector iniciado y el motor apagado
+        uint64_t Wakeups;           // Veces que se salio del reposo
+    };
+
     class GlobalVariables {
         public:
             PelicanoClass PelicanoObject;
@@ -73,10 +104,40 @@ namespace PelicanoControl{
             int WarnToCritical;
             int MaxCritical;
             std::string Path;
+            std::string CapturePath;    // Vacio: sin captura binaria del trafico serial
+            std::string JournalPath;    // Vacio: sin diario de eventos
+            std::string StatePath;      // Vacio: sin archivo de estado, StartReader siempre reinicia el validador
             int LogLvl;
             int MaximumPorts;
+            int CleanTimeoutMs;         // Tiempo maximo de la limpieza de la bandeja (ms)
+            int IdleTimeoutMs;          // Sin monedas ni sensores durante este tiempo se apaga el motor (ms, 0: sin reposo)
+            int IdlePollMs;             // Intervalo de polling con el motor apagado (ms)
+
+            //INTERNAL
+            int Remaining;
+            bool FlagCritical;
+            bool FlagCritical2;
+            int WarnCounter;
+            int CriticalCounter;
+            int CoinEventPrev;
+            int InhibitMask1;
+            int InhibitMask2;
+            bool ResumePending;
+            SavedState_t Saved;
+            Response_t Response;
+            bool Reading;                           // El lector esta iniciado, se cuenta el tiempo en cada modo
+            std::atomic<bool> Idle;                 // Motor apagado y polling lento, lo lee el hilo de onCoin
+            std::chrono::steady_clock::time_point LastActivity;    // Ultima moneda, sensor o wake
+            std::chrono::steady_clock::time_point LastIdlePoll;    // Ultima lectura de los optosensores en reposo
+            std::chrono::steady_clock::time_point ModeSince;       // Inicio del modo actual
+            PowerStats_t Power;
 
             GlobalVariables Globals;
+            CommandSchedulerClass Scheduler;
+            EventJournal::EventJournalClass Journal;
+            StateFile::StateFileClass State;
+            SpeedControl::SpeedControlClass Speed;     // Inactivo hasta Configure (opcion speedControl)
+            PollScheduler::PollSchedulerClass PollRate; // Espera entre polls con el motor encendido
             
             PelicanoControlClass();
             ~PelicanoControlClass();
@@ -92,7 +153,19 @@ namespace PelicanoControl{
             Response_t CleanDevice();
             Response_t GetInsertedCoins();
             TestStatus_t TestStatus();
+            long DumpFlightRecorder();
+            size_t GetEvents(uint64_t Since, std::vector<EventJournal::Event_t> &Events);
             Response_t CheckCodes(int Check);
+            void SaveState();
+            void ApplySpeed(SpeedControl::Change_t Change);
+            Response_t Wake();
+            PowerStats_t GetPowerStats();
+            PollScheduler::Stats_t GetPollStats();
+            int PollDelayMs();
+            void StartPower(std::chrono::steady_clock::time_point Now);
+            void AccountMode(std::chrono::steady_clock::time_point Now);
+            void EnterIdle(std::chrono::steady_clock::time_point Now);
+            int WakeUp(const char *Reason, std::chrono::steady_clock::time_point Now);
     };
 }
 
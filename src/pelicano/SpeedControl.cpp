@@ -0,0 +1,151 @@
+/**
+ * @file SpeedControl.cpp
+ * @brief Control adaptativo de la velocidad del disco del Pelicano
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include "SpeedControl.hpp"
+
+namespace SpeedControl {
+
+    // Codigos del polling: moneda muy rapida (18, 37), muy lenta (19, 38) y disco bloqueado (118)
+    static const int DISKBLOCKED = 118;
+
+    Config_t DefaultConfig(){
+        Config_t Config;
+        Config.MinSpeed = MINSPEED;
+        Config.MaxSpeed = MAXSPEED;
+        Config.WindowMs = 5000;
+        Config.IdleMs = 15000;
+        Config.UpPercent = 60;
+        Config.RejectPercent = 20;
+        return Config;
+    }
+
+    bool IsSpeedReject(int Code){
+        return (Code == 18) || (Code == 19) || (Code == 37) || (Code == 38) || (Code == DISKBLOCKED);
+    }
+
+    static int Clamp(int Value, int Min, int Max){
+        return (Value < Min) ? Min : ((Value > Max) ? Max : Value);
+    }
+
+    SpeedControlClass::SpeedControlClass() : Cfg(DefaultConfig()), Active(false), Current(0), Pending(false), Blocked(false) {}
+
+    void SpeedControlClass::Configure(const Config_t &Config){
+        Cfg = Config;
+        Cfg.MinSpeed = Clamp(Cfg.MinSpeed, MINSPEED, MAXSPEED);
+        Cfg.MaxSpeed = Clamp(Cfg.MaxSpeed, Cfg.MinSpeed, MAXSPEED);
+        Cfg.WindowMs = (Cfg.WindowMs > 0) ? Cfg.WindowMs : DefaultConfig().WindowMs;
+        Active = true;
+    }
+
+    Change_t SpeedControlClass::Start(Time_t Now){
+        Coins.clear();
+        Rejects.clear();
+        Blocked = false;
+        LastChange = Now;
+        LastCoin = Now;
+        Current = 0;
+        Pending = true;
+        return { Clamp(STARTSPEED, Cfg.MinSpeed, Cfg.MaxSpeed), REASON_START };
+    }
+
+    void SpeedControlClass::Accepted(int Count, Time_t Now){
+        for (int i = 0; i < Count; i++){
+            Coins.push_back(Now);
+        }
+        LastCoin = Now;
+    }
+
+    void SpeedControlClass::Rejected(int Code, Time_t Now){
+        if (!IsSpeedReject(Code)){
+            return;
+        }
+        Rejects.push_back(Now);
+        if (Code == DISKBLOCKED){
+            Blocked = true;
+        }
+    }
+
+    void SpeedControlClass::Prune(Time_t Now){
+        Time_t Oldest = Now - std::chrono::milliseconds(Cfg.WindowMs);
+        while (!Coins.empty() && (Coins.front() < Oldest)){
+            Coins.pop_front();
+        }
+        while (!Rejects.empty() && (Rejects.front() < Oldest)){
+            Rejects.pop_front();
+        }
+    }
+
+    Change_t SpeedControlClass::Update(Time_t Now){
+        Change_t Change = { 0, REASON_NONE };
+        if (!Active){
+            return Change;
+        }
+        // Si el validador no acepto la velocidad inicial se vuelve a pedir en cada poll hasta que la acepte
+        if (Pending){
+            return { Clamp(STARTSPEED, Cfg.MinSpeed, Cfg.MaxSpeed), REASON_START };
+        }
+        if (Current == 0){
+            return Change;
+        }
+        Prune(Now);
+
+        // El disco bloqueado baja la velocidad sin esperar la ventana
+        if (Blocked){
+            Blocked = false;
+            if (Current > Cfg.MinSpeed){
+                return { Current - 1, REASON_BLOCKED };
+            }
+        }
+
+        // Cada cambio se evalua con una ventana completa a la velocidad nueva
+        if (Now - LastChange < std::chrono::milliseconds(Cfg.WindowMs)){
+            return Change;
+        }
+
+        size_t Accepted = Coins.size();
+        size_t Rejected = Rejects.size();
+        if ((Rejected >= 2) && (Rejected * 100 >= static_cast<size_t>(Cfg.RejectPercent) * (Accepted + Rejected))){
+            if (Current > Cfg.MinSpeed){
+                Change = { Current - 1, REASON_REJECTS };
+            }
+        }
+        else if ((Rejected == 0) && (Accepted * 1000 * 100 >= static_cast<size_t>(Cfg.UpPercent) * Current * Cfg.WindowMs)){
+            if (Current < Cfg.MaxSpeed){
+                Change = { Current + 1, REASON_BURST };
+            }
+        }
+        else if ((Cfg.IdleMs > 0) && (Now - LastCoin >= std::chrono::milliseconds(Cfg.IdleMs))){
+            if (Current > Cfg.MinSpeed){
+                Change = { Current - 1, REASON_IDLE };
+            }
+        }
+        return Change;
+    }
+
+    void SpeedControlClass::Applied(int Speed, Time_t Now){
+        Current = Speed;
+        Pending = false;
+        LastChange = Now;
+        // Lo que entro a la velocidad anterior no cuenta para decidir el siguiente cambio
+        Coins.clear();
+        Rejects.clear();
+    }
+
+    void SpeedControlClass::Failed(Time_t Now){
+        if (Pending){
+            return;
+        }
+        // Se reinicia la ventana para no reenviar el ajuste en cada poll
+        LastChange = Now;
+        Coins.clear();
+        Rejects.clear();
+    }
+
+};
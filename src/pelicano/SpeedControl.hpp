@@ -0,0 +1,129 @@
+/**
+ * @file SpeedControl.hpp
+ * @brief Control adaptativo de la velocidad del disco del Pelicano: sube la velocidad cuando entran monedas seguidas
+ * (por ejemplo al vaciar una alcancia) y la baja cuando no entran monedas o aumentan los rechazos por velocidad
+ * @version 1.0
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#ifndef SPEEDCONTROL_HPP
+#define SPEEDCONTROL_HPP
+
+#include <chrono>
+#include <deque>
+
+namespace SpeedControl {
+
+    /**
+     * @brief Velocidades que acepta CMDSETSPEEDn (monedas por segundo)
+     */
+    static const int MINSPEED = 2;
+    static const int MAXSPEED = 5;
+
+    /**
+     * @brief Velocidad con la que arranca el lector, la misma que usa SetSpeed por defecto
+     */
+    static const int STARTSPEED = 3;
+
+    typedef std::chrono::steady_clock::time_point Time_t;
+
+    enum Reason_t{
+        REASON_NONE = 0,
+        REASON_START,               // Velocidad inicial al iniciar el lector
+        REASON_BURST,               // Las monedas aceptadas en la ventana se acercan a la velocidad actual
+        REASON_IDLE,                // No entran monedas hace IdleMs
+        REASON_REJECTS,             // Los rechazos por velocidad superan RejectPercent de la ventana
+        REASON_BLOCKED,             // El validador reporto el disco bloqueado
+    };
+
+    struct Change_t{
+        int Speed;                  // Nueva velocidad, 0 si no hay que cambiarla
+        Reason_t Reason;
+    };
+
+    struct Config_t{
+        int MinSpeed;               // Limites de la velocidad (MINSPEED a MAXSPEED)
+        int MaxSpeed;
+        int WindowMs;               // Ventana en la que se cuentan monedas y rechazos, y espera minima entre cambios
+        int IdleMs;                 // Sin monedas durante este tiempo se baja un paso
+        int UpPercent;              // Se sube un paso si las monedas por segundo llegan a este % de la velocidad
+        int RejectPercent;          // Se baja un paso si los rechazos por velocidad llegan a este % de los eventos
+    };
+
+    /**
+     * @brief Configuracion por defecto: de 2 a 5 monedas por segundo, ventana de 5 s, 15 s sin monedas para bajar
+     */
+    Config_t DefaultConfig();
+
+    /**
+     * @brief Indica si un codigo de error del polling es un rechazo que depende de la velocidad del disco (moneda
+     * muy rapida o muy lenta) o el disco bloqueado
+     */
+    bool IsSpeedReject(int Code);
+
+    class SpeedControlClass{
+        public:
+
+            SpeedControlClass();
+
+            /**
+             * @brief Cambia la configuracion y activa el control. Los limites se ajustan a MINSPEED..MAXSPEED
+             */
+            void Configure(const Config_t &Config);
+
+            /**
+             * @brief Borra el historial y regresa la velocidad que se debe poner al iniciar el lector
+             */
+            Change_t Start(Time_t Now);
+
+            /**
+             * @brief Registra monedas aceptadas en un poll
+             */
+            void Accepted(int Coins, Time_t Now);
+
+            /**
+             * @brief Registra un error del polling, solo cuentan los de IsSpeedReject
+             */
+            void Rejected(int Code, Time_t Now);
+
+            /**
+             * @brief Decide si hay que cambiar la velocidad. Se llama despues de cada poll
+             * @return Change_t Velocidad nueva (0 si se mantiene) y motivo
+             */
+            Change_t Update(Time_t Now);
+
+            /**
+             * @brief Confirma que el validador acepto la velocidad
+             */
+            void Applied(int Speed, Time_t Now);
+
+            /**
+             * @brief Registra que el validador no acepto la velocidad. Si es la inicial se vuelve a pedir en el
+             * siguiente Update; si es un ajuste se mantiene la velocidad actual y se espera una ventana completa
+             */
+            void Failed(Time_t Now);
+
+            bool Enabled() const { return Active; }
+            int Speed() const { return Current; }
+            const Config_t &GetConfig() const { return Cfg; }
+
+        private:
+            Config_t Cfg;
+            bool Active;
+            int Current;                    // Ultima velocidad aceptada por el validador, 0 si aun no acepta ninguna
+            bool Pending;                   // La velocidad inicial no se ha podido poner
+            bool Blocked;                   // Disco bloqueado desde el ultimo cambio
+            Time_t LastChange;
+            Time_t LastCoin;
+            std::deque<Time_t> Coins;       // Hora de cada moneda aceptada dentro de la ventana
+            std::deque<Time_t> Rejects;     // Hora de cada rechazo por velocidad dentro de la ventana
+
+            void Prune(Time_t Now);
+    };
+
+};
+
+#endif /* SPEEDCONTROL_HPP */
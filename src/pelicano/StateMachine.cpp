@@ -15,19 +15,9 @@ namespace PelicanoStateMachine{
 
     using namespace ValidatorPelicano;
 
-    PelicanoClass *PelicanoObject;
+    typedef StateMachineBase::StateMachine<PelicanoClass, PelicanoSMTypes::State_t, PelicanoSMTypes::Event_t> Base_t;
 
-    PelicanoSMClass::PelicanoSMClass(ValidatorPelicano::PelicanoClass *_PelicanoClass_p){
-        PelicanoObject = _PelicanoClass_p;
-        SM.CurrState = PelicanoSMClass::ST_IDLE;
-    };
-
-    struct StateFunctionRow_t{
-        const char * name;
-        int (PelicanoClass::*func)(void);
-    };
-
-    static StateFunctionRow_t StateFunctionValidatorPelicano[] = {
+    static const Base_t::StateRow_t StateFunctionValidatorPelicano[] = {
             // NAME         // FUNC
         { "ST_IDLE",       &PelicanoClass::StIdle },      
         { "ST_CONNECT",    &PelicanoClass::StConnect },      
@@ -37,15 +27,13 @@ namespace PelicanoStateMachine{
         { "ST_CLEANBOWL",  &PelicanoClass::StCleanBowl }, 
         { "ST_RESET",      &PelicanoClass::StReset }, 
         { "ST_ERROR",      &PelicanoClass::StError }, 
+        { "ST_RESUME",     &PelicanoClass::StResume },
     };
+    static_assert(sizeof(StateFunctionValidatorPelicano)/sizeof(StateFunctionValidatorPelicano[0]) == PelicanoSMClass::ST_COUNT, "Falta la funcion de algun estado");
+
+    typedef StateTable::TransitionRow_t<PelicanoSMClass::State_t, PelicanoSMClass::Event_t> StateTransitionRow_t;
 
-    struct StateTransitionRow_t{
-        PelicanoSMClass::State_t CurrState;
-        PelicanoSMClass::Event_t Event;
-        PelicanoSMClass::State_t NextState;
-    } ;
-    
-    static StateTransitionRow_t StateTransition[] = {
+    static constexpr StateTransitionRow_t StateTransition[] = {
         // CURR STATE       // EVENT            // NEXT STATE
         { PelicanoSMClass::ST_IDLE,          PelicanoSMClass::EV_ANY,             PelicanoSMClass::ST_CONNECT},
 
@@ -56,9 +44,14 @@ namespace PelicanoStateMachine{
         { PelicanoSMClass::ST_CHECK,         PelicanoSMClass::EV_CHECK,           PelicanoSMClass::ST_CHECK},
         { PelicanoSMClass::ST_CHECK,         PelicanoSMClass::EV_TRASH,           PelicanoSMClass::ST_CLEANBOWL},
         { PelicanoSMClass::ST_CHECK,         PelicanoSMClass::EV_ERROR,           PelicanoSMClass::ST_ERROR},
+        { PelicanoSMClass::ST_CHECK,         PelicanoSMClass::EV_RESUME,          PelicanoSMClass::ST_RESUME},
 
         { PelicanoSMClass::ST_ENABLE,        PelicanoSMClass::EV_READY,           PelicanoSMClass::ST_POLLING},
         { PelicanoSMClass::ST_ENABLE,        PelicanoSMClass::EV_ERROR,           PelicanoSMClass::ST_ERROR},
+
+        { PelicanoSMClass::ST_RESUME,        PelicanoSMClass::EV_READY,           PelicanoSMClass::ST_POLLING},
+        { PelicanoSMClass::ST_RESUME,        PelicanoSMClass::EV_CALL_POLLING,    PelicanoSMClass::ST_ENABLE},
+        { PelicanoSMClass::ST_RESUME,        PelicanoSMClass::EV_ERROR,           PelicanoSMClass::ST_ERROR},
         
         { PelicanoSMClass::ST_POLLING,       PelicanoSMClass::EV_FINISH_POLL,     PelicanoSMClass::ST_CLEANBOWL},
         { PelicanoSMClass::ST_POLLING,       PelicanoSMClass::EV_POLL,            PelicanoSMClass::ST_POLLING},
@@ -74,56 +67,27 @@ namespace PelicanoStateMachine{
         { PelicanoSMClass::ST_RESET,         PelicanoSMClass::EV_ERROR,           PelicanoSMClass::ST_ERROR},
         { PelicanoSMClass::ST_ERROR,         PelicanoSMClass::EV_ANY,             PelicanoSMClass::ST_IDLE},
     };
+    static_assert(StateTable::IsValid<PelicanoSMClass::ST_COUNT, PelicanoSMClass::EV_COUNT>(StateTransition), "Transicion fuera de rango o repetida");
+
+    // Tabla densa [estado][evento] construida en compilacion a partir de StateTransition
+    static constexpr Base_t::Table_t Transitions = StateTable::BuildTable<PelicanoSMClass::ST_COUNT, PelicanoSMClass::EV_COUNT>(StateTransition);
 
-    void PelicanoSMClass::InitStateMachine() {
-        SM.CurrState = PelicanoSMClass::ST_IDLE; 
-        (PelicanoObject[0].*(StateFunctionValidatorPelicano[SM.CurrState].func))();
+    PelicanoSMClass::PelicanoSMClass(ValidatorPelicano::PelicanoClass *_PelicanoClass_p)
+        : Base_t(_PelicanoClass_p, StateFunctionValidatorPelicano, &Transitions, -1) {
+        SetRecorder(&_PelicanoClass_p->Recorder);
+        SetEntryHook(ST_ERROR, &PelicanoClass::DumpRecorderOnError);
     }
 
     int PelicanoSMClass::RunCheck() {
-        int Response = -1;
-        LS.CurrState = SM.CurrState; 
-        SM.CurrState = PelicanoSMClass::ST_CHECK; 
-        Response = (PelicanoObject[0].*(StateFunctionValidatorPelicano[SM.CurrState].func))();
-        SM.CurrState = LS.CurrState;
-        return Response;
+        return RunState(PelicanoSMClass::ST_CHECK);
     }
 
     int PelicanoSMClass::RunReset() {
-        int Response = -1;
-        LS.CurrState = SM.CurrState; 
-        SM.CurrState = PelicanoSMClass::ST_RESET; 
-        Response = (PelicanoObject[0].*(StateFunctionValidatorPelicano[SM.CurrState].func))();
-        SM.CurrState = LS.CurrState;
-        return Response;
+        return RunState(PelicanoSMClass::ST_RESET);
     }
 
     int PelicanoSMClass::RunClean() {
-        int Response = -1;
-        LS.CurrState = SM.CurrState; 
-        SM.CurrState = PelicanoSMClass::ST_CLEANBOWL; 
-        Response = (PelicanoObject[0].*(StateFunctionValidatorPelicano[SM.CurrState].func))();
-        SM.CurrState = LS.CurrState;
-        return Response;
-    }
-    
-    
-    int PelicanoSMClass::StateMachineRun(Event_t Event) {
-        int Response = -1;
-        for(long unsigned int i = 0; i < sizeof(StateTransition)/sizeof(StateTransition[0]); i++) {
-            if(StateTransition[i].CurrState == SM.CurrState) {
-                if(StateTransition[i].Event == Event) {
-                    SM.CurrState =  StateTransition[i].NextState;
-                    Response = (PelicanoObject[0].*(StateFunctionValidatorPelicano[SM.CurrState].func))();
-                    return Response;
-                    break;
-                }
-            }
-        }
-        return Response;
-    }
-    
-    const char * PelicanoSMClass::StateMachineGetStateName(State_t State) {
-        return StateFunctionValidatorPelicano[State].name;
+        return RunState(PelicanoSMClass::ST_CLEANBOWL);
     }
+
 };
\ No newline at end of file
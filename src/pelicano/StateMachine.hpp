@@ -13,42 +13,48 @@
 #define STATEMACHINE_HPP_PELICANO
 
 #include "ValidatorPelicano.hpp"
+#include "../common/StateMachine.hpp"
 
 namespace PelicanoStateMachine{
 
     using namespace ValidatorPelicano;
-    
-    class PelicanoSMClass{
-        public:
-
-            enum State_t{
-                ST_IDLE,
-                ST_CONNECT,  
-                ST_CHECK,   
-                ST_ENABLE,
-                ST_POLLING,
-                ST_CLEANBOWL,
-                ST_RESET,
-                ST_ERROR              
-            };
 
-            struct StateMachine_t{
-                State_t CurrState;
-            };
+    /**
+     * @brief Estados y eventos de la maquina de estados
+     */
+    struct PelicanoSMTypes{
+        enum State_t{
+            ST_IDLE,
+            ST_CONNECT,  
+            ST_CHECK,   
+            ST_ENABLE,
+            ST_POLLING,
+            ST_CLEANBOWL,
+            ST_RESET,
+            ST_ERROR,
+            ST_RESUME,
+            ST_COUNT
+        };
+
+        enum Event_t{
+            EV_ANY,
+            EV_SUCCESS_CONN,
+            EV_CALL_POLLING,
+            EV_CHECK,
+            EV_TRASH,
+            EV_READY,
+            EV_FINISH_POLL,
+            EV_POLL,
+            EV_EMPTY,
+            EV_LOOP,
+            EV_ERROR,
+            EV_RESUME,
+            EV_COUNT
+        };
+    };
 
-            enum Event_t{
-                EV_ANY,
-                EV_SUCCESS_CONN,
-                EV_CALL_POLLING,
-                EV_CHECK,
-                EV_TRASH,
-                EV_READY,
-                EV_FINISH_POLL,
-                EV_POLL,
-                EV_EMPTY,
-                EV_LOOP,
-                EV_ERROR,
-            };
+    class PelicanoSMClass : public PelicanoSMTypes, public StateMachineBase::StateMachine<PelicanoClass, PelicanoSMTypes::State_t, PelicanoSMTypes::Event_t>{
+        public:
 
             /**
              * @brief Construct a new SMClass object
@@ -56,38 +62,6 @@ namespace PelicanoStateMachine{
              */
             PelicanoSMClass(ValidatorPelicano::PelicanoClass *_PelicanoClass_p);
 
-            /**
-             * @brief Estado actual de la maquina de estados
-             */
-            StateMachine_t SM;
-
-            /**
-             * @brief Estado ultimo de la maquina de estados
-             */
-            StateMachine_t LS;
-
-            /**
-             * @brief Evento actual que cambia el estado de la maquina de estados
-             */
-            Event_t Evento;
-
-            /**
-             * @brief Estado inicial de la maquina de estados
-             */
-            State_t Estado;
-
-            /**
-             * @brief Inicia la maquina de estados y corre la funcion asociada al estado actual
-             */
-            void InitStateMachine();
-
-            /**
-             * @brief Corre la maquina de estados dependiendo del evento ingresado y del estado que tenga actualmente
-             * @param Event Evento que ingresa para hacer el cambio de estado
-             * @return int Si la funcion asociada hizo el cambio de estado con exito retorna un 1 / -1, de lo contrario retorna 0
-             */
-            int StateMachineRun(Event_t Event);
-
             /**
              * @brief Corre el estado CHECK (revisa la comunicacion, corre revision inicial y lee los opto estados)
              * @return int - Retorna 0 si pudo correr las 3 funciones exitosamente
@@ -109,15 +83,7 @@ namespace PelicanoStateMachine{
              * @return int - Retorna 1 si no se pudo correr alguna de las 2 funciones o si el evento no esta en cero
              */
             int RunClean();
-
-            /**
-             * @brief Funcion para conocer el nombre del estado actual de la maquina de estados
-             * @param State Se introduce un enum del estado actual
-             * @return const char* Regresa una cadena de caracteres con el nombre dele stado actual
-             */
-            const char * StateMachineGetStateName(State_t State);
     };
 };
 
 #endif /* STATEMACHINE_HPP */
-
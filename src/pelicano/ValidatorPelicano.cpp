@@ -10,59 +10,12 @@
  */
 
 #include "ValidatorPelicano.hpp"
+#include "../common/CodeTable.hpp"
 
 namespace ValidatorPelicano{
     
-    // --------------- EXTERNAL VARIABLES --------------------//
-
-    //READ ONLY
-
-    int SerialPort;
-    bool SuccessConnect;
-    int PortO;
-    
-    int CoinEvent;
-    int CoinEventPrev;
-
-    int CoinCinc;
-    int CoinCien;
-    int CoinDosc;
-    int CoinQuin;
-    int CoinMil;
-
-    bool ErrorHappened;
-    bool CriticalError;
-    bool ErrorSolved;
-    bool ErrorNoSolved;
-
-    int ErrorOCode;
-    std::string ErrorOMsg;
-    int ErrorOStatic;
-    int ErrorOCritical;
-
-    int FaultOCode;
-    std::string FaultOMsg;
-
-    bool CoinPresent;
-    bool TrashDoorOpen;
-    bool LowerSensorBlocked;
-    bool UpperSensorBlocked;
-
-    int ActOChannel;
-    int ActOCoin;
-    int ActualSpeed;
-
-    unsigned long TotalInsertionCounter;
-
-    //WRITE ONLY
-    
-    int LoggerLevel;
-    std::string LogFilePath;
-    int MaxPorts;
-
     // --------------- INTERNAL VARIABLES --------------------//
 
-    bool Scanning;
 
     std::vector<unsigned char> CMDSIMPLEPOLL    = {0x02, 0x00, 0x01, 0xFE, 0xFF}; // 5 + 5 (add+data+add+ack+chk)
     std::vector<unsigned char> CMDSTARTPOLL     = {0x02, 0x00, 0x01, 0xE5, 0x18}; // 5 + 16(add+data+add+ack+event+pair1+pair2+pair3+pair4+pair5+chk)
@@ -82,18 +35,13 @@ namespace ValidatorPelicano{
     std::vector<unsigned char> CMDENABLE        = {0x02, 0x02, 0x01, 0xE7, 0xFF, 0xFF, 0x16}; // 7 + 5 (add+data+add+ack+chk)
     std::vector<unsigned char> CMDINHIBIT50     = {0x02, 0x02, 0x01, 0xE7, 0xF7, 0xFE, 0x1F}; // 7 + 5 (add+data+add+ack+chk)
 
-    std::string DEFAULTERROR = "Error por defecto";
+    const std::string DEFAULTERROR = "Error por defecto";
    
-    ErrorCodePolling_t ErrP;
-    ErrorCodePolling_t ErrPPrev;
 
-    FaultCode_t FaultC;
 
-    CoinPolling_t ActCoin;
 
-    std::shared_ptr<spdlog::logger> logger;
 
-    static CoinPolling_t CoinPolling[] = {
+    static constexpr CoinPolling_t CoinPolling[] = {
         {0, 0},
         {1, 0},
         {2, 0},
@@ -113,7 +61,7 @@ namespace ValidatorPelicano{
         {16,0},
     };
 
-    static ErrorCodePolling_t ErrorCodePolling[] = {
+    static constexpr ErrorCodePolling_t ErrorCodePolling[] = {
         {0,"NULL event, no error / previous error solved",0,0},
         {1,"Uknown reject coin",0,3},
         {2,"Inhibited coin rejected",0,0},
@@ -199,7 +147,7 @@ namespace ValidatorPelicano{
         {255,"Unspecified alarm code",0,2},
     };
 
-    static SpdlogLevels_t SpdlogLvl[] = {
+    static constexpr SpdlogLevels_t SpdlogLvl[] = {
         {0,"trace"},
         {1,"debug"},
         {2,"info"},
@@ -209,7 +157,7 @@ namespace ValidatorPelicano{
         {6,"off"},
     };
 
-    static ErrorCodeExComm_t ErrorCodesExComm[] = {
+    static constexpr ErrorCodeExComm_t ErrorCodesExComm[] = {
         {-6,"[] Function EC/HR/HRP/HRI was not executed"},
         {-5,"[EC] Writting error"},
         {-4,"[EC] Writing successful but cannot read"},
@@ -225,7 +173,7 @@ namespace ValidatorPelicano{
         { 6,"[EC] Command not recognized or adress is wrong"},
     };
 
-    static FaultCode_t FaultCodeM[] = {
+    static constexpr FaultCode_t FaultCodeM[] = {
         {  0,"OK"},
         {  1,"Firmware checksum corrupted"},
         {  2,"Fault on inductive coils"},
@@ -244,6 +192,27 @@ namespace ValidatorPelicano{
         {255,"Unspecified alarm code"},
     };
 
+    // Tablas de acceso directo por codigo, construidas en compilacion a partir de las tablas anteriores
+    static constexpr SpdlogLevels_t SpdlogTableDefault = {0,"SpdlogLvl not found!!!"};
+    static_assert(CodeTable::IsValid<SpdlogLevels_t, &SpdlogLevels_t::Code>(SpdlogLvl), "Codigo fuera de la tabla SpdlogLvl");
+    static constexpr CodeTable::DenseTable_t<SpdlogLevels_t> SpdlogTable = CodeTable::BuildTable<SpdlogLevels_t, &SpdlogLevels_t::Code>(SpdlogLvl, SpdlogTableDefault);
+
+    static constexpr ErrorCodeExComm_t ExCommTableDefault = {0,"ErrorCode not found!!!"};
+    static_assert(CodeTable::IsValid<ErrorCodeExComm_t, &ErrorCodeExComm_t::Code>(ErrorCodesExComm, -128), "Codigo fuera de la tabla ErrorCodesExComm");
+    static constexpr CodeTable::DenseTable_t<ErrorCodeExComm_t> ExCommTable = CodeTable::BuildTable<ErrorCodeExComm_t, &ErrorCodeExComm_t::Code>(ErrorCodesExComm, ExCommTableDefault, -128);
+
+    static constexpr CoinPolling_t CoinTableDefault = {0,0};
+    static_assert(CodeTable::IsValid<CoinPolling_t, &CoinPolling_t::Channel>(CoinPolling), "Codigo fuera de la tabla CoinPolling");
+    static constexpr CodeTable::DenseTable_t<CoinPolling_t> CoinTable = CodeTable::BuildTable<CoinPolling_t, &CoinPolling_t::Channel>(CoinPolling, CoinTableDefault);
+
+    static constexpr ErrorCodePolling_t ErrorPollingTableDefault = {0,"ErrorCode not found!!!",3,0};
+    static_assert(CodeTable::IsValid<ErrorCodePolling_t, &ErrorCodePolling_t::Code>(ErrorCodePolling), "Codigo fuera de la tabla ErrorCodePolling");
+    static constexpr CodeTable::DenseTable_t<ErrorCodePolling_t> ErrorPollingTable = CodeTable::BuildTable<ErrorCodePolling_t, &ErrorCodePolling_t::Code>(ErrorCodePolling, ErrorPollingTableDefault);
+
+    static constexpr FaultCode_t FaultTableDefault = {0,"FaultCode not found!!!"};
+    static_assert(CodeTable::IsValid<FaultCode_t, &FaultCode_t::Code>(FaultCodeM), "Codigo fuera de la tabla FaultCodeM");
+    static constexpr CodeTable::DenseTable_t<FaultCode_t> FaultTable = CodeTable::BuildTable<FaultCode_t, &FaultCode_t::Code>(FaultCodeM, FaultTableDefault);
+
     PelicanoClass::PelicanoClass(){
 
         SerialPort = 0;
@@ -253,6 +222,7 @@ namespace ValidatorPelicano{
 
         CoinEvent = 0;
         CoinEventPrev = 0;
+        ResumeEvent = -1;
 
         CoinCinc = 0;
         CoinCien = 0;
@@ -281,108 +251,46 @@ namespace ValidatorPelicano{
         UpperSensorBlocked = false;
 
         TotalInsertionCounter = 0;
+        CleanMs = 0;
+        CleanTimeoutMs = CLEANTIMEOUTMS;
     }
 
-    PelicanoClass::~PelicanoClass(){}
+    PelicanoClass::~PelicanoClass(){
+        // Cerrar el puerto libera el flock, otra instancia puede tomarlo
+        if (SerialPort > 0){
+            close(SerialPort);
+            SerialPort = -1;
+        }
+        Logging::DropLogger(logger);
+    }
 
     // --------------- LOGGER FUNCTIONS --------------------//
 
-    SpdlogLevels_t PelicanoClass::SearchSpdlogLevel(int Code){
-        SpdlogLevels_t SPLvl;
-        SPLvl.Message = "SpdlogLvl not found!!!"; 
-
-        for(long unsigned int i = 0; i < sizeof(SpdlogLvl)/sizeof(SpdlogLvl[0]); i++) {
-            if(SpdlogLvl[i].Code == Code) {
-                SPLvl.Message = SpdlogLvl[i].Message;
-                break;
-            }
-        }
-        
-        SPLvl.Code = Code;
-        return SPLvl;
+    SpdlogLevels_t PelicanoClass::SearchSpdlogLevel (int Code){
+        return CodeTable::Lookup<SpdlogLevels_t, &SpdlogLevels_t::Code>(SpdlogTable, Code, SpdlogTableDefault);
     }
 
     void PelicanoClass::SetSpdlogLevel(){
-        spdlog::set_level(static_cast<spdlog::level::level_enum>(LoggerLevel)); // Set global log level
+        logger->set_level(static_cast<spdlog::level::level_enum>(LoggerLevel)); // Set instance log level
         //logger->set_level(spdlog::level::debug);
     }
 
     // --------------- SEARCH FUNCTIONS --------------------//
 
     ErrorCodeExComm_t PelicanoClass::SearchErrorCodeExComm (int Code){
-        
-        ErrorCodeExComm_t Code_msg;
-        
-        Code_msg.Message = "ErrorCode not found!!!";
-        
-        for(long unsigned int i = 0; i < sizeof(ErrorCodesExComm)/sizeof(ErrorCodesExComm[0]); i++) {
-            if(ErrorCodesExComm[i].Code == Code) {
-                Code_msg.Message = ErrorCodesExComm[i].Message;
-                break;
-            }
-        }
-        
-        Code_msg.Code = Code;
-
-        return Code_msg;
+        return CodeTable::Lookup<ErrorCodeExComm_t, &ErrorCodeExComm_t::Code>(ExCommTable, Code, ExCommTableDefault);
     }
 
     CoinPolling_t PelicanoClass::SearchCoin (int Channel){
-        
-        CoinPolling_t ChannelCoin;
-        
-        ChannelCoin.Coin = 0;
-        
-        for(long unsigned int i = 0; i < sizeof(CoinPolling)/sizeof(CoinPolling[0]); i++) {
-            if(CoinPolling[i].Channel == Channel) {
-                ChannelCoin.Coin = CoinPolling[i].Coin;
-                break;
-            }
-        }
-        
-        ChannelCoin.Channel = Channel;
-
-        return ChannelCoin;
+        return CodeTable::Lookup<CoinPolling_t, &CoinPolling_t::Channel>(CoinTable, Channel, CoinTableDefault);
     }
 
     ErrorCodePolling_t PelicanoClass::SearchErrorCodePolling (int Code){
-        
-        ErrorCodePolling_t CodeMsgRej;
-        
-        CodeMsgRej.Message = "ErrorCode not found!!!";
-        CodeMsgRej.StaticE = 3;
-        CodeMsgRej.Critical = 0;
-        
-        for(long unsigned int i = 0; i < sizeof(ErrorCodePolling)/sizeof(ErrorCodePolling[0]); i++) {
-            if(ErrorCodePolling[i].Code == Code) {
-                CodeMsgRej.Message = ErrorCodePolling[i].Message;
-                CodeMsgRej.StaticE = ErrorCodePolling[i].StaticE;
-                CodeMsgRej.Critical = ErrorCodePolling[i].Critical;
-                break;
-            }
-        }
-        
-        CodeMsgRej.Code = Code;
-
-        return CodeMsgRej;
+        return CodeTable::Lookup<ErrorCodePolling_t, &ErrorCodePolling_t::Code>(ErrorPollingTable, Code, ErrorPollingTableDefault);
     }
 
     FaultCode_t PelicanoClass::SearchFaultCode (int Code){
-        
-        FaultCode_t FaultCodeMsg;
-        
-        FaultCodeMsg.Message = "FaultCode not found!!!";
-
-        for(long unsigned int i = 0; i < sizeof(FaultCodeM)/sizeof(FaultCodeM[0]); i++) {
-            if(FaultCodeM[i].Code == Code) {
-                FaultCodeMsg.Message = FaultCodeM[i].Message;
-                break;
-            }
-        }
-        
-        FaultCodeMsg.Code = Code;
-
-        return FaultCodeMsg;
+        return CodeTable::Lookup<FaultCode_t, &FaultCode_t::Code>(FaultTable, Code, FaultTableDefault);
     }
 
     // --------------- STATES OF MACHINE STATE (FUNCTIONS) --------------------//
@@ -395,8 +303,8 @@ namespace ValidatorPelicano{
 
         logger->critical("[E0:STIDLE] Setting spdlog level in {}",SpdlogLvl.Message);
 
-        logger->trace("   [E0:STIDLE] --------------------------------------------------------------------------");
-        logger->debug("   [E0:STIDLE] --------------------------------------------------------------------------");
+        SPDLOG_LOGGER_TRACE(logger,"   [E0:STIDLE] --------------------------------------------------------------------------");
+        SPDLOG_LOGGER_DEBUG(logger,"   [E0:STIDLE] --------------------------------------------------------------------------");
         logger->info("    [E0:STIDLE] --------------------------------------------------------------------------");
         logger->warn(" [E0:STIDLE] --------------------------------------------------------------------------");
         logger->error("   [E0:STIDLE] --------------------------------------------------------------------------");
@@ -455,7 +363,7 @@ namespace ValidatorPelicano{
             }
         }
 
-        logger->debug("[E2:STCHECK] Fault code is: OK");
+        SPDLOG_LOGGER_DEBUG(logger,"[E2:STCHECK] Fault code is: OK");
 
         logger->info("[E2:STCHECK] Checking opto states");
 
@@ -489,7 +397,7 @@ namespace ValidatorPelicano{
             }
         }
 
-        logger->debug("[E2:STCHECK] 4 Optostates are OK");
+        SPDLOG_LOGGER_DEBUG(logger,"[E2:STCHECK] 4 Optostates are OK");
         return 0;
     }
 
@@ -656,12 +564,86 @@ namespace ValidatorPelicano{
         return 0;
     }
 
+    int PelicanoClass::StResume() {
+
+        int Response = -1;
+
+        logger->info("[E7:STRESUME] Reading coin event without rebooting device, saved event: {0}",ResumeEvent);
+
+        if (ResumeEvent < 0){
+            logger->error("[E7:STRESUME] There is no saved event");
+            return 2;
+        }
+
+        CoinEventPrev = ResumeEvent;
+
+        Response = SendingCommand(CMDSTARTPOLL);
+
+        if ((Response != 0) & (Response != -2)){
+            logger->error("[E7:STRESUME] Acceptor could not read coin event");
+            return 1;
+        }
+
+        // El contador pasa de 255 a 1 (solo vale 0 despues de un reset) y el validador guarda los ultimos 5 eventos
+        int Pending = (CoinEvent >= ResumeEvent) ? CoinEvent - ResumeEvent : CoinEvent + 255 - ResumeEvent;
+
+        if (((CoinEvent == 0) & (ResumeEvent != 0)) | (Pending > 5)){
+            logger->error("[E7:STRESUME] Coin event is not consistent, event: {0} saved event: {1}",CoinEvent,ResumeEvent);
+            return 2;
+        }
+
+        logger->info("[E7:STRESUME] Coin event is consistent, pending events: {0}",Pending);
+
+        Response = EnableChannels();
+
+        if (Response != 0){
+            logger->error("[E7:STRESUME] Acceptor could not enable channels");
+            return 1;
+        }
+
+        Response = StartMotor();
+
+        if (Response != 0){
+            logger->error("[E7:STRESUME] Acceptor could not start motor");
+            return 1;
+        }
+
+        return 0;
+    }
+
     // --------------- MAIN FUNCTIONS --------------------//
 
     // Función para inicializar el logger
     void PelicanoClass::InitLogger(const std::string& Path) {
-        // Crear el daily_logger y asignarlo a la variable logger
-        logger = spdlog::daily_logger_mt("ValidatorPelicano", Path, 23, 59);
+        // Crear el logger asincrono (archivo diario) de esta instancia y asignarlo a la variable logger
+        // Si ya existia (InitLog despues de reconectar) se da de baja primero para no dejarlo registrado
+        Logging::DropLogger(logger);
+        logger = Logging::CreateLogger("ValidatorPelicano", Path);
+        Recorder.Path = Path + ".flight";
+    }
+
+    long PelicanoClass::DumpRecorder(const char *Reason){
+        long Entries = Recorder.Dump(Reason);
+        if (Entries >= 0){
+            logger->warn("[DumpRecorder] {0}: {1} entries written to {2}",Reason,Entries,Recorder.Path);
+        }
+        else {
+            logger->error("[DumpRecorder] {0}: could not write {1}",Reason,Recorder.Path);
+        }
+        return Entries;
+    }
+
+    void PelicanoClass::DumpRecorderOnError(){
+        DumpRecorder("ST_ERROR");
+    }
+
+    int PelicanoClass::StartCapture(const std::string& Path){
+        if (Capture.Open(Path, SerialCapture::DEVICE_PELICANO) != 0){
+            logger->error("[StartCapture] Could not open capture file {0}",Path);
+            return 1;
+        }
+        logger->info("[StartCapture] Capturing serial traffic to {0} (instance {1})",Path,Capture.Instance);
+        return 0;
     }
 
     //Connects to port /dev/ttyUSB% where % is the port number (Port)
@@ -672,11 +654,19 @@ namespace ValidatorPelicano{
             return 1;
         }
         else {
-            logger->debug("[ConnectSerial] Connecting to /dev/ttyUSB{0:d} port",Port);
+            SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] Connecting to /dev/ttyUSB{0:d} port",Port);
             char DeviceName [50];
             sprintf (DeviceName,"/dev/ttyUSB%d",Port);
             SerialPort = open(DeviceName, O_RDWR | O_NOCTTY );
 
+            // Bloqueo exclusivo del puerto para que otra instancia (o proceso) no lo tome mientras se usa
+            if ((SerialPort > 0) && (flock(SerialPort, LOCK_EX | LOCK_NB) != 0)){
+                SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] /dev/ttyUSB{0:d} is already in use",Port);
+                close(SerialPort);
+                SerialPort = -1;
+                return 5;
+            }
+
             if (SerialPort > 0){
 
                 struct termios Tty;
@@ -685,6 +675,8 @@ namespace ValidatorPelicano{
                 if (tcgetattr(SerialPort, &Tty) != 0) {
                     logger->error("[ConnectSerial] Error reading actual settings in this port. Error: {0:d}, from tcgetattr: {1}",errno,strerror(errno));
                     SuccessConnect = false;
+                    close(SerialPort);
+                    SerialPort = -1;
                     return 2;
                 }
 
@@ -714,15 +706,17 @@ namespace ValidatorPelicano{
                 if (tcsetattr(SerialPort, TCSANOW, &Tty) != 0) {
                     logger->error("[ConnectSerial] Error writing new settings in this port. Error: {0:d}, from tcgetattr: {1}",errno,strerror(errno));
                     SuccessConnect = false;
+                    close(SerialPort);
+                    SerialPort = -1;
                     return 3;
                 }
 
-                logger->debug("[ConnectSerial] Successfully connected to /dev/ttyUSB{0:d}",Port);
+                SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] Successfully connected to /dev/ttyUSB{0:d}",Port);
                 SuccessConnect = true;
                 return 0;
             }
             else {
-                logger->debug("[ConnectSerial] Could no connect to /dev/ttyUSB{0:d}",Port);
+                SPDLOG_LOGGER_DEBUG(logger,"[ConnectSerial] Could no connect to /dev/ttyUSB{0:d}",Port);
                 return 4;
             }
         }
@@ -733,23 +727,29 @@ namespace ValidatorPelicano{
         int Port = -1;
         int Response = -1;
 
+        // Al reconectar se cierra el puerto que ya se tenia, tambien libera el flock y el puerto se puede volver a tomar
+        if (SerialPort > 0){
+            close(SerialPort);
+            SerialPort = -1;
+        }
+
         for (int i=1; i<MaxPorts; i++)
         {   
-            logger->debug("[ScanPorts] Trying connection to /dev/ttyUSB{0:d}",i-1);
+            SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Trying connection to /dev/ttyUSB{0:d}",i-1);
             Response = ConnectSerial(i-1);
 
             if (Response==0)
             {   
-                logger->debug("[ScanPorts] Connection successfull");
+                SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Connection successfull");
                 Response = -1;
                 Scanning = true;
-                logger->debug("[ScanPorts] Sending simple poll Command (Checking connection)");
+                SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Sending simple poll Command (Checking connection)");
 
                 Response = SimplePoll();
 
                 if (Response == 0){
                     Port = i-1;
-                    logger->debug("[ScanPorts] Acceptor Pelicano found in port /dev/ttyUSB{0:d}",Port);
+                    SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Acceptor Pelicano found in port /dev/ttyUSB{0:d}",Port);
                     i=MaxPorts;
                     Scanning = false;
                     return Port;
@@ -758,8 +758,9 @@ namespace ValidatorPelicano{
                     logger->warn("[ScanPorts] Error in writing/reading or acceptor Pelicano is NOT connected to /dev/ttyUSB{0:d} port",i-1);
                 }
 
-                logger->debug("[ScanPorts] Clossing connection in /dev/ttyUSB{0:d}",i-1);
-                close(SerialPort);            
+                SPDLOG_LOGGER_DEBUG(logger,"[ScanPorts] Clossing connection in /dev/ttyUSB{0:d}",i-1);
+                close(SerialPort);
+                SerialPort = -1;
             }
         }
         Scanning = false;
@@ -776,23 +777,24 @@ namespace ValidatorPelicano{
 
         ErrorCodeExComm_t Err;
         Err = SearchErrorCodeExComm(Response);
+        Recorder.RecordResult(Err.Code, Err.Message.data());
 
-        logger->debug("[SendingCommand] Execute command returns: {0:d} with message: {1}",Err.Code,Err.Message);
+        SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Execute command returns: {0:d} with message: {1}",Err.Code,Err.Message);
 
         if (Response == 0){
-            logger->trace("[SendingCommand] Everything is OK");
+            SPDLOG_LOGGER_TRACE(logger,"[SendingCommand] Everything is OK");
             Res = 0;
         }
         else if ((Response == -5) | (Response == -4) | (Response == 1)){
-            logger->debug("[SendingCommand] Error with comand");
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Error with comand");
             Res = -1;
         }
         else if (Response == 4){
-            logger->debug("[SendingCommand] Polling error");
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Polling error");
             Res = -2;
         }
         else {
-            logger->debug("[SendingCommand] Repeat command");
+            SPDLOG_LOGGER_DEBUG(logger,"[SendingCommand] Repeat command");
             Res = 1;
         }
 
@@ -808,7 +810,9 @@ namespace ValidatorPelicano{
 
         int Xlen = Comm.size();
 
-        logger->trace("[ExecuteCommand] Writting command");
+        SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Writting command: {0:n}",Logging::Hex(Comm,Xlen));
+        Recorder.RecordFrame(FlightRecorder::ENTRY_TX, &Comm[0], Xlen);
+        Capture.Record(SerialCapture::DIRECTION_TX, &Comm[0], Xlen);
         Wrlen = write(SerialPort, &Comm[0], Xlen);
 
         if (Wrlen != Xlen){
@@ -816,21 +820,24 @@ namespace ValidatorPelicano{
             Res = -5;
         }
         else {
-            logger->trace("[ExecuteCommand] Length expected is the same: {0:d}",Wrlen);
+            SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Length expected is the same: {0:d}",Wrlen);
             
             std::vector<unsigned char> Buffer(100);
 
             usleep(200000);
 
-            logger->trace("[ExecuteCommand] Reading response");
+            SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Reading response");
             Rdlen = read(SerialPort, &Buffer[0], Buffer.size());
+            Recorder.RecordFrame(FlightRecorder::ENTRY_RX, &Buffer[0], Rdlen);
+            Capture.Record(SerialCapture::DIRECTION_RX, &Buffer[0], Rdlen);
             
             if (Rdlen > 0){
 
-                logger->debug("[ExecuteCommand] Reading length: {0:d}",Rdlen);
+                SPDLOG_LOGGER_DEBUG(logger,"[ExecuteCommand] Reading length: {0:d}",Rdlen);
+                SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Data read: {0:n}",Logging::Hex(Buffer,Rdlen));
 
                 if (Rdlen >= Xlen){
-                    logger->trace("[ExecuteCommand] Reading length greater or equal than {0}, handling response... ",Xlen);
+                    SPDLOG_LOGGER_TRACE(logger,"[ExecuteCommand] Reading length greater or equal than {0}, handling response... ",Xlen);
                     Res = HandleResponse(Buffer,Rdlen,Xlen);
                 }
                 else if (Rdlen == Xlen-1){
@@ -866,14 +873,14 @@ namespace ValidatorPelicano{
         int AdInfo = 0;
 
         if (Rdlen >= (Xlen+4)){
-            logger->trace("[HandleResponse] Message seems to be complete");
+            SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] Message seems to be complete");
 
-            //logger->trace("[HandleResponse] Message seems to be complete");
+            //SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] Message seems to be complete");
             if (Response[Xlen + 3] == 0){
-                //logger->trace("[HandleResponse] ACK Received!");
+                //SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] ACK Received!");
                 Header = Response[3];
                 if ((Rdlen >= Xlen+15) & ((Header == 229))){
-                    //logger->trace("[HandleResponse] Polling detected, searching response error");
+                    //SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] Polling detected, searching response error");
                     Res = HandleResponsePolling(Response,Rdlen);
                 }
                 else if ((Rdlen < Xlen+15) & ((Header == 229))){
@@ -881,21 +888,21 @@ namespace ValidatorPelicano{
                     Res = 2;
                 }
                 else if ((Header == 236) | (Header == 232) | (Header == 226)){
-                    logger->trace("[HandleResponse] Self check, read opto states or insertion counter detected, searching more info");
+                    SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] Self check, read opto states or insertion counter detected, searching more info");
                     Res = HandleResponseInfo(Response,Rdlen);
                 }
                 else if ((Header == 231) | (Header == 228) | (Header == 254) | (Header == 1)){
-                    logger->trace("[HandleResponse] No more information to check!");
+                    SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] No more information to check!");
                     Res = 0;
                 }
                 else if (Header == 239){
                     AdInfo = Response[4];
                     if (AdInfo == 11){
-                        logger->trace("[HandleResponse] Get speed detected, searching more info");
+                        SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] Get speed detected, searching more info");
                         Res = HandleResponseInfo(Response,Rdlen);
                     }
                     else {
-                        logger->trace("[HandleResponse] Clean bowl detected, no more information to check!");
+                        SPDLOG_LOGGER_TRACE(logger,"[HandleResponse] Clean bowl detected, no more information to check!");
                         Res = 0;
                     }
                 }
@@ -918,7 +925,7 @@ namespace ValidatorPelicano{
             }
         }
         else {
-            logger->debug("[HandleResponse] Message is NOT complete!!!");
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponse] Message is NOT complete!!!");
             Res = 2;
         }
         return Res;
@@ -952,10 +959,11 @@ namespace ValidatorPelicano{
 
         ActOCoin = 0;
         ActOChannel = 0;
+        PollCoins.clear();
 
         if (Response[6] == 11){
 
-            logger->trace("[HandleResponsePolling] Data is correct!");
+            SPDLOG_LOGGER_TRACE(logger,"[HandleResponsePolling] Data is correct!");
 
             CoinEvent = Response[9];
 
@@ -963,20 +971,20 @@ namespace ValidatorPelicano{
                 
                 Remaining = CoinEvent-CoinEventPrev;
 
-                logger->debug("[HandleResponsePolling] CoinEvent: {0} CoinEventPrev: {1}",CoinEvent,CoinEventPrev);
+                SPDLOG_LOGGER_DEBUG(logger,"[HandleResponsePolling] CoinEvent: {0} CoinEventPrev: {1}",CoinEvent,CoinEventPrev);
 
                 if (Remaining > 1){
-                    logger->debug("[HandleResponsePolling] Remaining events: {0}",Remaining);
+                    SPDLOG_LOGGER_DEBUG(logger,"[HandleResponsePolling] Remaining events: {0} Data: {1:n}",Remaining,Logging::Hex(Response,2*Remaining,10));
                     for (int i = 0; i<2*Remaining; i++){
-                        logger->debug("[HandleResponsePolling] Counters, i:{0} k:{1}",i,k);
                         Data = Response[10+i];
-                        logger->debug("[HandleResponsePolling] Data: {0}",Data);
                         if ((Data == 0) & (i == 2*(k-1)) & (ErrorSolved == false)) {
                             ErrorHappened = true;
                         }
                         else if ((Data >= 4) & (Data <= 12) & (i == 2*(k-1))){
                             ActCoin = SearchCoin(Data);
-                            logger->debug("[HandleResponsePolling] Coin: {0}",ActCoin.Coin);
+                            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponsePolling] Coin: {0}",ActCoin.Coin);
+                            // El buffer trae primero el evento mas reciente
+                            PollCoins.insert(PollCoins.begin(), ActCoin);
                             if (ActCoin.Coin == 50){
                                 CoinCinc++;
                             }
@@ -1043,8 +1051,12 @@ namespace ValidatorPelicano{
                     logger->error("[HandleResponsePolling] ----------> Error happened!");
                     logger->error("[HandleResponsePolling] Error code: {0}",ErrP.Code);
                     logger->error("[HandleResponsePolling] Error message: {0}",ErrP.Message);
-                    logger->trace("[HandleResponsePolling] Error static: {0}",ErrP.StaticE);
-                    logger->trace("[HandleResponsePolling] Error critical: {0}",ErrP.Critical);
+                    SPDLOG_LOGGER_TRACE(logger,"[HandleResponsePolling] Error static: {0}",ErrP.StaticE);
+                    SPDLOG_LOGGER_TRACE(logger,"[HandleResponsePolling] Error critical: {0}",ErrP.Critical);
+
+                    if (ErrP.Critical == 1){
+                        DumpRecorder("Critical polling error");
+                    }
 
                     Res = 4;
                 }
@@ -1052,28 +1064,28 @@ namespace ValidatorPelicano{
 
                     ActOCoin = ActCoin.Coin;
                     ActOChannel = ActCoin.Channel;
+                    if ((Remaining <= 1) & (ActCoin.Coin != 0)){
+                        PollCoins.push_back(ActCoin);
+                    }
 
-                    logger->trace("[HandleResponsePolling] ----------> Coin detected");
-                    logger->debug("[HandleResponsePolling] Coin: {0}",ActCoin.Coin);
-                    logger->trace("[HandleResponsePolling] Coin Channel: {0}",ActCoin.Channel);
+                    SPDLOG_LOGGER_TRACE(logger,"[HandleResponsePolling] ----------> Coin detected");
+                    SPDLOG_LOGGER_DEBUG(logger,"[HandleResponsePolling] Coin: {0}",ActCoin.Coin);
+                    SPDLOG_LOGGER_TRACE(logger,"[HandleResponsePolling] Coin Channel: {0}",ActCoin.Channel);
 
                     Res = 0;
                 }
 
-                for (int i = 0; i<10; i++){
-                    Data = Response[10+i];
-                    logger->debug("[HandleResponsePolling] Data: {0}",Data);
-                }
+                SPDLOG_LOGGER_DEBUG(logger,"[HandleResponsePolling] Data: {0:n}",Logging::Hex(Response,10,10));
 
                 CoinEventPrev = CoinEvent;
             }   
             else{
-                logger->trace("[HandleResponsePolling] Actual coin event is identical to coin event prev");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponsePolling] Actual coin event is identical to coin event prev");
                 Res = 0;
             }
         }
         else{
-            logger->debug("[HandleResponsePolling] Data is not correct!");
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponsePolling] Data is not correct!");
             Res = 3;
         }
         return Res;
@@ -1086,19 +1098,19 @@ namespace ValidatorPelicano{
 
         if (Response[3] == 232){
 
-            logger->trace("[HandleResponseInfo] Self check detected, checking fault code");
+            SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Self check detected, checking fault code");
             FaultCode = Response[9];
             FaultC = SearchFaultCode(FaultCode);
             FaultOCode = FaultC.Code;
-            FaultOMsg = FaultC.Message.c_str();
-            logger->debug("[HandleResponseInfo] Fault code: {0}",FaultC.Code);
-            logger->debug("[HandleResponseInfo] Fault message: {0}",FaultC.Message);
+            FaultOMsg = FaultC.Message;
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponseInfo] Fault code: {0}",FaultC.Code);
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponseInfo] Fault message: {0}",FaultC.Message);
             
             Res = 0;
         }
         else if(Response[3] == 236){
 
-            logger->trace("[HandleResponseInfo] Read opto states detected, checking bit mask");
+            SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Read opto states detected, checking bit mask");
             int StateMask = 0;
             StateMask = Response[9];
 
@@ -1110,48 +1122,48 @@ namespace ValidatorPelicano{
             UpperSensorBlocked = Bits[3];
 
             if(CoinPresent){
-                logger->trace("[HandleResponseInfo] There is something in bowl");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] There is something in bowl");
             }
             else{
-                logger->trace("[HandleResponseInfo] Bowl is empty!");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Bowl is empty!");
             }
 
             if(TrashDoorOpen){
-                logger->trace("[HandleResponseInfo] Trash door is open");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Trash door is open");
             }
             else{
-                logger->trace("[HandleResponseInfo] Trash door is close");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Trash door is close");
             }
 
             if(LowerSensorBlocked){
-                logger->trace("[HandleResponseInfo] Lower sensor (Accept & Reject path) is blocked");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Lower sensor (Accept & Reject path) is blocked");
             }
             else{
-                logger->trace("[HandleResponseInfo] Lower sensor (Accept & Reject path) is clear");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Lower sensor (Accept & Reject path) is clear");
             }
 
             if(UpperSensorBlocked){
-                logger->trace("[HandleResponseInfo] Upper sensor (Accept path) is blocked");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Upper sensor (Accept path) is blocked");
             }
             else{
-                logger->trace("[HandleResponseInfo] Upper sensor (Accept path) is clear");
+                SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Upper sensor (Accept path) is clear");
             }
 
             Res = 0;
         }
         else if(Response[3] == 239){
 
-            logger->trace("[HandleResponseInfo] Get speed detected, checking actual speed");
+            SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Get speed detected, checking actual speed");
 
             ActualSpeed = Response[10];
 
-            logger->debug("[HandleResponseInfo] Actual Speed is: {0}",ActualSpeed);
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponseInfo] Actual Speed is: {0}",ActualSpeed);
             
             Res = 0;
         }
         else if(Response[3] == 226){
 
-            logger->trace("[HandleResponseInfo] Insertion counter detected, checking counted coins");
+            SPDLOG_LOGGER_TRACE(logger,"[HandleResponseInfo] Insertion counter detected, checking counted coins");
 
             unsigned long Counter1 = Response[9]; 
             unsigned long Counter2 = Response[10];
@@ -1159,7 +1171,7 @@ namespace ValidatorPelicano{
 
             TotalInsertionCounter = Counter1 + (Counter2 * 256) + (Counter3 * 65536);
 
-            logger->debug("[HandleResponseInfo] InsertionCounter is: {0}. Counters: {1} {2} {3}",TotalInsertionCounter,Counter1,Counter2,Counter3);
+            SPDLOG_LOGGER_DEBUG(logger,"[HandleResponseInfo] InsertionCounter is: {0}. Counters: {1} {2} {3}",TotalInsertionCounter,Counter1,Counter2,Counter3);
             
             Res = 0;
         }
@@ -1171,8 +1183,8 @@ namespace ValidatorPelicano{
 
         int Response  = -2;
 
-        logger->debug("[CheckOptoStates] Reading opto states");
-        logger->trace("[CheckOptoStates] Running CMDREADOPTOST");
+        SPDLOG_LOGGER_DEBUG(logger,"[CheckOptoStates] Reading opto states");
+        SPDLOG_LOGGER_TRACE(logger,"[CheckOptoStates] Running CMDREADOPTOST");
         
         Response = SendingCommand(CMDREADOPTOST);
         
@@ -1197,7 +1209,7 @@ namespace ValidatorPelicano{
             }
         }
 
-        logger->trace("[CheckOptoStates] Optostates return: Everything is OK");
+        SPDLOG_LOGGER_TRACE(logger,"[CheckOptoStates] Optostates return: Everything is OK");
         return Response;
     }
 
@@ -1205,8 +1217,8 @@ namespace ValidatorPelicano{
 
         int Response  = -1;
 
-        logger->debug("[SimplePoll] Checking communication");
-        logger->trace("[SimplePoll] Running CMDSIMPLEPOLL");
+        SPDLOG_LOGGER_DEBUG(logger,"[SimplePoll] Checking communication");
+        SPDLOG_LOGGER_TRACE(logger,"[SimplePoll] Running CMDSIMPLEPOLL");
         
         Response = SendingCommand(CMDSIMPLEPOLL);
 
@@ -1223,7 +1235,7 @@ namespace ValidatorPelicano{
             }
         }
 
-        logger->trace("[SimplePoll] Acceptor return ACK successfully");
+        SPDLOG_LOGGER_TRACE(logger,"[SimplePoll] Acceptor return ACK successfully");
         return 0;
     }
 
@@ -1231,8 +1243,8 @@ namespace ValidatorPelicano{
         
         int Response = -1;
 
-        logger->debug("[SelfCheck] Running initial revision");
-        logger->trace("[SelfCheck] Running CMDSELFCHECK");
+        SPDLOG_LOGGER_DEBUG(logger,"[SelfCheck] Running initial revision");
+        SPDLOG_LOGGER_TRACE(logger,"[SelfCheck] Running CMDSELFCHECK");
         
         Response = SendingCommand(CMDSELFCHECK);
 
@@ -1261,7 +1273,7 @@ namespace ValidatorPelicano{
             }
         }
 
-        logger->trace("[SimplePoll] Acceptor return faultcode: OK");
+        SPDLOG_LOGGER_TRACE(logger,"[SimplePoll] Acceptor return faultcode: OK");
         return 0;
     }
 
@@ -1269,8 +1281,8 @@ namespace ValidatorPelicano{
         
         int Response  = -1;
 
-        logger->debug("[EnableChannels] Enabling coins");
-        logger->trace("[EnableChannels] Running CMDENABLE");
+        SPDLOG_LOGGER_DEBUG(logger,"[EnableChannels] Enabling coins");
+        SPDLOG_LOGGER_TRACE(logger,"[EnableChannels] Running CMDENABLE");
 
         Response = SendingCommand(CMDENABLE);
 
@@ -1279,7 +1291,7 @@ namespace ValidatorPelicano{
             return -1;
         }
 
-        logger->trace("[EnableChannels] Acceptor has all coins enabled");
+        SPDLOG_LOGGER_TRACE(logger,"[EnableChannels] Acceptor has all coins enabled");
         return 0;
     }
 
@@ -1287,8 +1299,8 @@ namespace ValidatorPelicano{
 
         int Response  = -1;
 
-        logger->debug("[StartMotor] Starting motor");
-        logger->trace("[StartMotor] Running CMDSTARTMOTOR");
+        SPDLOG_LOGGER_DEBUG(logger,"[StartMotor] Starting motor");
+        SPDLOG_LOGGER_TRACE(logger,"[StartMotor] Running CMDSTARTMOTOR");
 
         Response = SendingCommand(CMDSTARTMOTOR);
 
@@ -1297,7 +1309,7 @@ namespace ValidatorPelicano{
             return -1;
         }
 
-        logger->trace("[EnableChannels] Motor is running");
+        SPDLOG_LOGGER_TRACE(logger,"[EnableChannels] Motor is running");
         return 0;
     }
 
@@ -1305,14 +1317,14 @@ namespace ValidatorPelicano{
         
         int Response = 2;
 
-        logger->debug("[CheckEventReset] Reading coin event");
-        logger->trace("[CheckEventReset] Running CMDSTARTPOLL");
+        SPDLOG_LOGGER_DEBUG(logger,"[CheckEventReset] Reading coin event");
+        SPDLOG_LOGGER_TRACE(logger,"[CheckEventReset] Running CMDSTARTPOLL");
 
         Response = SendingCommand(CMDSTARTPOLL);
 
         if ((Response == 0) | (Response == -2)){
             if ((CoinEvent == 0)|(CoinEvent == 1)){
-                logger->debug("[CheckEventReset] CoinEvent is OK: {0}",CoinEvent);
+                SPDLOG_LOGGER_DEBUG(logger,"[CheckEventReset] CoinEvent is OK: {0}",CoinEvent);
             }
             else {
                 logger->error("[CheckEventReset] CoinEvent is not OK {0}",CoinEvent);
@@ -1330,7 +1342,7 @@ namespace ValidatorPelicano{
             }
         }
 
-        logger->trace("[CheckEventReset] Coin event is ready");
+        SPDLOG_LOGGER_TRACE(logger,"[CheckEventReset] Coin event is ready");
         return 0;
         
     }
@@ -1339,8 +1351,8 @@ namespace ValidatorPelicano{
 
         int Response = 2;
 
-        logger->debug("[CleanBowl] Cleaning bowl");
-        logger->trace("[CleanBowl] Running CMDCLEANBOWL");
+        SPDLOG_LOGGER_DEBUG(logger,"[CleanBowl] Cleaning bowl");
+        SPDLOG_LOGGER_TRACE(logger,"[CleanBowl] Running CMDCLEANBOWL");
 
         Response = SendingCommand(CMDCLEANBOWL);
         
@@ -1349,9 +1361,37 @@ namespace ValidatorPelicano{
             return -1;
         }
 
-        sleep(7);
+        // La rutina abre la compuerta, deja caer lo que hay en la bandeja y la cierra. La compuerta puede tardar en
+        // abrir, asi que se termina cuando la bandeja lleva CLEANSETTLEMS limpia (vacia, cerrada y sin sensores
+        // bloqueados) desde la ultima lectura sucia o fallida
+        std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+        long ClearSinceMs = -1;
+
+        while (true){
+            usleep(CLEANPOLLMS * 1000);
+            CleanMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Start).count();
+
+            bool Clear = false;
+            if (SendingCommand(CMDREADOPTOST) == 0){
+                Clear = (!CoinPresent) & (!TrashDoorOpen) & (!LowerSensorBlocked) & (!UpperSensorBlocked);
+                SPDLOG_LOGGER_TRACE(logger,"[CleanBowl] {0} ms coin present: {1} trash door open: {2}",CleanMs,CoinPresent,TrashDoorOpen);
+            }
+            if (!Clear){
+                ClearSinceMs = -1;
+            }
+            else if (ClearSinceMs < 0){
+                ClearSinceMs = CleanMs;
+            }
+            if ((ClearSinceMs >= 0) && (CleanMs - ClearSinceMs >= CLEANSETTLEMS)){
+                break;
+            }
+            if (CleanMs >= CleanTimeoutMs){
+                logger->warn("[CleanBowl] Bowl not clear after {0} ms",CleanMs);
+                return 0;
+            }
+        }
 
-        logger->trace("[CleanBowl] Cleaning bowl run successfully");
+        logger->info("[CleanBowl] Cleaning bowl run successfully in {0} ms",CleanMs);
 
         return 0;
     }
@@ -1360,8 +1400,8 @@ namespace ValidatorPelicano{
 
         int Response  = -1;
 
-        logger->debug("[StopMotor] Starting motor");
-        logger->trace("[StopMotor] Running CMDSTARTMOTOR");
+        SPDLOG_LOGGER_DEBUG(logger,"[StopMotor] Stopping motor");
+        SPDLOG_LOGGER_TRACE(logger,"[StopMotor] Running CMDSTOPMOTOR");
 
         Response = SendingCommand(CMDSTOPMOTOR);
 
@@ -1370,7 +1410,7 @@ namespace ValidatorPelicano{
             return -1;
         }
 
-        logger->trace("[StopMotor] Motor was stopped");
+        SPDLOG_LOGGER_TRACE(logger,"[StopMotor] Motor was stopped");
 
         return 0;
     }
@@ -1379,8 +1419,8 @@ namespace ValidatorPelicano{
 
         int Response  = -1;
 
-        logger->debug("[ResetDevice] Reset device running");
-        logger->trace("[ResetDevice] Running CMDRESETDEVICE");
+        SPDLOG_LOGGER_DEBUG(logger,"[ResetDevice] Reset device running");
+        SPDLOG_LOGGER_TRACE(logger,"[ResetDevice] Running CMDRESETDEVICE");
 
         Response = SendingCommand(CMDRESETDEVICE);
 
@@ -1389,7 +1429,7 @@ namespace ValidatorPelicano{
             return -1;
         }
         
-        logger->trace("[StopMotor] Device was rebooted");
+        SPDLOG_LOGGER_TRACE(logger,"[StopMotor] Device was rebooted");
 
         return 0;
     }
@@ -1398,8 +1438,8 @@ namespace ValidatorPelicano{
 
         int Response  = -1;
 
-        logger->debug("[SetSpeed] Setting Speed");
-        logger->trace("[SetSpeed] Running CMDSETSPEEDn");
+        SPDLOG_LOGGER_DEBUG(logger,"[SetSpeed] Setting Speed");
+        SPDLOG_LOGGER_TRACE(logger,"[SetSpeed] Running CMDSETSPEEDn");
 
         if (cps == 2){
             Response = SendingCommand(CMDSETSPEED2);
@@ -1419,7 +1459,7 @@ namespace ValidatorPelicano{
             return -1;
         }
         
-        logger->trace("[SetSpeed] Set speed run successfully");
+        SPDLOG_LOGGER_TRACE(logger,"[SetSpeed] Set speed run successfully");
 
         return 0;
     }
@@ -1427,8 +1467,8 @@ namespace ValidatorPelicano{
     int PelicanoClass::GetSpeed(){
         int Response  = -1;
 
-        logger->debug("[GetSpeed] Getting Speed");
-        logger->trace("[GetSpeed] Running CMDGETSPEED");
+        SPDLOG_LOGGER_DEBUG(logger,"[GetSpeed] Getting Speed");
+        SPDLOG_LOGGER_TRACE(logger,"[GetSpeed] Running CMDGETSPEED");
 
         Response = SendingCommand(CMDGETSPEED);
 
@@ -1437,7 +1477,7 @@ namespace ValidatorPelicano{
             return -1;
         }
         
-        logger->trace("[GetSpeed] Get speed run successfully");
+        SPDLOG_LOGGER_TRACE(logger,"[GetSpeed] Get speed run successfully");
 
         return 0;
     }
@@ -1445,8 +1485,8 @@ namespace ValidatorPelicano{
     int PelicanoClass::GetCountCoins(){
         int Response  = -1;
 
-        logger->debug("[GetCountCoins] Getting insertion counter");
-        logger->trace("[GetCountCoins] Running CMDCOUNTCOINS");
+        SPDLOG_LOGGER_DEBUG(logger,"[GetCountCoins] Getting insertion counter");
+        SPDLOG_LOGGER_TRACE(logger,"[GetCountCoins] Running CMDCOUNTCOINS");
 
         Response = SendingCommand(CMDCOUNTCOINS);
 
@@ -1455,7 +1495,7 @@ namespace ValidatorPelicano{
             return -1;
         }
         
-        logger->trace("[GetCountCoins] Get insertion counter run successfully");
+        SPDLOG_LOGGER_TRACE(logger,"[GetCountCoins] Get insertion counter run successfully");
 
         return 0;
     }
@@ -1481,13 +1521,13 @@ namespace ValidatorPelicano{
         // Calcular el checksum del mensaje (suma de todos los bytes hasta ahora)
         unsigned char checksum = 0;
         for (size_t i = 0; i < command.size(); i++) {
-            logger->debug("Custom command {0}",command[i]);
             checksum += command[i];
         }
         checksum = 256-checksum;
 
         // Checksum al final del mensaje
         command.push_back(checksum);
+        SPDLOG_LOGGER_DEBUG(logger,"Custom command {0:n}",Logging::Hex(command,command.size()));
 
         return command;
     }
@@ -1496,8 +1536,8 @@ namespace ValidatorPelicano{
 
         int Response  = -1;
 
-        logger->debug("[ChangeInhibitChannels] Changing inhibit channels");
-        logger->trace("[ChangeInhibitChannels] Running BuildCmdModifyInhibit");
+        SPDLOG_LOGGER_DEBUG(logger,"[ChangeInhibitChannels] Changing inhibit channels");
+        SPDLOG_LOGGER_TRACE(logger,"[ChangeInhibitChannels] Running BuildCmdModifyInhibit");
 
         std::vector<unsigned char> command = BuildCmdModifyInhibit(InhibitMask1,InhibitMask2);
 
@@ -1508,7 +1548,7 @@ namespace ValidatorPelicano{
             return -1;
         }
         
-        logger->trace("[ChangeInhibitChannels] Inhibited custom channels");
+        SPDLOG_LOGGER_TRACE(logger,"[ChangeInhibitChannels] Inhibited custom channels");
 
         return 0;
     }
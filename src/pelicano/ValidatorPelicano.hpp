@@ -19,22 +19,28 @@
 #include <termios.h> // Contains POSIX terminal control definitions
 #include <unistd.h> // write(), read(), close()
 #include <sys/ioctl.h> //To use flush
+#include <sys/file.h> //To use flock
+#include <atomic>
 #include <bitset> //To use bitset in HandleResponseInfo
+#include <chrono>
 #include <vector>
+#include <string_view>
 
 #include "spdlog/spdlog.h" //Logging library
-#include "spdlog/sinks/daily_file_sink.h" //Logging library - daily file
+#include "../common/Logging.hpp" //Logging library - async logger and hex dump
+#include "../common/FlightRecorder.hpp"
+#include "../common/SerialCapture.hpp"
 
 namespace ValidatorPelicano{
 
     struct SpdlogLevels_t{
         int Code;
-        std::string Message;
+        std::string_view Message;
     };
 
     struct ErrorCodePolling_t{
         int Code;
-        std::string Message;
+        std::string_view Message;
         int StaticE;
         int Critical;
     };
@@ -46,14 +52,30 @@ namespace ValidatorPelicano{
 
     struct ErrorCodeExComm_t{
         int Code;
-        std::string Message;
+        std::string_view Message;
     };
 
     struct FaultCode_t{
         int Code;
-        std::string Message;
+        std::string_view Message;
     };
 
+    /**
+     * @brief Tiempo maximo por defecto de la limpieza de la bandeja, en milisegundos (la espera fija que se usaba)
+     */
+    static const int CLEANTIMEOUTMS = 7000;
+
+    /**
+     * @brief Intervalo entre lecturas de los optosensores mientras se limpia la bandeja
+     */
+    static const int CLEANPOLLMS = 100;
+
+    /**
+     * @brief Tiempo que la bandeja debe leerse limpia sin interrupcion (vacia, compuerta cerrada, sensores libres)
+     * antes de dar la limpieza por terminada
+     */
+    static const int CLEANSETTLEMS = 1500;
+
     class PelicanoClass{
         public:
 
@@ -87,6 +109,12 @@ namespace ValidatorPelicano{
              */
             int CoinEventPrev;
 
+            /**
+             * @brief Contador de eventos guardado en el archivo de estado antes de reiniciar el proceso. Lo asigna
+             * PelicanoControl antes de pasar a ST_RESUME, -1 si no hay estado guardado (Funcion StResume)
+             */
+            int ResumeEvent;
+
             /**
              * @brief Cantidad de monedas de 50 faltantes, cuando hay perdida de eventos
              */
@@ -188,6 +216,12 @@ namespace ValidatorPelicano{
              */
             int ActOChannel;
 
+            /**
+             * @brief Monedas aceptadas en el ultimo polling, en el orden en que entraron. Con varios eventos en el
+             * mismo polling ActOCoin solo guarda la ultima
+             */
+            std::vector<CoinPolling_t> PollCoins;
+
             /**
              * @brief Velocidad actual del motor que mueve el disco
              */
@@ -198,6 +232,11 @@ namespace ValidatorPelicano{
              */
             unsigned long TotalInsertionCounter;
 
+            /**
+             * @brief Duracion medida de la ultima limpieza de la bandeja (CleanBowl), en milisegundos
+             */
+            long CleanMs;
+
             //WRITE ONLY
 
             /**
@@ -215,6 +254,53 @@ namespace ValidatorPelicano{
              */
             int MaxPorts;
 
+            /**
+             * @brief Tiempo maximo de espera de la limpieza de la bandeja, en milisegundos
+             */
+            int CleanTimeoutMs;
+
+            // --------------- INTERNAL VARIABLES --------------------//
+
+            /**
+             * @brief Bandera que indica si se estan escaneando los puertos (ScanPorts)
+             */
+            bool Scanning;
+
+            /**
+             * @brief Ultimo error de polling reportado por el validador
+             */
+            ErrorCodePolling_t ErrP;
+
+            /**
+             * @brief Error de polling anterior
+             */
+            ErrorCodePolling_t ErrPPrev;
+
+            /**
+             * @brief Ultima falla general reportada por el validador
+             */
+            FaultCode_t FaultC;
+
+            /**
+             * @brief Ultima moneda reconocida con su canal
+             */
+            CoinPolling_t ActCoin;
+
+            /**
+             * @brief Logger de esta instancia del validador
+             */
+            std::shared_ptr<spdlog::logger> logger;
+
+            /**
+             * @brief Registro en memoria de las ultimas tramas, transiciones y resultados de esta instancia del validador
+             */
+            FlightRecorder::FlightRecorderClass Recorder;
+
+            /**
+             * @brief Captura binaria de las tramas enviadas y recibidas (inactiva hasta StartCapture)
+             */
+            SerialCapture::SerialCaptureClass Capture;
+
             // --------------- CONSTRUCTOR FUNCTIONS --------------------//
 
             /**
@@ -333,14 +419,44 @@ namespace ValidatorPelicano{
             */
             int StError();
 
+            /**
+            * @brief Estado de arranque en caliente (el proceso se reinicio con el lector iniciado): lee el contador de
+            * eventos sin resetear el validador y, si es coherente con ResumeEvent, vuelve a habilitar los canales y
+            * el motor. Los eventos pendientes se leen en el siguiente polling
+            * @return int - Retorna 0 si se puede retomar el polling
+            * @return int - Retorna 1 si no se pudo correr alguna de las funciones
+            * @return int - Retorna 2 si el contador no es coherente (el validador se reinicio o se perdieron eventos)
+            */
+            int StResume();
+
             // --------------- MAIN FUNCTIONS --------------------//
             
             /**
-            * @brief Abre el archivo donde se van a guardar los logs
+            * @brief Abre el archivo donde se van a guardar los logs con un logger propio de la instancia. Si la
+            * instancia ya tenia logger lo da de baja antes de crear el nuevo
             * @param Path Ruta donde se debe guardar el log de Spdlog
             */
             void InitLogger(const std::string& Path);
 
+            /**
+            * @brief Vuelca el flight recorder al archivo <ruta del log>.flight
+            * @param Reason Motivo del volcado
+            * @return long Numero de entradas escritas, -1 si no se pudo escribir el archivo
+            */
+            long DumpRecorder(const char *Reason);
+
+            /**
+            * @brief Hook de entrada al estado ST_ERROR, vuelca el flight recorder
+            */
+            void DumpRecorderOnError();
+
+            /**
+            * @brief Empieza a guardar cada trama enviada y recibida en un archivo de captura binario
+            * @param Path Ruta del archivo de captura (se agrega al final si ya existe)
+            * @return int 0 si se pudo abrir el archivo, 1 si no
+            */
+            int StartCapture(const std::string& Path);
+
             /**
             * @brief Se conecta al puerto con las caracteristicas definidas en la hoja de datos del dispensador
             * @brief Cambia bandera de conexion exitosa/fallida
@@ -483,9 +599,12 @@ namespace ValidatorPelicano{
             int CheckEventReset();
 
             /**
-            * @brief Corre el comando CMDCLEANBOWL para correr la rutina de vaciado de basura en la bandeja, se espera 7 segundos a que acabe
+            * @brief Corre el comando CMDCLEANBOWL para correr la rutina de vaciado de basura en la bandeja y lee los optosensores
+            * cada CLEANPOLLMS hasta que la bandeja lleva CLEANSETTLEMS limpia sin interrupcion (una lectura sucia o fallida
+            * reinicia la cuenta), maximo CleanTimeoutMs. Deja la duracion medida en CleanMs
             * @return Si retorna -1 -> Error grave, no pudo correr rutina de vaciado de bandeja
-            * @return Si retorna  0 -> Rutina de vaciado de basura corrio exitosamente
+            * @return Si retorna  0 -> Rutina de vaciado de basura corrio exitosamente (o se agoto CleanTimeoutMs, StCleanBowl
+            * revisa despues los optosensores)
             */
             int CleanBowl();
 
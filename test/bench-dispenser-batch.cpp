@@ -0,0 +1,205 @@
+/**
+ * @file bench-dispenser-batch.cpp
+ * @brief Mide tarjetas por minuto del dispensador sin hardware. Un hilo hace de dispensador al otro lado de un
+ * socketpair: responde GETSTATUS, DISPENSECARD y RETURNCARD con la trama de exito (ACK + F2 ... 'P' CM PM st0 st1 st2
+ * ETX BCC), tarda --motor ms en llevar la tarjeta a la puerta y el usuario simulado la retira --take ms despues.
+ * Se compara el flujo que hace hoy JS por tarjeta (dispenseCard, onDispense hasta que deja de responder 301,
+ * endProcess) contra DispenseCards, que usa la lectura que confirma el retiro como revision de la siguiente tarjeta.
+ *
+ * g++ -std=c++17 -O2 -I../src -I../src/spdlog/include bench-dispenser-batch.cpp ../src/dispenser/DispenserControl.cpp ../src/dispenser/Dispenser.cpp ../src/dispenser/StateMachine.cpp ../src/common/CommandScheduler.cpp ../src/common/EventJournal.cpp ../src/common/PollScheduler.cpp ../src/common/Logging.cpp ../src/common/FlightRecorder.cpp ../src/common/SerialCapture.cpp -lpthread -o bench-dispenser-batch
+ * ./bench-dispenser-batch [--cards 20] [--delay 15] [--motor 400] [--take 800] [--split 16]
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include "dispenser/DispenserControl.hpp"
+#include "spdlog/sinks/null_sink.h"
+
+using namespace DispenserControl;
+
+static int DelayMs = 15;            // Tiempo de respuesta del dispensador simulado (13 bytes a 9600 baudios)
+static int MotorMs = 400;           // Tiempo que tarda la tarjeta en llegar a la puerta
+static int TakeMs = 800;            // Tiempo que tarda el usuario en retirar la tarjeta
+static int SplitMs = 0;             // Si es mayor a 0 la respuesta llega en dos partes, como con el latency timer USB
+static std::atomic<bool> Running(true);
+
+// --------------- DISPENSADOR SIMULADO --------------------//
+
+struct Simulated_t{
+    int Cards = 1000;
+    bool AtGate = false;
+    std::chrono::steady_clock::time_point GateSince;
+    std::atomic<uint64_t> Commands{0};
+
+    // El usuario retira la tarjeta TakeMs despues de que llega a la puerta
+    void Update(){
+        if (AtGate && (std::chrono::steady_clock::now() - GateSince >= std::chrono::milliseconds(TakeMs))){
+            AtGate = false;
+        }
+    }
+
+    std::vector<unsigned char> Reply(unsigned char Cm, unsigned char Pm){
+        unsigned char St0 = AtGate ? '1' : '0';
+        unsigned char St1 = (Cards > 0) ? '1' : '0';
+        std::vector<unsigned char> Frame = {0x06, 0xF2, 0x00, 0x00, 0x06, 0x50, Cm, Pm, St0, St1, '0', 0x03};
+        unsigned char Bcc = 0;
+        for (size_t i = 1; i < Frame.size(); i++){
+            Bcc ^= Frame[i];
+        }
+        Frame.push_back(Bcc);
+        return Frame;
+    }
+};
+
+static void Slave(int Fd, Simulated_t *Sim){
+    std::vector<unsigned char> Frame;
+    unsigned char Byte;
+
+    while (Running){
+        if (recv(Fd, &Byte, 1, 0) != 1){
+            continue;
+        }
+        // El ACK del host despues de cada respuesta no lleva respuesta
+        if (Frame.empty() && (Byte != 0xF2)){
+            continue;
+        }
+        Frame.push_back(Byte);
+        if (Frame.size() < 9){
+            continue;
+        }
+
+        unsigned char Cm = Frame[5];
+        unsigned char Pm = Frame[6];
+        Frame.clear();
+        Sim->Commands++;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(DelayMs));
+        Sim->Update();
+        if ((Cm == '2') && (Pm == '0') && !Sim->AtGate && (Sim->Cards > 0)){
+            std::this_thread::sleep_for(std::chrono::milliseconds(MotorMs));
+            Sim->Cards--;
+            Sim->AtGate = true;
+            Sim->GateSince = std::chrono::steady_clock::now();
+        }
+        else if ((Cm == '2') && (Pm == '3')){
+            Sim->AtGate = false;
+        }
+        std::vector<unsigned char> Out = Sim->Reply(Cm, Pm);
+        size_t First = (SplitMs > 0) ? 7 : Out.size();
+        send(Fd, &Out[0], First, 0);
+        if (First < Out.size()){
+            std::this_thread::sleep_for(std::chrono::milliseconds(SplitMs));
+            send(Fd, &Out[First], Out.size() - First, 0);
+        }
+    }
+}
+
+// --------------- FLUJOS --------------------//
+
+// Lo que hace hoy JS por tarjeta: dispenseCard, onDispense (CheckDevice hasta que deja de responder 301) y endProcess
+static int Sequential(DispenserControlClass &Control, int Cards){
+    int Delivered = 0;
+    for (int i = 0; i < Cards; i++){
+        Response_t Res = Control.DispenseCard();
+        if ((Res.StatusCode != 203) && (Res.StatusCode != 304) && (Res.StatusCode != 305)){
+            fprintf(stderr, "secuencial: tarjeta %d fallo con %d %s\n", i + 1, Res.StatusCode, Res.Message.c_str());
+            break;
+        }
+        do {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            Res = Control.CheckDevice();
+        } while (Res.StatusCode == 301);
+        Control.EndProcess();
+        Delivered++;
+    }
+    return Delivered;
+}
+
+static int Batch(DispenserControlClass &Control, int Cards){
+    int Delivered = 0;
+    std::atomic<bool> BatchRunning(true);
+    BatchOptions_t Options;
+    Options.TakeTimeoutMs = 0;
+    Response_t Res = Control.DispenseCards(Cards, Options, [&Delivered](const CardResult_t &Card){
+        if (Card.Taken){
+            Delivered++;
+        }
+    }, BatchRunning);
+    if (Res.StatusCode != 205){
+        fprintf(stderr, "lote: termino con %d %s\n", Res.StatusCode, Res.Message.c_str());
+    }
+    return Delivered;
+}
+
+static void Report(const char *Name, int Delivered, double Seconds, uint64_t Commands){
+    printf("%-10s %3d tarjetas en %6.2f s: %6.1f tarjetas/min, %5.1f comandos por tarjeta\n", Name, Delivered, Seconds,
+           Delivered ? 60.0 * Delivered / Seconds : 0.0, Delivered ? static_cast<double>(Commands) / Delivered : 0.0);
+}
+
+// --------------- MAIN --------------------//
+
+int main(int argc, char *argv[]){
+    int Cards = 20;
+
+    for (int i = 1; i + 1 < argc; i += 2){
+        std::string Arg = argv[i];
+        if (Arg == "--cards") Cards = atoi(argv[i + 1]);
+        else if (Arg == "--delay") DelayMs = atoi(argv[i + 1]);
+        else if (Arg == "--motor") MotorMs = atoi(argv[i + 1]);
+        else if (Arg == "--take") TakeMs = atoi(argv[i + 1]);
+        else if (Arg == "--split") SplitMs = atoi(argv[i + 1]);
+        else {
+            fprintf(stderr, "Opcion desconocida %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    int Fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, Fds) != 0){
+        perror("socketpair");
+        return 1;
+    }
+    // Como VTIME = 10 en el puerto real: cada read espera maximo 1 s
+    struct timeval Tv = {1, 0};
+    setsockopt(Fds[0], SOL_SOCKET, SO_RCVTIMEO, &Tv, sizeof(Tv));
+    Tv = {0, 100000};
+    setsockopt(Fds[1], SOL_SOCKET, SO_RCVTIMEO, &Tv, sizeof(Tv));
+    Simulated_t Sim;
+    std::thread SlaveThread(Slave, Fds[1], &Sim);
+
+    DispenserControlClass Control;
+    DispenserClass &Dispenser = Control.Globals.DispenserObject;
+    Dispenser.logger = spdlog::null_logger_mt("bench-dispenser-batch");
+    Dispenser.SerialPort = Fds[0];
+    Dispenser.Initialized = true;
+    Dispenser.MaxInitAttempts = Control.MaxInitAttempts;
+    Dispenser.ShortTime = Control.ShortTime;
+    Dispenser.LongTime = Control.LongTime;
+    Control.Globals.SMObject.SM.CurrState = DispenserSMClass::ST_WAIT;
+    Control.CheckDevice();
+
+    printf("respuesta %d ms (partida %d ms), motor %d ms, retiro %d ms\n", DelayMs, SplitMs, MotorMs, TakeMs);
+
+    uint64_t Commands = Sim.Commands;
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    int Delivered = Sequential(Control, Cards);
+    Report("secuencial", Delivered, std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count(), Sim.Commands - Commands);
+
+    Commands = Sim.Commands;
+    Start = std::chrono::steady_clock::now();
+    Delivered = Batch(Control, Cards);
+    Report("lote", Delivered, std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count(), Sim.Commands - Commands);
+
+    Running = false;
+    SlaveThread.join();
+    return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file bench-dispenser-decode.cpp
+ * @brief Benchmark de la decodificacion de respuestas del dispensador: busqueda por cadenas (implementacion
+ * anterior, copiada aqui como referencia) contra las tablas de acceso directo de Dispenser.cpp. Usa tramas de
+ * exito y de error con el formato que entrega el dispensador (ACK + F2 ... 'P'/'N' CM PM datos ETX BCC).
+ *
+ * g++ -std=c++17 -O2 -I../src -I../src/spdlog/include bench-dispenser-decode.cpp ../src/dispenser/Dispenser.cpp ../src/common/Logging.cpp ../src/common/FlightRecorder.cpp ../src/common/SerialCapture.cpp -lpthread -o bench-dispenser-decode && ./bench-dispenser-decode
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "dispenser/Dispenser.hpp"
+#include "spdlog/sinks/null_sink.h"
+
+// Respuestas a GETSTATUS (CM '1' PM '0')
+static const std::vector<std::vector<unsigned char>> SuccessFrames = {
+    {0x06, 0xF2, 0x00, 0x00, 0x06, 0x50, 0x31, 0x30, 0x30, 0x32, 0x30, 0x03, 0xB6}, // sin tarjeta en puerta, caja llena
+    {0x06, 0xF2, 0x00, 0x00, 0x06, 0x50, 0x31, 0x30, 0x31, 0x31, 0x30, 0x03, 0xB6}, // tarjeta en la salida, pocas tarjetas
+    {0x06, 0xF2, 0x00, 0x00, 0x06, 0x50, 0x31, 0x30, 0x32, 0x30, 0x31, 0x03, 0xB6}, // tarjeta en RF/IC, sin tarjetas, reciclaje lleno
+};
+
+// Respuestas de fallo a DISPENSECARD (CM '2' PM '0')
+static const std::vector<std::vector<unsigned char>> ErrorFrames = {
+    {0x06, 0xF2, 0x00, 0x00, 0x05, 0x4E, 0x32, 0x30, 0x41, 0x30, 0x03, 0xB6}, // "A0" sin tarjetas
+    {0x06, 0xF2, 0x00, 0x00, 0x05, 0x4E, 0x32, 0x30, 0x31, 0x30, 0x03, 0xB6}, // "10" tarjeta atorada
+    {0x06, 0xF2, 0x00, 0x00, 0x05, 0x4E, 0x32, 0x30, 0x42, 0x30, 0x03, 0xB6}, // "B0" no se ha reseteado
+};
+
+// --------------- IMPLEMENTACION ANTERIOR (REFERENCIA) --------------------//
+
+struct LegacyRow_t{
+    std::string Code;
+    std::string Message;
+    int Priority;
+};
+
+static LegacyRow_t LegacyStatus[] = {
+    { "0","There is no card in gate",0},
+    { "1","There is a card at exit slot of card dispenser channel",0},
+    { "2","There is a card at RF / IC card slot of card dispenser channel",1},
+};
+
+static LegacyRow_t LegacyErrors[] = {
+    { "00","Undefined command",1}, { "01","Errors in command parameters",1}, { "02","Error in the command execution order",1},
+    { "03","Hardware does not support commands",1}, { "04","Command data error (error in communication packets DATA)",1},
+    { "10","Clogged card",1}, { "11","Code not found, may be code is Clogged card",1}, { "12","Sensor error",1},
+    { "40","The card has been pulled away when recycling card",1}, { "50","Recycled cards counter overflows",1},
+    { "51","Motor error",1}, { "60","IC card power supply is short-circuited",1},
+    { "A0","Card dispensing stack (box) is empty, there is no card in card stack",1},
+    { "A1","Card collection box is full",2}, { "B0","Card dispenser is not reset",3},
+};
+
+template <size_t N>
+static LegacyRow_t LegacySearch(LegacyRow_t (&Rows)[N], const std::string &Code, const std::string &Default){
+    LegacyRow_t Row;
+    Row.Message = Default;
+    Row.Priority = 1;
+    for (size_t i = 0; i < N; i++){
+        if (Rows[i].Code == Code){
+            Row.Message = Rows[i].Message;
+            Row.Priority = Rows[i].Priority;
+            break;
+        }
+    }
+    Row.Code = Code;
+    return Row;
+}
+
+static int LegacySuccess(std::vector<unsigned char> Response){
+    std::string DefaultMessage = "Code not found!!!";
+    std::string Status0 = std::string(1, static_cast<char>(Response[8]));
+    std::string Status1 = std::string(1, static_cast<char>(Response[9]));
+    std::string Status2 = std::string(1, static_cast<char>(Response[10]));
+    LegacyRow_t St0 = LegacySearch(LegacyStatus, Status0, DefaultMessage);
+    LegacyRow_t St1 = LegacySearch(LegacyStatus, Status1, DefaultMessage);
+    LegacyRow_t St2 = LegacySearch(LegacyStatus, Status2, DefaultMessage);
+    return ((St0.Message != DefaultMessage) & (St1.Message != DefaultMessage) & (St2.Message != DefaultMessage)) ? 0 : 2;
+}
+
+static int LegacyError(std::vector<unsigned char> Response){
+    std::string DefaultMessage = "ErrorCode not found!!!";
+    std::string ErrorCode1 = std::string(1, static_cast<char>(Response[8]));
+    std::string ErrorCode0 = std::string(1, static_cast<char>(Response[9]));
+    std::string ErrorCode = ErrorCode1 + ErrorCode0;
+    LegacyRow_t Err = LegacySearch(LegacyErrors, ErrorCode, DefaultMessage);
+    return (Err.Message != DefaultMessage) ? 1 : 2;
+}
+
+// --------------- BENCHMARK --------------------//
+
+template <typename Func>
+static double Bench(const char *Name, const std::vector<std::vector<unsigned char>> &Frames, Func Decode){
+    const long Iterations = 1000000;
+    long Sum = 0;
+    auto Start = std::chrono::steady_clock::now();
+    for (long i = 0; i < Iterations; i++){
+        for (const auto &Frame : Frames){
+            Sum += Decode(Frame);
+        }
+    }
+    double Ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count() / (Iterations * Frames.size());
+    printf("%-18s %7.2f ns/respuesta (checksum %ld)\n", Name, Ns, Sum);
+    return Ns;
+}
+
+int main(){
+    Dispenser::DispenserClass Device;
+    Device.logger = spdlog::null_logger_mt("bench-dispenser-decode");
+
+    double LegacyS = Bench("exito (cadenas)", SuccessFrames, LegacySuccess);
+    double TableS = Bench("exito (tabla)", SuccessFrames, [&Device](const std::vector<unsigned char> &Frame){ return Device.HandleResponseSuccess(Frame); });
+    double LegacyE = Bench("error (cadenas)", ErrorFrames, LegacyError);
+    double TableE = Bench("error (tabla)", ErrorFrames, [&Device](const std::vector<unsigned char> &Frame){ return Device.HandleResponseError(Frame); });
+
+    printf("speedup exito %.2fx, error %.2fx\n", LegacyS / TableS, LegacyE / TableE);
+    printf("ultimo error: %s - %s (prioridad %d)\n", Device.ErrorOCode.c_str(), Device.ErrorOMsg.c_str(), Device.ErrorOPriority);
+    return 0;
+}
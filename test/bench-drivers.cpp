@@ -0,0 +1,247 @@
+/**
+ * @file bench-drivers.cpp
+ * @brief Microbenchmarks del camino caliente de los drivers sobre tramas fijas, sin puerto serial: decodificadores
+ * (HandleResponse/HandleResponsePolling del Pelicano y Azkoyen, HandleResponse del NV10 y del dispensador), armado
+ * de comandos (CalcCRC/BuildCmd del NV10, BuildCmdModifyInhibit), busquedas en tablas de codigos y el despacho de
+ * la maquina de estados. Reporta ns/op y asignaciones de memoria/op (operator new reemplazado), para comparar
+ * cambios en los drivers con numeros y no a ojo.
+ *
+ * Los loggers escriben a un null sink con nivel info, como en produccion pero sin disco: los mensajes info/warn se
+ * siguen formateando y cuentan en el resultado.
+ *
+ * Target opcional de binding.gyp (se compila con el mismo SPDLOG_ACTIVE_LEVEL que el addon):
+ * npm run bench
+ * Filtro por nombre: ./build/Release/oink-bench nv10
+ *
+ * O a mano:
+ * g++ -std=c++17 -O2 -I../src -I../src/spdlog/include bench-drivers.cpp ../src/pelicano/ValidatorPelicano.cpp ../src/azkoyen/ValidatorAzkoyen.cpp ../src/nv10/ValidatorNV10.cpp ../src/dispenser/Dispenser.cpp ../src/common/Logging.cpp ../src/common/FlightRecorder.cpp ../src/common/SerialCapture.cpp -lpthread -o bench-drivers && ./bench-drivers
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include "pelicano/ValidatorPelicano.hpp"
+#include "azkoyen/ValidatorAzkoyen.hpp"
+#include "nv10/ValidatorNV10.hpp"
+#include "dispenser/Dispenser.hpp"
+#include "common/StateMachine.hpp"
+#include "spdlog/sinks/null_sink.h"
+
+// --------------- CONTEO DE ASIGNACIONES --------------------//
+
+static std::atomic<size_t> Allocations(0);
+
+void *operator new(size_t Size){
+    Allocations.fetch_add(1, std::memory_order_relaxed);
+    void *Ptr = malloc(Size ? Size : 1);
+    if (Ptr == nullptr){
+        throw std::bad_alloc();
+    }
+    return Ptr;
+}
+
+void *operator new[](size_t Size){
+    return operator new(Size);
+}
+
+// noinline: si se inlinean, GCC ve un free() sobre memoria de new y avisa (-Wmismatched-new-delete)
+__attribute__((noinline)) void operator delete(void *Ptr) noexcept { free(Ptr); }
+__attribute__((noinline)) void operator delete[](void *Ptr) noexcept { free(Ptr); }
+__attribute__((noinline)) void operator delete(void *Ptr, size_t) noexcept { free(Ptr); }
+__attribute__((noinline)) void operator delete[](void *Ptr, size_t) noexcept { free(Ptr); }
+
+// --------------- HARNESS --------------------//
+
+static const char *Filter = nullptr;
+
+// Evita que el compilador descarte el resultado de la operacion medida
+template <typename T>
+static inline void Keep(const T &Value){
+    asm volatile("" : : "g"(&Value) : "memory");
+}
+
+/**
+ * @brief Corre Op hasta juntar al menos 200 ms (despues de un calentamiento) y reporta ns/op y asignaciones/op
+ */
+template <typename Op_t>
+static void Bench(const char *Name, Op_t Op){
+    if ((Filter != nullptr) && (strstr(Name, Filter) == nullptr)){
+        return;
+    }
+    for (int i = 0; i < 1000; i++){
+        Op();
+    }
+    long Iterations = 1000;
+    double Ns = 0;
+    size_t Allocs = 0;
+    while (true){
+        size_t StartAllocs = Allocations.load(std::memory_order_relaxed);
+        auto Start = std::chrono::steady_clock::now();
+        for (long i = 0; i < Iterations; i++){
+            Op();
+        }
+        Ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count();
+        Allocs = Allocations.load(std::memory_order_relaxed) - StartAllocs;
+        if ((Ns >= 2e8) || (Iterations >= (1L << 30))){
+            break;
+        }
+        Iterations *= 4;
+    }
+    printf("%-44s %10.1f ns/op %8.2f allocs/op\n", Name, Ns / Iterations, static_cast<double>(Allocs) / Iterations);
+}
+
+template <typename Validator_t>
+static void NullLogger(Validator_t &Validator, const char *Name){
+    Validator.logger = spdlog::null_logger_mt(Name);
+    Validator.logger->set_level(spdlog::level::info);
+}
+
+// --------------- TRAMAS --------------------//
+
+// ccTalk (Pelicano/Azkoyen): eco de CMDSTARTPOLL + respuesta con contador de eventos en [9] y 5 pares canal/error
+static std::vector<unsigned char> CcTalkPoll(){
+    std::vector<unsigned char> Frame = {0x02, 0x00, 0x01, 0xE5, 0x18,
+                                        0x01, 0x0B, 0x02, 0x00, 0x01, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    Frame.resize(30);
+    return Frame;
+}
+
+// ccTalk: eco de CMDSIMPLEPOLL + ACK
+static const std::vector<unsigned char> CcTalkSimplePoll = {0x02, 0x00, 0x01, 0xFE, 0xFF, 0x01, 0x00, 0x02, 0x00, 0xFD};
+
+// SSP (NV10): STX, SEQ/ID, LEN, datos, CRC. Datos vacios = OK sin eventos, con 0xEE 0x01 = credito canal 1
+static std::vector<unsigned char> SspFrame(ValidatorNV10::NV10Class &Validator, unsigned char Seq, const std::vector<unsigned char> &Data){
+    std::vector<unsigned char> Frame = {0x7F, Seq, static_cast<unsigned char>(Data.size())};
+    Frame.insert(Frame.end(), Data.begin(), Data.end());
+    std::vector<unsigned char> Body(Frame.begin() + 1, Frame.end());
+    std::vector<unsigned char> Crc = Validator.CalcCRC(Body);
+    Frame.insert(Frame.end(), Crc.begin(), Crc.end());
+    Frame.resize(30);
+    return Frame;
+}
+
+// Dispensador: respuesta a GETSTATUS (ACK + F2 ... 'P' CM PM St0 St1 St2 ETX BCC)
+static const std::vector<unsigned char> DispenserStatus = {0x06, 0xF2, 0x00, 0x00, 0x06, 0x50, 0x31, 0x30, 0x30, 0x32, 0x30, 0x03, 0xB6};
+
+// Dispensador: fallo "A0" (sin tarjetas) a DISPENSECARD
+static const std::vector<unsigned char> DispenserError = {0x06, 0xF2, 0x00, 0x00, 0x05, 0x4E, 0x32, 0x30, 0x41, 0x30, 0x03, 0xB6};
+
+// --------------- MAQUINA DE ESTADOS --------------------//
+
+enum State_t{ ST_IDLE, ST_POLLING, ST_ERROR, ST_COUNT };
+enum Event_t{ EV_ANY, EV_POLL, EV_ERROR, EV_COUNT };
+
+class MockValidator{
+    public:
+        int Calls = 0;
+        int St(){ return ++Calls & 1; }
+};
+
+typedef StateMachineBase::StateMachine<MockValidator, State_t, Event_t> MockSM_t;
+
+static constexpr StateTable::TransitionRow_t<State_t, Event_t> MockTransition[] = {
+    { ST_IDLE,    EV_ANY,   ST_POLLING },
+    { ST_POLLING, EV_POLL,  ST_POLLING },
+    { ST_POLLING, EV_ERROR, ST_ERROR },
+    { ST_ERROR,   EV_ANY,   ST_IDLE },
+};
+
+static constexpr auto MockTable = StateTable::BuildTable<ST_COUNT, EV_COUNT>(MockTransition);
+
+static const MockSM_t::StateRow_t MockStates[ST_COUNT] = {
+    { "ST_IDLE", &MockValidator::St }, { "ST_POLLING", &MockValidator::St }, { "ST_ERROR", &MockValidator::St },
+};
+
+int main(int argc, char *argv[]){
+    Filter = (argc > 1) ? argv[1] : nullptr;
+    printf("SPDLOG_ACTIVE_LEVEL %d, logger en nivel info a null sink\n", SPDLOG_ACTIVE_LEVEL);
+
+    // Pelicano
+    {
+        ValidatorPelicano::PelicanoClass Validator;
+        NullLogger(Validator, "bench-pelicano");
+        std::vector<unsigned char> Poll = CcTalkPoll();
+        Poll[12] = 0x00;
+
+        Bench("pelicano/HandleResponsePolling (sin evento)", [&]{ Keep(Validator.HandleResponsePolling(Poll, 21)); });
+        Bench("pelicano/HandleResponsePolling (moneda)", [&]{
+            Poll[9] = (Poll[9] == 255) ? 1 : Poll[9] + 1;
+            Keep(Validator.HandleResponsePolling(Poll, 21));
+        });
+        Bench("pelicano/HandleResponse (poll)", [&]{ Keep(Validator.HandleResponse(Poll, 21, 5)); });
+        Bench("pelicano/HandleResponse (simple poll)", [&]{ Keep(Validator.HandleResponse(CcTalkSimplePoll, 10, 5)); });
+        Bench("pelicano/BuildCmdModifyInhibit", [&]{ Keep(Validator.BuildCmdModifyInhibit(0xFF, 0x00)); });
+        int Channel = 0;
+        Bench("pelicano/SearchCoin", [&]{ Channel = (Channel + 1) & 15; Keep(Validator.SearchCoin(Channel)); });
+        int Code = 0;
+        Bench("pelicano/SearchErrorCodePolling", [&]{ Code = (Code + 1) & 255; Keep(Validator.SearchErrorCodePolling(Code)); });
+        Bench("pelicano/SearchErrorCodeExComm", [&]{ Code = (Code + 1) & 7; Keep(Validator.SearchErrorCodeExComm(Code - 5)); });
+    }
+
+    // Azkoyen
+    {
+        ValidatorAzkoyen::AzkoyenClass Validator;
+        NullLogger(Validator, "bench-azkoyen");
+        std::vector<unsigned char> Poll = CcTalkPoll();
+
+        Bench("azkoyen/HandleResponsePolling (sin evento)", [&]{ Keep(Validator.HandleResponsePolling(Poll, 21)); });
+        Bench("azkoyen/HandleResponsePolling (moneda)", [&]{
+            Poll[9] = (Poll[9] == 255) ? 1 : Poll[9] + 1;
+            Keep(Validator.HandleResponsePolling(Poll, 21));
+        });
+        Bench("azkoyen/HandleResponse (poll)", [&]{ Keep(Validator.HandleResponse(Poll, 21, 5)); });
+        Bench("azkoyen/BuildCmdModifyInhibit", [&]{ Keep(Validator.BuildCmdModifyInhibit(0xFF, 0x00)); });
+    }
+
+    // NV10
+    {
+        ValidatorNV10::NV10Class Validator;
+        NullLogger(Validator, "bench-nv10");
+        const std::vector<unsigned char> Poll = {0x07};
+        const std::vector<unsigned char> Body = {0x80, 0x01, 0x07};
+        std::vector<unsigned char> Idle[2] = { SspFrame(Validator, 0x80, {0xF0}), SspFrame(Validator, 0x00, {0xF0}) };
+        std::vector<unsigned char> Credit[2] = { SspFrame(Validator, 0x80, {0xF0, 0xEE, 0x01}), SspFrame(Validator, 0x00, {0xF0, 0xEE, 0x01}) };
+        int Seq = 0;
+
+        Bench("nv10/CalcCRC", [&]{ Keep(Validator.CalcCRC(Body)); });
+        Bench("nv10/BuildCmd (POLL)", [&]{ Keep(Validator.BuildCmd(Poll)); });
+        // La respuesta alterna el bit de secuencia, una respuesta repetida se descarta sin decodificar
+        Bench("nv10/HandleResponse (OK)", [&]{ Seq ^= 1; Keep(Validator.HandleResponse(Idle[Seq])); });
+        Bench("nv10/HandleResponse (credito)", [&]{ Seq ^= 1; Keep(Validator.HandleResponse(Credit[Seq])); });
+        int Code = 0;
+        Bench("nv10/SearchEventCodes", [&]{ Code = (Code + 1) & 255; Keep(Validator.SearchEventCodes(Code)); });
+    }
+
+    // Dispensador
+    {
+        Dispenser::DispenserClass Validator;
+        NullLogger(Validator, "bench-dispenser");
+
+        Bench("dispenser/HandleResponse (status)", [&]{ Keep(Validator.HandleResponse(DispenserStatus, '1', '0')); });
+        Bench("dispenser/HandleResponse (error)", [&]{ Keep(Validator.HandleResponse(DispenserError, '2', '0')); });
+    }
+
+    // Maquina de estados
+    {
+        MockValidator Validator;
+        MockSM_t SM(&Validator, MockStates, &MockTable, -1);
+        FlightRecorder::FlightRecorderClass Recorder;
+        SM.InitStateMachine();
+        SM.StateMachineRun(EV_ANY);
+
+        Bench("statemachine/StateMachineRun (EV_POLL)", [&]{ Keep(SM.StateMachineRun(EV_POLL)); });
+        SM.SetRecorder(&Recorder);
+        Bench("statemachine/StateMachineRun + recorder", [&]{ Keep(SM.StateMachineRun(EV_POLL)); });
+    }
+
+    spdlog::shutdown();
+    return 0;
+}
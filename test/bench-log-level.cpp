@@ -0,0 +1,95 @@
+/**
+ * @file bench-log-level.cpp
+ * @brief Benchmark del costo de logging en una poll del Pelicano (StPolling, el estado que corre getCoin) segun el
+ * nivel compilado con SPDLOG_ACTIVE_LEVEL. read/write/usleep se reemplazan con --wrap para regresar una respuesta de
+ * poll capturada sin puerto serial ni esperas. El logger queda en nivel info, como en produccion. Cuenta instrucciones
+ * de usuario con perf_event_open cuando el kernel lo permite; siempre reporta ns por poll.
+ *
+ * Build de produccion (trace/debug compilados fuera) y de depuracion:
+ * g++ -std=c++17 -O2 -I../src -I../src/spdlog/include -DSPDLOG_ACTIVE_LEVEL=SPDLOG_LEVEL_INFO bench-log-level.cpp ../src/pelicano/ValidatorPelicano.cpp ../src/common/Logging.cpp ../src/common/FlightRecorder.cpp ../src/common/SerialCapture.cpp -Wl,--wrap=read,--wrap=write,--wrap=usleep -lpthread -o bench-log-level-info && ./bench-log-level-info
+ * g++ -std=c++17 -O2 -I../src -I../src/spdlog/include -DSPDLOG_ACTIVE_LEVEL=SPDLOG_LEVEL_TRACE bench-log-level.cpp ../src/pelicano/ValidatorPelicano.cpp ../src/common/Logging.cpp ../src/common/FlightRecorder.cpp ../src/common/SerialCapture.cpp -Wl,--wrap=read,--wrap=write,--wrap=usleep -lpthread -o bench-log-level-trace && ./bench-log-level-trace
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include "pelicano/ValidatorPelicano.hpp"
+
+// Eco de CMDSTARTPOLL (2 0 1 229 chk) + respuesta: destino, longitud 11, origen, ACK, contador de eventos, 5 pares
+static unsigned char PollResponse[] = {0x02, 0x00, 0x01, 0xE5, 0x18,
+                                       0x01, 0x0B, 0x02, 0x00, 0x01, 0x05, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+extern "C" {
+    ssize_t __real_read(int Fd, void *Buf, size_t Count);
+
+    ssize_t __wrap_write(int Fd, const void *Buf, size_t Count){
+        (void)Fd; (void)Buf;
+        return Count;
+    }
+
+    ssize_t __wrap_read(int Fd, void *Buf, size_t Count){
+        (void)Fd;
+        // Un evento nuevo en cada poll para recorrer el camino de moneda detectada
+        PollResponse[9]++;
+        size_t Length = (Count < sizeof(PollResponse)) ? Count : sizeof(PollResponse);
+        memcpy(Buf, PollResponse, Length);
+        return Length;
+    }
+
+    int __wrap_usleep(useconds_t Usec){
+        (void)Usec;
+        return 0;
+    }
+}
+
+static int OpenCounter(){
+    struct perf_event_attr Attr;
+    memset(&Attr, 0, sizeof(Attr));
+    Attr.type = PERF_TYPE_HARDWARE;
+    Attr.size = sizeof(Attr);
+    Attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    Attr.exclude_kernel = 1;
+    Attr.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &Attr, 0, -1, -1, 0);
+}
+
+int main(){
+    const int Polls = 200000;
+    ValidatorPelicano::PelicanoClass Validator;
+    Validator.InitLogger("/tmp/bench-log-level.log");
+    Validator.logger->set_level(spdlog::level::info);
+    Validator.SerialPort = 100;
+
+    int Counter = OpenCounter();
+    long long StartInstr = 0;
+    long long EndInstr = 0;
+    long Sum = 0;
+
+    if (Counter >= 0){
+        __real_read(Counter, &StartInstr, sizeof(StartInstr));
+    }
+    auto Start = std::chrono::steady_clock::now();
+    for (int i = 0; i < Polls; i++){
+        Sum += Validator.StPolling();
+    }
+    double Ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count() / Polls;
+    if (Counter >= 0){
+        __real_read(Counter, &EndInstr, sizeof(EndInstr));
+    }
+
+    printf("SPDLOG_ACTIVE_LEVEL %d: %7.1f ns/poll", SPDLOG_ACTIVE_LEVEL, Ns);
+    if (Counter >= 0){
+        printf(", %lld instrucciones/poll", (EndInstr - StartInstr) / Polls);
+    }
+    else {
+        printf(", sin contador de instrucciones (perf_event_open no disponible)");
+    }
+    printf(" (checksum %ld, descartados %zu)\n", Sum, Logging::DroppedMessages());
+    spdlog::shutdown();
+    return 0;
+}
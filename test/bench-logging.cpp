@@ -0,0 +1,82 @@
+/**
+ * @file bench-logging.cpp
+ * @brief Benchmark de la latencia de una poll con logging: logger sincrono (daily_logger_mt, implementacion anterior)
+ * contra Logging::CreateLogger (cola preasignada, hilo de fondo, descarta si se llena), con nivel trace e info. Cada
+ * poll simulada escribe los mismos mensajes que ExecuteCommand + HandleResponsePolling del Pelicano, incluyendo el
+ * volcado hexadecimal de la trama enviada y recibida. El directorio del log se pasa como argumento, para medir sobre
+ * la memoria SD del equipo y no solo sobre /tmp.
+ *
+ * g++ -std=c++17 -O2 -I../src -I../src/spdlog/include bench-logging.cpp ../src/common/Logging.cpp -lpthread -o bench-logging && ./bench-logging /tmp
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/Logging.hpp"
+#include "spdlog/sinks/daily_file_sink.h"
+
+static const int Polls = 5000;
+
+// Pausa entre polls (el driver real espera 200 ms por respuesta), da tiempo al hilo de fondo de vaciar la cola
+static const auto PollGap = std::chrono::microseconds(500);
+
+static const std::vector<unsigned char> PollCommand = {0x02, 0x00, 0x01, 0xE5, 0x18};
+static const std::vector<unsigned char> PollResponse = {0x02, 0x00, 0x01, 0xE5, 0x18, 0x01, 0x0B, 0x02, 0x00, 0x07,
+                                                        0x05, 0x01, 0x06, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                                        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+static void Poll(spdlog::logger &Logger, int Event){
+    Logger.trace("[ExecuteCommand] Writting command: {0:n}", Logging::Hex(PollCommand, PollCommand.size()));
+    Logger.trace("[ExecuteCommand] Length expected is the same: {0:d}", 5);
+    Logger.trace("[ExecuteCommand] Reading response");
+    Logger.debug("[ExecuteCommand] Reading length: {0:d}", 30);
+    Logger.trace("[ExecuteCommand] Data read: {0:n}", Logging::Hex(PollResponse, PollResponse.size()));
+    Logger.trace("[HandleResponsePolling] Data is correct!");
+    Logger.debug("[HandleResponsePolling] CoinEvent: {0} CoinEventPrev: {1}", Event, Event - 1);
+    Logger.trace("[HandleResponsePolling] ----------> Coin detected");
+    Logger.debug("[HandleResponsePolling] Coin: {0}", 100);
+    Logger.trace("[HandleResponsePolling] Coin Channel: {0}", 5);
+    Logger.debug("[HandleResponsePolling] Data: {0:n}", Logging::Hex(PollResponse, 10, 10));
+    Logger.info("[E4:STPOLLING] Coin inserted: {0}", 100);
+}
+
+static void Bench(const char *Name, std::shared_ptr<spdlog::logger> Logger, spdlog::level::level_enum Level){
+    Logger->set_level(Level);
+    std::vector<double> Latency(Polls);
+    for (int i = 0; i < Polls; i++){
+        auto Start = std::chrono::steady_clock::now();
+        Poll(*Logger, i);
+        Latency[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - Start).count();
+        std::this_thread::sleep_for(PollGap);
+    }
+    Logger->flush();
+    std::sort(Latency.begin(), Latency.end());
+    double Sum = 0;
+    for (double L : Latency){
+        Sum += L;
+    }
+    printf("%-22s %-5s media %7.2f us  p99 %8.2f us  max %9.2f us\n", Name, spdlog::level::to_string_view(Level).data(),
+        Sum / Polls, Latency[Polls * 99 / 100], Latency[Polls - 1]);
+}
+
+int main(int argc, char *argv[]){
+    std::string Dir = (argc > 1) ? argv[1] : "/tmp";
+
+    auto Sync = spdlog::daily_logger_mt("BenchSync", Dir + "/bench-logging-sync.log", 23, 59);
+    auto Async = Logging::CreateLogger("BenchAsync", Dir + "/bench-logging-async.log");
+
+    Bench("sincrono (anterior)", Sync, spdlog::level::info);
+    Bench("asincrono", Async, spdlog::level::info);
+    Bench("sincrono (anterior)", Sync, spdlog::level::trace);
+    Bench("asincrono", Async, spdlog::level::trace);
+
+    printf("mensajes descartados: %zu\n", Logging::DroppedMessages());
+    spdlog::shutdown();
+    return 0;
+}
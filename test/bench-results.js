@@ -0,0 +1,36 @@
+// Mide el costo de una llamada a getCoin/getBill (cruce JS -> C++ -> JS y armado del resultado).
+// No necesita hardware: sin startReader el lector regresa 507/503 sin tocar el puerto.
+// Para comparar antes/despues se corre este mismo script sobre cada build.
+// Aun no se ha corrido sobre el build anterior y el de ResultCache: no hay una mejora medida de ResultCache.
+const { Pelicano, NV10 } = require('../dist');
+
+const ITERATIONS = 1_000_000;
+
+function bench(name, fn) {
+  for (let i = 0; i < 10_000; i++) fn();
+  const start = process.hrtime.bigint();
+  for (let i = 0; i < ITERATIONS; i++) fn();
+  const elapsed = Number(process.hrtime.bigint() - start);
+  console.log(`${name}: ${(elapsed / ITERATIONS).toFixed(1)} ns/llamada`);
+}
+
+for (const compact of [false, true]) {
+  const pelicano = new Pelicano({
+    maxCritical: 4,
+    warnToCritical: 10,
+    maximumPorts: 10,
+    logLevel: 6,
+    logPath: 'logs/pelicano.log',
+    compact,
+  });
+  const nv10 = new NV10({
+    logPath: 'logs/nv10.log',
+    logLevel: 6,
+    maximumPorts: 10,
+    compact,
+  });
+  bench(`pelicano.getCoin (compact: ${compact})`, () => pelicano.getCoin());
+  bench(`nv10.getBill (compact: ${compact})`, () => nv10.getBill());
+}
+
+console.log(Pelicano.messages);
@@ -0,0 +1,131 @@
+/**
+ * @file bench-statemachine.cpp
+ * @brief Benchmark del despacho de transiciones: busqueda lineal en las filas (implementacion anterior) contra la
+ * plantilla StateMachineBase::StateMachine (tabla densa [estado][evento], hooks y trazas). Usa las filas de la
+ * maquina de estados del Pelicano con un validador simulado para no depender del puerto serial. Tambien mide la
+ * plantilla guardando cada transicion en un flight recorder.
+ *
+ * g++ -std=c++17 -O2 -I../src bench-statemachine.cpp ../src/common/FlightRecorder.cpp -o bench-statemachine && ./bench-statemachine
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include "common/StateMachine.hpp"
+
+enum State_t{ ST_IDLE, ST_CONNECT, ST_CHECK, ST_ENABLE, ST_POLLING, ST_CLEANBOWL, ST_RESET, ST_ERROR, ST_COUNT };
+enum Event_t{ EV_ANY, EV_SUCCESS_CONN, EV_CALL_POLLING, EV_CHECK, EV_TRASH, EV_READY, EV_FINISH_POLL, EV_POLL, EV_EMPTY, EV_LOOP, EV_ERROR, EV_COUNT };
+
+// Al llamar por apuntador a miembro GCC revisa tambien la rama virtual, que lee un vptr del objeto: con un objeto de
+// 4 bytes -O2 avisa -Warray-bounds. Un contador de 8 bytes lo deja del tamaño de un apuntador, como los validadores
+class MockValidator{
+    public:
+        long Calls = 0;
+        int St(){ return ++Calls & 1; }
+};
+
+typedef StateTable::TransitionRow_t<State_t, Event_t> StateTransitionRow_t;
+
+static constexpr StateTransitionRow_t StateTransition[] = {
+    { ST_IDLE,      EV_ANY,          ST_CONNECT },
+    { ST_CONNECT,   EV_SUCCESS_CONN, ST_CHECK },
+    { ST_CONNECT,   EV_ERROR,        ST_ERROR },
+    { ST_CHECK,     EV_CALL_POLLING, ST_ENABLE },
+    { ST_CHECK,     EV_CHECK,        ST_CHECK },
+    { ST_CHECK,     EV_TRASH,        ST_CLEANBOWL },
+    { ST_CHECK,     EV_ERROR,        ST_ERROR },
+    { ST_ENABLE,    EV_READY,        ST_POLLING },
+    { ST_ENABLE,    EV_ERROR,        ST_ERROR },
+    { ST_POLLING,   EV_FINISH_POLL,  ST_CLEANBOWL },
+    { ST_POLLING,   EV_POLL,         ST_POLLING },
+    { ST_POLLING,   EV_ERROR,        ST_ERROR },
+    { ST_CLEANBOWL, EV_EMPTY,        ST_RESET },
+    { ST_CLEANBOWL, EV_ERROR,        ST_ERROR },
+    { ST_CLEANBOWL, EV_ANY,          ST_CHECK },
+    { ST_CLEANBOWL, EV_FINISH_POLL,  ST_CLEANBOWL },
+    { ST_RESET,     EV_LOOP,         ST_CHECK },
+    { ST_RESET,     EV_ANY,          ST_RESET },
+    { ST_RESET,     EV_ERROR,        ST_ERROR },
+    { ST_ERROR,     EV_ANY,          ST_IDLE },
+};
+
+static constexpr auto Transitions = StateTable::BuildTable<ST_COUNT, EV_COUNT>(StateTransition);
+
+typedef StateMachineBase::StateMachine<MockValidator, State_t, Event_t> MockSM_t;
+
+static const MockSM_t::StateRow_t StateFunction[ST_COUNT] = {
+    { "ST_IDLE", &MockValidator::St }, { "ST_CONNECT", &MockValidator::St }, { "ST_CHECK", &MockValidator::St },
+    { "ST_ENABLE", &MockValidator::St }, { "ST_POLLING", &MockValidator::St }, { "ST_CLEANBOWL", &MockValidator::St },
+    { "ST_RESET", &MockValidator::St }, { "ST_ERROR", &MockValidator::St },
+};
+
+static int RunLinear(MockValidator &Validator, State_t &CurrState, Event_t Event){
+    for (size_t i = 0; i < sizeof(StateTransition)/sizeof(StateTransition[0]); i++){
+        if ((StateTransition[i].CurrState == CurrState) && (StateTransition[i].Event == Event)){
+            CurrState = StateTransition[i].NextState;
+            return (Validator.*(StateFunction[CurrState].func))();
+        }
+    }
+    return -1;
+}
+
+// Secuencia tipica: conexion, habilitar y muchas polls, terminar con limpieza y reset
+static const Event_t Sequence[] = {
+    EV_ANY, EV_SUCCESS_CONN, EV_CALL_POLLING, EV_READY,
+    EV_POLL, EV_POLL, EV_POLL, EV_POLL, EV_POLL, EV_POLL, EV_POLL, EV_POLL,
+    EV_FINISH_POLL, EV_EMPTY, EV_LOOP, EV_ERROR, EV_ANY,
+};
+
+static const long Iterations = 2000000;
+static const size_t Length = sizeof(Sequence)/sizeof(Sequence[0]);
+
+static double Report(const char *Name, std::chrono::steady_clock::time_point Start, int CurrState, long Sum){
+    double Ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count() / (Iterations * Length);
+    printf("%-10s %6.2f ns/transicion (estado final %d, checksum %ld)\n", Name, Ns, CurrState, Sum);
+    return Ns;
+}
+
+int main(){
+    MockValidator Validator;
+    State_t CurrState = ST_IDLE;
+    long Sum = 0;
+    auto Start = std::chrono::steady_clock::now();
+    for (long i = 0; i < Iterations; i++){
+        for (size_t j = 0; j < Length; j++){
+            Sum += RunLinear(Validator, CurrState, Sequence[j]);
+        }
+    }
+    double Linear = Report("lineal", Start, CurrState, Sum);
+
+    MockSM_t SM(&Validator, StateFunction, &Transitions, -1);
+    Sum = 0;
+    Start = std::chrono::steady_clock::now();
+    for (long i = 0; i < Iterations; i++){
+        for (size_t j = 0; j < Length; j++){
+            Sum += SM.StateMachineRun(Sequence[j]);
+        }
+    }
+    double Table = Report("plantilla", Start, SM.SM.CurrState, Sum);
+    printf("speedup    %6.2fx\n", Linear / Table);
+
+    FlightRecorder::FlightRecorderClass Recorder;
+    MockSM_t SMRecorder(&Validator, StateFunction, &Transitions, -1);
+    SMRecorder.SetRecorder(&Recorder);
+    Sum = 0;
+    Start = std::chrono::steady_clock::now();
+    for (long i = 0; i < Iterations; i++){
+        for (size_t j = 0; j < Length; j++){
+            Sum += SMRecorder.StateMachineRun(Sequence[j]);
+        }
+    }
+    Report("recorder", Start, SMRecorder.SM.CurrState, Sum);
+
+    MockSM_t::Trace_t Trace[4];
+    size_t Count = SM.GetTrace(Trace, 4);
+    for (size_t i = 0; i < Count; i++){
+        printf("traza %u %s -> %s (evento %d, respuesta %d)\n", Trace[i].Sequence, SM.StateMachineGetStateName(Trace[i].From), SM.StateMachineGetStateName(Trace[i].To), Trace[i].Event, Trace[i].Response);
+    }
+    return 0;
+}
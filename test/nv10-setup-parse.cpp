@@ -0,0 +1,100 @@
+/**
+ * @file nv10-setup-parse.cpp
+ * @brief Revisa HandleSetup del NV10 sin hardware con respuestas de SETUP_REQUEST (0x05) armadas segun la
+ * especificacion SSP (no son capturas): una con protocolo 4, donde el valor de cada canal es un byte por el
+ * multiplicador, y otra con protocolo 7, donde se usan los valores expandidos de 4 bytes. En las dos la tabla debe
+ * quedar en pesos enteros, igual que la tabla por defecto de COP. Tambien revisa que una respuesta corta se rechace.
+ *
+ * g++ -std=c++17 -O2 -I../src -I../src/spdlog/include nv10-setup-parse.cpp ../src/nv10/ValidatorNV10.cpp ../src/common/Logging.cpp ../src/common/FlightRecorder.cpp ../src/common/SerialCapture.cpp -lpthread -o nv10-setup-parse
+ * ./nv10-setup-parse
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <cstdio>
+#include <vector>
+#include "nv10/ValidatorNV10.hpp"
+#include "spdlog/sinks/null_sink.h"
+
+static const int Denominations[] = {1000, 2000, 5000, 10000, 20000, 50000, 100000};
+static const int Channels = 7;
+
+static void Push24(std::vector<unsigned char> &Data, long Value){
+    Data.push_back((Value >> 16) & 0xFF);
+    Data.push_back((Value >> 8) & 0xFF);
+    Data.push_back(Value & 0xFF);
+}
+
+// Trama STX SEQ LEN datos CRC; HandleSetup no revisa el CRC, se deja en 0
+static std::vector<unsigned char> Frame(ValidatorNV10::NV10Class &Validator, const std::vector<unsigned char> &Data){
+    std::vector<unsigned char> Response = {0x7F, 0x80, static_cast<unsigned char>(Data.size())};
+    Response.insert(Response.end(), Data.begin(), Data.end());
+    Response.push_back(0);
+    Response.push_back(0);
+    Validator.LengthData = Data.size();
+    return Response;
+}
+
+static std::vector<unsigned char> Setup(int Protocol, long ValueMultiplier){
+    std::vector<unsigned char> Data = {0xF0, 0x00, '0', '3', '7', '5', 'C', 'O', 'P'};
+    Push24(Data, ValueMultiplier);
+    Data.push_back(Channels);
+    for (int i = 0; i < Channels; i++){
+        Data.push_back((Protocol >= 6) ? 0 : Denominations[i] / ValueMultiplier);
+    }
+    for (int i = 0; i < Channels; i++){
+        Data.push_back(0x02);
+    }
+    Push24(Data, 100);
+    Data.push_back(Protocol);
+    if (Protocol >= 6){
+        for (int i = 0; i < Channels; i++){
+            Data.insert(Data.end(), {'C', 'O', 'P'});
+        }
+        for (int i = 0; i < Channels; i++){
+            for (int b = 0; b < 4; b++){
+                Data.push_back((Denominations[i] >> (8 * b)) & 0xFF);
+            }
+        }
+    }
+    return Data;
+}
+
+static int Check(const char *Name, ValidatorNV10::NV10Class &Validator, const std::vector<unsigned char> &Data){
+    int Failures = 0;
+    if (Validator.HandleSetup(Frame(Validator, Data)) != 0){
+        printf("%s: HandleSetup fallo\n", Name);
+        return 1;
+    }
+    if (Validator.Setup.Count != Channels){
+        printf("%s: %d canales, se esperaban %d\n", Name, Validator.Setup.Count, Channels);
+        Failures++;
+    }
+    for (int i = 0; i < Channels; i++){
+        if (Validator.Setup.Values[i + 1] != Denominations[i]){
+            printf("%s: canal %d vale %d, se esperaba %d\n", Name, i + 1, Validator.Setup.Values[i + 1], Denominations[i]);
+            Failures++;
+        }
+    }
+    printf("%s: %s\n", Name, Failures ? "FALLA" : "ok");
+    return Failures;
+}
+
+int main(){
+    ValidatorNV10::NV10Class Validator;
+    Validator.logger = spdlog::null_logger_mt("nv10-setup-parse");
+    int Failures = 0;
+
+    Failures += Check("protocolo 4", Validator, Setup(4, 1000));
+    Failures += Check("protocolo 7", Validator, Setup(7, 0));
+
+    // Sin los bytes de seguridad ni la version de protocolo la respuesta se rechaza y la tabla no cambia
+    std::vector<unsigned char> Short = Setup(4, 1000);
+    Short.resize(16 + Channels);
+    int Res = Validator.HandleSetup(Frame(Validator, Short));
+    printf("respuesta corta: %s\n", (Res != 0) ? "ok" : "FALLA");
+    Failures += (Res != 0) ? 0 : 1;
+
+    return Failures ? 1 : 0;
+}
@@ -0,0 +1,28 @@
+const { Pelicano } = require('../dist');
+
+// Dos validadores Pelicano conectados al mismo tiempo. Cada instancia toma el primer puerto libre.
+const devices = [0, 1].map((id) => new Pelicano({
+  maxCritical: 4,
+  warnToCritical: 10,
+  maximumPorts: 10,
+  logLevel: 1,
+  logPath: `logs/pelicano-${id}.log`,
+}));
+
+const stops = devices.map((pelicano, id) => {
+  const connect = pelicano.connect();
+  console.log(`[${id}] Connect retorna: ${connect.statusCode} y ${connect.message}`);
+  const startReader = pelicano.startReader();
+  console.log(`[${id}] StartReader retorna: ${startReader.statusCode} y ${startReader.message}`);
+  return pelicano.onCoin((coin) => {
+    console.log(`[${id}] StatusCode: ${coin.statusCode} Event: ${coin.event} Coin: ${coin.coin} Message: ${coin.message}`);
+  });
+});
+
+setTimeout(() => {
+  stops.forEach((stop) => stop());
+  devices.forEach((pelicano, id) => {
+    const stopReader = pelicano.stopReader();
+    console.log(`[${id}] StopReader retorna: ${stopReader.statusCode} y ${stopReader.message}`);
+  });
+}, 30_000);
@@ -0,0 +1,107 @@
+/**
+ * @file pelicano-speed-control.cpp
+ * @brief Revisa SpeedControl sin hardware con horas simuladas: velocidad inicial y su reintento cuando el validador no
+ * la acepta, subida por rafaga de monedas, que no haya otro cambio antes de una ventana completa (histeresis), bajada
+ * por rechazos, por disco bloqueado y por falta de monedas, y los limites MinSpeed/MaxSpeed. Sale con 1 si algo falla.
+ *
+ * g++ -std=c++17 -O2 -I../src pelicano-speed-control.cpp ../src/pelicano/SpeedControl.cpp -o pelicano-speed-control
+ * ./pelicano-speed-control
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <cstdio>
+#include "pelicano/SpeedControl.hpp"
+
+using namespace SpeedControl;
+
+static int Failures = 0;
+static Time_t Base = std::chrono::steady_clock::now();
+
+static Time_t At(int Ms){
+    return Base + std::chrono::milliseconds(Ms);
+}
+
+static void Expect(const char *Name, Change_t Change, int Speed, Reason_t Reason){
+    bool Ok = (Change.Speed == Speed) && ((Speed == 0) || (Change.Reason == Reason));
+    if (!Ok){
+        Failures++;
+    }
+    printf("%-52s %s (velocidad %d, motivo %d)\n", Name, Ok ? "ok" : "FALLA", Change.Speed, Change.Reason);
+}
+
+// Monedas repartidas entre From y To (ms), una por poll
+static void Coins(SpeedControlClass &Control, int Count, int From, int To){
+    for (int i = 0; i < Count; i++){
+        Control.Accepted(1, At(From + (To - From) * i / Count));
+    }
+}
+
+int main(){
+    Config_t Config = DefaultConfig();      // 2 a 5 monedas/s, ventana 5 s, 15 s sin monedas, sube al 60 %, baja al 20 %
+
+    // Velocidad inicial: si el validador no la acepta se vuelve a pedir en el siguiente poll
+    SpeedControlClass Control;
+    Control.Configure(Config);
+    Expect("inicio", Control.Start(At(0)), STARTSPEED, REASON_START);
+    Control.Failed(At(0));
+    Expect("inicio no aceptado: se reintenta", Control.Update(At(50)), STARTSPEED, REASON_START);
+    Control.Failed(At(50));
+    Expect("se sigue reintentando", Control.Update(At(100)), STARTSPEED, REASON_START);
+    Control.Applied(STARTSPEED, At(100));
+    Expect("inicio aceptado: sin cambio", Control.Update(At(150)), 0, REASON_NONE);
+
+    // Rafaga: 3 monedas/s * 60 % = 1.8 monedas/s, 10 monedas en 5 s suben un paso
+    Coins(Control, 10, 200, 5000);
+    Expect("rafaga antes de la ventana: sin cambio", Control.Update(At(5000)), 0, REASON_NONE);
+    Expect("rafaga con la ventana completa: sube", Control.Update(At(5100)), 4, REASON_BURST);
+    Control.Applied(4, At(5100));
+
+    // Histeresis: a 4 monedas/s hacen falta 2.4 monedas/s y una ventana completa a la velocidad nueva
+    Coins(Control, 20, 5200, 9000);
+    Expect("rafaga dentro de la ventana nueva: sin cambio", Control.Update(At(9000)), 0, REASON_NONE);
+    Expect("rafaga con la ventana nueva completa: sube", Control.Update(At(10100)), 5, REASON_BURST);
+    Control.Applied(5, At(10100));
+    Coins(Control, 30, 10200, 15100);
+    Expect("en MaxSpeed no sube", Control.Update(At(15200)), 0, REASON_NONE);
+
+    // Pocas monedas por debajo del umbral ni suben ni bajan
+    Coins(Control, 5, 15300, 20000);
+    Expect("entrada moderada: sin cambio", Control.Update(At(20200)), 0, REASON_NONE);
+
+    // Rechazos por velocidad: 2 de 8 eventos (25 %) bajan un paso
+    Coins(Control, 6, 20300, 25000);
+    Control.Rejected(18, At(21000));
+    Control.Rejected(37, At(22000));
+    Control.Rejected(254, At(23000));       // No depende de la velocidad, no cuenta
+    Expect("rechazos por velocidad: baja", Control.Update(At(25300)), 4, REASON_REJECTS);
+
+    // Un ajuste que el validador no acepta mantiene la velocidad y espera otra ventana
+    Control.Failed(At(25300));
+    Control.Rejected(19, At(25400));
+    Control.Rejected(38, At(25500));
+    Expect("ajuste no aceptado: espera la ventana", Control.Update(At(26000)), 0, REASON_NONE);
+    Expect("ajuste no aceptado: se reevalua", Control.Update(At(30400)), 4, REASON_REJECTS);
+    Control.Applied(4, At(30400));
+
+    // Disco bloqueado: baja sin esperar la ventana
+    Control.Rejected(118, At(30500));
+    Expect("disco bloqueado: baja de inmediato", Control.Update(At(30600)), 3, REASON_BLOCKED);
+    Control.Applied(3, At(30600));
+
+    // Sin monedas durante IdleMs (desde la ultima moneda) baja un paso por ventana hasta MinSpeed
+    Control.Accepted(1, At(31000));
+    Expect("sin monedas poco tiempo: sin cambio", Control.Update(At(40000)), 0, REASON_NONE);
+    Expect("sin monedas 15 s: baja", Control.Update(At(46000)), 2, REASON_IDLE);
+    Control.Applied(2, At(46000));
+    Expect("en MinSpeed no baja", Control.Update(At(60000)), 0, REASON_NONE);
+
+    // Limites configurados: la velocidad inicial se ajusta a MinSpeed
+    Config.MinSpeed = 4;
+    Control.Configure(Config);
+    Expect("inicio con MinSpeed 4", Control.Start(At(70000)), 4, REASON_START);
+
+    printf("%s\n", Failures ? "FALLA" : "ok");
+    return Failures ? 1 : 0;
+}
@@ -0,0 +1,309 @@
+/**
+ * @file replay-capture.cpp
+ * @brief Reproduce una captura binaria (capturePath / SerialCapture) sin hardware. read/write/usleep/sleep se
+ * reemplazan con --wrap: cada write avanza a la siguiente trama TX capturada del dispositivo y los read entregan los
+ * trozos RX que se recibieron despues de ella (0 bytes, como un timeout, cuando ya no hay mas). Asi las tramas pasan
+ * por ExecuteCommand y los HandleResponse* reales del driver. Las polls (CMDSTARTPOLL del Pelicano/Azkoyen, POLL del
+ * NV10) se corren con la maquina de estados en ST_POLLING y el evento EV_POLL, como lo hace getCoin/getBill; el
+ * resto de tramas se envian directo con ExecuteCommand. El dispensador no tiene poll en su maquina de estados, todas
+ * sus tramas van por ExecuteCommand. Las polls del NV10 corridas por la maquina de estados llevan el bit de secuencia
+ * del driver, por eso pueden contar como tramas distintas a la captura.
+ *
+ * Por defecto corre tan rapido como puede y reporta ns por comando (para pruebas de rendimiento con trafico real);
+ * con --realtime respeta los tiempos entre tramas TX de la captura (maximo 5 s por pausa).
+ *
+ * g++ -std=c++17 -O2 -I../src -I../src/spdlog/include replay-capture.cpp ../src/pelicano/ValidatorPelicano.cpp ../src/pelicano/StateMachine.cpp ../src/azkoyen/ValidatorAzkoyen.cpp ../src/azkoyen/StateMachine.cpp ../src/nv10/ValidatorNV10.cpp ../src/nv10/StateMachine.cpp ../src/dispenser/Dispenser.cpp ../src/common/Logging.cpp ../src/common/FlightRecorder.cpp ../src/common/SerialCapture.cpp -Wl,--wrap=read,--wrap=write,--wrap=usleep,--wrap=sleep -lpthread -o replay-capture
+ * ./replay-capture captura.bin pelicano [--instance N] [--realtime] [--repeat N] [--log trace|debug|info]
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/SerialCapture.hpp"
+#include "pelicano/StateMachine.hpp"
+#include "azkoyen/StateMachine.hpp"
+#include "nv10/StateMachine.hpp"
+#include "dispenser/Dispenser.hpp"
+
+// Pausa maxima entre tramas con --realtime (las capturas de varios dias tienen huecos de horas)
+static const uint64_t MAXGAPNS = 5000000000ULL;
+
+static std::vector<SerialCapture::Record_t> Records;   // Solo los registros del dispositivo e instancia elegidos
+static size_t Cursor = 0;           // Siguiente registro sin consumir
+static size_t Offset = 0;           // Bytes ya entregados del registro RX actual
+static bool Realtime = false;
+static std::chrono::steady_clock::time_point PassStart;     // Inicio de la pasada actual (--realtime)
+
+static long Mismatches = 0;         // Tramas escritas por el driver distintas a la capturada
+static long UnreadChunks = 0;       // Trozos RX que el driver no leyo antes de escribir la siguiente trama
+static long MissingTx = 0;          // Escrituras despues de la ultima trama TX de la captura
+
+// Codigo que se cuenta para las tramas que no se envian (ACK sueltos del dispensador)
+static const int SKIPPED = 999;
+
+extern "C" {
+    ssize_t __wrap_write(int Fd, const void *Buf, size_t Count){
+        (void)Fd;
+        while ((Cursor < Records.size()) && (Records[Cursor].Header.Direction != SerialCapture::DIRECTION_TX)){
+            UnreadChunks++;
+            Cursor++;
+        }
+        Offset = 0;
+        if (Cursor >= Records.size()){
+            MissingTx++;
+            return Count;
+        }
+        const SerialCapture::Record_t &Tx = Records[Cursor++];
+        if ((Tx.Data.size() != Count) || (memcmp(&Tx.Data[0], Buf, Count) != 0)){
+            Mismatches++;
+        }
+        if (Realtime){
+            std::this_thread::sleep_until(PassStart + std::chrono::nanoseconds(Tx.Header.TimeNs));
+        }
+        return Count;
+    }
+
+    ssize_t __wrap_read(int Fd, void *Buf, size_t Count){
+        (void)Fd;
+        if ((Cursor >= Records.size()) || (Records[Cursor].Header.Direction != SerialCapture::DIRECTION_RX)){
+            return 0;
+        }
+        const SerialCapture::Record_t &Rx = Records[Cursor];
+        size_t Length = Rx.Data.size() - Offset;
+        if (Length > Count){
+            Length = Count;
+        }
+        memcpy(Buf, &Rx.Data[Offset], Length);
+        Offset += Length;
+        if (Offset >= Rx.Data.size()){
+            Offset = 0;
+            Cursor++;
+        }
+        return Length;
+    }
+
+    int __wrap_usleep(useconds_t Usec){
+        (void)Usec;
+        return 0;
+    }
+
+    unsigned int __wrap_sleep(unsigned int Seconds){
+        (void)Seconds;
+        return 0;
+    }
+}
+
+struct Stats_t{
+    long Commands = 0;              // Tramas enviadas con ExecuteCommand
+    long Polls = 0;                 // Polls corridas con la maquina de estados
+    std::map<int, long> ExecCodes;  // Codigo de ExecuteCommand -> veces
+    std::map<int, long> PollCodes;  // Respuesta de StPolling -> veces
+};
+
+/**
+ * @brief Recorre la captura una vez. Execute envia una trama con ExecuteCommand, Poll corre EV_POLL si la trama es
+ * la poll del dispositivo (regresa false si no lo es)
+ */
+template <typename Execute_t, typename Poll_t>
+static void ReplayOnce(Stats_t &Stats, Execute_t Execute, Poll_t Poll){
+    Cursor = 0;
+    Offset = 0;
+    PassStart = std::chrono::steady_clock::now();
+    while (Cursor < Records.size()){
+        if (Records[Cursor].Header.Direction != SerialCapture::DIRECTION_TX){
+            UnreadChunks++;
+            Cursor++;
+            continue;
+        }
+        size_t Before = Cursor;
+        std::vector<unsigned char> Tx = Records[Cursor].Data;
+        int Response;
+        if (Poll(Tx, Response)){
+            Stats.Polls++;
+            Stats.PollCodes[Response]++;
+        }
+        else {
+            Stats.Commands++;
+            Stats.ExecCodes[Execute(Tx)]++;
+        }
+        if (Cursor == Before){
+            // El driver no escribio (error antes del write), se salta la trama para no quedar en un ciclo
+            Cursor++;
+        }
+    }
+}
+
+static void PrintCodes(const char *Title, const std::map<int, long> &Codes){
+    for (const auto &Code : Codes){
+        printf("  %-14s %5d: %ld\n", Title, Code.first, Code.second);
+    }
+}
+
+template <typename Validator_t>
+static void InitValidator(Validator_t &Validator, const std::string &LogPath, spdlog::level::level_enum Level){
+    Validator.InitLogger(LogPath);
+    Validator.logger->set_level(Level);
+    Validator.SerialPort = -1;
+}
+
+int main(int argc, char *argv[]){
+    if (argc < 3){
+        fprintf(stderr, "uso: %s <captura> <pelicano|azkoyen|nv10|dispenser> [--instance N] [--realtime] [--repeat N] [--log trace|debug|info]\n", argv[0]);
+        return 1;
+    }
+    std::string Path = argv[1];
+    std::string Device = argv[2];
+    int Instance = -1;
+    int Repeat = 1;
+    spdlog::level::level_enum Level = spdlog::level::info;
+    for (int i = 3; i < argc; i++){
+        std::string Arg = argv[i];
+        if ((Arg == "--instance") && (i + 1 < argc)){
+            Instance = atoi(argv[++i]);
+        }
+        else if ((Arg == "--repeat") && (i + 1 < argc)){
+            Repeat = atoi(argv[++i]);
+        }
+        else if ((Arg == "--log") && (i + 1 < argc)){
+            Level = spdlog::level::from_str(argv[++i]);
+        }
+        else if (Arg == "--realtime"){
+            Realtime = true;
+        }
+    }
+
+    std::vector<SerialCapture::Record_t> All;
+    int Read = SerialCapture::ReadCapture(Path, All);
+    if (Read == 1){
+        fprintf(stderr, "%s no es un archivo de captura\n", Path.c_str());
+        return 1;
+    }
+    if (Read == 2){
+        fprintf(stderr, "aviso: el ultimo registro de %s esta incompleto, se ignora\n", Path.c_str());
+    }
+    if (Read == 3){
+        fprintf(stderr, "aviso: %s esta dañado despues del registro %zu, se reproduce hasta ahi\n", Path.c_str(), All.size());
+    }
+
+    int DeviceId = 0;
+    for (int d = SerialCapture::DEVICE_PELICANO; d < SerialCapture::DEVICE_COUNT; d++){
+        if (Device == SerialCapture::DeviceName(d)){
+            DeviceId = d;
+        }
+    }
+    if (DeviceId == 0){
+        fprintf(stderr, "dispositivo desconocido: %s\n", Device.c_str());
+        return 1;
+    }
+    for (const auto &Record : All){
+        if (Record.Header.Device != DeviceId){
+            continue;
+        }
+        if (Instance < 0){
+            Instance = Record.Header.Instance;
+        }
+        if (Record.Header.Instance == Instance){
+            Records.push_back(Record);
+        }
+    }
+    if (Records.empty()){
+        fprintf(stderr, "%s no tiene registros de %s\n", Path.c_str(), Device.c_str());
+        return 1;
+    }
+    // Tiempos relativos al primer registro. Huecos largos (reinicios, horas sin actividad) o hacia atras (cambio de
+    // hora del equipo) se recortan para --realtime
+    uint64_t Prev = Records[0].Header.TimeNs;
+    Records[0].Header.TimeNs = 0;
+    for (size_t i = 1; i < Records.size(); i++){
+        uint64_t Now = Records[i].Header.TimeNs;
+        uint64_t Gap = (Now > Prev) ? Now - Prev : 0;
+        Records[i].Header.TimeNs = Records[i - 1].Header.TimeNs + ((Gap < MAXGAPNS) ? Gap : MAXGAPNS);
+        Prev = Now;
+    }
+
+    std::string LogPath = Path + ".replay.log";
+    Stats_t Stats;
+    auto ReplayStart = std::chrono::steady_clock::now();
+    auto NoPoll = [](const std::vector<unsigned char> &, int &){ return false; };
+
+    if (DeviceId == SerialCapture::DEVICE_PELICANO){
+        ValidatorPelicano::PelicanoClass Validator;
+        InitValidator(Validator, LogPath, Level);
+        PelicanoStateMachine::PelicanoSMClass SM(&Validator);
+        SM.SM.CurrState = PelicanoStateMachine::PelicanoSMClass::ST_POLLING;
+        for (int r = 0; r < Repeat; r++){
+            ReplayOnce(Stats, [&](std::vector<unsigned char> &Tx){ return Validator.ExecuteCommand(Tx); },
+                [&](const std::vector<unsigned char> &Tx, int &Response){
+                    if ((Tx.size() < 4) || (Tx[3] != 0xE5)){
+                        return false;
+                    }
+                    Response = SM.StateMachineRun(PelicanoStateMachine::PelicanoSMClass::EV_POLL);
+                    return true;
+                });
+        }
+    }
+    else if (DeviceId == SerialCapture::DEVICE_AZKOYEN){
+        ValidatorAzkoyen::AzkoyenClass Validator;
+        InitValidator(Validator, LogPath, Level);
+        AzkoyenStateMachine::AzkoyenSMClass SM(&Validator);
+        SM.SM.CurrState = AzkoyenStateMachine::AzkoyenSMClass::ST_POLLING;
+        for (int r = 0; r < Repeat; r++){
+            ReplayOnce(Stats, [&](std::vector<unsigned char> &Tx){ return Validator.ExecuteCommand(Tx); },
+                [&](const std::vector<unsigned char> &Tx, int &Response){
+                    if ((Tx.size() < 4) || (Tx[3] != 0xE5)){
+                        return false;
+                    }
+                    Response = SM.StateMachineRun(AzkoyenStateMachine::AzkoyenSMClass::EV_POLL);
+                    return true;
+                });
+        }
+    }
+    else if (DeviceId == SerialCapture::DEVICE_NV10){
+        ValidatorNV10::NV10Class Validator;
+        InitValidator(Validator, LogPath, Level);
+        NV10StateMachine::NV10SMClass SM(&Validator);
+        SM.SM.CurrState = NV10StateMachine::NV10SMClass::ST_POLLING;
+        for (int r = 0; r < Repeat; r++){
+            ReplayOnce(Stats, [&](std::vector<unsigned char> &Tx){ return Validator.ExecuteCommand(Tx); },
+                [&](const std::vector<unsigned char> &Tx, int &Response){
+                    // STX, secuencia/direccion, longitud, comando (el driver pone su propio bit de secuencia)
+                    if ((Tx.size() < 4) || (Tx[3] != 0x07)){
+                        return false;
+                    }
+                    Response = SM.StateMachineRun(NV10StateMachine::NV10SMClass::EV_POLL);
+                    return true;
+                });
+        }
+    }
+    else {
+        Dispenser::DispenserClass Validator;
+        InitValidator(Validator, LogPath, Level);
+        for (int r = 0; r < Repeat; r++){
+            ReplayOnce(Stats, [&](std::vector<unsigned char> &Tx){
+                    // El ACK que escribe WriteAck ya se consume dentro de ExecuteCommand; uno suelto no es un comando
+                    return (Tx.size() < 7) ? SKIPPED : Validator.ExecuteCommand(Tx, 0);
+                }, NoPoll);
+        }
+    }
+
+    double Ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - ReplayStart).count();
+    long Total = Stats.Commands + Stats.Polls;
+    printf("%s instancia %d: %zu registros, %d pasadas\n", Device.c_str(), Instance, Records.size(), Repeat);
+    printf("  comandos %ld, polls por maquina de estados %ld\n", Stats.Commands, Stats.Polls);
+    PrintCodes("ExecuteCommand", Stats.ExecCodes);
+    PrintCodes("StPolling", Stats.PollCodes);
+    if (Stats.ExecCodes.count(SKIPPED) > 0){
+        printf("  (%d: trama suelta que no se envia)\n", SKIPPED);
+    }
+    printf("  tramas distintas a la captura %ld, trozos RX sin leer %ld, escrituras sin trama capturada %ld\n", Mismatches, UnreadChunks, MissingTx);
+    printf("  %.1f ms en total, %.1f ns/comando%s\n", Ns / 1e6, (Total > 0) ? Ns / Total : 0.0, Realtime ? " (tiempo real)" : "");
+    spdlog::shutdown();
+    return 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file ssp-link-loss.cpp
+ * @brief Mide la recuperacion del enlace SSP del NV10 con perdida de bytes, sin hardware. Un hilo hace de billetero
+ * al otro lado de un socketpair: responde OK a cada comando, repite su ultima respuesta cuando recibe el mismo bit de
+ * secuencia (como lo pide SSP) y reinicia la secuencia con SYNC. Cada byte, en las dos direcciones, se pierde con
+ * la probabilidad indicada. El driver corre SendingCommand(POLL) real (ExecuteCommand, ReadFrame, CRC, reenvios y
+ * SYNC) y al final se reportan la latencia por comando, los comandos fallidos y los contadores del enlace.
+ *
+ * g++ -std=c++17 -O2 -I../src -I../src/spdlog/include ssp-link-loss.cpp ../src/nv10/ValidatorNV10.cpp ../src/common/Logging.cpp ../src/common/FlightRecorder.cpp ../src/common/SerialCapture.cpp -lpthread -o ssp-link-loss
+ * ./ssp-link-loss [--loss 0.02] [--count 500] [--timeout 200] [--retries 3] [--sync-after 2] [--delay 5]
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include "nv10/ValidatorNV10.hpp"
+#include "spdlog/sinks/null_sink.h"
+
+static double Loss = 0.02;          // Probabilidad de perder cada byte
+static int DelayMs = 5;             // Tiempo de respuesta del billetero simulado
+static std::atomic<bool> Running(true);
+
+// --------------- BILLETERO SIMULADO --------------------//
+
+static std::mt19937 Random(12345);
+
+static bool Drop(){
+    return std::uniform_real_distribution<double>(0, 1)(Random) < Loss;
+}
+
+static std::vector<unsigned char> Reply(ValidatorNV10::NV10Class &Crc, unsigned char Seq){
+    std::vector<unsigned char> Frame = {0x7F, Seq, 0x01, 0xF0};
+    std::vector<unsigned char> Body(Frame.begin() + 1, Frame.end());
+    std::vector<unsigned char> Sum = Crc.CalcCRC(Body);
+    Frame.insert(Frame.end(), Sum.begin(), Sum.end());
+    for (size_t i = 1; i < Frame.size(); i++){
+        if (Frame[i] == 0x7F){
+            Frame.insert(Frame.begin() + i, 0x7F);
+            i++;
+        }
+    }
+    return Frame;
+}
+
+static void Slave(int Fd){
+    ValidatorNV10::NV10Class Crc;
+    std::vector<unsigned char> Frame;       // Trama recibida sin relleno
+    std::vector<unsigned char> Last;        // Ultima respuesta, se repite si llega el mismo bit de secuencia
+    int LastSeq = -1;
+    bool Stuffed = false;
+    unsigned char Byte;
+
+    while (Running){
+        if (recv(Fd, &Byte, 1, 0) != 1){
+            continue;
+        }
+        if (Drop()){
+            continue;
+        }
+        if (Frame.empty()){
+            if (Byte == 0x7F){
+                Frame.push_back(Byte);
+            }
+            continue;
+        }
+        if (Stuffed){
+            Stuffed = false;
+            if (Byte != 0x7F){
+                Frame.assign(1, 0x7F);
+            }
+        }
+        else if (Byte == 0x7F){
+            Stuffed = true;
+            continue;
+        }
+        Frame.push_back(Byte);
+        if ((Frame.size() < 3) || (Frame.size() < 5u + Frame[2])){
+            continue;
+        }
+
+        std::vector<unsigned char> Body(Frame.begin() + 1, Frame.begin() + 3 + Frame[2]);
+        std::vector<unsigned char> Sum = Crc.CalcCRC(Body);
+        bool Valid = (Sum[0] == Frame[3 + Frame[2]]) && (Sum[1] == Frame[4 + Frame[2]]);
+        int Seq = Frame[1] & 0x80;
+        bool Sync = (Frame[2] >= 1) && (Frame[3] == 0x11);
+        Frame.clear();
+        // Una trama con CRC invalido no se responde, el host la reenvia cuando se cumple su tiempo de espera
+        if (!Valid){
+            continue;
+        }
+        if (Sync || (Seq != LastSeq) || Last.empty()){
+            Last = Reply(Crc, static_cast<unsigned char>(Seq));
+            LastSeq = Seq;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(DelayMs));
+        for (unsigned char Out : Last){
+            if (!Drop()){
+                send(Fd, &Out, 1, 0);
+            }
+        }
+    }
+}
+
+// --------------- MAIN --------------------//
+
+int main(int argc, char *argv[]){
+    int Count = 500;
+    int TimeoutMs = ValidatorNV10::RETRYTIMEOUTMS;
+    int Retries = ValidatorNV10::MAXRETRIES;
+    int SyncAfter = ValidatorNV10::SYNCAFTER;
+
+    for (int i = 1; i + 1 < argc; i += 2){
+        std::string Arg = argv[i];
+        if (Arg == "--loss") Loss = atof(argv[i + 1]);
+        else if (Arg == "--count") Count = atoi(argv[i + 1]);
+        else if (Arg == "--timeout") TimeoutMs = atoi(argv[i + 1]);
+        else if (Arg == "--retries") Retries = atoi(argv[i + 1]);
+        else if (Arg == "--sync-after") SyncAfter = atoi(argv[i + 1]);
+        else if (Arg == "--delay") DelayMs = atoi(argv[i + 1]);
+        else {
+            fprintf(stderr, "Opcion desconocida %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    int Fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, Fds) != 0){
+        perror("socketpair");
+        return 1;
+    }
+    // Como VTIME = 1 en el puerto real: cada read espera maximo 100 ms
+    struct timeval Tv = {0, 100000};
+    setsockopt(Fds[0], SOL_SOCKET, SO_RCVTIMEO, &Tv, sizeof(Tv));
+    setsockopt(Fds[1], SOL_SOCKET, SO_RCVTIMEO, &Tv, sizeof(Tv));
+    std::thread SlaveThread(Slave, Fds[1]);
+
+    ValidatorNV10::NV10Class Validator;
+    Validator.logger = spdlog::null_logger_mt("ssp-link-loss");
+    Validator.SerialPort = Fds[0];
+    Validator.RetryTimeoutMs = TimeoutMs;
+    Validator.MaxRetries = Retries;
+    Validator.SyncAfter = SyncAfter;
+    Validator.Sync();
+
+    std::vector<double> Latency;
+    int Failed = 0;
+    for (int i = 0; i < Count; i++){
+        std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+        int Res = Validator.SendingCommand({0x07});
+        Latency.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count());
+        if ((Res != 0) && (Res != -2)){
+            Failed++;
+        }
+    }
+
+    Running = false;
+    SlaveThread.join();
+
+    std::sort(Latency.begin(), Latency.end());
+    double Sum = 0;
+    for (double Ms : Latency){
+        Sum += Ms;
+    }
+    const ValidatorNV10::LinkStats_t &Link = Validator.Link;
+    printf("perdida %.3f, timeout %d ms, %d reenvios, SYNC despues de %d fallas\n", Loss, TimeoutMs, Retries, SyncAfter);
+    printf("comandos %d, fallidos %d (%.2f%%)\n", Count, Failed, 100.0 * Failed / Count);
+    printf("latencia ms: promedio %.1f, p50 %.1f, p99 %.1f, max %.1f\n", Sum / Count, Latency[Count / 2],
+           Latency[(Count * 99) / 100], Latency.back());
+    printf("enlace: reenvios %llu, timeouts %llu, crc %llu, fallas %llu, sync %llu\n",
+           (unsigned long long)Link.Retries, (unsigned long long)Link.Timeouts, (unsigned long long)Link.CrcErrors,
+           (unsigned long long)Link.Failures, (unsigned long long)Link.Resyncs);
+    printf("recuperacion: %llu comandos, promedio %.1f ms, max %.1f ms\n", (unsigned long long)Link.Recovered,
+           Link.Recovered ? Link.RecoveryUs / 1000.0 / Link.Recovered : 0.0, Link.MaxRecoveryUs / 1000.0);
+    return 0;
+}
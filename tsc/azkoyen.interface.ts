@@ -1,4 +1,4 @@
-import { CommandResponse, DeviceStatus, UnsubscribeFunc } from "./interface";
+import { CommandResponse, DeviceStatus, QueueStats, PollStats, PollRateOptions, FlightRecorderDump, JournalEvent, UnsubscribeFunc } from "./interface";
 import { CoinResult, LostCoins } from "./interface";
 
 export interface IAzkoyen {
@@ -13,6 +13,11 @@ export interface IAzkoyen {
   testStatus(): DeviceStatus;
   cleanDevice(): CommandResponse;
   onCoin(callback: (coin: CoinResult) => void): UnsubscribeFunc;
+  getQueueStats(): QueueStats;
+  dumpFlightRecorder(): FlightRecorderDump;
+  // Eventos del diario con secuencia mayor a `since` (maximo 1024 por llamada)
+  getEvents(since?: number): JournalEvent[];
+  getPollStats(): PollStats;
 }
 
 export interface AzkoyenOptions {
@@ -21,4 +26,12 @@ export interface AzkoyenOptions {
   maximumPorts: number;
   logLevel: number;
   logPath: string;
+  // Sin `message` en getCoin/onCoin, se busca por statusCode en la tabla estatica `messages`
+  compact?: boolean;
+  // Archivo donde se agrega cada trama enviada/recibida (formato binario, ver test/replay-capture.cpp)
+  capturePath?: string;
+  // Diario binario de monedas/billetes aceptados, rechazos y tarjetas dispensadas (ver getEvents)
+  journalPath?: string;
+  // Espera adaptativa entre polls de onCoin
+  pollRate?: PollRateOptions;
 }
\ No newline at end of file
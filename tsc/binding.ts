@@ -9,10 +9,12 @@ const addons = require('node-gyp-build')(join(__dirname, '..'));
 
 export var Pelicano: {
   new (options: PelicanoOptions): IPelicano
+  messages: Readonly<Record<number, string>>
 } = addons.Pelicano;
 
 export var Azkoyen: {
   new (options: AzkoyenOptions): IAzkoyen
+  messages: Readonly<Record<number, string>>
 } = addons.Azkoyen;
 
 export var Dispenser: {
@@ -21,4 +23,5 @@ export var Dispenser: {
 
 export var NV10: {
   new (options: NV10Options): INV10
+  messages: Readonly<Record<number, string>>
 } = addons.NV10;
\ No newline at end of file
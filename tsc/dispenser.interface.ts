@@ -1,4 +1,4 @@
-import { CommandResponse, DeviceStatus, UnsubscribeFunc } from "./interface"
+import { CommandResponse, DeviceStatus, QueueStats, PollStats, PollRateOptions, FlightRecorderDump, JournalEvent, UnsubscribeFunc } from "./interface"
 
 export interface IDispenser {
   connect(): CommandResponse;
@@ -9,6 +9,16 @@ export interface IDispenser {
   getDispenserFlags(): DispenserFlags;
   testStatus(): DeviceStatus;
   onDispense(callback: (dispenseStatus: CommandResponse) => void): UnsubscribeFunc;
+  getQueueStats(): QueueStats;
+  dumpFlightRecorder(): FlightRecorderDump;
+  // Eventos del diario con secuencia mayor a `since` (maximo 1024 por llamada)
+  getEvents(since?: number): JournalEvent[];
+  // Cambios de las banderas del estado. La primera llamada trae el valor actual de cada bandera
+  onStatus(callback: (change: DispenserFlagChange) => void): UnsubscribeFunc;
+  getPollStats(): PollStats;
+  // Dispensa `count` tarjetas seguidas: la siguiente sale en cuanto se confirma que se retiro la anterior.
+  // Se detiene en el primer error o al llamar la funcion que regresa
+  dispenseCards(count: number, options: DispenseCardsOptions): UnsubscribeFunc;
 }
 
 export interface DispenserOptions {
@@ -18,6 +28,12 @@ export interface DispenserOptions {
   maximumPorts: number;
   logPath: string;
   logLevel: string;
+  // Archivo donde se agrega cada trama enviada/recibida (formato binario, ver test/replay-capture.cpp)
+  capturePath?: string;
+  // Diario binario de monedas/billetes aceptados, rechazos y tarjetas dispensadas (ver getEvents)
+  journalPath?: string;
+  // Ritmo de lectura del estado en onStatus/onDispense (limites 20 ms a 2000 ms)
+  pollRate?: PollRateOptions;
 }
 
 export interface DispenserFlags {
@@ -26,4 +42,33 @@ export interface DispenserFlags {
   cardInG: boolean;
   cardsInD: boolean;
   dispenserF: boolean;
+}
+
+export interface DispenseCardsOptions {
+  // Cada tarjeta se reporta dos veces: al llegar a la puerta (taken = false) y al retirarse (taken = true)
+  onCard: (card: DispensedCard) => void;
+  // Resultado del lote: 205 todas entregadas, 306 detenido, o el codigo del error que lo detuvo
+  onEnd?: (result: CommandResponse) => void;
+  // Espera maxima en ms a que se retire cada tarjeta (517 si se cumple). 0 o sin definir: sin limite
+  takeTimeout?: number;
+}
+
+export interface DispensedCard {
+  // Numero de la tarjeta en el lote, desde 1
+  index: number;
+  taken: boolean;
+  statusCode: number;
+  message: string;
+  // Desde la orden hasta que la tarjeta llego a la puerta
+  dispenseMs: number;
+  // Desde que llego a la puerta hasta que se retiro (0 al llegar a la puerta)
+  takenMs: number;
+}
+
+export interface DispenserFlagChange {
+  // Milisegundos desde 1970, hora en que se leyo el estado
+  time: number;
+  // Bandera de DispenserFlags o "responding" cuando el dispensador deja de responder o vuelve a hacerlo
+  flag: keyof DispenserFlags | "responding";
+  value: boolean;
 }
\ No newline at end of file
@@ -27,4 +27,55 @@ export interface LostCoins {
   "1000": number;
 }
 
+export interface QueueClassStats {
+  count: number;
+  avgWaitUs: number;
+  maxWaitUs: number;
+}
+
+export interface QueueStats {
+  urgent: QueueClassStats;
+  normal: QueueClassStats;
+  poll: QueueClassStats;
+}
+
+export interface PollRateOptions {
+  // Espera entre polls durante la actividad y maxima sin actividad, en ms. Se ajustan a los limites del protocolo:
+  // ccTalk (pelicano, azkoyen) 10 a 600, SSP (nv10) 100 a 1000
+  fastMs?: number;
+  maxMs?: number;
+  // Tiempo con la espera corta despues de la ultima moneda/billete (5000). Despues la espera se duplica en cada poll
+  activeWindowMs?: number;
+}
+
+export interface PollStats {
+  active: boolean;
+  // Espera actual entre polls
+  intervalMs: number;
+  fastMs: number;
+  maxMs: number;
+  activeWindowMs: number;
+  // Polls desde startReader y cuantos se hicieron con la espera corta
+  polls: number;
+  fastPolls: number;
+}
+
+export interface FlightRecorderDump {
+  // Entradas escritas, -1 si no se pudo escribir el archivo
+  count: number;
+  path: string;
+}
+
+export interface JournalEvent {
+  // Secuencia continua del diario, se usa como `since` en la siguiente llamada a getEvents
+  sequence: number;
+  // Milisegundos desde 1970
+  time: number;
+  device: "pelicano" | "azkoyen" | "nv10" | "dispenser";
+  type: "coinAccepted" | "coinRejected" | "billAccepted" | "billRejected" | "dispense" | "speedChange";
+  value: number;
+  channel: number;
+  statusCode: number;
+}
+
 export type UnsubscribeFunc = () => void;
\ No newline at end of file
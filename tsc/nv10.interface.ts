@@ -1,21 +1,72 @@
-import { CommandResponse, DeviceStatus, UnsubscribeFunc } from "./interface"
+import { CommandResponse, DeviceStatus, QueueStats, PollStats, PollRateOptions, FlightRecorderDump, JournalEvent, UnsubscribeFunc } from "./interface"
 
 export interface INV10 {
   connect(): CommandResponse;
   checkDevice(): CommandResponse;
   startReader(): CommandResponse;
   getBill(): Bill;
+  // Bit i en 0 inhibe el canal i + 1 (hasta 24 canales)
   modifyChannels(inhibitMask: number): CommandResponse;
   stopReader(): CommandResponse;
   reject(): CommandResponse;
   testStatus(): DeviceStatus;
   onBill(callback: (bill: Bill) => void): UnsubscribeFunc;
+  getQueueStats(): QueueStats;
+  dumpFlightRecorder(): FlightRecorderDump;
+  // Eventos del diario con secuencia mayor a `since` (maximo 1024 por llamada)
+  getEvents(since?: number): JournalEvent[];
+  // Reemplaza la politica de custodia; el total aceptado en la sesion se conserva
+  setEscrowPolicy(policy: EscrowPolicy): CommandResponse;
+  // Libera el billete en custodia (315), el siguiente poll lo acepta. reject() lo devuelve
+  acceptEscrow(): CommandResponse;
+  resetEscrowSession(): CommandResponse;
+  getLinkStats(): LinkStats;
+  getPollStats(): PollStats;
 }
 
 export interface NV10Options {
   maximumPorts: number;
   logPath: string;
   logLevel: number;
+  // Sin `message` en getBill/onBill, se busca por statusCode en la tabla estatica `messages`
+  compact?: boolean;
+  // Archivo donde se agrega cada trama enviada/recibida (formato binario, ver test/replay-capture.cpp)
+  capturePath?: string;
+  // Diario binario de monedas/billetes aceptados, rechazos y tarjetas dispensadas (ver getEvents)
+  journalPath?: string;
+  // Tabla de canales leida con SETUP_REQUEST, guardada por version de dataset. En la siguiente conexion solo se
+  // consulta la version del dataset; si no cambio se usa la tabla guardada
+  channelCachePath?: string;
+  // Espera de cada intento SSP en ms (200 por defecto), reenvios de la misma trama (3) y comandos fallidos
+  // seguidos antes de SYNC (2)
+  retryTimeout?: number;
+  maxRetries?: number;
+  syncAfter?: number;
+  // Espera adaptativa entre polls de onBill, corta mientras hay un billete en lectura o en custodia
+  pollRate?: PollRateOptions;
+}
+
+export interface LinkStats {
+  commands: number;
+  retries: number;
+  timeouts: number;
+  crcErrors: number;
+  failures: number;
+  resyncs: number;
+  // Tiempo desde el primer envio hasta la respuesta de los comandos que necesitaron reenvio
+  avgRecoveryUs: number;
+  maxRecoveryUs: number;
+}
+
+export type EscrowAction = 'accept' | 'reject' | 'hold';
+
+export interface EscrowPolicy {
+  // rules[i] es la accion para el canal i + 1, los canales sin regla se aceptan
+  rules?: EscrowAction[];
+  // Maximo en COP a aceptar en la sesion (0 sin maximo), los billetes que lo superan se rechazan (314)
+  sessionMax?: number;
+  // Milisegundos en custodia antes de rechazar el billete (316), por defecto 10000
+  holdTimeout?: number;
 }
 
 export interface Bill extends CommandResponse {
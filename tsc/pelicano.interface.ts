@@ -1,29 +1,85 @@
-import { CommandResponse, DeviceStatus, UnsubscribeFunc } from "./interface";
+import { CommandResponse, DeviceStatus, QueueStats, PollStats, PollRateOptions, FlightRecorderDump, JournalEvent, UnsubscribeFunc } from "./interface";
 import { CoinResult, LostCoins } from "./interface";
 
 export interface IPelicano {
   connect(): CommandResponse;
   checkDevice(): CommandResponse;
-  startReader(): CommandResponse;
+  startReader(): CleanResponse;
   getCoin(): CoinResult;
   getLostCoins(): LostCoins;
   modifyChannels(inhibitMask1: number, inhibitMask2: number): CommandResponse;
-  stopReader(): CommandResponse;
+  stopReader(): CleanResponse;
   resetDevice(): CommandResponse;
   testStatus(): DeviceStatus;
-  cleanDevice(): CommandResponse;
+  cleanDevice(): CleanResponse;
   onCoin(callback: (coin: CoinResult) => void): UnsubscribeFunc;
+  getQueueStats(): QueueStats;
+  dumpFlightRecorder(): FlightRecorderDump;
+  // Eventos del diario con secuencia mayor a `since` (maximo 1024 por llamada)
+  getEvents(since?: number): JournalEvent[];
   getInsertedCoins(): PelicanoUsage;
+  // Sale del reposo: enciende el motor y vuelve al polling normal (statusCode 208, 512 si el motor no arranco)
+  wake(): CommandResponse;
+  getPowerStats(): PowerStats;
+  getPollStats(): PollStats;
 }
 
 interface PelicanoUsage extends CommandResponse {
   insertedCoins: number;
 }
 
+interface PowerStats {
+  idle: boolean;
+  // Milisegundos con el lector iniciado y el motor encendido / apagado por inactividad
+  activeMs: number;
+  idleMs: number;
+  wakeups: number;
+}
+
+interface CleanResponse extends CommandResponse {
+  // Milisegundos que tardo la limpieza de la bandeja en esta llamada, 0 si no se limpio
+  cleanMs: number;
+}
+
 export interface PelicanoOptions {
   warnToCritical: number;
   maxCritical: number;
   maximumPorts: number;
   logLevel: number;
   logPath: string;
+  // Sin `message` en getCoin/onCoin, se busca por statusCode en la tabla estatica `messages`
+  compact?: boolean;
+  // Archivo donde se agrega cada trama enviada/recibida (formato binario, ver test/replay-capture.cpp)
+  capturePath?: string;
+  // Diario binario de monedas/billetes aceptados, rechazos y tarjetas dispensadas (ver getEvents)
+  journalPath?: string;
+  // Archivo con el cursor de eventos, mascaras y contadores. Si el proceso se reinicia con el lector iniciado,
+  // startReader retoma el polling sin reiniciar el validador (statusCode 207)
+  statePath?: string;
+  // Tiempo maximo de la limpieza de la bandeja en ms (7000 por defecto). La limpieza termina antes, cuando los
+  // optosensores reportan la bandeja vacia y la compuerta cerrada
+  cleanTimeout?: number;
+  // Control adaptativo de la velocidad del disco (monedas por segundo, 2 a 5). Sin esta opcion la velocidad no se cambia.
+  // Cada cambio queda en el diario como evento speedChange
+  speedControl?: SpeedControlOptions;
+  // Espera adaptativa entre polls de onCoin con el motor encendido
+  pollRate?: PollRateOptions;
+  // Sin monedas ni sensores durante este tiempo (ms) se apaga el motor y el polling baja a idlePollInterval.
+  // La primera moneda o sensor en la bandeja, wake() o startReader lo vuelven a encender. 0 o sin definir: sin reposo
+  idleTimeout?: number;
+  // Intervalo (ms) con el que se leen los optosensores en reposo (1000)
+  idlePollInterval?: number;
+}
+
+export interface SpeedControlOptions {
+  minSpeed?: number;
+  maxSpeed?: number;
+  // Ventana (ms) en la que se cuentan monedas y rechazos, tambien es la espera minima entre cambios (5000)
+  windowMs?: number;
+  // Sin monedas durante este tiempo se baja un paso (15000)
+  idleMs?: number;
+  // Se sube un paso cuando las monedas por segundo llegan a este % de la velocidad actual (60)
+  upPercent?: number;
+  // Se baja un paso cuando los rechazos por velocidad (moneda rapida/lenta, disco bloqueado) llegan a este % (20)
+  rejectPercent?: number;
 }
\ No newline at end of file